@@ -0,0 +1,288 @@
+#include <atomic>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <stdlib.h>
+#include <thread>
+#include "Audio.h"
+#include "Bench.h"
+#include "Scheduler.h"
+
+// The file the WAV sink writes, it is removed afterwards
+#define AUDIO_BENCH_FILE "audio_bench.wav"
+
+/* Sets the sound timer to "kk" with its second instruction then spins, the timer is set with 8 instructions of the first
+ * frame left so it sounds for those and "kk" - 1 whole frames after */
+static const u8 audioBeepProgram[] = {
+    0x60, 0x00,     // 0x200 LD V0, kk
+    0xF0, 0x18,     // 0x202 LD ST, V0
+    0x12, 0x04      // 0x204 JP 0x204
+};
+
+// Returns the samples the buzzer sounded in setting the sound timer to "length" and running "frames" frames
+static u64 beepSamples(u8 length, u32 frames, u64& samples)
+{
+    u8 program[sizeof(audioBeepProgram)];
+    memcpy(program, audioBeepProgram, sizeof(program));
+    program[1] = length;
+    BenchCore core;
+    core.loadMemory(program, sizeof(program));
+    NullAudioSink sink;
+    Chip8Audio audio;
+    audio.setSink(&sink);
+    for (u32 f = 0; f < frames; f++)
+        audio.execute(core, CHIP8_INSTRUCTIONS_PER_FRAME);
+    samples = sink.getSamples();
+    return sink.getLoudSamples();
+}
+
+/* Returns the samples the buzzer sounded in "frames" frames of "rom" at "instructionsPerFrame" on "engine" with idle
+ * skipping and every fused pattern on, the audio is given "step" instructions at a time */
+static u64 soundedSamples(const char* rom, DISPATCH_ENGINE engine, u16 instructionsPerFrame, u32 frames, u32 step)
+{
+    BenchCore core;
+    core.loadFile(rom);
+    core.setDispatchEngine(engine);
+    core.setInstructionsPerFrame(instructionsPerFrame);
+    core.setIdleSkipping(true);
+    core.setFusedPatterns(CHIP8_ALL_FUSED_PATTERNS);
+    core.setKeyDown(5);
+    NullAudioSink sink;
+    Chip8Audio audio;
+    audio.setSink(&sink);
+    for (u64 n = (u64) frames * instructionsPerFrame; n > 0; n -= step)
+        audio.execute(core, step);
+    return sink.getLoudSamples();
+}
+
+/* Runs "frames" frames of "rom" at 1000 instructions a frame on "engine" through the audio with a sink or without, as
+ * the frontend does with and without the audio open. Returns the host milliseconds it took */
+static double runAtSpeed(const char* rom, DISPATCH_ENGINE engine, bool withSink, u32 frames, IDLE_STATS& idle, FUSION_STATS& fusion)
+{
+    BenchCore core;
+    core.loadFile(rom);
+    core.setDispatchEngine(engine);
+    core.setInstructionsPerFrame(1000);
+    core.setIdleSkipping(true);
+    core.setFusedPatterns(CHIP8_ALL_FUSED_PATTERNS);
+    NullAudioSink sink;
+    Chip8Audio audio;
+    audio.setSink(withSink ? &sink : NULL);
+    u64 start = benchNow();
+    for (u32 f = 0; f < frames; f++)
+        audio.execute(core, 1000);
+    u64 ns = benchNow() - start;
+    benchKeep(core.getState());
+    idle = core.getIdleStats();
+    fusion = core.getFusionStats();
+    return ns / 1e6;
+}
+
+// Plays "frames" frames of "rom" into a WAV file and reads the header back, returns false if it does not add up
+static bool checkWav(const char* rom, u32 frames, u64& samples, u64& loud)
+{
+    BenchCore core;
+    if (!core.loadFile(rom))
+        return false;
+    WavAudioSink wav;
+    Chip8Audio audio;
+    if (!wav.open(AUDIO_BENCH_FILE))
+        return false;
+    audio.setSink(&wav);
+    for (u32 f = 0; f < frames; f++)
+        audio.execute(core, CHIP8_INSTRUCTIONS_PER_FRAME);
+    wav.close();
+    samples = wav.getSamples();
+    loud = audio.getLoudSamples();
+
+    std::ifstream file(AUDIO_BENCH_FILE, std::ios::binary | std::ios::ate);
+    u64 bytes = file.tellg();
+    file.seekg(0);
+    char riff[4];
+    u32 sizes[10];
+    file.read(riff, sizeof(riff));
+    file.read((char*) sizes, sizeof(sizes));
+    file.close();
+    remove(AUDIO_BENCH_FILE);
+    // The RIFF size and the data size that ends the 44 byte header
+    return memcmp(riff, "RIFF", 4) == 0 && bytes == 44 + samples * 2 && sizes[0] == bytes - 8 && sizes[9] == samples * 2;
+}
+
+/* Runs "rom" at 1x for "seconds" with a thread standing in for the audio device, it reads a period every period of its
+ * own clock as the SDL callback would */
+static AUDIO_RING_STATS runRealTime(const char* rom, u32 seconds, u64& frames)
+{
+    BenchCore core;
+    core.loadFile(rom);
+    RingAudioSink ring;
+    Chip8Audio audio;
+    audio.setSink(&ring);
+    Chip8Scheduler scheduler;
+    scheduler.setPaced(true);
+
+    std::atomic<bool> done(false);
+    std::thread device;
+    scheduler.start();
+    frames = (u64) seconds * CHIP8_FRAMES_PER_SECOND;
+    for (u64 f = 0; f < frames; f++)
+    {
+        audio.execute(core, CHIP8_INSTRUCTIONS_PER_FRAME);
+        if (f == 0)
+        {
+            // The device starts once a frame is waiting for it, as the frontend starts it
+            device = std::thread([&]() {
+                s16 period[CHIP8_AUDIO_DEVICE_SAMPLES];
+                std::chrono::steady_clock::time_point due = std::chrono::steady_clock::now();
+                u64 n = 0;
+                while (!done.load(std::memory_order_relaxed))
+                {
+                    ring.read(period, CHIP8_AUDIO_DEVICE_SAMPLES);
+                    benchKeep(period);
+                    n++;
+                    std::this_thread::sleep_until(due + std::chrono::nanoseconds(n * CHIP8_AUDIO_DEVICE_SAMPLES * 1000000000ull / CHIP8_AUDIO_RATE));
+                }
+            });
+        }
+        scheduler.wait();
+    }
+    done = true;
+    device.join();
+    return ring.getStats();
+}
+
+// Returns the host nanoseconds "lanes" machines take to run a second of emulated time, with or without audio
+static double timeInstances(const char* rom, u32 lanes, bool withAudio, u64& loud)
+{
+    BenchCore* cores = new BenchCore[lanes];
+    NullAudioSink* sinks = new NullAudioSink[lanes];
+    Chip8Audio* audios = new Chip8Audio[lanes];
+    for (u32 l = 0; l < lanes; l++)
+    {
+        cores[l].loadFile(rom);
+        cores[l].setKeyDown(l & 0x0f);
+        audios[l].setSink(withAudio ? &sinks[l] : NULL);
+    }
+
+    std::clock_t cpu = std::clock();
+    for (u32 f = 0; f < CHIP8_FRAMES_PER_SECOND; f++)
+    {
+        for (u32 l = 0; l < lanes; l++)
+            audios[l].execute(cores[l], CHIP8_INSTRUCTIONS_PER_FRAME);
+    }
+    double ns = (double) (std::clock() - cpu) / CLOCKS_PER_SEC * 1e9;
+
+    loud = 0;
+    for (u32 l = 0; l < lanes; l++)
+    {
+        loud += sinks[l].getLoudSamples();
+        benchKeep(cores[l].getState());
+    }
+    delete[] audios;
+    delete[] sinks;
+    delete[] cores;
+    return ns;
+}
+
+int benchAudio(int argc, char* argv[])
+{
+    u32 seconds = argc > 0 ? atoi(argv[0]) : 3;
+    if (seconds == 0)
+        seconds = 1;
+    const u32 frameSamples = CHIP8_AUDIO_RATE / CHIP8_FRAMES_PER_SECOND;
+    bool ok = true;
+
+    // Instructions 2 to the end of the "kk"th frame sound, the samples up to each are worked out as the audio does
+    std::cout << "Sound timer set to kk 2 instructions into a frame, " << CHIP8_AUDIO_RATE << " Hz, " << frameSamples
+              << " samples a frame" << std::endl;
+    for (u8 length : {0, 1, 2, 5, 60})
+    {
+        u64 samples = 0;
+        u64 loud = beepSamples(length, 90, samples);
+        u64 perInstruction = (u64) CHIP8_FRAMES_PER_SECOND * CHIP8_INSTRUCTIONS_PER_FRAME;
+        u64 expected = length ? ((u64) length * CHIP8_INSTRUCTIONS_PER_FRAME * CHIP8_AUDIO_RATE) / perInstruction -
+                                (2ull * CHIP8_AUDIO_RATE) / perInstruction : 0;
+        bool right = loud == expected && samples == 90ull * frameSamples;
+        ok = ok && right;
+        std::cout << "  ST " << std::setw(2) << (u32) length << ": " << std::setw(6) << loud << " samples sounded, "
+                  << std::setw(6) << expected << " expected" << (right ? "" : " WRONG") << std::endl;
+    }
+
+    /* Every engine makes the same samples at either speed with idle skipping and fusion on, as the reference that runs
+     * the machine an instruction at a time and so looks at "ST" before every one */
+    const DISPATCH_ENGINE engines[] = {DISPATCH_SWITCH, DISPATCH_TABLE, DISPATCH_GOTO, DISPATCH_CACHE, DISPATCH_JIT, DISPATCH_COMPILED};
+    const char* const names[] = {"switch", "table", "goto", "cache", "jit", "compiled"};
+    for (u16 instructionsPerFrame : {CHIP8_INSTRUCTIONS_PER_FRAME, 1000})
+    {
+        u64 reference = soundedSamples(benchRoms[0], DISPATCH_SWITCH, instructionsPerFrame, 1200, 1);
+        std::stringstream line;
+        line << "  " << benchRoms[0] << " 1200 frames of " << std::setw(4) << instructionsPerFrame << ": " << reference
+             << " samples sounded an instruction at a time, the same on";
+        for (u32 e = 0; e < sizeof(engines) / sizeof(engines[0]); e++)
+        {
+            bool same = soundedSamples(benchRoms[0], engines[e], instructionsPerFrame, 1200, instructionsPerFrame) == reference;
+            ok = ok && same;
+            line << " " << names[e] << (same ? "" : " DIFFER");
+        }
+        std::cout << line.str() << std::endl;
+    }
+
+    // A sink leaves the machine to skip idle loops, fuse and run blocks the same as it does without one
+    std::cout << std::fixed << std::setprecision(2);
+    for (u32 e = 0; e < sizeof(engines) / sizeof(engines[0]); e++)
+    {
+        IDLE_STATS idle[2];
+        FUSION_STATS fusion[2];
+        double ms[2];
+        for (u32 withSink = 0; withSink < 2; withSink++)
+            ms[withSink] = runAtSpeed(benchRoms[0], engines[e], withSink != 0, 3000, idle[withSink], fusion[withSink]);
+        u64 fused[2] = {0, 0};
+        for (u32 withSink = 0; withSink < 2; withSink++)
+        {
+            for (u32 p = 0; p < FUSED_PATTERN_COUNT; p++)
+                fused[withSink] += fusion[withSink].dispatches[p];
+        }
+        bool kept = idle[1].elided > 0 && idle[1].elided == idle[0].elided && fused[1] == fused[0] &&
+                    (engines[e] != DISPATCH_CACHE || fused[1] > 0);
+        ok = ok && kept;
+        std::cout << "  " << benchRoms[0] << " 3000 frames of 1000 on " << std::setw(8) << names[e] << ": " << std::setw(6)
+                  << idle[1].elided << " skipped and " << std::setw(6) << fused[1] << " fused with a sink, " << std::setw(6)
+                  << idle[0].elided << " and " << std::setw(6) << fused[0] << " without, " << std::setw(7) << ms[1]
+                  << " ms against " << std::setw(7) << ms[0] << " ms" << (kept ? "" : " WRONG") << std::endl;
+    }
+
+    u64 wavSamples = 0;
+    u64 wavLoud = 0;
+    bool wav = checkWav(benchRoms[0], 600, wavSamples, wavLoud);
+    ok = ok && wav;
+    std::cout << "WAV of 600 frames: " << wavSamples << " samples, " << wavLoud << " sounded"
+              << (wav ? ", header matches" : " WRONG") << std::endl;
+
+    u64 frames = 0;
+    AUDIO_RING_STATS stats = runRealTime(benchRoms[0], seconds, frames);
+    double msPerSample = 1000.0 / CHIP8_AUDIO_RATE;
+    double meanMs = stats.latencyWrites ? (double) stats.latencyTotal / stats.latencyWrites * msPerSample : 0;
+    double maxMs = stats.latencyMax * msPerSample;
+    bool kept = stats.underruns == 0 && stats.latencyMax <= frameSamples;
+    ok = ok && kept;
+    std::cout << std::fixed << std::setprecision(2) << seconds << "s at 1x with a device reading " << CHIP8_AUDIO_DEVICE_SAMPLES
+              << " samples a period: " << frames << " frames, " << stats.written << " samples written, " << stats.read << " read, "
+              << stats.underruns << " underrun, " << stats.dropped << " dropped" << std::endl;
+    std::cout << "  latency ahead of the device " << meanMs << " ms mean, " << maxMs << " ms worst, a frame is "
+              << frameSamples * msPerSample << " ms, the device's period adds " << CHIP8_AUDIO_DEVICE_SAMPLES * msPerSample
+              << " ms" << (kept ? "" : " WRONG") << std::endl;
+
+    // The cost of the audio on top of running the machines, per emulated second
+    for (u32 lanes : {1, 32})
+    {
+        u64 loud = 0;
+        double bare = timeInstances(benchRoms[0], lanes, false, loud);
+        double withAudio = timeInstances(benchRoms[0], lanes, true, loud);
+        std::cout << "  " << std::setw(2) << lanes << " instances, a second of emulated time: " << std::setw(9) << bare / 1000
+                  << " us without audio, " << std::setw(9) << withAudio / 1000 << " us with, "
+                  << std::setprecision(3) << withAudio / 1e9 * 100 << "% of a core at 1x" << std::setprecision(2) << std::endl;
+    }
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,123 @@
+#include <iostream>
+#include <iomanip>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "Batch.h"
+#include "Bench.h"
+
+// Gives each lane its own input, lanes hold different keys so they drift apart as they would in a search
+static u8 laneKey(u32 lane)
+{
+    static const u8 laneKeys[] = {0x5, 0x1, 0x4, 0xC, 0xD, 0x5, 0x5, 0x5};
+    return laneKeys[lane % sizeof(laneKeys)];
+}
+
+/* Steps each lane's reference core one instruction at a time next to the batch, each core is seeded the same as its
+ * lane so the two can be compared byte for byte */
+static bool checkLanes(const char* rom, u32 lanes, u32 steps)
+{
+    std::vector<BenchCore> cores(lanes);
+    for (BenchCore& core : cores)
+    {
+        if (!core.loadFile(rom))
+            return false;
+    }
+
+    Chip8Batch batch(lanes);
+    batch.loadState(cores[0].getState());
+    for (u32 lane = 0; lane < lanes; lane++)
+    {
+        batch.setKeyDown(lane, laneKey(lane));
+        cores[lane].setKeyDown(laneKey(lane));
+    }
+
+    for (u32 lane = 0; lane < lanes; lane++)
+    {
+        batch.setSeed(lane, lane * 7919 + 1);
+        cores[lane].getState().random = lane * 7919 + 1;
+    }
+
+    CHIP8_STATE laneState;
+    for (u32 c = 0; c < steps; c++)
+    {
+        batch.run(1);
+        for (u32 lane = 0; lane < lanes; lane++)
+        {
+            if (!cores[lane].hasQuit())
+                cores[lane].execute(1);
+        }
+
+        // Comparing every lane every step is slow so it is done every so often and at the end
+        if (c % 997 != 0 && c != steps - 1)
+            continue;
+        for (u32 lane = 0; lane < lanes; lane++)
+        {
+            batch.getLaneState(lane, laneState);
+            if (memcmp(&laneState, &cores[lane].getState(), sizeof(CHIP8_STATE)) != 0 || batch.hasQuit(lane) != cores[lane].hasQuit())
+            {
+                std::cout << "    " << rom << " lane " << lane << " differs from its core after " << c + 1 << " steps" << std::endl;
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+int benchBatch(int argc, char* argv[])
+{
+    u32 instructions = argc > 0 ? atoi(argv[0]) : 200000;
+    static const u32 laneCounts[] = {8, 16, 32};
+
+    std::cout << "Batch kernels: " << Chip8Batch::getKernelName() << std::endl;
+
+    bool ok = true;
+    for (const char* rom : benchRoms)
+    {
+        bool same = checkLanes(rom, 32, 20000);
+        ok = ok && same;
+
+        for (u32 lanes : laneCounts)
+        {
+            BenchCore loader;
+            if (!loader.loadFile(rom))
+            {
+                std::cout << "Failed to load " << rom << std::endl;
+                return 1;
+            }
+
+            Chip8Batch batch(lanes);
+            batch.loadState(loader.getState());
+            for (u32 lane = 0; lane < lanes; lane++)
+                batch.setKeyDown(lane, laneKey(lane));
+            u64 start = benchNow();
+            u64 batchInstructions = batch.run(instructions);
+            u64 batchNs = benchNow() - start;
+            BATCH_STATS stats = batch.getStats();
+
+            // The same work done by independent cores one after another
+            std::vector<BenchCore> cores(lanes);
+            for (u32 lane = 0; lane < lanes; lane++)
+            {
+                cores[lane].loadFile(rom);
+                cores[lane].setKeyDown(laneKey(lane));
+            }
+            u64 scalarInstructions = 0;
+            start = benchNow();
+            for (BenchCore& core : cores)
+                scalarInstructions += core.execute(instructions);
+            u64 scalarNs = benchNow() - start;
+
+            double batchRate = batchInstructions / (batchNs / 1e9) / 1e6;
+            double scalarRate = scalarInstructions / (scalarNs / 1e9) / 1e6;
+            std::cout << std::left << std::setw(10) << rom << std::right << std::setw(3) << lanes << " lanes"
+                      << std::fixed << std::setprecision(1) << std::setw(9) << batchRate << " M/s batched"
+                      << std::setw(9) << scalarRate << " M/s scalar  x" << std::setprecision(2) << batchRate / scalarRate
+                      << std::setprecision(1) << std::setw(7) << (double) stats.instructions / stats.groups << " lanes per group, "
+                      << std::setw(5) << 100.0 * stats.vectorGroups / stats.groups << "% of groups vectorised"
+                      << (same ? "" : "  LANES DIFFER FROM SCALAR CORES") << std::endl;
+        }
+    }
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,112 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <chrono>
+#include <iostream>
+#include <stdlib.h>
+#include <string.h>
+#include "Def.h"
+#include "Chip8Core.h"
+
+/* Small benchmarks for the headless core, these need no SDL and no display so they can run on any box */
+
+// Returns the monotonic time in nanoseconds
+inline u64 benchNow()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Stops the optimiser throwing away a value that is only computed for the benchmark
+template<typename T>
+inline void benchKeep(const T& value)
+{
+    asm volatile("" : : "g"(&value) : "memory");
+}
+
+// A core that counts bad opcodes instead of printing them so they do not swamp the timings
+class BenchCore : public Chip8Core
+{
+    public:
+        u64 badOpcodes = 0;
+    protected:
+        virtual void badOpcode(u16 opcode)
+        {
+            badOpcodes++;
+        }
+};
+
+/* Runs "core" on "engine" and "reference" on the switch engine side by side in chunks of random size and checks they
+ * agree after every chunk, returns false at the first difference */
+inline bool benchLockstep(Chip8Core& core, DISPATCH_ENGINE engine, Chip8Core& reference, u32 instructions, u32& chunks)
+{
+    core.setDispatchEngine(engine);
+    reference.setDispatchEngine(DISPATCH_SWITCH);
+    core.setKeyDown(5);
+    reference.setKeyDown(5);
+
+    u32 seed = 1;
+    u32 done = 0;
+    chunks = 0;
+    while (done < instructions)
+    {
+        seed = seed * 1103515245 + 12345;
+        u32 chunk = 1 + ((seed >> 16) % 5000);
+
+        u32 ran = core.execute(chunk);
+        u32 expected = reference.execute(chunk);
+        chunks++;
+
+        if (ran != expected || memcmp(&core.getState(), &reference.getState(), sizeof(CHIP8_STATE)) != 0)
+        {
+            std::cout << "    states differ after chunk " << chunks << " at instruction " << done
+                      << ", PC " << std::hex << core.getState().PC << " against " << reference.getState().PC << std::dec << std::endl;
+            return false;
+        }
+
+        done += ran;
+        if (ran < chunk)
+            break;
+    }
+    return true;
+}
+
+// The ROMs shipped with the repository, the benchmarks are run from the repository root
+static const char* const benchRoms[] = {"PONG.c8", "blitz.c8", "chip8.c8"};
+
+/* A program that rewrites one of its own instructions on every pass of its loop, "Fx55" stores "ADD V2, kk" over
+ * 0x20A with "kk" counting up so anything translated or compiled from it goes stale every time */
+static const u8 benchSelfModifyingProgram[] = {
+    0x60, 0x72,     // 0x200 LD V0, 0x72
+    0x61, 0x00,     // 0x202 LD V1, 0x00
+    0xA2, 0x0A,     // 0x204 LD I, 0x20A
+    0x71, 0x01,     // 0x206 ADD V1, 0x01
+    0xF1, 0x55,     // 0x208 LD [I], V1
+    0x00, 0x00,     // 0x20A written by 0x208
+    0x12, 0x04      // 0x20C JP 0x204
+};
+
+int benchState(int argc, char* argv[]);
+int benchSprite(int argc, char* argv[]);
+int benchDispatch(int argc, char* argv[]);
+int benchJit(int argc, char* argv[]);
+int benchCompiled(int argc, char* argv[]);
+int benchFusion(int argc, char* argv[]);
+int benchBatch(int argc, char* argv[]);
+int benchQuirks(int argc, char* argv[]);
+int benchSavestate(int argc, char* argv[]);
+int benchPool(int argc, char* argv[]);
+int benchRewind(int argc, char* argv[]);
+int benchReplay(int argc, char* argv[]);
+int benchRunAhead(int argc, char* argv[]);
+int benchPacing(int argc, char* argv[]);
+int benchIdle(int argc, char* argv[]);
+int benchKeyWait(int argc, char* argv[]);
+int benchBreakpoints(int argc, char* argv[]);
+int benchDebugger(int argc, char* argv[]);
+int benchAudio(int argc, char* argv[]);
+int benchTrace(int argc, char* argv[]);
+int benchProfile(int argc, char* argv[]);
+int benchHeatmap(int argc, char* argv[]);
+int benchSuite(int argc, char* argv[]);
+
+#endif // BENCH_H
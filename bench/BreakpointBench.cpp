@@ -0,0 +1,303 @@
+#include <iostream>
+#include <iomanip>
+#include <set>
+#include <sstream>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "Bench.h"
+
+// Counts V0 up, copies it to V3 and stores then loads a few bytes at 0x300 over and over
+static const u8 breakProgram[] = {
+    0x60, 0x00,     // 0x200 LD V0, 0
+    0xA3, 0x00,     // 0x202 LD I, 0x300
+    0x70, 0x01,     // 0x204 ADD V0, 1
+    0x83, 0x00,     // 0x206 LD V3, V0
+    0xF1, 0x55,     // 0x208 LD [I], V1
+    0xF2, 0x65,     // 0x20A LD V2, [I]
+    0x12, 0x04      // 0x20C JP 0x204
+};
+
+// A condition and whether it holds on the state "checkConditions" sets up
+struct CONDITION_CASE
+{
+    const char* text;
+    bool holds;
+};
+
+// Compiles conditions and checks what they evaluate to, and that malformed ones are refused
+static bool checkConditions()
+{
+    BenchCore core;
+    CHIP8_STATE& s = core.getState();
+    s.V[3] = 0x10;
+    s.V[0xf] = 1;
+    s.I = 0x310;
+    s.DT = 5;
+    s.memory[0x310] = 0xab;
+
+    static const CONDITION_CASE cases[] = {
+        {"V3 == 0x10 && I > 0x300", true},
+        {"v3 != 16", false},
+        {"[I] == 0xab && [I + 1] == 0", true},
+        {"!(DT < 5) || ST", true},
+        {"V3 & 0x0f", false},
+        {"PC == 0x200 && SP == 0", true},
+        {"1 + 2 + 3 == 6 && 6 - 2 - 1 == 3", true},
+        {"V3 == 0 || VF == 1 && DT == 0", false},
+        {"(V3 == 0 || VF == 1) && DT == 5", true},
+        {"I >= 0x310 && I <= 0x310 && !(I < 0x310) && !(I > 0x310)", true},
+        {"[[0x310] + 0x265] == [0x310]", true}
+    };
+    bool ok = true;
+    for (const CONDITION_CASE& c : cases)
+    {
+        BreakCondition condition;
+        std::string error;
+        if (!condition.compile(c.text, error) || condition.evaluate(s) != c.holds)
+        {
+            std::cout << "    \"" << c.text << "\" " << (error.empty() ? "evaluated wrong" : error) << std::endl;
+            ok = false;
+        }
+    }
+
+    // The deepest condition that fits the stack compiles and one deeper is refused
+    std::string deep = "1";
+    for (u32 d = 1; d < CHIP8_BREAK_STACK_SIZE; d++)
+        deep = "1 + (" + deep + ")";
+    static const char* const bad[] = {"", "V3 ==", "VG == 1", "0x10000", "(V3", "[I", "V3 = 1", "0x", "V3 == 1 &&& 2"};
+    std::vector<std::string> refused(bad, bad + sizeof(bad) / sizeof(bad[0]));
+    refused.push_back("1 + (" + deep + ")");
+    BreakCondition condition;
+    std::string error;
+    ok = ok && condition.compile(deep, error) && condition.evaluate(s);
+    for (const std::string& text : refused)
+    {
+        if (condition.compile(text, error))
+        {
+            std::cout << "    \"" << text << "\" compiled" << std::endl;
+            ok = false;
+        }
+    }
+    // A refused condition leaves the last one that compiled
+    return ok && condition.getText() == deep;
+}
+
+// Sets and clears break points at random against a set of them, checks every address agrees after each change
+static bool checkBitmap()
+{
+    BenchCore core;
+    std::set<u16> reference;
+    u32 seed = 1;
+    for (u32 change = 0; change < 2000; change++)
+    {
+        seed = seed * 1103515245 + 12345;
+        u16 location = (seed >> 12) % CHIP8_MEMORY_SIZE;
+        if ((seed >> 8) & 1)
+        {
+            core.setBreakPoint(location);
+            reference.insert(location);
+        }
+        else
+        {
+            core.clearBreakPoint(location);
+            reference.erase(location);
+        }
+
+        for (u16 a = 0; a < CHIP8_MEMORY_SIZE; a++)
+        {
+            if (core.hasBreakPoint(a) != (reference.count(a) != 0))
+                return false;
+        }
+    }
+    std::vector<u16> set = core.getBreakPoints();
+    return std::vector<u16>(reference.begin(), reference.end()) == set;
+}
+
+// Runs the program until it breaks, returns false unless the break came after "instructions" for the reason expected
+static bool expectBreak(BenchCore& core, u32 instructions, u16 PC, u8 kind, u16 address, u8 reg)
+{
+    u64 before = core.getLastBreak().number;
+    core.run();
+    u32 ran = core.execute(1000);
+    BREAK_EVENT event = core.getLastBreak();
+    return ran == instructions && core.getState().PC == PC && !core.isRunning() && event.number == before + 1 &&
+           event.PC == PC && event.kind == kind && event.address == address && event.reg == reg;
+}
+
+/* Takes the program through each kind of break on "engine" and then runs on with everything cleared, the machine is
+ * left as the steps did so the engines can be compared */
+static bool checkBreaks(BenchCore& core, DISPATCH_ENGINE engine)
+{
+    core.setDispatchEngine(engine);
+    core.loadMemory(breakProgram, sizeof(breakProgram));
+    std::string error;
+
+    // Running on carries on past the instruction broken on and round the loop to it again
+    core.setBreakPoint(0x208);
+    bool ok = expectBreak(core, 4, 0x208, BREAK_EXECUTE, 0x208, CHIP8_REGISTER_COUNT) &&
+              expectBreak(core, 5, 0x208, BREAK_EXECUTE, 0x208, CHIP8_REGISTER_COUNT);
+    // A condition replaces the plain break point
+    ok = ok && core.setBreakPoint(0x208, "V0 == 4", error) && expectBreak(core, 10, 0x208, BREAK_CONDITION, 0x208, CHIP8_REGISTER_COUNT);
+    core.clearBreakPoints();
+    ok = ok && core.setBreakPoint(CHIP8_BREAK_ANYWHERE, "V3 == 6", error) &&
+         expectBreak(core, 10, 0x208, BREAK_CONDITION, 0x208, CHIP8_REGISTER_COUNT);
+    core.clearBreakPoints();
+
+    /* "Fx55" writes 0x300 and 0x301, "Fx65" reads 0x300 to 0x302. Each run starts on the instruction the last broke
+     * on, which runs unchecked */
+    core.setWatchPoint(0x301, 1, CHIP8_WATCH_WRITE);
+    ok = ok && expectBreak(core, 5, 0x208, BREAK_WRITE, 0x301, CHIP8_REGISTER_COUNT);
+    core.clearWatchPoints();
+    core.setWatchPoint(0x302, 4, CHIP8_WATCH_READ);
+    ok = ok && expectBreak(core, 1, 0x20A, BREAK_READ, 0x302, CHIP8_REGISTER_COUNT);
+    core.clearWatchPoints();
+
+    ok = ok && core.setRegisterWatchPoint(3, CHIP8_WATCH_WRITE) && expectBreak(core, 3, 0x206, BREAK_WRITE, 0x206, 3);
+    core.clearWatchPoints();
+    ok = ok && core.setRegisterWatchPoint(2, CHIP8_WATCH_READ | CHIP8_WATCH_WRITE) && expectBreak(core, 2, 0x20A, BREAK_WRITE, 0x20A, 2);
+    core.clearWatchPoints();
+    ok = ok && core.setRegisterWatchPoint(CHIP8_REGISTER_I, CHIP8_WATCH_READ) && expectBreak(core, 4, 0x208, BREAK_READ, 0x208, CHIP8_REGISTER_I);
+    ok = ok && !core.setRegisterWatchPoint(CHIP8_REGISTER_PC, CHIP8_WATCH_WRITE);
+    core.clearWatchPoints();
+
+    // With nothing set the whole call runs
+    core.run();
+    return ok && core.execute(1000) == 1000 && core.isRunning();
+}
+
+// Returns the nanoseconds an instruction takes running "instructions" of the ROM a frame at a time
+static double timeExecute(BenchCore& core, u32 instructions)
+{
+    u64 start = benchNow();
+    for (u32 done = 0; done < instructions; done += CHIP8_INSTRUCTIONS_PER_FRAME)
+        core.execute(CHIP8_INSTRUCTIONS_PER_FRAME);
+    u64 ns = benchNow() - start;
+    benchKeep(core.getState());
+    return (double) ns / instructions;
+}
+
+/* The way break points were kept before the bitmap, a list searched before every instruction, returns the nanoseconds an
+ * instruction takes with "breakPoints" in the list */
+static double timeLinearScan(const char* rom, const std::vector<u16>& breakPoints, u32 instructions)
+{
+    BenchCore core;
+    core.loadFile(rom);
+    u32 hits = 0;
+    u64 start = benchNow();
+    for (u32 done = 0; done < instructions; done++)
+    {
+        u16 PC = core.getState().PC;
+        for (u16 i = 0; i < breakPoints.size(); i++)
+        {
+            if (breakPoints[i] == PC)
+            {
+                hits++;
+                break;
+            }
+        }
+        core.execute(1);
+    }
+    u64 ns = benchNow() - start;
+    benchKeep(hits);
+    benchKeep(core.getState());
+    return (double) ns / instructions;
+}
+
+int benchBreakpoints(int argc, char* argv[])
+{
+    u32 instructions = argc > 0 ? atoi(argv[0]) : 500000;
+    if (instructions == 0)
+        instructions = 1;
+
+    bool ok = true;
+    bool conditions = checkConditions();
+    std::cout << "Conditions compile and evaluate" << (conditions ? "" : " WRONG") << std::endl;
+    bool bitmap = checkBitmap();
+    std::cout << "Break point bitmap agrees with a set over 2000 changes" << (bitmap ? "" : " DIFFERS") << std::endl;
+    ok = ok && conditions && bitmap;
+
+    static const DISPATCH_ENGINE engines[] = {DISPATCH_SWITCH, DISPATCH_TABLE, DISPATCH_GOTO, DISPATCH_CACHE, DISPATCH_JIT, DISPATCH_COMPILED};
+    static const char* const names[] = {"switch", "table", "goto", "cache", "jit", "compiled"};
+    std::stringstream line;
+    line << "Break points, conditions and watch points break on";
+    BenchCore reference;
+    checkBreaks(reference, DISPATCH_SWITCH);
+    for (u32 e = 0; e < sizeof(engines) / sizeof(engines[0]); e++)
+    {
+        BenchCore core;
+        bool breaks = checkBreaks(core, engines[e]);
+        bool same = memcmp(&core.getState(), &reference.getState(), sizeof(CHIP8_STATE)) == 0;
+        line << " " << names[e] << (breaks ? "" : " WRONG") << (same ? "" : " DIFFERS");
+        ok = ok && breaks && same;
+    }
+    std::cout << line.str() << std::endl;
+
+    const char* rom = benchRoms[0];
+    // The addresses the ROM never executes from get the break points so the timings are not cut short
+    std::vector<u16> unreached;
+    {
+        BenchCore core;
+        core.loadFile(rom);
+        std::vector<bool> reached(CHIP8_MEMORY_SIZE);
+        for (u32 done = 0; done < instructions; done++)
+        {
+            reached[core.getState().PC & (CHIP8_MEMORY_SIZE - 1)] = true;
+            core.execute(1);
+        }
+        for (u16 a = 0; a < CHIP8_MEMORY_SIZE; a++)
+        {
+            if (!reached[a])
+                unreached.push_back(a);
+        }
+    }
+
+    std::cout << std::fixed << std::setprecision(2) << rom << ", " << instructions << " instructions a frame at a time" << std::endl;
+    {
+        BenchCore none;
+        none.loadFile(rom);
+        BenchCore cleared;
+        cleared.loadFile(rom);
+        cleared.setBreakPoint(0x300);
+        cleared.setWatchPoint(0x300, 16, CHIP8_WATCH_READ | CHIP8_WATCH_WRITE);
+        cleared.setRegisterWatchPoint(3, CHIP8_WATCH_WRITE);
+        cleared.clearBreakPoint(0x300);
+        cleared.clearWatchPoints();
+        double noneNs = timeExecute(none, instructions);
+        double clearedNs = timeExecute(cleared, instructions);
+        std::cout << "  nothing set " << std::setw(8) << noneNs << " ns an instruction, everything set then cleared "
+                  << std::setw(8) << clearedNs << " ns" << std::endl;
+        ok = ok && memcmp(&none.getState(), &cleared.getState(), sizeof(CHIP8_STATE)) == 0;
+    }
+
+    for (u32 count : {(u32) 1, (u32) 100, (u32) unreached.size()})
+    {
+        std::vector<u16> breakPoints(unreached.begin(), unreached.begin() + std::min(count, (u32) unreached.size()));
+        BenchCore core;
+        core.loadFile(rom);
+        for (u16 a : breakPoints)
+            core.setBreakPoint(a);
+        double bitmapNs = timeExecute(core, instructions);
+        double linearNs = timeLinearScan(rom, breakPoints, instructions);
+        std::cout << "  " << std::setw(4) << breakPoints.size() << " break points, bitmap " << std::setw(8) << bitmapNs
+                  << " ns an instruction, list searched " << std::setw(9) << linearNs << " ns" << std::endl;
+        ok = ok && core.getLastBreak().number == 0;
+    }
+
+    {
+        BenchCore core;
+        core.loadFile(rom);
+        std::string error;
+        core.setBreakPoint(CHIP8_BREAK_ANYWHERE, "V3 == 0x10 && I > 0x300 && [I] == 0x55", error);
+        double conditionNs = timeExecute(core, instructions);
+        core.clearBreakPoints();
+        core.setWatchPoint(0xf00, 0x100, CHIP8_WATCH_READ | CHIP8_WATCH_WRITE);
+        core.setRegisterWatchPoint(CHIP8_REGISTER_SP, CHIP8_WATCH_WRITE);
+        core.setRegisterWatchPoint(0xe, CHIP8_WATCH_READ);
+        double watchNs = timeExecute(core, instructions);
+        std::cout << "  a condition tested before every instruction " << std::setw(8) << conditionNs
+                  << " ns an instruction, watch points on 256 bytes and 2 registers " << std::setw(8) << watchNs << " ns" << std::endl;
+    }
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,49 @@
+#include <iostream>
+#include <iomanip>
+#include <stdlib.h>
+#include "Bench.h"
+
+/* The ROMs in bench/compiled were generated by tools/Recompiler, for example
+ *     Recompiler PONG.c8 bench/compiled/PONG.cpp
+ * and register themselves so the compiled engine picks them up when the same ROM is loaded */
+
+static void printStats(const char* name, BenchCore& core, bool same, u32 chunks)
+{
+    COMPILED_STATS stats = core.getCompiledStats();
+    u64 total = stats.compiled + stats.interpreted;
+    std::cout << std::left << std::setw(12) << name << (same ? "same state" : "DIFFERENT STATE") << " over " << chunks << " chunks, "
+              << stats.compiled << " compiled and " << stats.interpreted << " interpreted instructions ("
+              << std::fixed << std::setprecision(1) << (total ? 100.0 * stats.compiled / total : 0.0) << "% compiled)"
+              << (core.isCompiledCodeStale() ? ", compiled code went stale" : "") << std::endl;
+}
+
+int benchCompiled(int argc, char* argv[])
+{
+    u32 instructions = argc > 0 ? atoi(argv[0]) : 2000000;
+
+    bool ok = true;
+    for (const char* rom : benchRoms)
+    {
+        BenchCore core, reference;
+        if (!core.loadFile(rom) || !reference.loadFile(rom))
+        {
+            std::cout << "Failed to load " << rom << std::endl;
+            return 1;
+        }
+
+        u32 chunks;
+        bool same = benchLockstep(core, DISPATCH_COMPILED, reference, instructions, chunks);
+        printStats(rom, core, same, chunks);
+        ok = ok && same;
+    }
+
+    BenchCore core, reference;
+    core.loadMemory(benchSelfModifyingProgram, sizeof(benchSelfModifyingProgram));
+    reference.loadMemory(benchSelfModifyingProgram, sizeof(benchSelfModifyingProgram));
+    u32 chunks;
+    bool same = benchLockstep(core, DISPATCH_COMPILED, reference, instructions, chunks);
+    printStats("self-modify", core, same, chunks);
+    ok = ok && same;
+
+    return ok ? 0 : 1;
+}
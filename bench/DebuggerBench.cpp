@@ -0,0 +1,273 @@
+#include <atomic>
+#include <ctime>
+#include <iostream>
+#include <iomanip>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+#include "Bench.h"
+#include "Debugger.h"
+
+static DEBUG_COMMAND benchCommand(u8 kind)
+{
+    DEBUG_COMMAND command;
+    memset(&command, 0, sizeof(command));
+    command.kind = kind;
+    return command;
+}
+
+/* Pushes a count through a small queue from one thread to another, the consumer checks every item arrives once and in
+ * order. Either side yields when the queue is full or empty, that is the benchmark's choice not the queue's */
+static bool checkQueue(u32 items, double& nsPerItem)
+{
+    static SpscQueue<u32, 64> queue;
+    bool ordered = true;
+    u64 start = benchNow();
+    std::thread producer([&]() {
+        for (u32 i = 1; i <= items; i++)
+        {
+            while (!queue.push(i))
+                std::this_thread::yield();
+        }
+    });
+    for (u32 expected = 1; expected <= items; expected++)
+    {
+        u32 item;
+        while (!queue.pop(item))
+            std::this_thread::yield();
+        ordered = ordered && item == expected;
+    }
+    producer.join();
+    nsPerItem = (double) (benchNow() - start) / items;
+    return ordered && queue.empty();
+}
+
+/* The machine side publishes registers that are all derived from one count as fast as it can while readers check every
+ * snapshot they take is whole, returns the snapshots that mixed two publishes */
+static u64 checkSnapshots(u32 milliseconds, u64& reads, u64& publishes)
+{
+    Chip8Debugger debugger;
+    BenchCore core;
+    std::atomic<bool> done(false);
+    std::atomic<u64> torn(0);
+    std::atomic<u64> taken(0);
+    std::thread readers[2];
+    for (std::thread& reader : readers)
+    {
+        reader = std::thread([&]() {
+            u64 mine = 0;
+            u64 bad = 0;
+            while (!done.load(std::memory_order_relaxed))
+            {
+                DEBUG_SNAPSHOT regs = debugger.getSnapshot();
+                u8 k = regs.instructions & 0xff;
+                bool whole = regs.I == (u16) (regs.instructions * 3) && regs.PC == (u16) (regs.instructions >> 1) &&
+                             regs.DT == (u8) ~k && regs.ST == k;
+                for (u8 v = 0; v < CHIP8_TOTAL_GENERAL_PURPOSE_REGISTERS; v++)
+                    whole = whole && regs.V[v] == (u8) (k + v);
+                bad += !whole;
+                mine++;
+            }
+            torn += bad;
+            taken += mine;
+        });
+    }
+
+    CHIP8_STATE& s = core.getState();
+    u64 end = benchNow() + (u64) milliseconds * 1000000;
+    publishes = 0;
+    while (benchNow() < end)
+    {
+        for (u32 i = 0; i < 1000; i++)
+        {
+            u64 n = ++publishes;
+            u8 k = n & 0xff;
+            s.instructions = n;
+            s.I = n * 3;
+            s.PC = n >> 1;
+            s.DT = ~k;
+            s.ST = k;
+            for (u8 v = 0; v < CHIP8_TOTAL_GENERAL_PURPOSE_REGISTERS; v++)
+                s.V[v] = k + v;
+            debugger.publish(core);
+        }
+    }
+    done = true;
+    for (std::thread& reader : readers)
+        reader.join();
+    reads = taken;
+    return torn;
+}
+
+/* Plays a debugging session against a machine running on its own thread: breaks, a read, register writes and steps, each
+ * command answered by its event. The machine thread sleeps whenever it is stopped. Returns false if an answer is wrong */
+static bool checkSession(const char* rom, u32 rounds)
+{
+    Chip8Debugger debugger;
+    BenchCore core;
+    core.loadFile(rom);
+    std::thread machine([&]() {
+        while (!debugger.isClosed())
+        {
+            debugger.applyCommands(core);
+            if (core.isRunning())
+            {
+                core.execute(CHIP8_INSTRUCTIONS_PER_FRAME);
+                debugger.publish(core);
+            }
+            else
+            {
+                debugger.waitCommand();
+            }
+        }
+    });
+
+    // The address the ROM reaches first after a few frames gets the break point
+    BenchCore probe;
+    probe.loadFile(rom);
+    probe.execute(CHIP8_INSTRUCTIONS_PER_FRAME * 7 + 3);
+    u16 breakAt = probe.getState().PC;
+
+    bool ok = true;
+    DEBUG_COMMAND command = benchCommand(DEBUG_BREAK);
+    command.address = breakAt;
+    ok = ok && debugger.send(command) && debugger.send(benchCommand(DEBUG_RUN));
+    DEBUG_EVENT event;
+    for (u32 round = 0; round < rounds && ok; round++)
+    {
+        ok = debugger.waitEvent(event) && event.kind == DEBUG_EVENT_BREAK && event.why.PC == breakAt &&
+             event.registers.PC == breakAt && !event.registers.running;
+
+        // The machine is stopped so what is read and written is exactly what the next instruction sees
+        command = benchCommand(DEBUG_SET_REGISTER);
+        command.reg = 0xe;
+        command.value = round & 0xff;
+        ok = ok && debugger.send(command);
+        command = benchCommand(DEBUG_READ_MEMORY);
+        command.address = breakAt;
+        command.length = 2;
+        ok = ok && debugger.send(command) && debugger.waitEvent(event) && event.kind == DEBUG_EVENT_MEMORY &&
+             event.length == 2 && event.registers.V[0xe] == (round & 0xff) &&
+             event.bytes[0] == probe.getState().memory[breakAt] && event.bytes[1] == probe.getState().memory[breakAt + 1];
+
+        command = benchCommand(DEBUG_STEP);
+        command.value = 1;
+        ok = ok && debugger.send(command) && debugger.waitEvent(event) && event.kind == DEBUG_EVENT_STEPPED &&
+             event.value == 1 && event.registers.PC != breakAt;
+        ok = ok && debugger.send(benchCommand(DEBUG_RUN));
+    }
+
+    // A bad condition comes back as an error
+    command = benchCommand(DEBUG_BREAK);
+    command.address = breakAt;
+    strcpy(command.text, "V3 ==");
+    ok = ok && debugger.waitEvent(event) && event.kind == DEBUG_EVENT_BREAK && debugger.send(command) &&
+         debugger.waitEvent(event) && event.kind == DEBUG_EVENT_ERROR;
+
+    // Settings are changed on the machine's thread and answered with an event, the frontend's own are refused
+    command = benchCommand(DEBUG_INSTRUCTIONS_PER_FRAME);
+    command.value = 20;
+    ok = ok && debugger.send(command) && debugger.waitEvent(event) && event.kind == DEBUG_EVENT_INFO &&
+         strstr(event.text, "Running 20 instructions") != NULL;
+    ok = ok && debugger.send(benchCommand(DEBUG_PACING)) && debugger.waitEvent(event) && event.kind == DEBUG_EVENT_ERROR;
+
+    debugger.close();
+    machine.join();
+    return ok && debugger.getDroppedEvents() == 0;
+}
+
+// Returns the nanoseconds an instruction takes running "frames" frames, "share" is the host CPU used over the time in cores
+static double timeFrames(BenchCore& core, Chip8Debugger* debugger, u32 frames, double& share)
+{
+    std::clock_t cpu = std::clock();
+    u64 start = benchNow();
+    for (u32 f = 0; f < frames; f++)
+    {
+        if (debugger)
+            debugger->applyCommands(core);
+        core.execute(CHIP8_INSTRUCTIONS_PER_FRAME);
+    }
+    u64 ns = benchNow() - start;
+    share = (double) (std::clock() - cpu) / CLOCKS_PER_SEC / (ns / 1e9);
+    benchKeep(core.getState());
+    return (double) ns / ((u64) frames * CHIP8_INSTRUCTIONS_PER_FRAME);
+}
+
+int benchDebugger(int argc, char* argv[])
+{
+    u32 frames = argc > 0 ? atoi(argv[0]) : 200000;
+    if (frames == 0)
+        frames = 1;
+
+    bool ok = true;
+    double nsPerItem = 0;
+    bool ordered = checkQueue(2000000, nsPerItem);
+    std::cout << std::fixed << std::setprecision(1) << "Queue passed 2000000 items between threads in order"
+              << (ordered ? "" : " WRONG") << ", " << nsPerItem << " ns an item" << std::endl;
+
+    u64 reads = 0;
+    u64 publishes = 0;
+    u64 torn = checkSnapshots(500, reads, publishes);
+    std::cout << "Snapshots: " << publishes << " published and " << reads << " read by two threads, " << torn << " torn" << std::endl;
+
+    bool session = checkSession(benchRoms[0], 200);
+    std::cout << "A session of 200 breaks, reads, writes and steps against a machine on its own thread"
+              << (session ? " answered every command" : " WRONG") << std::endl;
+    ok = ordered && torn == 0 && session;
+
+    const char* rom = benchRoms[0];
+    std::cout << std::setprecision(2) << rom << ", " << frames << " frames of " << CHIP8_INSTRUCTIONS_PER_FRAME
+              << " instructions as fast as they run" << std::endl;
+    double share = 0;
+    {
+        BenchCore core;
+        core.loadFile(rom);
+        double ns = timeFrames(core, NULL, frames, share);
+        std::cout << "  no debugger             " << std::setw(7) << ns << " ns an instruction, " << share << " cores busy" << std::endl;
+    }
+    {
+        // A listener asleep on events and an observer reading the registers a thousand times a second
+        BenchCore core;
+        core.loadFile(rom);
+        Chip8Debugger debugger;
+        std::atomic<bool> done(false);
+        std::thread listener([&]() {
+            DEBUG_EVENT event;
+            while (debugger.waitEvent(event))
+                benchKeep(event);
+        });
+        std::thread observer([&]() {
+            while (!done.load(std::memory_order_relaxed))
+            {
+                benchKeep(debugger.getSnapshot());
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        });
+        double ns = timeFrames(core, &debugger, frames, share);
+        done = true;
+        debugger.close();
+        listener.join();
+        observer.join();
+        std::cout << "  debugger attached       " << std::setw(7) << ns << " ns an instruction, " << share << " cores busy" << std::endl;
+    }
+    {
+        // How the listener used to wait for a break, asking the machine for its registers over and over
+        BenchCore core;
+        core.loadFile(rom);
+        std::atomic<bool> done(false);
+        std::thread listener([&]() {
+            while (!done.load(std::memory_order_relaxed))
+            {
+                REGISTERS regs = core.getRegs();
+                benchKeep(regs);
+                benchKeep(core.hasBreakPoint(regs.PC));
+            }
+        });
+        double ns = timeFrames(core, NULL, frames, share);
+        done = true;
+        listener.join();
+        std::cout << "  polling listener        " << std::setw(7) << ns << " ns an instruction, " << share << " cores busy" << std::endl;
+    }
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,83 @@
+#include <iostream>
+#include <iomanip>
+#include <stdlib.h>
+#include <string.h>
+#include "Bench.h"
+
+struct ENGINE_RUN
+{
+    u64 ns;
+    u32 executed;
+    DECODE_CACHE_STATS cache;
+    JIT_STATS jit;
+    CHIP8_STATE state;
+};
+
+// Runs a ROM from reset with the engine given, key 5 is held down so ROMs waiting on a key move on
+static bool runEngine(const char* rom, DISPATCH_ENGINE engine, u32 instructions, ENGINE_RUN& run)
+{
+    BenchCore core;
+    if (!core.loadFile(rom))
+        return false;
+
+    core.setDispatchEngine(engine);
+    core.setKeyDown(5);
+
+    u64 start = benchNow();
+    run.executed = core.execute(instructions);
+    run.ns = benchNow() - start;
+    run.cache = core.getDecodeCacheStats();
+    run.jit = core.getJitStats();
+    run.state = core.getState();
+    return true;
+}
+
+int benchDispatch(int argc, char* argv[])
+{
+    u32 instructions = argc > 0 ? atoi(argv[0]) : 20000000;
+    static const DISPATCH_ENGINE engines[] = {DISPATCH_SWITCH, DISPATCH_TABLE, DISPATCH_GOTO, DISPATCH_CACHE, DISPATCH_JIT, DISPATCH_COMPILED};
+    static const char* const engineNames[] = {"switch", "table", "goto", "cache", "jit", "compiled"};
+
+    bool ok = true;
+    for (const char* rom : benchRoms)
+    {
+        ENGINE_RUN reference;
+        for (u32 e = 0; e < sizeof(engines) / sizeof(engines[0]); e++)
+        {
+            ENGINE_RUN run;
+            if (!runEngine(rom, engines[e], instructions, run))
+            {
+                std::cout << "Failed to load " << rom << std::endl;
+                return 1;
+            }
+
+            // Every engine has to leave the machine in exactly the same state as the switch engine
+            bool same = true;
+            if (e == 0)
+                reference = run;
+            else
+                same = run.executed == reference.executed && memcmp(&run.state, &reference.state, sizeof(CHIP8_STATE)) == 0;
+            ok = ok && same;
+
+            double seconds = run.ns / 1e9;
+            std::cout << std::left << std::setw(10) << rom << std::setw(8) << engineNames[e]
+                      << std::right << std::setw(10) << std::fixed << std::setprecision(1) << (run.executed / seconds) / 1e6 << " M instructions/sec"
+                      << std::setw(8) << std::setprecision(2) << (double) run.ns / run.executed << " ns/instruction"
+                      << std::setw(10) << run.executed << " executed"
+                      << (same ? "" : "  STATE DIFFERS FROM SWITCH ENGINE") << std::endl;
+
+            if (engines[e] == DISPATCH_CACHE)
+            {
+                std::cout << std::setw(18) << "" << "decode cache: " << run.cache.hits << " hits, " << run.cache.misses << " misses, "
+                          << run.cache.invalidations << " invalidations" << std::endl;
+            }
+            if (engines[e] == DISPATCH_JIT)
+            {
+                std::cout << std::setw(18) << "" << "jit: " << run.jit.blocks << " blocks, " << run.jit.links << " links, "
+                          << run.jit.interpreted << " interpreted addresses, " << run.jit.flushes << " flushes" << std::endl;
+            }
+        }
+    }
+
+    return ok ? 0 : 1;
+}
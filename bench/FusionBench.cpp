@@ -0,0 +1,115 @@
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include "Bench.h"
+
+struct SEQUENCE
+{
+    std::string name;
+    u64 count;
+};
+
+// Prints the hottest pairs and triples of opcode classes in a profile
+static void printHotSequences(const OPCODE_PROFILE& profile, u32 top)
+{
+    std::vector<SEQUENCE> sequences;
+    for (u32 a = 0; a < OPCODE_CLASS_COUNT; a++)
+    {
+        for (u32 b = 0; b < OPCODE_CLASS_COUNT; b++)
+        {
+            if (profile.pairs[a][b])
+                sequences.push_back({std::string(opcodeClassName(a)) + " " + opcodeClassName(b), profile.pairs[a][b]});
+            for (u32 c = 0; c < OPCODE_CLASS_COUNT; c++)
+            {
+                if (profile.triples[a][b][c])
+                    sequences.push_back({std::string(opcodeClassName(a)) + " " + opcodeClassName(b) + " " + opcodeClassName(c), profile.triples[a][b][c]});
+            }
+        }
+    }
+
+    std::sort(sequences.begin(), sequences.end(), [](const SEQUENCE& a, const SEQUENCE& b) { return a.count > b.count; });
+    for (u32 c = 0; c < sequences.size() && c < top; c++)
+    {
+        std::cout << "    " << std::left << std::setw(16) << sequences[c].name << std::right << std::setw(12) << sequences[c].count
+                  << std::setw(8) << std::fixed << std::setprecision(1) << 100.0 * sequences[c].count / profile.total << "%" << std::endl;
+    }
+}
+
+// Runs a ROM on the cache engine with the fused patterns given, key 5 is held down as in the dispatch benchmark
+static bool runFused(const char* rom, u32 mask, u32 instructions, u64& ns, FUSION_STATS& stats, CHIP8_STATE& state)
+{
+    BenchCore core;
+    if (!core.loadFile(rom))
+        return false;
+
+    core.setDispatchEngine(mask == 0xffffffff ? DISPATCH_SWITCH : DISPATCH_CACHE);
+    if (mask != 0xffffffff)
+        core.setFusedPatterns(mask);
+    core.setKeyDown(5);
+
+    u64 start = benchNow();
+    core.execute(instructions);
+    ns = benchNow() - start;
+    stats = core.getFusionStats();
+    state = core.getState();
+    return true;
+}
+
+int benchFusion(int argc, char* argv[])
+{
+    u32 instructions = argc > 0 ? atoi(argv[0]) : 20000000;
+    double minShare = argc > 1 ? atof(argv[1]) : 0.01;
+
+    bool ok = true;
+    for (const char* rom : benchRoms)
+    {
+        // Profile the first part of the run to pick the patterns worth fusing for this ROM
+        BenchCore profiler;
+        if (!profiler.loadFile(rom))
+        {
+            std::cout << "Failed to load " << rom << std::endl;
+            return 1;
+        }
+        profiler.setKeyDown(5);
+        profiler.setProfiling(true);
+        profiler.execute(instructions / 10);
+        const OPCODE_PROFILE& profile = *profiler.getOpcodeProfile();
+        u32 mask = chooseFusedPatterns(profile, minShare);
+
+        std::cout << rom << ", hottest runs over " << profile.total << " instructions" << std::endl;
+        printHotSequences(profile, 8);
+
+        u64 referenceNs, plainNs, fusedNs;
+        FUSION_STATS stats;
+        CHIP8_STATE reference, plain, fused;
+        runFused(rom, 0xffffffff, instructions, referenceNs, stats, reference);
+        runFused(rom, 0, instructions, plainNs, stats, plain);
+        runFused(rom, mask, instructions, fusedNs, stats, fused);
+
+        bool same = memcmp(&plain, &reference, sizeof(CHIP8_STATE)) == 0 && memcmp(&fused, &reference, sizeof(CHIP8_STATE)) == 0;
+        ok = ok && same;
+
+        u64 dispatches = 0;
+        u64 saved = 0;
+        for (u8 p = 0; p < FUSED_PATTERN_COUNT; p++)
+        {
+            if (!(mask & (1 << p)))
+                continue;
+            u64 patternSaved = stats.instructions[p] - stats.dispatches[p];
+            saved += patternSaved;
+            dispatches += stats.dispatches[p];
+            std::cout << "    fused " << std::left << std::setw(16) << fusedPatterns[p].name << std::right
+                      << std::setw(12) << stats.dispatches[p] << " dispatches" << std::setw(12) << patternSaved << " dispatches saved" << std::endl;
+        }
+
+        std::cout << "    cache engine " << std::fixed << std::setprecision(2) << (double) plainNs / 1e6 << " ms, fused "
+                  << (double) fusedNs / 1e6 << " ms, " << saved << " dispatches saved"
+                  << (same ? "" : "  STATE DIFFERS FROM SWITCH ENGINE") << std::endl;
+    }
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,221 @@
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <stdlib.h>
+#include <string>
+#include "Bench.h"
+#include "Handlers.h"
+#include "Heatmap.h"
+
+// The files the benchmark writes heatmaps to, they are removed afterwards
+#define HEATMAP_BENCH_CSV "heatmap_bench.csv"
+#define HEATMAP_BENCH_FILE "heatmap_bench.c8h"
+
+/* Counts what a stepped core's instruction is about to touch by reading the opcode itself rather than through
+ * "instructionAccess", so the two ways of working it out check each other */
+static void expectAccess(const CHIP8_STATE& s, std::vector<u64>& reads, std::vector<u64>& writes, std::vector<u64>& executes)
+{
+    u16 opcode = Handlers::fetch(s);
+    u8 x = (opcode >> 8) & 0x0f;
+    executes[CHIP8_ADDRESS(s.PC)]++;
+    executes[CHIP8_ADDRESS(s.PC + 1)]++;
+    if ((opcode & 0xf000) == 0xd000)
+    {
+        for (u32 c = 0; c < (opcode & 0x000f); c++)
+            reads[CHIP8_ADDRESS(s.I + c)]++;
+    }
+    else if ((opcode & 0xf0ff) == 0xf033)
+    {
+        for (u32 c = 0; c < 3; c++)
+            writes[CHIP8_ADDRESS(s.I + c)]++;
+    }
+    else if ((opcode & 0xf0ff) == 0xf055 || (opcode & 0xf0ff) == 0xf065)
+    {
+        std::vector<u64>& counts = (opcode & 0x00ff) == 0x55 ? writes : reads;
+        for (u32 c = 0; c <= x; c++)
+            counts[CHIP8_ADDRESS(s.I + c)]++;
+    }
+}
+
+// True if "counted" holds what was expected at every address, the first address that differs is printed
+static bool sameCounts(const char* what, const u64* counted, const std::vector<u64>& expected)
+{
+    for (u32 a = 0; a < CHIP8_MEMORY_SIZE; a++)
+    {
+        if (counted[a] != expected[a])
+        {
+            std::cout << "    " << what << " of " << std::hex << a << std::dec << " counted " << counted[a] << ", expected "
+                      << expected[a] << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+/* Counts "frames" frames of "program" on the default engine with idle skipping asked for and steps a second core an
+ * instruction at a time beside it, every byte must have been counted exactly as often as it was touched */
+static bool checkCounts(const std::vector<u8>& program, u32 frames, Chip8Heatmap& heatmap)
+{
+    BenchCore core;
+    BenchCore reference;
+    core.loadMemory(program.data(), program.size());
+    reference.loadMemory(program.data(), program.size());
+    core.setKeyDown(5);
+    reference.setKeyDown(5);
+    core.setIdleSkipping(true);
+    heatmap.reset();
+    core.setHeatmap(&heatmap);
+
+    std::vector<u64> reads(CHIP8_MEMORY_SIZE, 0);
+    std::vector<u64> writes(CHIP8_MEMORY_SIZE, 0);
+    std::vector<u64> executes(CHIP8_MEMORY_SIZE, 0);
+    for (u32 f = 0; f < frames; f++)
+    {
+        core.execute(CHIP8_INSTRUCTIONS_PER_FRAME);
+        for (u32 i = 0; i < CHIP8_INSTRUCTIONS_PER_FRAME; i++)
+        {
+            // A machine halted on "Fx0A" touches nothing while it waits
+            if (!reference.getState().keyWait)
+                expectAccess(reference.getState(), reads, writes, executes);
+            reference.execute(1);
+        }
+    }
+    core.setHeatmap(NULL);
+
+    return memcmp(&core.getState(), &reference.getState(), sizeof(CHIP8_STATE)) == 0 &&
+           sameCounts("reads", heatmap.getReads(), reads) && sameCounts("writes", heatmap.getWrites(), writes) &&
+           sameCounts("executes", heatmap.getExecutes(), executes) && heatmap.getInstructions() > 0;
+}
+
+// Writes "heatmap" as CSV and as a binary file, both must read back to the same counts
+static bool checkFiles(Chip8Heatmap& heatmap)
+{
+    bool ok = heatmap.writeCsv(HEATMAP_BENCH_CSV) && heatmap.save(HEATMAP_BENCH_FILE);
+
+    std::ifstream csv(HEATMAP_BENCH_CSV);
+    std::string line;
+    u32 rows = 0;
+    ok = ok && std::getline(csv, line) && line == "address,reads,writes,executes";
+    while (ok && std::getline(csv, line))
+    {
+        char* at = &line[0];
+        u32 address = strtoul(at, &at, 10);
+        u64 reads = strtoull(at + 1, &at, 10);
+        u64 writes = strtoull(at + 1, &at, 10);
+        u64 executes = strtoull(at + 1, &at, 10);
+        ok = address == rows && reads == heatmap.getReads()[address] && writes == heatmap.getWrites()[address] &&
+             executes == heatmap.getExecutes()[address];
+        rows++;
+    }
+    csv.close();
+
+    Chip8Heatmap loaded;
+    ok = ok && rows == CHIP8_MEMORY_SIZE && loaded.load(HEATMAP_BENCH_FILE) &&
+         loaded.getInstructions() == heatmap.getInstructions() &&
+         memcmp(loaded.getReads(), heatmap.getReads(), CHIP8_MEMORY_SIZE * sizeof(u64)) == 0 &&
+         memcmp(loaded.getWrites(), heatmap.getWrites(), CHIP8_MEMORY_SIZE * sizeof(u64)) == 0 &&
+         memcmp(loaded.getExecutes(), heatmap.getExecutes(), CHIP8_MEMORY_SIZE * sizeof(u64)) == 0;
+    remove(HEATMAP_BENCH_CSV);
+    remove(HEATMAP_BENCH_FILE);
+    return ok;
+}
+
+// The byte executed the most is full blue and a byte nothing touched is black
+static bool checkColours(Chip8Heatmap& heatmap)
+{
+    std::vector<u32> colours(CHIP8_MEMORY_SIZE);
+    heatmap.getColours(colours.data());
+    const u64* executes = heatmap.getExecutes();
+    u32 hottest = std::max_element(executes, executes + CHIP8_MEMORY_SIZE) - executes;
+    u32 untouched = 0;
+    while (untouched < CHIP8_MEMORY_SIZE &&
+           (heatmap.getReads()[untouched] || heatmap.getWrites()[untouched] || executes[untouched]))
+        untouched++;
+    return (colours[hottest] & 0xff) == 0xff && (untouched == CHIP8_MEMORY_SIZE || colours[untouched] == 0);
+}
+
+// Returns the nanoseconds an instruction of "rom" takes on "engine", counted into a heatmap or not
+static double timeRun(const char* rom, DISPATCH_ENGINE engine, bool count, u32 instructions)
+{
+    BenchCore core;
+    core.loadFile(rom);
+    core.setDispatchEngine(engine);
+    core.setKeyDown(5);
+    Chip8Heatmap heatmap;
+    if (count)
+        core.setHeatmap(&heatmap);
+
+    u64 start = benchNow();
+    u32 done = 0;
+    while (done < instructions)
+    {
+        u32 ran = core.execute(CHIP8_INSTRUCTIONS_PER_FRAME * 60);
+        if (ran == 0)
+            break;
+        done += ran;
+    }
+    double ns = (double) (benchNow() - start) / (done ? done : 1);
+    benchKeep(core.getState());
+    benchKeep(heatmap);
+    core.setHeatmap(NULL);
+    return ns;
+}
+
+int benchHeatmap(int argc, char* argv[])
+{
+    u32 instructions = argc > 0 ? atoi(argv[0]) : 5000000;
+    if (instructions < 100000)
+        instructions = 100000;
+    bool ok = true;
+
+    Chip8Heatmap heatmap;
+    for (const char* rom : benchRoms)
+    {
+        BenchCore loader;
+        loader.loadFile(rom);
+        std::vector<u8> program(&loader.getState().memory[CHIP8_PROGRAM_LOAD_ADDRESS], &loader.getState().memory[CHIP8_MEMORY_SIZE]);
+        bool right = checkCounts(program, 6000, heatmap) && checkColours(heatmap);
+        if (rom == benchRoms[0])
+            right = checkFiles(heatmap) && right;
+        ok = ok && right;
+
+        HEATMAP_STATS stats = heatmap.getStats();
+        std::cout << "  " << std::setw(8) << rom << ": " << std::setw(4) << stats.read << " bytes read, " << std::setw(4)
+                  << stats.written << " written, " << std::setw(4) << stats.executed << " executed, " << stats.codeWritten
+                  << " of code written, hottest data" << std::hex;
+        for (const HEATMAP_REGION& region : heatmap.getDataRegions(3))
+            std::cout << " " << region.address << "+" << std::dec << region.length << std::hex;
+        std::cout << std::dec << (right ? "" : " WRONG") << std::endl;
+    }
+
+    // "Fx55" stores two registers over the instruction at 0x20A and the byte after it, both of which run
+    std::vector<u8> program(benchSelfModifyingProgram, benchSelfModifyingProgram + sizeof(benchSelfModifyingProgram));
+    bool found = checkCounts(program, 100, heatmap);
+    HEATMAP_STATS stats = heatmap.getStats();
+    found = found && stats.codeWritten == 2 && stats.firstCodeWritten == 0x20A;
+    ok = ok && found;
+    std::cout << "Self-modifying program: " << stats.codeWritten << " bytes of code written from " << std::hex
+              << stats.firstCodeWritten << std::dec << (found ? "" : " WRONG") << std::endl;
+
+    /* Counting dispatches as the switch engine does and the goto engine is the default, the runs are taken in turn and
+     * the best of three kept as the host is noisy */
+    std::cout << std::fixed << std::setprecision(2);
+    for (const char* rom : benchRoms)
+    {
+        double counted = 1e9;
+        double bare = 1e9;
+        double fastest = 1e9;
+        for (u32 r = 0; r < 3; r++)
+        {
+            counted = std::min(counted, timeRun(rom, DISPATCH_SWITCH, true, instructions));
+            bare = std::min(bare, timeRun(rom, DISPATCH_SWITCH, false, instructions));
+            fastest = std::min(fastest, timeRun(rom, DISPATCH_GOTO, false, instructions));
+        }
+        std::cout << "  " << std::setw(8) << rom << ": " << std::setw(6) << counted << " ns an instruction with a heatmap, "
+                  << std::setw(6) << bare << " on switch, " << counted / bare << "x, " << std::setw(6) << fastest
+                  << " on goto, " << counted / fastest << "x" << std::endl;
+    }
+
+    return ok ? 0 : 1;
+}
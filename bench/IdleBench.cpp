@@ -0,0 +1,189 @@
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "Audio.h"
+#include "Bench.h"
+
+// Sets the delay timer and jumps to itself
+static const u8 idleSelfJumpProgram[] = {
+    0x60, 0x05,     // 0x200 LD V0, 5
+    0xF0, 0x15,     // 0x202 LD DT, V0
+    0x12, 0x04      // 0x204 JP 0x204
+};
+
+// Waits half a second on the delay timer, counts the waits in V2 and waits again
+static const u8 idleTimerWaitProgram[] = {
+    0x60, 0x1E,     // 0x200 LD V0, 30
+    0xF0, 0x15,     // 0x202 LD DT, V0
+    0xF1, 0x07,     // 0x204 LD V1, DT
+    0x31, 0x00,     // 0x206 SE V1, 0
+    0x12, 0x04,     // 0x208 JP 0x204
+    0x72, 0x01,     // 0x20A ADD V2, 1
+    0x12, 0x00      // 0x20C JP 0x200
+};
+
+// Polls key 5 and counts the polls that found it down in V2
+static const u8 idleKeyPollProgram[] = {
+    0x60, 0x05,     // 0x200 LD V0, 5
+    0xE0, 0x9E,     // 0x202 SKP V0
+    0x12, 0x00,     // 0x204 JP 0x200
+    0x72, 0x01,     // 0x206 ADD V2, 1
+    0x12, 0x00      // 0x208 JP 0x200
+};
+
+struct IDLE_PROGRAM
+{
+    std::string name;
+    std::vector<u8> code;
+};
+
+// Key 5 goes down and up every 45 frames, between frames the way the frontend delivers it
+static void idleFrameKeys(Chip8Core& core, u32 frame)
+{
+    if (frame % 45 == 0)
+    {
+        if (core.keyDown(5))
+            core.setKeyUp(5);
+        else
+            core.setKeyDown(5);
+    }
+}
+
+/* Runs a program "frames" frames of its "instructionsPerFrame" with idle skipping and without on "engine", checks the
+ * two machines agree after every frame and returns the instructions skipped */
+static bool checkIdle(const IDLE_PROGRAM& program, DISPATCH_ENGINE engine, u16 instructionsPerFrame, u32 frames, u64& elided)
+{
+    BenchCore core;
+    BenchCore reference;
+    core.loadMemory(program.code.data(), program.code.size());
+    reference.loadMemory(program.code.data(), program.code.size());
+    core.setDispatchEngine(engine);
+    reference.setDispatchEngine(engine);
+    core.setInstructionsPerFrame(instructionsPerFrame);
+    reference.setInstructionsPerFrame(instructionsPerFrame);
+    core.setIdleSkipping(true);
+
+    for (u32 f = 0; f < frames; f++)
+    {
+        idleFrameKeys(core, f);
+        idleFrameKeys(reference, f);
+        u32 ran = core.execute(instructionsPerFrame);
+        u32 expected = reference.execute(instructionsPerFrame);
+        if (ran != expected || memcmp(&core.getState(), &reference.getState(), sizeof(CHIP8_STATE)) != 0 ||
+            core.hasQuit() != reference.hasQuit())
+        {
+            std::cout << "    " << program.name << " differs after frame " << f << " at PC " << std::hex
+                      << core.getState().PC << " against " << reference.getState().PC << std::dec << std::endl;
+            return false;
+        }
+    }
+    elided = core.getIdleStats().elided;
+    return true;
+}
+
+/* Runs a program as the frontend does with the audio open, a frame a call through a Chip8Audio with a sink, and checks
+ * it skips as much and ends up the same as running the core on its own */
+static bool checkThroughAudio(const IDLE_PROGRAM& program, u16 instructionsPerFrame, u32 frames, u64& elided)
+{
+    BenchCore core;
+    BenchCore reference;
+    core.loadMemory(program.code.data(), program.code.size());
+    reference.loadMemory(program.code.data(), program.code.size());
+    core.setInstructionsPerFrame(instructionsPerFrame);
+    reference.setInstructionsPerFrame(instructionsPerFrame);
+    core.setIdleSkipping(true);
+    reference.setIdleSkipping(true);
+    NullAudioSink sink;
+    Chip8Audio audio;
+    audio.setSink(&sink);
+
+    for (u32 f = 0; f < frames; f++)
+    {
+        idleFrameKeys(core, f);
+        idleFrameKeys(reference, f);
+        audio.execute(core, instructionsPerFrame);
+        reference.execute(instructionsPerFrame);
+    }
+    elided = core.getIdleStats().elided;
+    return elided == reference.getIdleStats().elided && memcmp(&core.getState(), &reference.getState(), sizeof(CHIP8_STATE)) == 0;
+}
+
+// Returns the nanoseconds it takes the default engine to run "frames" frames of a program
+static u64 timeIdle(const IDLE_PROGRAM& program, bool skipping, u16 instructionsPerFrame, u32 frames)
+{
+    BenchCore core;
+    core.loadMemory(program.code.data(), program.code.size());
+    core.setInstructionsPerFrame(instructionsPerFrame);
+    core.setIdleSkipping(skipping);
+    u64 start = benchNow();
+    for (u32 f = 0; f < frames; f++)
+    {
+        idleFrameKeys(core, f);
+        core.execute(instructionsPerFrame);
+    }
+    u64 ns = benchNow() - start;
+    benchKeep(core.getState());
+    return ns;
+}
+
+int benchIdle(int argc, char* argv[])
+{
+    u32 frames = argc > 0 ? atoi(argv[0]) : 6000;
+    if (frames == 0)
+        frames = 1;
+
+    std::vector<IDLE_PROGRAM> programs;
+    for (const char* rom : benchRoms)
+    {
+        BenchCore core;
+        IDLE_PROGRAM program;
+        program.name = rom;
+        if (core.loadFile(rom))
+            program.code.assign(&core.getState().memory[CHIP8_PROGRAM_LOAD_ADDRESS], &core.getState().memory[CHIP8_MEMORY_SIZE]);
+        programs.push_back(program);
+    }
+    programs.push_back({"selfjump", std::vector<u8>(idleSelfJumpProgram, idleSelfJumpProgram + sizeof(idleSelfJumpProgram))});
+    programs.push_back({"timerwait", std::vector<u8>(idleTimerWaitProgram, idleTimerWaitProgram + sizeof(idleTimerWaitProgram))});
+    programs.push_back({"keypoll", std::vector<u8>(idleKeyPollProgram, idleKeyPollProgram + sizeof(idleKeyPollProgram))});
+
+    static const DISPATCH_ENGINE engines[] = {DISPATCH_SWITCH, DISPATCH_TABLE, DISPATCH_GOTO, DISPATCH_CACHE, DISPATCH_JIT, DISPATCH_COMPILED};
+    static const char* const names[] = {"switch", "table", "goto", "cache", "jit", "compiled"};
+    bool ok = true;
+    std::cout << std::fixed;
+    for (u16 instructionsPerFrame : {CHIP8_INSTRUCTIONS_PER_FRAME, 1000})
+    {
+        std::cout << frames << " frames of " << instructionsPerFrame << " instructions, time on the "
+                  << (CHIP8_DISPATCH_ENGINE == CHIP8_DISPATCH_GOTO ? "goto" : "table") << " engine" << std::endl;
+        for (const IDLE_PROGRAM& program : programs)
+        {
+            // The line is built up first as ROMs that overflow the stack print while they run
+            std::stringstream line;
+            line << std::fixed << std::left << std::setw(10) << program.name << std::right << " same on";
+            u64 elided = 0;
+            for (u32 e = 0; e < sizeof(engines) / sizeof(engines[0]); e++)
+            {
+                bool same = checkIdle(program, engines[e], instructionsPerFrame, frames, elided);
+                line << " " << names[e] << (same ? "" : " DIFFER");
+                ok = ok && same;
+            }
+            u64 heard = 0;
+            bool same = checkThroughAudio(program, instructionsPerFrame, frames, heard) && heard == elided;
+            line << " audio" << (same ? "" : " DIFFER");
+            ok = ok && same;
+
+            u64 stepped = timeIdle(program, false, instructionsPerFrame, frames);
+            u64 skipped = timeIdle(program, true, instructionsPerFrame, frames);
+            double seconds = (double) frames / CHIP8_FRAMES_PER_SECOND;
+            line << ", " << std::setprecision(1) << std::setw(5) << 100.0 * elided / ((u64) frames * instructionsPerFrame)
+                 << "% skipped, " << std::setprecision(2) << std::setw(8) << stepped / 1e3 / seconds << " us a second stepped "
+                 << std::setw(8) << skipped / 1e3 / seconds << " us skipping, " << std::setw(8)
+                 << ((double) stepped - skipped) / 1e3 / seconds << " us of host CPU saved each emulated second";
+            std::cout << line.str() << std::endl;
+        }
+    }
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,47 @@
+#include <iostream>
+#include <iomanip>
+#include <stdlib.h>
+#include <string.h>
+#include "Bench.h"
+
+static void printStats(const char* name, BenchCore& core, bool same, u32 chunks)
+{
+    JIT_STATS stats = core.getJitStats();
+    std::cout << std::left << std::setw(12) << name << (same ? "same state" : "DIFFERENT STATE") << " over " << chunks << " chunks, "
+              << stats.blocks << " blocks, " << stats.links << " links, " << stats.interpreted << " interpreted addresses, "
+              << stats.flushes << " flushes" << std::endl;
+}
+
+int benchJit(int argc, char* argv[])
+{
+    u32 instructions = argc > 0 ? atoi(argv[0]) : 2000000;
+
+    if (!CHIP8_JIT_SUPPORTED)
+        std::cout << "The jit is not available here, the jit engine falls back to the decode cache" << std::endl;
+
+    bool ok = true;
+    for (const char* rom : benchRoms)
+    {
+        BenchCore jit, reference;
+        if (!jit.loadFile(rom) || !reference.loadFile(rom))
+        {
+            std::cout << "Failed to load " << rom << std::endl;
+            return 1;
+        }
+
+        u32 chunks;
+        bool same = benchLockstep(jit, DISPATCH_JIT, reference, instructions, chunks);
+        printStats(rom, jit, same, chunks);
+        ok = ok && same;
+    }
+
+    BenchCore jit, reference;
+    jit.loadMemory(benchSelfModifyingProgram, sizeof(benchSelfModifyingProgram));
+    reference.loadMemory(benchSelfModifyingProgram, sizeof(benchSelfModifyingProgram));
+    u32 chunks;
+    bool same = benchLockstep(jit, DISPATCH_JIT, reference, instructions, chunks);
+    printStats("self-modify", jit, same, chunks);
+    ok = ok && same;
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,224 @@
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "Batch.h"
+#include "Bench.h"
+
+// Starts the delay timer then waits for a key into V3 over and over, counting the keys in V2
+static const u8 keyWaitProgram[] = {
+    0x60, 0x3C,     // 0x200 LD V0, 60
+    0xF0, 0x15,     // 0x202 LD DT, V0
+    0xF3, 0x0A,     // 0x204 LD V3, K
+    0x72, 0x01,     // 0x206 ADD V2, 1
+    0x12, 0x04      // 0x208 JP 0x204
+};
+
+// Polls every key in turn and counts the polls in V2, how a ROM waits for a key when it cannot halt
+static const u8 keyPollProgram[] = {
+    0x61, 0x00,     // 0x200 LD V1, 0
+    0xE1, 0x9E,     // 0x202 SKP V1
+    0x12, 0x08,     // 0x204 JP 0x208
+    0x12, 0x0E,     // 0x206 JP 0x20E
+    0x71, 0x01,     // 0x208 ADD V1, 1
+    0x41, 0x10,     // 0x20A SNE V1, 16
+    0x61, 0x00,     // 0x20C LD V1, 0
+    0x12, 0x02,     // 0x20E JP 0x202
+};
+
+/* Takes the program through halting with the timer running, a press, a release and a key that was already down, checking
+ * each step under "profile". Leaves the machine as the steps did so the engines can be compared */
+static bool checkKeyWait(BenchCore& core, DISPATCH_ENGINE engine, QUIRK_PROFILE profile)
+{
+    bool release = quirkProfileQuirks(profile) & CHIP8_QUIRK_KEY_RELEASE;
+    CHIP8_STATE& s = core.getState();
+    core.setDispatchEngine(engine);
+    core.setQuirkProfile(profile);
+    core.loadMemory(keyWaitProgram, sizeof(keyWaitProgram));
+
+    // Three instructions run then the rest of the call is spent halted, the timer ticks every 10 of them all the same
+    bool ok = core.execute(300) == 300 && core.isWaitingForKey() && s.keyWait == (CHIP8_KEY_WAITING | 3) &&
+              s.PC == 0x206 && s.DT == 30 && core.getInstructions() == 300;
+
+    // Halted with no key down, only a press resumes it, or under the profile the release that follows
+    core.setKeyDown(7);
+    ok = ok && core.isWaitingForKey() == release;
+    core.setKeyUp(7);
+    ok = ok && !core.isWaitingForKey() && s.V[3] == 7;
+    ok = ok && core.execute(3) == 3 && core.isWaitingForKey() && s.V[2] == 1;
+
+    // A key already down is taken straight away, the profile halts until it is let go
+    ok = ok && core.injectKey(0xA) && s.V[3] == 0xA && !core.isWaitingForKey();
+    core.setKeyDown(9);
+    ok = ok && core.execute(25) == 25 && core.isWaitingForKey() == release && s.V[3] == (release ? 0xA : 9);
+    core.setKeyUp(9);
+    ok = ok && !core.isWaitingForKey() && s.V[3] == 9;
+
+    // With 5 then 6 pressed and 6 let go the key still down is taken, not the last one pressed
+    core.setKeyDown(5);
+    core.setKeyDown(6);
+    core.setKeyUp(6);
+    ok = ok && core.execute(3) == 3 && core.isWaitingForKey() == release && s.V[3] == (release ? 9 : 5);
+    core.setKeyUp(5);
+    ok = ok && !core.isWaitingForKey() && s.V[3] == 5;
+    return ok && !core.hasQuit();
+}
+
+/* Runs a batch of lanes that each get a key on a different frame against a core per lane, returns false at the first lane
+ * that differs from its core */
+static bool checkBatch(u32 lanes)
+{
+    BenchCore loaded;
+    loaded.loadMemory(keyWaitProgram, sizeof(keyWaitProgram));
+    Chip8Batch batch(lanes);
+    batch.loadState(loaded.getState());
+    std::vector<BenchCore> cores(lanes);
+    for (u32 lane = 0; lane < lanes; lane++)
+    {
+        cores[lane].loadMemory(keyWaitProgram, sizeof(keyWaitProgram));
+        cores[lane].setSeed(lane + 1);
+    }
+
+    for (u32 frame = 0; frame < 120; frame++)
+    {
+        for (u32 lane = 0; lane < lanes; lane++)
+        {
+            // Lane "n" presses its key on every frame that is a multiple of "n" + 2 and lets it go on the next
+            bool down = frame % (lane + 2) == 0;
+            if (down)
+            {
+                batch.setKeyDown(lane, lane);
+                cores[lane].setKeyDown(lane);
+            }
+            else
+            {
+                batch.setKeyUp(lane, lane);
+                cores[lane].setKeyUp(lane);
+            }
+        }
+
+        batch.run(CHIP8_INSTRUCTIONS_PER_FRAME);
+        for (u32 lane = 0; lane < lanes; lane++)
+        {
+            cores[lane].execute(CHIP8_INSTRUCTIONS_PER_FRAME);
+            CHIP8_STATE laneState;
+            batch.getLaneState(lane, laneState);
+            if (memcmp(&laneState, &cores[lane].getState(), sizeof(CHIP8_STATE)) != 0 ||
+                batch.isWaitingForKey(lane) != cores[lane].isWaitingForKey())
+            {
+                std::cout << "    lane " << lane << " differs after frame " << frame << std::endl;
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/* Runs a ROM on "engine" and the switch engine a frame at a time with no key held, tapping key 5 every 37 frames, and
+ * checks they agree after every frame. The times the ROM halted are returned in "waits" */
+static bool checkRom(const char* rom, DISPATCH_ENGINE engine, u64& waits)
+{
+    BenchCore core;
+    BenchCore reference;
+    core.setDispatchEngine(engine);
+    reference.setDispatchEngine(DISPATCH_SWITCH);
+    if (!core.loadFile(rom) || !reference.loadFile(rom))
+        return false;
+
+    for (u32 frame = 0; frame < 3000; frame++)
+    {
+        if (frame % 37 == 36)
+        {
+            core.injectKey(5);
+            reference.injectKey(5);
+        }
+        u32 ran = core.execute(CHIP8_INSTRUCTIONS_PER_FRAME);
+        if (ran != reference.execute(CHIP8_INSTRUCTIONS_PER_FRAME) ||
+            memcmp(&core.getState(), &reference.getState(), sizeof(CHIP8_STATE)) != 0)
+        {
+            std::cout << "    " << rom << " differs after frame " << frame << std::endl;
+            return false;
+        }
+    }
+    waits = core.getKeyWaitStats().waits;
+    return true;
+}
+
+// Returns the nanoseconds a frame of "instructionsPerFrame" takes on the default engine, the machine is left to wait on its own
+static double timeFrames(const u8* program, u32 size, u16 instructionsPerFrame, u32 frames)
+{
+    BenchCore core;
+    core.loadMemory(program, size);
+    core.setInstructionsPerFrame(instructionsPerFrame);
+    u64 start = benchNow();
+    for (u32 f = 0; f < frames; f++)
+        core.execute(instructionsPerFrame);
+    u64 ns = benchNow() - start;
+    benchKeep(core.getState());
+    return (double) ns / frames;
+}
+
+int benchKeyWait(int argc, char* argv[])
+{
+    u32 frames = argc > 0 ? atoi(argv[0]) : 100000;
+    if (frames == 0)
+        frames = 1;
+
+    static const DISPATCH_ENGINE engines[] = {DISPATCH_SWITCH, DISPATCH_TABLE, DISPATCH_GOTO, DISPATCH_CACHE, DISPATCH_JIT, DISPATCH_COMPILED};
+    static const char* const names[] = {"switch", "table", "goto", "cache", "jit", "compiled"};
+    bool ok = true;
+    for (u8 p = 0; p < QUIRK_PROFILE_COUNT; p++)
+    {
+        QUIRK_PROFILE profile = (QUIRK_PROFILE) p;
+        std::stringstream line;
+        line << std::left << std::setw(10) << quirkProfileName(profile) << std::right << " resumes on "
+             << (quirkProfileQuirks(profile) & CHIP8_QUIRK_KEY_RELEASE ? "release" : "press  ") << ", halts on";
+        BenchCore reference;
+        checkKeyWait(reference, DISPATCH_SWITCH, profile);
+        for (u32 e = 0; e < sizeof(engines) / sizeof(engines[0]); e++)
+        {
+            BenchCore core;
+            bool halts = checkKeyWait(core, engines[e], profile);
+            bool same = memcmp(&core.getState(), &reference.getState(), sizeof(CHIP8_STATE)) == 0;
+            line << " " << names[e] << (halts ? "" : " WRONG") << (same ? "" : " DIFFERS");
+            ok = ok && halts && same;
+        }
+        std::cout << line.str() << std::endl;
+    }
+
+    for (const char* rom : benchRoms)
+    {
+        // The line is built up first as ROMs that overflow the stack print while they run
+        std::stringstream line;
+        line << std::left << std::setw(10) << rom << std::right << " tapping a key";
+        u64 waits = 0;
+        for (u32 e = 0; e < sizeof(engines) / sizeof(engines[0]); e++)
+        {
+            bool same = checkRom(rom, engines[e], waits);
+            line << " " << names[e] << (same ? "" : " DIFFERS");
+            ok = ok && same;
+        }
+        std::cout << line.str() << ", halted " << waits << " times" << std::endl;
+    }
+
+    for (u32 lanes : {1, 8, 32})
+    {
+        bool same = checkBatch(lanes);
+        std::cout << "Batch of " << std::setw(2) << lanes << " lanes halts and resumes as cores do" << (same ? "" : " DIFFERS") << std::endl;
+        ok = ok && same;
+    }
+
+    std::cout << std::fixed << std::setprecision(1);
+    for (u16 instructionsPerFrame : {CHIP8_INSTRUCTIONS_PER_FRAME, 1000})
+    {
+        double halted = timeFrames(keyWaitProgram, sizeof(keyWaitProgram), instructionsPerFrame, frames);
+        double polled = timeFrames(keyPollProgram, sizeof(keyPollProgram), instructionsPerFrame, frames);
+        std::cout << "Waiting for a key at " << std::setw(4) << instructionsPerFrame << " instructions a frame: halted "
+                  << std::setw(7) << halted << " ns a frame, polling the keys " << std::setw(8) << polled << " ns a frame, "
+                  << std::setw(6) << halted * CHIP8_FRAMES_PER_SECOND / 1e3 << " us of host CPU an emulated second halted" << std::endl;
+    }
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,116 @@
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <stdlib.h>
+#include <thread>
+#include <time.h>
+#include "Bench.h"
+#include "Scheduler.h"
+
+// Sets the delay timer to 60 and loops forever
+static const u8 pacingTimerProgram[] = {
+    0x60, 0x3C,     // 0x200 LD V0, 60
+    0xF0, 0x15,     // 0x202 LD DT, V0
+    0x12, 0x04      // 0x204 JP 0x204
+};
+
+/* Checks the delay timer on "engine" after runs of every length up to 70 frames, the timer ticks at the end of each
+ * instruction that completes a frame so it is one down for every multiple of "instructionsPerFrame" after the first
+ * instruction */
+static bool checkTimer(DISPATCH_ENGINE engine, u16 instructionsPerFrame)
+{
+    BenchCore core;
+    core.loadMemory(pacingTimerProgram, sizeof(pacingTimerProgram));
+    core.setDispatchEngine(engine);
+    core.setInstructionsPerFrame(instructionsPerFrame);
+    u32 seed = instructionsPerFrame;
+    u64 ran = 0;
+    while (ran < 70ull * instructionsPerFrame)
+    {
+        // Runs of random length so the timer is ticked from the middle of blocks as well as their ends
+        seed = seed * 1103515245 + 12345;
+        ran += core.execute(1 + (seed >> 16) % (3 * instructionsPerFrame));
+        s64 ticks = ran / instructionsPerFrame - 1 / instructionsPerFrame;
+        u8 expected = ticks >= 60 ? 0 : 60 - ticks;
+        if (core.getState().DT != expected)
+            return false;
+    }
+    return true;
+}
+
+/* Runs PONG a frame at a time for "seconds" the way the frontend does. With "scheduler" each frame sleeps until its
+ * deadline, otherwise it is paced the old way with a relative delay of the frame time left, which adds up the time
+ * lost to rounding and oversleeping. Returns the process CPU time used as a fraction of the wall clock time */
+static double runPaced(u32 seconds, Chip8Scheduler* scheduler, s64& driftNs)
+{
+    BenchCore core;
+    core.loadFile(benchRoms[0]);
+    core.setKeyDown(5);
+    u64 frames = (u64) seconds * CHIP8_FRAMES_PER_SECOND;
+    clock_t cpu = clock();
+    u64 start = benchNow();
+    if (scheduler)
+        scheduler->start();
+    for (u64 f = 0; f < frames; f++)
+    {
+        u64 frameStart = benchNow();
+        core.execute(core.getInstructionsPerFrame());
+        if (scheduler)
+            scheduler->wait();
+        else
+        {
+            // The frame time in whole milliseconds less what the frame took, as an SDL_Delay loop paces
+            s64 left = 1000 / CHIP8_FRAMES_PER_SECOND - (s64) (benchNow() - frameStart) / 1000000;
+            if (left > 0)
+                std::this_thread::sleep_for(std::chrono::milliseconds(left));
+        }
+    }
+    u64 wall = benchNow() - start;
+    driftNs = (s64) wall - (s64) (frames * 1000000000ull / CHIP8_FRAMES_PER_SECOND);
+    return (double) (clock() - cpu) / CLOCKS_PER_SEC / (wall / 1e9);
+}
+
+int benchPacing(int argc, char* argv[])
+{
+    u32 seconds = argc > 0 ? atoi(argv[0]) : 10;
+    if (seconds == 0)
+        seconds = 1;
+
+    static const DISPATCH_ENGINE engines[] = {DISPATCH_SWITCH, DISPATCH_TABLE, DISPATCH_GOTO, DISPATCH_CACHE, DISPATCH_JIT, DISPATCH_COMPILED};
+    static const char* const names[] = {"switch", "table", "goto", "cache", "jit", "compiled"};
+    bool ok = true;
+    for (u16 instructionsPerFrame : {1, 2, CHIP8_INSTRUCTIONS_PER_FRAME, 37, 1000})
+    {
+        std::stringstream line;
+        line << "Delay timer ticks once every " << std::setw(4) << instructionsPerFrame << " instructions on";
+        for (u32 e = 0; e < sizeof(engines) / sizeof(engines[0]); e++)
+        {
+            bool same = checkTimer(engines[e], instructionsPerFrame);
+            line << " " << names[e] << (same ? "" : " WRONG");
+            ok = ok && same;
+        }
+        std::cout << line.str() << std::endl;
+    }
+
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "Pacing " << benchRoms[0] << " at " << CHIP8_INSTRUCTIONS_PER_FRAME << " instructions a frame, "
+              << CHIP8_FRAMES_PER_SECOND << " frames a second for " << seconds << " seconds" << std::endl;
+
+    Chip8Scheduler scheduler;
+    scheduler.setPaced(true);
+    s64 driftNs = 0;
+    double cpu = runPaced(seconds, &scheduler, driftNs);
+    SCHEDULER_STATS stats = scheduler.getStats();
+    std::cout << "    sleep until deadline: " << stats.frames << " frames, " << stats.lateFrames << " late, "
+              << stats.resyncs << " resyncs, drift " << driftNs / 1e6 << " ms" << std::endl
+              << "        woke late by " << stats.jitterMeanNs / 1e3 << " us on average, "
+              << stats.jitterP99Ns / 1e3 << " us at the 99th percentile, " << stats.jitterMaxNs / 1e3 << " us at the latest" << std::endl
+              << "        " << 100.0 * stats.idle << "% of the time asleep, process CPU "
+              << 100.0 * cpu << "% of one core" << std::endl;
+
+    cpu = runPaced(seconds, nullptr, driftNs);
+    std::cout << "    relative delay:       drift " << driftNs / 1e6 << " ms, " << driftNs / 1e3 / (seconds * CHIP8_FRAMES_PER_SECOND)
+              << " us a frame, process CPU " << 100.0 * cpu << "% of one core" << std::endl;
+
+    return ok ? 0 : 1;
+}
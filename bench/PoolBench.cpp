@@ -0,0 +1,177 @@
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "Bench.h"
+#include "Pool.h"
+
+// The keys each branch of the search holds, the keys the shipped ROMs play with
+static const u8 branchKeys[] = {0x1, 0x4, 0xC, 0xD, 0x5, 0x6, 0x2, 0x8};
+
+/* Branches a ROM two levels deep through the pool and checks every branch against a core that ran the same branch from a
+ * savestate, then that the branches writing to memory left the machines they were forked from alone */
+static bool checkBranches(const char* rom, bool copyOnWrite)
+{
+    BenchCore core;
+    if (!core.loadFile(rom))
+        return false;
+    core.setDispatchEngine(DISPATCH_SWITCH);
+    core.setKeyDown(5);
+    core.execute(20000);
+
+    Chip8Pool pool(64, 1024, copyOnWrite);
+    u32 root = pool.fork(core);
+    static CHIP8_STATE rootState;
+    rootState = core.getState();
+
+    static SAVESTATE savestate;
+    BenchCore reference;
+    reference.setDispatchEngine(DISPATCH_SWITCH);
+    static CHIP8_STATE state;
+    bool ok = root != CHIP8_POOL_NONE;
+    for (u32 b = 0; ok && b < sizeof(branchKeys); b++)
+    {
+        u32 child = pool.fork(root);
+        pool.load(child, core);
+        core.setKeyDown(branchKeys[b]);
+        core.execute(3000);
+        ok = child != CHIP8_POOL_NONE && pool.store(core, child);
+
+        // The grandchild is forked straight from the core sharing what it can with its parent
+        core.setKeyUp(branchKeys[b]);
+        core.execute(3000);
+        u32 grandchild = pool.fork(core, child);
+        ok = ok && grandchild != CHIP8_POOL_NONE;
+
+        core.saveState(savestate);
+        reference.loadState(savestate);
+        pool.getState(grandchild, state);
+        ok = ok && memcmp(&state, &reference.getState(), sizeof(CHIP8_STATE)) == 0;
+
+        pool.load(root, reference);
+        reference.setKeyDown(branchKeys[b]);
+        reference.execute(3000);
+        pool.getState(child, state);
+        ok = ok && memcmp(&state, &reference.getState(), sizeof(CHIP8_STATE)) == 0;
+        pool.release(child);
+    }
+
+    pool.getState(root, state);
+    return ok && memcmp(&state, &rootState, sizeof(CHIP8_STATE)) == 0;
+}
+
+/* Fills the pool with "live" forks of a running machine then frees them all, returns the nanoseconds a fork and
+ * "liveBytes" the bytes the live slots and pages took at the peak */
+static double timeForks(Chip8Pool& pool, BenchCore& core, u32 live, u64& liveBytes, bool& ok)
+{
+    std::vector<u32> slots(live);
+    u32 root = pool.fork(core);
+    u64 start = benchNow();
+    for (u32 f = 0; f < live; f++)
+        slots[f] = pool.fork(root);
+    u64 ns = benchNow() - start;
+
+    POOL_STATS stats = pool.getStats();
+    liveBytes = stats.liveBytes;
+    ok = ok && stats.liveSlots == live + 1;
+    for (u32 f = 0; f < live; f++)
+    {
+        ok = ok && slots[f] != CHIP8_POOL_NONE;
+        pool.release(slots[f]);
+    }
+    pool.release(root);
+    ok = ok && pool.getStats().liveSlots == 0 && pool.getStats().livePages == 0;
+    return (double) ns / live;
+}
+
+int benchPool(int argc, char* argv[])
+{
+    u32 live = argc > 0 ? atoi(argv[0]) : 1000000;
+    if (live == 0)
+        live = 1;
+    // Full copies take a whole 4KB of pages a fork so they are measured with fewer live
+    u32 copyLive = live / 10 ? live / 10 : 1;
+
+    bool ok = true;
+    for (const char* rom : benchRoms)
+    {
+        // The line is built up first as ROMs that overflow the stack print while they run
+        std::stringstream line;
+        bool shared = checkBranches(rom, true);
+        bool copied = checkBranches(rom, false);
+        ok = ok && shared && copied;
+        line << std::left << std::setw(10) << rom << std::right << " branches  copy on write" << (shared ? " ok" : " DIFFER")
+             << "  full copies" << (copied ? " ok" : " DIFFER");
+        std::cout << line.str() << std::endl;
+    }
+
+    BenchCore core;
+    core.loadFile(benchRoms[0]);
+    core.setDispatchEngine(DISPATCH_SWITCH);
+    core.execute(20000);
+
+    // What duplicating a machine costs without the pool, building a core and loading a savestate into it
+    static SAVESTATE savestate;
+    core.saveState(savestate);
+    const u32 builds = 100000;
+    u64 start = benchNow();
+    for (u32 b = 0; b < builds; b++)
+    {
+        BenchCore copy;
+        copy.loadState(savestate);
+        benchKeep(copy.getState());
+    }
+    double buildNs = (double)(benchNow() - start) / builds;
+
+    u64 sharedBytes = 0;
+    u64 copiedBytes = 0;
+    double sharedNs = 0;
+    double copiedNs = 0;
+    {
+        Chip8Pool pool(live + 1, 4096, true);
+        sharedNs = timeForks(pool, core, live, sharedBytes, ok);
+        // The slots and pages come back so filling the pool again recycles them
+        double recycledNs = timeForks(pool, core, live, sharedBytes, ok);
+        sharedNs = recycledNs < sharedNs ? recycledNs : sharedNs;
+    }
+    {
+        Chip8Pool pool(copyLive + 1, (copyLive + 1) * CHIP8_POOL_PAGES, false);
+        copiedNs = timeForks(pool, core, copyLive, copiedBytes, ok);
+    }
+
+    // A search step, fork a node then run a branch from it and store it back which copies the pages it wrote
+    u64 stepNs = 0;
+    u64 pageCopies = 0;
+    u32 steps = live / 10 ? live / 10 : 1;
+    {
+        Chip8Pool pool(steps + 1, steps * 4 + CHIP8_POOL_PAGES, true);
+        BenchCore branch;
+        branch.setDispatchEngine(DISPATCH_SWITCH);
+        u32 root = pool.fork(core);
+        start = benchNow();
+        for (u32 s = 0; s < steps; s++)
+        {
+            u32 node = pool.fork(s ? 1 + rand() % s : root);
+            pool.load(node, branch);
+            branch.setKeyDown(branchKeys[s % sizeof(branchKeys)]);
+            branch.execute(100);
+            ok = pool.store(branch, node) && ok;
+        }
+        stepNs = (benchNow() - start) / steps;
+        pageCopies = pool.getStats().pageCopies;
+    }
+
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "sizeof(CHIP8_FORK) = " << sizeof(CHIP8_FORK) << " bytes, pages of " << CHIP8_POOL_PAGE_SIZE << " bytes" << std::endl;
+    std::cout << "New core and loadState " << std::setw(8) << buildNs << " ns per copy" << std::endl;
+    std::cout << "Fork, copy on write    " << std::setw(8) << sharedNs << " ns per fork, " << 1e3 / sharedNs << " M forks/sec, "
+              << (double) sharedBytes / (live + 1) << " bytes per live clone at " << live << " live" << std::endl;
+    std::cout << "Fork, full copies      " << std::setw(8) << copiedNs << " ns per fork, " << 1e3 / copiedNs << " M forks/sec, "
+              << (double) copiedBytes / (copyLive + 1) << " bytes per live clone at " << copyLive << " live" << std::endl;
+    std::cout << "Search step            " << std::setw(8) << (double) stepNs << " ns for fork, load, 100 instructions and store, "
+              << (double) pageCopies / steps << " pages copied per store" << std::endl;
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,236 @@
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <stdlib.h>
+#include <string>
+#include "Bench.h"
+#include "Handlers.h"
+#include "Profiler.h"
+
+// The file the benchmark writes a callgrind profile to, it is removed afterwards
+#define PROFILE_BENCH_FILE "profile_bench.out"
+
+/* A loop that calls a function which calls another twice, ten instructions a pass. The call from 0x202 takes the seven
+ * instructions of 0x210 and what it calls, each call from 0x210 and 0x212 the two of 0x220 */
+static const u8 profileCallProgram[] = {
+    0x60, 0x00,     // 0x200 LD V0, 0x00
+    0x22, 0x10,     // 0x202 CALL 0x210
+    0x70, 0x01,     // 0x204 ADD V0, 0x01
+    0x12, 0x02,     // 0x206 JP 0x202
+    0x00, 0x00,     // 0x208
+    0x00, 0x00,     // 0x20A
+    0x00, 0x00,     // 0x20C
+    0x00, 0x00,     // 0x20E
+    0x22, 0x20,     // 0x210 CALL 0x220
+    0x22, 0x20,     // 0x212 CALL 0x220
+    0x00, 0xEE,     // 0x214 RET
+    0x00, 0x00,     // 0x216
+    0x00, 0x00,     // 0x218
+    0x00, 0x00,     // 0x21A
+    0x00, 0x00,     // 0x21C
+    0x00, 0x00,     // 0x21E
+    0x71, 0x01,     // 0x220 ADD V1, 0x01
+    0x00, 0xEE      // 0x222 RET
+};
+
+/* Profiles "frames" frames of "rom" on the default engine with idle skipping asked for and steps a second core an
+ * instruction at a time beside it, every address and class must have been counted exactly as often as it ran */
+static bool checkCounts(const char* rom, u32 frames, u64& instructions)
+{
+    BenchCore core;
+    BenchCore reference;
+    core.loadFile(rom);
+    reference.loadFile(rom);
+    core.setKeyDown(5);
+    reference.setKeyDown(5);
+    core.setIdleSkipping(true);
+    Chip8Profiler profiler;
+    profiler.reset(core.getState());
+    core.setProfiler(&profiler);
+
+    std::vector<u64> executions(CHIP8_MEMORY_SIZE, 0);
+    std::vector<u64> classes(OPCODE_CLASS_COUNT, 0);
+    for (u32 f = 0; f < frames; f++)
+    {
+        core.execute(CHIP8_INSTRUCTIONS_PER_FRAME);
+        for (u32 i = 0; i < CHIP8_INSTRUCTIONS_PER_FRAME; i++)
+        {
+            // A machine halted on "Fx0A" executes nothing while it waits
+            CHIP8_STATE& state = reference.getState();
+            if (!state.keyWait)
+            {
+                u16 pc = state.PC & (CHIP8_MEMORY_SIZE - 1);
+                executions[pc]++;
+                classes[decodeOpcode(Handlers::fetch(state)).cls]++;
+            }
+            reference.execute(1);
+        }
+    }
+    core.setProfiler(NULL);
+
+    instructions = profiler.getInstructions();
+    u64 total = 0;
+    u64 classTotal = 0;
+    bool ok = memcmp(&core.getState(), &reference.getState(), sizeof(CHIP8_STATE)) == 0;
+    for (u32 a = 0; a < CHIP8_MEMORY_SIZE; a++)
+    {
+        total += profiler.getExecutions()[a];
+        if (profiler.getExecutions()[a] != executions[a])
+        {
+            std::cout << "    " << std::hex << a << std::dec << " counted " << profiler.getExecutions()[a] << " times, ran "
+                      << executions[a] << std::endl;
+            ok = false;
+        }
+    }
+    for (u8 c = 0; c < OPCODE_CLASS_COUNT; c++)
+    {
+        classTotal += profiler.getClassCounts()[c];
+        ok = ok && profiler.getClassCounts()[c] == classes[c];
+    }
+    return ok && total == instructions && classTotal == instructions && instructions > 0;
+}
+
+// True if the calls made from "site" went to "callee" "calls" times and took "inclusive" instructions
+static bool checkCall(Chip8Profiler& profiler, u16 site, u16 callee, u64 calls, u64 inclusive)
+{
+    const PROFILE_CALL& call = profiler.getCall(site);
+    if (call.calls == calls && call.callee == callee && call.inclusive == inclusive)
+        return true;
+    std::cout << "    the call from " << std::hex << site << " went to " << call.callee << std::dec << " " << call.calls
+              << " times for " << call.inclusive << " instructions, expected " << calls << " for " << inclusive << std::endl;
+    return false;
+}
+
+/* Runs the call program for "passes" passes, then starts again part way through a call to check the calls already on
+ * the stack are picked up, and writes and reads back a callgrind profile */
+static bool checkCalls(u32 passes)
+{
+    BenchCore core;
+    core.loadMemory(profileCallProgram, sizeof(profileCallProgram));
+    Chip8Profiler profiler;
+    profiler.reset(core.getState());
+    core.setProfiler(&profiler);
+    core.execute(1 + 10 * passes);
+
+    bool ok = profiler.getInstructions() == 1 + 10 * passes && profiler.getExecutions()[0x202] == passes &&
+              profiler.getClassCounts()[OPCODE_CALL] == 3 * passes && profiler.getClassCounts()[OPCODE_RET] == 3 * passes;
+    ok = checkCall(profiler, 0x202, 0x210, passes, 7 * passes) && ok;
+    ok = checkCall(profiler, 0x210, 0x220, passes, 2 * passes) && ok;
+    ok = checkCall(profiler, 0x212, 0x220, passes, 2 * passes) && ok;
+    ok = ok && profiler.getFunction(0x204) == 0x200 && profiler.getFunction(0x214) == 0x210 &&
+         profiler.getFunction(0x222) == 0x220;
+
+    // Three instructions into a pass the machine is at 0x220 inside both calls, the profile starts again from there
+    core.execute(3);
+    profiler.reset(core.getState());
+    core.execute(10 * passes);
+    ok = ok && profiler.getFunction(0x222) == 0x220 && profiler.getFunction(0x214) == 0x210 &&
+         profiler.getFunction(0x204) == 0x200;
+    /* The first pass finishes calls made before the reset, they cost what ran of them since but were never counted as
+     * made, and the last pass leaves calls from 0x202 and 0x210 running */
+    ok = checkCall(profiler, 0x202, 0x210, passes, 7 * passes - 2) && ok;
+    ok = checkCall(profiler, 0x210, 0x220, passes, 2 * passes - 1) && ok;
+    ok = checkCall(profiler, 0x212, 0x220, passes, 2 * passes) && ok;
+
+    /* Every instruction counted has to show up once as a self cost in the callgrind file, and the call from 0x202 made
+     * just before the profile ended is still running so its cost so far is added to the finished ones */
+    ok = ok && profiler.writeCallgrind(PROFILE_BENCH_FILE, "calls");
+    std::ifstream file(PROFILE_BENCH_FILE);
+    std::string line;
+    u64 summary = 0;
+    u64 self = 0;
+    bool cost = false;
+    std::string call;
+    while (std::getline(file, line))
+    {
+        if (line.compare(0, 9, "summary: ") == 0)
+            summary = strtoull(line.c_str() + 9, NULL, 10);
+        else if (line.compare(0, 6, "calls=") == 0)
+            call = line;
+        else if (line.compare(0, 2, "0x") == 0 && !call.empty())
+        {
+            // The line after a call is its inclusive cost rather than a self cost
+            cost = cost || (call == "calls=" + std::to_string(passes) + " 0x210" && line == "0x202 " + std::to_string(7 * passes));
+            call.clear();
+        }
+        else if (line.compare(0, 2, "0x") == 0)
+            self += strtoull(line.c_str() + line.find(' '), NULL, 10);
+    }
+    file.close();
+    remove(PROFILE_BENCH_FILE);
+    return ok && summary == 10 * passes && self == summary && cost;
+}
+
+// Returns the nanoseconds an instruction of "rom" takes on "engine", profiled or not
+static double timeRun(const char* rom, DISPATCH_ENGINE engine, bool profile, u32 instructions)
+{
+    BenchCore core;
+    core.loadFile(rom);
+    core.setDispatchEngine(engine);
+    core.setKeyDown(5);
+    Chip8Profiler profiler;
+    if (profile)
+    {
+        profiler.reset(core.getState());
+        core.setProfiler(&profiler);
+    }
+
+    u64 start = benchNow();
+    u32 done = 0;
+    while (done < instructions)
+    {
+        u32 ran = core.execute(CHIP8_INSTRUCTIONS_PER_FRAME * 60);
+        if (ran == 0)
+            break;
+        done += ran;
+    }
+    double ns = (double) (benchNow() - start) / (done ? done : 1);
+    benchKeep(core.getState());
+    benchKeep(profiler);
+    core.setProfiler(NULL);
+    return ns;
+}
+
+int benchProfile(int argc, char* argv[])
+{
+    u32 instructions = argc > 0 ? atoi(argv[0]) : 5000000;
+    if (instructions < 100000)
+        instructions = 100000;
+    bool ok = true;
+
+    for (const char* rom : benchRoms)
+    {
+        u64 counted = 0;
+        bool right = checkCounts(rom, 6000, counted);
+        ok = ok && right;
+        std::cout << "  " << std::setw(8) << rom << ": " << counted << " instructions counted by address and class against a stepped core"
+                  << (right ? "" : " WRONG") << std::endl;
+    }
+
+    bool calls = checkCalls(1000);
+    ok = ok && calls;
+    std::cout << "Nested calls: counts and inclusive costs exact, across a reset inside a call and in the callgrind file"
+              << (calls ? "" : " WRONG") << std::endl;
+
+    /* Profiling dispatches as the switch engine does and the goto engine is the default, the runs are taken in turn and
+     * the best of three kept as the host is noisy */
+    std::cout << std::fixed << std::setprecision(2);
+    for (const char* rom : benchRoms)
+    {
+        double profiled = 1e9;
+        double bare = 1e9;
+        double fastest = 1e9;
+        for (u32 r = 0; r < 3; r++)
+        {
+            profiled = std::min(profiled, timeRun(rom, DISPATCH_SWITCH, true, instructions));
+            bare = std::min(bare, timeRun(rom, DISPATCH_SWITCH, false, instructions));
+            fastest = std::min(fastest, timeRun(rom, DISPATCH_GOTO, false, instructions));
+        }
+        std::cout << "  " << std::setw(8) << rom << ": " << std::setw(6) << profiled << " ns an instruction profiled, "
+                  << std::setw(6) << bare << " on switch, " << profiled / bare << "x, " << std::setw(6) << fastest
+                  << " on goto, " << profiled / fastest << "x" << std::endl;
+    }
+
+    return ok ? 0 : 1;
+}
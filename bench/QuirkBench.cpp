@@ -0,0 +1,269 @@
+#include <iostream>
+#include <functional>
+#include <iomanip>
+#include <sstream>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "Bench.h"
+#include "Handlers.h"
+
+/* A program that runs into every quirk once then loops on the spot
+ *   "8716" shifts "V1" into "V7" only under CHIP8_QUIRK_SHIFT_VY, otherwise it shifts the empty "V7"
+ *   "D035" draws a "0" at x 62 which wraps onto the left edge unless CHIP8_QUIRK_CLIP_SPRITES
+ *   "B220" lands on 0x222 with "V0" or on 0x224 with "V2" under CHIP8_QUIRK_JUMP_VX, "V8" counts what ran
+ *   "F155" leaves "I" at 0x300 or 0x302 under CHIP8_QUIRK_LOAD_STORE_I */
+static const u8 quirkProgram[] = {
+    0x61, 0x03,     // 0x200 LD V1, 3
+    0x87, 0x16,     // 0x202 SHR V7, V1
+    0x60, 0x3E,     // 0x204 LD V0, 62
+    0x63, 0x00,     // 0x206 LD V3, 0
+    0xA0, 0x00,     // 0x208 LD I, 0
+    0xD0, 0x35,     // 0x20A DRW V0, V3, 5
+    0x60, 0x02,     // 0x20C LD V0, 2
+    0x62, 0x04,     // 0x20E LD V2, 4
+    0xB2, 0x20,     // 0x210 JP V0, 0x220
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00,     // 0x220
+    0x78, 0x01,     // 0x222 ADD V8, 1
+    0x78, 0x02,     // 0x224 ADD V8, 2
+    0xA3, 0x00,     // 0x226 LD I, 0x300
+    0xF1, 0x55,     // 0x228 LD [I], V1
+    0x12, 0x2A      // 0x22A JP 0x22A
+};
+
+// Checks the quirk program left the state each quirk of "quirks" should
+static bool checkQuirkProgram(const CHIP8_STATE& s, u32 quirks)
+{
+    bool shifted = s.V[7] == ((quirks & CHIP8_QUIRK_SHIFT_VY) ? 1 : 0);
+    bool clipped = ((s.pixels[0] >> 63) & 1) == ((quirks & CHIP8_QUIRK_CLIP_SPRITES) ? 0 : 1);
+    bool jumped = s.V[8] == ((quirks & CHIP8_QUIRK_JUMP_VX) ? 2 : 3);
+    bool stored = s.I == ((quirks & CHIP8_QUIRK_LOAD_STORE_I) ? 0x302 : 0x300);
+    return shifted && clipped && jumped && stored && s.PC == 0x22A;
+}
+
+// Runs one of the opcodes a quirk touches testing the quirk flags at run time
+static void executeQuirk(Chip8Core& core, const INSTRUCTION& ins, u32 quirks)
+{
+    CHIP8_STATE& s = core.getState();
+    switch(ins.cls)
+    {
+        case OPCODE_SHR:
+            if (quirks & CHIP8_QUIRK_SHIFT_VY)
+                QuirkHandlers<CHIP8_QUIRK_SHIFT_VY>::SHR(core, ins);
+            else
+                Handlers::SHR(core, ins);
+        break;
+        case OPCODE_SHL:
+            if (quirks & CHIP8_QUIRK_SHIFT_VY)
+                QuirkHandlers<CHIP8_QUIRK_SHIFT_VY>::SHL(core, ins);
+            else
+                Handlers::SHL(core, ins);
+        break;
+        case OPCODE_JP_V0:
+            if (quirks & CHIP8_QUIRK_JUMP_VX)
+                QuirkHandlers<CHIP8_QUIRK_JUMP_VX>::JP_V0(core, ins);
+            else
+                Handlers::JP_V0(core, ins);
+        break;
+        case OPCODE_DRW:
+            if (quirks & CHIP8_QUIRK_CLIP_SPRITES)
+                QuirkHandlers<CHIP8_QUIRK_CLIP_SPRITES>::DRW(core, ins);
+            else
+                Handlers::DRW(core, ins);
+        break;
+        case OPCODE_LD_VX_K:
+            if (quirks & CHIP8_QUIRK_KEY_RELEASE)
+                QuirkHandlers<CHIP8_QUIRK_KEY_RELEASE>::LD_VX_K(core, ins);
+            else
+                Handlers::LD_VX_K(core, ins);
+        break;
+        case OPCODE_LD_I_VX:
+            Handlers::LD_I_VX(core, ins);
+            if (quirks & CHIP8_QUIRK_LOAD_STORE_I)
+                s.I += ins.x + 1;
+        break;
+        case OPCODE_LD_VX_I:
+            Handlers::LD_VX_I(core, ins);
+            if (quirks & CHIP8_QUIRK_LOAD_STORE_I)
+                s.I += ins.x + 1;
+        break;
+    }
+}
+
+/* A core that can also run the loops the quirk profiles are measured against. They stop on the same test the core's
+ * own engines make and are driven the same way, so the only difference left is the loop */
+class QuirkBenchCore : public BenchCore
+{
+    public:
+        // Today's hard wired loop, the switch engine as it was before quirk profiles with the plain handlers called directly
+        u32 executeFixed(u32 count)
+        {
+            CHIP8_STATE& s = getState();
+            u32 done = 0;
+            while (done < count && !quit && !s.keyWait)
+            {
+                INSTRUCTION ins = decodeOpcode(Handlers::fetch(s));
+                s.PC += 2;
+                switch(ins.cls)
+                {
+                    #define CHIP8_FIXED_CASE(name, text) case OPCODE_##name: Handlers::name(*this, ins); break;
+                    CHIP8_OPCODE_CLASSES(CHIP8_FIXED_CASE)
+                    #undef CHIP8_FIXED_CASE
+                    default: Handlers::BAD(*this, ins); break;
+                }
+                Handlers::tickTimers(*this);
+                done++;
+            }
+            return done;
+        }
+
+        // The same loop testing runtime quirk flags on every instruction a quirk touches, what the profiles avoid
+        u32 executeFlags(u32 count, u32 quirks)
+        {
+            CHIP8_STATE& s = getState();
+            u32 done = 0;
+            while (done < count && !quit && !s.keyWait)
+            {
+                INSTRUCTION ins = decodeOpcode(Handlers::fetch(s));
+                s.PC += 2;
+                switch(ins.cls)
+                {
+                    #define CHIP8_FLAGS_CASE(name, text) case OPCODE_##name: \
+                        if (quirksAffect(OPCODE_##name, ~0u)) executeQuirk(*this, ins, quirks); else Handlers::name(*this, ins); break;
+                    CHIP8_OPCODE_CLASSES(CHIP8_FLAGS_CASE)
+                    #undef CHIP8_FLAGS_CASE
+                    default: Handlers::BAD(*this, ins); break;
+                }
+                Handlers::tickTimers(*this);
+                done++;
+            }
+            return done;
+        }
+};
+
+// Runs up to "count" instructions of a loop being timed
+typedef std::function<u32(QuirkBenchCore& core, u32 count)> QUIRK_RUN;
+
+/* Runs "run" a second of emulated time at a time as the frontend would call the core. Key 5 is held down through the
+ * runs so a profile that resumes "Fx0A" on release would stay halted, the key is let go and pressed again whenever the
+ * machine waits. Returns the instructions executed leaving out the time spent waiting */
+static u32 executeRun(QuirkBenchCore& core, const QUIRK_RUN& run, u32 instructions)
+{
+    u32 second = core.getInstructionsPerFrame() * CHIP8_FRAMES_PER_SECOND;
+    u32 done = 0;
+    while (done < instructions && !core.hasQuit())
+    {
+        if (core.isWaitingForKey())
+        {
+            core.setKeyUp(5);
+            core.setKeyDown(5);
+        }
+        done += run(core, instructions - done < second ? instructions - done : second);
+    }
+    return done - core.getKeyWaitStats().instructions;
+}
+
+/* Times each run from reset a few times taking turns so they all see the same machine noise, returns the best
+ * M instructions a second of each. "profiles" gives the quirk profile each run's core is set to */
+static std::vector<double> timeRuns(const char* rom, const std::vector<QUIRK_RUN>& runs,
+                                    const std::vector<QUIRK_PROFILE>& profiles, u32 instructions)
+{
+    std::vector<double> best(runs.size(), 0);
+    for (u32 round = 0; round < 5; round++)
+    {
+        for (size_t r = 0; r < runs.size(); r++)
+        {
+            QuirkBenchCore core;
+            core.setQuirkProfile(profiles[r]);
+            core.setDispatchEngine(DISPATCH_SWITCH);
+            core.loadFile(rom);
+            core.setKeyDown(5);
+            u64 start = benchNow();
+            u32 executed = executeRun(core, runs[r], instructions);
+            u64 ns = benchNow() - start;
+            double rate = executed / (ns / 1e9) / 1e6;
+            best[r] = rate > best[r] ? rate : best[r];
+        }
+    }
+    return best;
+}
+
+int benchQuirks(int argc, char* argv[])
+{
+    u32 instructions = argc > 0 ? atoi(argv[0]) : 10000000;
+    static const DISPATCH_ENGINE engines[] = {DISPATCH_SWITCH, DISPATCH_TABLE, DISPATCH_GOTO, DISPATCH_CACHE, DISPATCH_JIT, DISPATCH_COMPILED};
+    static const char* const engineNames[] = {"switch", "table", "goto", "cache", "jit", "compiled"};
+    const u32 totalEngines = sizeof(engines) / sizeof(engines[0]);
+
+    // Every engine has to show each profile's quirks and agree with the switch engine under that profile
+    bool ok = true;
+    for (u8 p = 0; p < QUIRK_PROFILE_COUNT; p++)
+    {
+        // Lines are built up first as ROMs that overflow the stack print while they run
+        QUIRK_PROFILE profile = (QUIRK_PROFILE) p;
+        std::stringstream line;
+        line << std::left << std::setw(10) << quirkProfileName(profile) << std::right;
+        for (u32 e = 0; e < totalEngines; e++)
+        {
+            BenchCore core;
+            core.setQuirkProfile(profile);
+            core.setDispatchEngine(engines[e]);
+            core.loadMemory(quirkProgram, sizeof(quirkProgram));
+            core.execute(40);
+            bool quirky = checkQuirkProgram(core.getState(), quirkProfileQuirks(profile));
+
+            bool same = true;
+            for (const char* rom : benchRoms)
+            {
+                BenchCore tested;
+                BenchCore reference;
+                u32 chunks = 0;
+                tested.setQuirkProfile(profile);
+                reference.setQuirkProfile(profile);
+                if (!tested.loadFile(rom) || !reference.loadFile(rom))
+                {
+                    std::cout << "Failed to load " << rom << std::endl;
+                    return 1;
+                }
+                same = same && benchLockstep(tested, engines[e], reference, 200000, chunks);
+            }
+
+            ok = ok && quirky && same;
+            line << "  " << engineNames[e] << (quirky ? " ok" : " WRONG QUIRKS") << (same ? "" : " DIFFERS");
+        }
+        std::cout << line.str() << std::endl;
+    }
+
+    /* Every profile on the switch engine against the loop it replaced and a loop that tests flags at run time, all
+     * called through the same driver. The default profile compiles down to the plain handlers so it should match the
+     * fixed loop */
+    for (const char* rom : benchRoms)
+    {
+        std::vector<QUIRK_RUN> runs;
+        std::vector<QUIRK_PROFILE> profiles;
+        runs.push_back([](QuirkBenchCore& core, u32 count) { return core.executeFixed(count); });
+        runs.push_back([](QuirkBenchCore& core, u32 count) { return core.executeFlags(count, 0); });
+        profiles.push_back(QUIRK_PROFILE_DEFAULT);
+        profiles.push_back(QUIRK_PROFILE_DEFAULT);
+        for (u8 p = 0; p < QUIRK_PROFILE_COUNT; p++)
+        {
+            runs.push_back([](QuirkBenchCore& core, u32 count) { return core.execute(count); });
+            profiles.push_back((QUIRK_PROFILE) p);
+        }
+        std::vector<double> rates = timeRuns(rom, runs, profiles, instructions);
+
+        double fixed = rates[0];
+        std::cout << std::left << std::setw(10) << rom << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(8) << fixed << " M/s fixed" << std::setw(8) << rates[1] << " M/s runtime flags (x"
+                  << std::setprecision(3) << rates[1] / fixed << ")";
+        for (u8 p = 0; p < QUIRK_PROFILE_COUNT; p++)
+        {
+            std::cout << std::setprecision(1) << std::setw(8) << rates[2 + p] << " M/s " << quirkProfileName((QUIRK_PROFILE) p)
+                      << " (x" << std::setprecision(3) << rates[2 + p] / fixed << ")";
+        }
+        std::cout << std::endl;
+    }
+
+    return ok ? 0 : 1;
+}
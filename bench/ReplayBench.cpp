@@ -0,0 +1,123 @@
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+#include "Bench.h"
+#include "Replay.h"
+#include "Rewind.h"
+
+// The file recordings are saved to and played back from, it is removed afterwards
+#define REPLAY_BENCH_FILE "replay_bench.c8r"
+
+// The keys the shipped ROMs play with
+static const u8 replayKeys[] = {0x1, 0x4, 0xC, 0xD, 0x5, 0x6, 0x2, 0x8};
+
+/* Records a session of "instructions" on a ROM with keys going down and up after runs of random length, the way input
+ * turns up from the frontend between instructions. With "rewinding" the session is rewound ten chunks back after
+ * its twentieth and carries on with different keys, which a replay has to follow */
+static bool recordSession(const char* rom, u32 seed, u64 instructions, bool rewinding, Chip8Replay& replay)
+{
+    BenchCore core;
+    if (!core.loadFile(rom))
+        return false;
+    core.setDispatchEngine(DISPATCH_SWITCH);
+    core.setSeed(seed);
+    replay.record(core);
+
+    Chip8Rewind history(1024 * 1024, CHIP8_FRAMES_PER_SECOND * 60);
+    u32 input = seed;
+    u32 chunks = 0;
+    while (core.getInstructions() < instructions)
+    {
+        input = input * 1103515245 + 12345;
+        u32 ran = core.execute(1 + (input >> 16) % 2000);
+        history.record(core);
+        if (!ran)
+            break;
+
+        input = input * 1103515245 + 12345;
+        u8 key = replayKeys[(input >> 16) % sizeof(replayKeys)];
+        replay.setKey(core, key, !core.keyDown(key));
+
+        if (rewinding && ++chunks == 20)
+        {
+            history.rewind(core, 10);
+            replay.truncate(core);
+            input ^= 0x5a5a5a5a;
+        }
+    }
+
+    replay.finish(core);
+    return true;
+}
+
+// Plays a replay file back on every engine, returns false if any of them did not end on the recorded machine
+static bool playFile(const char* fname, double& nsPerInstruction, std::string& engines)
+{
+    static const DISPATCH_ENGINE allEngines[] = {DISPATCH_SWITCH, DISPATCH_TABLE, DISPATCH_GOTO, DISPATCH_CACHE, DISPATCH_JIT, DISPATCH_COMPILED};
+    static const char* const names[] = {"switch", "table", "goto", "cache", "jit", "compiled"};
+
+    Chip8Replay replay;
+    if (!replay.load(fname))
+        return false;
+
+    bool ok = true;
+    for (u32 e = 0; e < sizeof(allEngines) / sizeof(allEngines[0]); e++)
+    {
+        BenchCore core;
+        core.setDispatchEngine(allEngines[e]);
+        u64 start = benchNow();
+        bool same = replay.play(core);
+        u64 ns = benchNow() - start;
+        if (allEngines[e] == DISPATCH_SWITCH)
+            nsPerInstruction = (double) ns / (replay.getInstructions() ? replay.getInstructions() : 1);
+        engines += std::string(" ") + names[e] + (same ? "" : " DIFFER");
+        ok = ok && same;
+    }
+    return ok;
+}
+
+int benchReplay(int argc, char* argv[])
+{
+    std::cout << std::fixed << std::setprecision(1);
+
+    // Given a file it is only played back, as a frontend recording would be to reproduce a bug
+    if (argc > 0)
+    {
+        double ns = 0;
+        std::string engines;
+        bool ok = playFile(argv[0], ns, engines);
+        std::cout << argv[0] << (ok ? " replayed exactly on" : " did not replay on") << engines << ", "
+                  << 1e3 / ns << " M instructions/sec on the switch engine" << std::endl;
+        return ok ? 0 : 1;
+    }
+
+    const u64 instructions = 5000000;
+    bool ok = true;
+    for (u32 r = 0; r < sizeof(benchRoms) / sizeof(benchRoms[0]); r++)
+    {
+        for (u32 rewinding = 0; rewinding < 2; rewinding++)
+        {
+            Chip8Replay replay;
+            bool saved = recordSession(benchRoms[r], 1234 + r, instructions, rewinding, replay) && replay.save(REPLAY_BENCH_FILE);
+            double ns = 0;
+            std::string engines;
+            bool same = saved && playFile(REPLAY_BENCH_FILE, ns, engines);
+            remove(REPLAY_BENCH_FILE);
+            ok = ok && same;
+
+            // The line is built up first as ROMs that overflow the stack print while they run
+            u64 eventBytes = replay.getFileSize() - sizeof(REPLAY_FILE_HEADER) - sizeof(SAVESTATE);
+            std::stringstream line;
+            line << std::fixed << std::setprecision(1) << std::left << std::setw(10) << benchRoms[r] << std::right << (rewinding ? " rewound " : "         ")
+                 << std::setw(8) << replay.getInstructions() << " instructions, " << std::setw(5) << replay.getEvents().size() << " key events in "
+                 << std::setw(5) << eventBytes << " bytes, " << replay.getFileSize() << " byte file, "
+                 << std::setw(6) << 1e3 / ns << " M instructions/sec replayed," << (same ? engines : " DIFFER" + engines);
+            std::cout << line.str() << std::endl;
+        }
+    }
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,136 @@
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "Bench.h"
+#include "Rewind.h"
+
+struct REWIND_RUN
+{
+    // Mean time running a frame took and recording it took, then the 99th percentile and slowest record
+    double frameNs;
+    double recordNs;
+    u64 recordP99Ns;
+    u64 slowestRecordNs;
+    REWIND_STATS stats;
+    bool ok;
+};
+
+// Changes the key held every second so the recording has input in it
+static void pressKeys(BenchCore& core, u32 frame)
+{
+    static const u8 keys[] = {0x1, 0x4, 0xC, 0xD, 0x5};
+    if (frame % CHIP8_FRAMES_PER_SECOND == 0)
+    {
+        for (u8 key : keys)
+            core.setKeyUp(key);
+        core.setKeyDown(keys[(frame / CHIP8_FRAMES_PER_SECOND) % sizeof(keys)]);
+    }
+}
+
+/* Records "frames" frames of a ROM keeping the checksum of every frame, then rewinds a frame at a time back to the
+ * oldest frame held, seeks about and steps forward checking each frame comes back exactly as it was recorded */
+static REWIND_RUN runRewind(const char* rom, u32 frames, u32 bytes)
+{
+    REWIND_RUN run;
+    memset(&run, 0, sizeof(run));
+    BenchCore core;
+    if (!core.loadFile(rom))
+        return run;
+    core.setDispatchEngine(DISPATCH_SWITCH);
+
+    Chip8Rewind history(bytes, frames);
+    std::vector<u64> checksums(frames);
+    std::vector<u64> recordNs(frames);
+    u64 runNs = 0;
+    u64 totalRecordNs = 0;
+    for (u32 f = 0; f < frames; f++)
+    {
+        pressKeys(core, f);
+        u64 start = benchNow();
+        core.execute(CHIP8_INSTRUCTIONS_PER_FRAME);
+        u64 ran = benchNow();
+        history.record(core);
+        u64 recorded = benchNow();
+        runNs += ran - start;
+        recordNs[f] = recorded - ran;
+        totalRecordNs += recordNs[f];
+        checksums[f] = savestateChecksum(core.getState());
+    }
+    run.frameNs = (double) runNs / frames;
+    run.recordNs = (double) totalRecordNs / frames;
+    std::sort(recordNs.begin(), recordNs.end());
+    run.recordP99Ns = recordNs[frames * 99 / 100];
+    run.slowestRecordNs = recordNs[frames - 1];
+    run.stats = history.getStats();
+
+    // The oldest frame held has to be a keyframe and every frame from it on has to come back
+    u64 oldest = history.getOldestFrame();
+    bool ok = history.getNewestFrame() == frames - 1 && oldest + run.stats.frames == frames;
+    while (ok && history.getFrame() > oldest)
+        ok = history.rewind(core) && savestateChecksum(core.getState()) == checksums[history.getFrame()];
+    ok = ok && !history.rewind(core);
+
+    srand(1);
+    for (u32 s = 0; ok && s < 200; s++)
+    {
+        u64 frame = oldest + rand() % run.stats.frames;
+        ok = history.seek(core, frame) && savestateChecksum(core.getState()) == checksums[frame];
+        for (u32 f = 0; ok && f < 30 && history.getFrame() < frames - 1; f++)
+            ok = history.forward(core) && savestateChecksum(core.getState()) == checksums[history.getFrame()];
+    }
+
+    // Recording after a rewind carries on from there, the old future is gone
+    if (ok)
+    {
+        u64 frame = frames / 2 > oldest ? frames / 2 : oldest;
+        ok = history.seek(core, frame);
+        core.execute(CHIP8_INSTRUCTIONS_PER_FRAME);
+        history.record(core);
+        u64 branched = savestateChecksum(core.getState());
+        ok = ok && history.getNewestFrame() == frame + 1 && history.rewind(core) && savestateChecksum(core.getState()) == checksums[frame] &&
+             history.forward(core) && savestateChecksum(core.getState()) == branched;
+    }
+
+    run.ok = ok;
+    return run;
+}
+
+int benchRewind(int argc, char* argv[])
+{
+    u32 minutes = argc > 0 ? atoi(argv[0]) : 10;
+    if (minutes == 0)
+        minutes = 1;
+    u32 frames = minutes * 60 * CHIP8_FRAMES_PER_SECOND;
+
+    bool ok = true;
+    std::cout << "Recording " << minutes << " minutes, " << frames << " frames of " << CHIP8_INSTRUCTIONS_PER_FRAME
+              << " instructions, a full copy of every frame would take " << (u64) sizeof(CHIP8_STATE) * 60 * CHIP8_FRAMES_PER_SECOND
+              << " bytes a minute" << std::endl;
+    for (const char* rom : benchRoms)
+    {
+        // Big enough to hold every frame, then small enough that the oldest history has to be dropped
+        REWIND_RUN all = runRewind(rom, frames, CHIP8_REWIND_BYTES * 4);
+        REWIND_RUN ring = runRewind(rom, frames, 256 * 1024);
+        ok = ok && all.ok && ring.ok;
+
+        // The line is built up first as ROMs that overflow the stack print while they run
+        double perMinute = (double) all.stats.bytes / all.stats.frames * 60 * CHIP8_FRAMES_PER_SECOND;
+        std::stringstream line;
+        line << std::left << std::setw(10) << rom << std::right << std::fixed << std::setprecision(1)
+             << std::setw(10) << perMinute / 1024 << " KB a minute, " << std::setw(6) << (double) all.stats.bytes / all.stats.frames
+             << " bytes a frame, " << all.stats.keyframes << " keyframes, record " << std::setw(6) << all.recordNs << " ns mean "
+             << std::setw(5) << all.recordP99Ns << " ns 99th percentile " << std::setw(6) << all.slowestRecordNs << " ns slowest against "
+             << std::setw(6) << all.frameNs << " ns running a frame, "
+             << std::setprecision(4) << 100.0 * all.recordNs / (1e9 / CHIP8_FRAMES_PER_SECOND) << "% of a frame"
+             << (all.ok ? "" : "  REWOUND FRAMES DIFFER") << std::endl;
+        line << std::setw(10) << "" << std::setprecision(1) << "  256KB ring holds " << ring.stats.frames << " frames, "
+             << (double) ring.stats.frames / CHIP8_FRAMES_PER_SECOND << " seconds" << (ring.ok ? "" : "  REWOUND FRAMES DIFFER");
+        std::cout << line.str() << std::endl;
+    }
+
+    return ok ? 0 : 1;
+}
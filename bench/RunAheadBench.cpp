@@ -0,0 +1,200 @@
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "Bench.h"
+#include "RunAhead.h"
+
+// Key presses that get no response within this many frames are not counted
+#define RUN_AHEAD_BENCH_MAX_LATENCY 60
+
+// The keys the shipped ROMs play with
+static const u8 runAheadKeys[] = {0x1, 0x4, 0xC, 0xD, 0x5, 0x6, 0x2, 0x8};
+
+/* Runs a program for "frames" frames on "engine" running four frames ahead every frame, checks the machine is put back
+ * exactly as a reference that never ran ahead has it and that each display presented is the one the reference reaches
+ * four frames later */
+static bool checkRunAhead(const u8* program, u32 size, DISPATCH_ENGINE engine, u32 frames)
+{
+    BenchCore core;
+    BenchCore reference;
+    if (!core.loadMemory(program, size) || !reference.loadMemory(program, size))
+        return false;
+    core.setDispatchEngine(engine);
+    reference.setDispatchEngine(DISPATCH_SWITCH);
+    core.setKeyDown(5);
+    reference.setKeyDown(5);
+
+    Chip8RunAhead runAhead(4);
+    std::vector<u64> presented((frames + 4) * CHIP8_ORIGINAL_DISPLAY_HEIGHT);
+    std::vector<u64> reached((frames + 4) * CHIP8_ORIGINAL_DISPLAY_HEIGHT);
+    bool ok = true;
+    for (u32 f = 0; ok && f < frames + 4; f++)
+    {
+        core.execute(CHIP8_INSTRUCTIONS_PER_FRAME);
+        reference.execute(CHIP8_INSTRUCTIONS_PER_FRAME);
+        runAhead.run(core, CHIP8_INSTRUCTIONS_PER_FRAME);
+        ok = memcmp(&core.getState(), &reference.getState(), sizeof(CHIP8_STATE)) == 0 && core.hasQuit() == reference.hasQuit();
+        memcpy(&presented[f * CHIP8_ORIGINAL_DISPLAY_HEIGHT], runAhead.getPixels(), CHIP8_ORIGINAL_DISPLAY_HEIGHT * sizeof(u64));
+        memcpy(&reached[f * CHIP8_ORIGINAL_DISPLAY_HEIGHT], reference.getPixels(), CHIP8_ORIGINAL_DISPLAY_HEIGHT * sizeof(u64));
+    }
+    return ok && memcmp(&presented[0], &reached[4 * CHIP8_ORIGINAL_DISPLAY_HEIGHT], frames * CHIP8_ORIGINAL_DISPLAY_HEIGHT * sizeof(u64)) == 0;
+}
+
+// Loads "rom" into a buffer for "checkRunAhead"
+static std::vector<u8> readRom(const char* rom)
+{
+    BenchCore core;
+    std::vector<u8> program;
+    if (core.loadFile(rom))
+        program.assign(&core.getState().memory[CHIP8_PROGRAM_LOAD_ADDRESS], &core.getState().memory[CHIP8_MEMORY_SIZE]);
+    return program;
+}
+
+/* Presents "frames" frames from "savestate" holding "key" down, or no key when it is 16, running ahead "ahead" frames and
+ * keeps the displays presented */
+static void presentFrames(const SAVESTATE& savestate, u8 key, u32 ahead, u32 frames, std::vector<u64>& displays)
+{
+    BenchCore core;
+    core.loadState(savestate);
+    if (key < CHIP8_TOTAL_KEYS)
+        core.setKeyDown(key);
+    Chip8RunAhead runAhead(ahead);
+    displays.resize(frames * CHIP8_ORIGINAL_DISPLAY_HEIGHT);
+    for (u32 f = 0; f < frames; f++)
+    {
+        core.execute(CHIP8_INSTRUCTIONS_PER_FRAME);
+        runAhead.run(core, CHIP8_INSTRUCTIONS_PER_FRAME);
+        memcpy(&displays[f * CHIP8_ORIGINAL_DISPLAY_HEIGHT], runAhead.getPixels(), CHIP8_ORIGINAL_DISPLAY_HEIGHT * sizeof(u64));
+    }
+}
+
+/* Presses each key at "trials" points of a ROM and counts the frames until the display presented differs from the one
+ * presented without the press, the frame the key went down in counts as one. Returns the mean over presses that got a
+ * response and how many did in "responses" */
+static double measureLatency(const char* rom, u32 ahead, u32 trials, u32& responses)
+{
+    BenchCore core;
+    responses = 0;
+    if (!core.loadFile(rom))
+        return 0;
+    core.setDispatchEngine(DISPATCH_SWITCH);
+    core.execute(300 * CHIP8_INSTRUCTIONS_PER_FRAME);
+
+    static SAVESTATE savestate;
+    std::vector<u64> control;
+    std::vector<u64> pressed;
+    u64 total = 0;
+    for (u32 t = 0; t < trials && !core.hasQuit(); t++)
+    {
+        core.execute(7 * CHIP8_INSTRUCTIONS_PER_FRAME);
+        core.saveState(savestate);
+        presentFrames(savestate, CHIP8_TOTAL_KEYS, ahead, RUN_AHEAD_BENCH_MAX_LATENCY, control);
+        for (u8 key : runAheadKeys)
+        {
+            presentFrames(savestate, key, ahead, RUN_AHEAD_BENCH_MAX_LATENCY, pressed);
+            for (u32 f = 0; f < RUN_AHEAD_BENCH_MAX_LATENCY; f++)
+            {
+                if (memcmp(&control[f * CHIP8_ORIGINAL_DISPLAY_HEIGHT], &pressed[f * CHIP8_ORIGINAL_DISPLAY_HEIGHT],
+                           CHIP8_ORIGINAL_DISPLAY_HEIGHT * sizeof(u64)) != 0)
+                {
+                    total += f + 1;
+                    responses++;
+                    break;
+                }
+            }
+        }
+    }
+    return responses ? (double) total / responses : 0;
+}
+
+// Returns the mean nanoseconds a frame of running ahead takes and the slowest in "slowestNs"
+static double timeRunAhead(const char* rom, u32 ahead, u32 instructionsPerFrame, u32 frames, u64& slowestNs)
+{
+    BenchCore core;
+    core.loadFile(rom);
+    core.setKeyDown(5);
+    Chip8RunAhead runAhead(ahead);
+    for (u32 f = 0; f < frames; f++)
+    {
+        core.execute(instructionsPerFrame);
+        runAhead.run(core, instructionsPerFrame);
+    }
+    RUN_AHEAD_STATS stats = runAhead.getStats();
+    slowestNs = stats.slowestNs;
+    return (double) stats.totalNs / stats.frames;
+}
+
+int benchRunAhead(int argc, char* argv[])
+{
+    u32 trials = argc > 0 ? atoi(argv[0]) : 40;
+    if (trials == 0)
+        trials = 1;
+
+    static const DISPATCH_ENGINE engines[] = {DISPATCH_SWITCH, DISPATCH_TABLE, DISPATCH_GOTO, DISPATCH_CACHE, DISPATCH_JIT, DISPATCH_COMPILED};
+    static const char* const names[] = {"switch", "table", "goto", "cache", "jit", "compiled"};
+    bool ok = true;
+    std::vector<std::pair<std::string, std::vector<u8>>> programs;
+    for (const char* rom : benchRoms)
+        programs.push_back(std::make_pair(std::string(rom), readRom(rom)));
+    programs.push_back(std::make_pair(std::string("selfmod"),
+                       std::vector<u8>(benchSelfModifyingProgram, benchSelfModifyingProgram + sizeof(benchSelfModifyingProgram))));
+    for (const auto& program : programs)
+    {
+        // The line is built up first as ROMs that overflow the stack print while they run
+        std::stringstream line;
+        line << std::left << std::setw(10) << program.first << std::right << " put back exactly on";
+        for (u32 e = 0; e < sizeof(engines) / sizeof(engines[0]); e++)
+        {
+            bool same = checkRunAhead(program.second.data(), program.second.size(), engines[e], 2000);
+            line << " " << names[e] << (same ? "" : " DIFFER");
+            ok = ok && same;
+        }
+        std::cout << line.str() << std::endl;
+    }
+
+    const double frameMs = 1000.0 / CHIP8_FRAMES_PER_SECOND;
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "Input to display latency, frames of " << frameMs << " ms at " << CHIP8_INSTRUCTIONS_PER_FRAME
+              << " instructions a frame, " << trials
+              << " points in each ROM, presses that got a response in brackets" << std::endl;
+    for (const char* rom : benchRoms)
+    {
+        std::stringstream line;
+        line << std::fixed << std::setprecision(2) << std::left << std::setw(10) << rom << std::right;
+        for (u32 ahead = 0; ahead <= CHIP8_RUN_AHEAD_MAX_FRAMES; ahead++)
+        {
+            u32 responses = 0;
+            double frames = measureLatency(rom, ahead, trials, responses);
+            if (!responses)
+            {
+                line << "  no key presses got a response";
+                break;
+            }
+            line << "  ahead " << ahead << ": " << std::setw(5) << frames << " frames " << std::setw(5) << frames * frameMs << " ms";
+            line << " (" << responses << ")";
+        }
+        std::cout << line.str() << std::endl;
+    }
+
+    // What running ahead costs a frame against the frame budget, at the VIP's speed and at a hundred times it
+    std::cout << "Cost of running ahead on the " << (CHIP8_DISPATCH_ENGINE == CHIP8_DISPATCH_GOTO ? "goto" : "table")
+              << " engine, PONG.c8" << std::endl;
+    for (u32 instructions : {CHIP8_INSTRUCTIONS_PER_FRAME, CHIP8_INSTRUCTIONS_PER_FRAME * 100})
+    {
+        std::stringstream line;
+        line << std::fixed << std::setprecision(1) << std::setw(6) << instructions << " instructions a frame";
+        for (u32 ahead = 1; ahead <= CHIP8_RUN_AHEAD_MAX_FRAMES; ahead++)
+        {
+            u64 slowestNs = 0;
+            double ns = timeRunAhead(benchRoms[0], ahead, instructions, 20000, slowestNs);
+            line << "  ahead " << ahead << ": " << std::setw(7) << ns << " ns " << std::setprecision(3)
+                 << 100.0 * ns / (frameMs * 1e6) << "% slowest " << std::setprecision(1) << slowestNs / 1000.0 << " us";
+        }
+        std::cout << line.str() << std::endl;
+    }
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,168 @@
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "Bench.h"
+#include "Savestate.h"
+
+// The file the streaming part of the benchmark writes, it is removed afterwards
+#define SAVESTATE_BENCH_FILE "savestate_bench.c8s"
+
+/* Saves part way through a ROM then checks that a fresh core loading the savestate and the core that saved it going back
+ * to it both run on exactly as the core did the first time */
+static bool checkRoundTrip(const char* rom, DISPATCH_ENGINE engine)
+{
+    BenchCore core;
+    if (!core.loadFile(rom))
+        return false;
+    core.setDispatchEngine(engine);
+    core.setKeyDown(5);
+    core.execute(50000);
+
+    static SAVESTATE savestate;
+    core.saveState(savestate);
+    u32 ran = core.execute(100000);
+    CHIP8_STATE expected = core.getState();
+
+    BenchCore fresh;
+    fresh.setDispatchEngine(engine);
+    bool ok = fresh.loadState(savestate) && fresh.execute(100000) == ran &&
+              memcmp(&fresh.getState(), &expected, sizeof(CHIP8_STATE)) == 0;
+
+    // The core that saved has code decoded and translated from the future it is going back on
+    ok = ok && core.loadState(savestate) && core.execute(100000) == ran && memcmp(&core.getState(), &expected, sizeof(CHIP8_STATE)) == 0;
+
+    // A savestate with a single bit flipped is refused and leaves the machine alone
+    static SAVESTATE corrupt;
+    corrupt = savestate;
+    corrupt.state.memory[0x300] ^= 0x10;
+    ok = ok && !fresh.loadState(corrupt) && memcmp(&fresh.getState(), &expected, sizeof(CHIP8_STATE)) == 0;
+    return ok;
+}
+
+/* Streams a state every "every" instructions into a file, opens it again and checks each state loads back to the machine
+ * it was saved from. Returns the mean nanoseconds per append, which includes growing the file, and the fastest append */
+static bool checkStream(const char* rom, u32 states, u32 every, u64& appendNs, u64& fastestNs, u64& fileBytes)
+{
+    BenchCore core;
+    if (!core.loadFile(rom))
+        return false;
+    core.setKeyDown(5);
+
+    std::vector<CHIP8_STATE> saved(states);
+    SavestateFile file;
+    if (!file.create(SAVESTATE_BENCH_FILE))
+        return false;
+
+    appendNs = 0;
+    fastestNs = ~0ull;
+    bool ok = true;
+    for (u32 c = 0; c < states; c++)
+    {
+        core.execute(every);
+        saved[c] = core.getState();
+        u64 start = benchNow();
+        ok = file.append(core) && ok;
+        u64 ns = benchNow() - start;
+        appendNs += ns;
+        fastestNs = ns < fastestNs ? ns : fastestNs;
+    }
+    appendNs /= states;
+    file.close();
+
+    ok = ok && file.open(SAVESTATE_BENCH_FILE) && file.getCount() == states;
+    for (u32 c = 0; ok && c < states; c++)
+    {
+        BenchCore loaded;
+        ok = file.load(c, loaded) && memcmp(&loaded.getState(), &saved[c], sizeof(CHIP8_STATE)) == 0;
+    }
+    file.close();
+
+    FILE* written = fopen(SAVESTATE_BENCH_FILE, "rb");
+    fileBytes = 0;
+    if (written)
+    {
+        fseek(written, 0, SEEK_END);
+        fileBytes = ftell(written);
+        fclose(written);
+    }
+    remove(SAVESTATE_BENCH_FILE);
+    return ok;
+}
+
+int benchSavestate(int argc, char* argv[])
+{
+    u32 iterations = argc > 0 ? atoi(argv[0]) : 100000;
+    if (iterations == 0)
+        iterations = 1;
+    static const DISPATCH_ENGINE engines[] = {DISPATCH_SWITCH, DISPATCH_TABLE, DISPATCH_GOTO, DISPATCH_CACHE, DISPATCH_JIT, DISPATCH_COMPILED};
+    static const char* const engineNames[] = {"switch", "table", "goto", "cache", "jit", "compiled"};
+
+    bool ok = true;
+    for (const char* rom : benchRoms)
+    {
+        // The line is built up first as ROMs that overflow the stack print while they run
+        std::stringstream line;
+        line << std::left << std::setw(10) << rom << std::right << " round trip";
+        for (u32 e = 0; e < sizeof(engines) / sizeof(engines[0]); e++)
+        {
+            bool same = checkRoundTrip(rom, engines[e]);
+            ok = ok && same;
+            line << "  " << engineNames[e] << (same ? " ok" : " DIFFERS");
+        }
+        std::cout << line.str() << std::endl;
+    }
+
+    // Save and load latency against a plain copy of the machine state
+    BenchCore core;
+    core.loadFile(benchRoms[0]);
+    core.setDispatchEngine(DISPATCH_SWITCH);
+    core.execute(10000);
+    static SAVESTATE savestate;
+    static CHIP8_STATE copy;
+
+    u64 start = benchNow();
+    for (u32 i = 0; i < iterations; i++)
+    {
+        memcpy(&copy, &core.getState(), sizeof(CHIP8_STATE));
+        benchKeep(copy);
+    }
+    double copyNs = (double)(benchNow() - start) / iterations;
+
+    start = benchNow();
+    for (u32 i = 0; i < iterations; i++)
+    {
+        core.saveState(savestate);
+        benchKeep(savestate);
+    }
+    double saveNs = (double)(benchNow() - start) / iterations;
+
+    start = benchNow();
+    for (u32 i = 0; i < iterations; i++)
+    {
+        ok = core.loadState(savestate) && ok;
+        benchKeep(core.getState());
+    }
+    double loadNs = (double)(benchNow() - start) / iterations;
+
+    u64 appendNs = 0;
+    u64 fastestNs = 0;
+    u64 fileBytes = 0;
+    const u32 states = 2000;
+    bool streamed = checkStream(benchRoms[1], states, 1000, appendNs, fastestNs, fileBytes);
+    ok = ok && streamed;
+
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "Savestate = " << sizeof(SAVESTATE) << " bytes, " << sizeof(CHIP8_STATE) << " bytes of it machine state" << std::endl;
+    std::cout << "memcpy of the state " << std::setw(8) << copyNs << " ns" << std::endl;
+    std::cout << "saveState           " << std::setw(8) << saveNs << " ns" << std::endl;
+    std::cout << "loadState           " << std::setw(8) << loadNs << " ns" << std::endl;
+    std::cout << "Streamed " << states << " states, " << appendNs << " ns per append with the file growing, " << fastestNs
+              << " ns fastest, " << fileBytes << " bytes on disk, "
+              << (double) fileBytes / states << " bytes per state" << (streamed ? "" : "  STREAMED STATES DIFFER") << std::endl;
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,142 @@
+#include <iostream>
+#include <vector>
+#include <stdlib.h>
+#include <string.h>
+#include "Bench.h"
+#include "Chip8Core.h"
+
+struct SPRITE_DRAW
+{
+    u8 x;
+    u8 y;
+    u8 n;
+    u8 sprite[16];
+};
+
+/* The framebuffer as it was before it was packed, one bool per pixel with a function call and wrap check for every
+ * pixel of a sprite. This is kept here only to measure the packed framebuffer against. */
+class BoolFramebuffer
+{
+    public:
+        __attribute__((noinline)) void setPixel(u16 x, u16 y)
+        {
+            if (x >= CHIP8_ORIGINAL_DISPLAY_WIDTH)
+                x -= CHIP8_ORIGINAL_DISPLAY_WIDTH;
+            if (y >= CHIP8_ORIGINAL_DISPLAY_HEIGHT)
+                y -= CHIP8_ORIGINAL_DISPLAY_HEIGHT;
+            pixels[(y * CHIP8_ORIGINAL_DISPLAY_WIDTH) + x] ^= true;
+        }
+
+        __attribute__((noinline)) bool getPixel(u16 x, u16 y)
+        {
+            x %= CHIP8_ORIGINAL_DISPLAY_WIDTH;
+            y %= CHIP8_ORIGINAL_DISPLAY_HEIGHT;
+            return pixels[(y * CHIP8_ORIGINAL_DISPLAY_WIDTH) + x];
+        }
+
+        bool drawSprite(u8 x, u8 y, const u8* sprite, u8 n)
+        {
+            bool collision = false;
+            for (int yc = 0; yc < n; yc++)
+            {
+                for (int xc = 0; xc < 8; xc++)
+                {
+                    if (sprite[yc] & (0x80 >> xc))
+                    {
+                        if (getPixel(xc + x, yc + y))
+                            collision = true;
+                        setPixel(xc + x, yc + y);
+                    }
+                }
+            }
+            return collision;
+        }
+
+        bool pixels[CHIP8_RESOLUTION] = {};
+};
+
+// Runs the ROM headless and records every sprite it draws
+static std::vector<SPRITE_DRAW> recordSprites(const char* rom, u32 instructions)
+{
+    std::vector<SPRITE_DRAW> draws;
+    Chip8Core core;
+    if (!core.loadFile(rom))
+        return draws;
+
+    CHIP8_STATE& state = core.getState();
+    for (u32 i = 0; i < instructions && !core.hasQuit(); i++)
+    {
+        u16 opcode = (state.memory[state.PC & 0xfff] << 8) | state.memory[(state.PC + 1) & 0xfff];
+        if ((opcode >> 12) == 0xD)
+        {
+            SPRITE_DRAW draw;
+            draw.x = state.V[(opcode >> 8) & 0x0f];
+            draw.y = state.V[(opcode >> 4) & 0x0f];
+            draw.n = opcode & 0x0f;
+            for (int c = 0; c < draw.n; c++)
+                draw.sprite[c] = state.memory[(state.I + c) & 0xfff];
+            draws.push_back(draw);
+        }
+
+        // Answer any wait for a key so the ROM gets past its title screen
+        if ((opcode & 0xf0ff) == 0xf00a)
+            core.setKeyDown(i & 0x0f);
+        else
+            core.setKeyUp(core.getLastKeyPressed());
+
+        core.process();
+    }
+
+    return draws;
+}
+
+int benchSprite(int argc, char* argv[])
+{
+    const char* rom = argc > 0 ? argv[0] : "blitz.c8";
+    u32 rounds = argc > 1 ? atoi(argv[1]) : 200;
+
+    std::vector<SPRITE_DRAW> draws = recordSprites(rom, 200000);
+    if (draws.empty())
+    {
+        std::cout << "No sprites were drawn by " << rom << std::endl;
+        return 1;
+    }
+
+    BoolFramebuffer reference;
+    u32 referenceCollisions = 0;
+    u64 start = benchNow();
+    for (u32 r = 0; r < rounds; r++)
+    {
+        for (const SPRITE_DRAW& draw : draws)
+            referenceCollisions += reference.drawSprite(draw.x, draw.y, draw.sprite, draw.n);
+    }
+    u64 referenceNs = benchNow() - start;
+
+    Chip8Core core;
+    u32 packedCollisions = 0;
+    start = benchNow();
+    for (u32 r = 0; r < rounds; r++)
+    {
+        for (const SPRITE_DRAW& draw : draws)
+            packedCollisions += core.drawSprite(draw.x, draw.y, draw.sprite, draw.n);
+    }
+    u64 packedNs = benchNow() - start;
+
+    // Both framebuffers must end up identical for the comparison to mean anything
+    bool same = referenceCollisions == packedCollisions;
+    for (u16 y = 0; y < CHIP8_ORIGINAL_DISPLAY_HEIGHT; y++)
+    {
+        for (u16 x = 0; x < CHIP8_ORIGINAL_DISPLAY_WIDTH; x++)
+        {
+            if (reference.pixels[(y * CHIP8_ORIGINAL_DISPLAY_WIDTH) + x] != core.getPixel(x, y))
+                same = false;
+        }
+    }
+
+    u64 total = (u64) draws.size() * rounds;
+    std::cout << rom << ": " << draws.size() << " sprites recorded, drawn " << rounds << " times" << std::endl;
+    std::cout << "Per pixel bool framebuffer = " << (double) referenceNs / total << " ns per sprite" << std::endl;
+    std::cout << "Packed 64 bit rows        = " << (double) packedNs / total << " ns per sprite" << std::endl;
+    std::cout << "Speedup = " << (double) referenceNs / packedNs << "x" << (same ? "" : ", RESULTS DIFFER") << std::endl;
+    return same ? 0 : 1;
+}
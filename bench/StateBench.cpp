@@ -0,0 +1,37 @@
+#include <iostream>
+#include <new>
+#include <stdlib.h>
+#include "Bench.h"
+#include "Chip8Core.h"
+
+// Budgets the construction time and the state size are held under
+#define STATE_BENCH_MAX_CONSTRUCT_NS 5000
+#define STATE_BENCH_MAX_STATE_BYTES 8192
+
+int benchState(int argc, char* argv[])
+{
+    u32 iterations = argc > 0 ? atoi(argv[0]) : 100000;
+    if (iterations == 0)
+        iterations = 1;
+
+    // Construct into the same aligned storage each time so only the core itself is measured
+    alignas(Chip8Core) static unsigned char storage[sizeof(Chip8Core)];
+    u64 start = benchNow();
+    for (u32 i = 0; i < iterations; i++)
+    {
+        Chip8Core* core = new (storage) Chip8Core();
+        benchKeep(*core);
+        core->~Chip8Core();
+    }
+    u64 constructNs = (benchNow() - start) / iterations;
+
+    std::cout << "sizeof(CHIP8_STATE) = " << sizeof(CHIP8_STATE) << " bytes, alignment " << alignof(CHIP8_STATE) << std::endl;
+    std::cout << "sizeof(Chip8Core) = " << sizeof(Chip8Core) << " bytes" << std::endl;
+    std::cout << "Construction = " << constructNs << " ns per core over " << iterations << " cores" << std::endl;
+
+    bool ok = constructNs <= STATE_BENCH_MAX_CONSTRUCT_NS && sizeof(CHIP8_STATE) <= STATE_BENCH_MAX_STATE_BYTES;
+    if (!ok)
+        std::cout << "Over budget, construction must stay under " << STATE_BENCH_MAX_CONSTRUCT_NS << " ns and the state under "
+                  << STATE_BENCH_MAX_STATE_BYTES << " bytes" << std::endl;
+    return ok ? 0 : 1;
+}
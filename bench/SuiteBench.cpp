@@ -0,0 +1,305 @@
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <map>
+#include <new>
+#include <sstream>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+#include "Bench.h"
+
+/* The suite is the one benchmark meant to be tracked over time. It times a loop of each opcode family and whole ROMs
+ * with scripted input, writes the results as JSON and compares them against a baseline saved earlier, so a change can
+ * be checked for regressions on any headless box:
+ *
+ *     bench suite                            prints the results as JSON
+ *     bench suite save baseline.json         and writes them to a file
+ *     bench suite compare baseline.json 15   fails if anything got more than 15% slower per instruction
+ *
+ * Every run is taken three times in turn and the best kept as hosts are noisy. */
+
+// Instructions each microbenchmark and each ROM runs for in a timing
+#define SUITE_MICRO_INSTRUCTIONS 10000000
+#define SUITE_ROM_INSTRUCTIONS 20000000
+#define SUITE_REPEATS 3
+// How much slower per instruction than the baseline a result can be before "compare" calls it a regression
+#define SUITE_TOLERANCE_PERCENT 15
+#define SUITE_VERSION 1
+
+/* Every allocation in the process is counted so a run can report the ones it made. The replacements are kept out of
+ * line so the compiler does not pair an inlined "free" with the "new" that made the pointer and warn */
+static std::atomic<u64> suiteAllocations(0);
+
+__attribute__((noinline)) void* operator new(size_t size)
+{
+    suiteAllocations.fetch_add(1, std::memory_order_relaxed);
+    void* p = malloc(size ? size : 1);
+    if (!p)
+        throw std::bad_alloc();
+    return p;
+}
+
+__attribute__((noinline)) void* operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+__attribute__((noinline)) void operator delete(void* p) noexcept
+{
+    free(p);
+}
+
+__attribute__((noinline)) void operator delete[](void* p) noexcept
+{
+    free(p);
+}
+
+__attribute__((noinline)) void operator delete(void* p, size_t) noexcept
+{
+    free(p);
+}
+
+__attribute__((noinline)) void operator delete[](void* p, size_t) noexcept
+{
+    free(p);
+}
+
+/* A loop of one opcode family, "setup" runs once from 0x200 and "body" is repeated then jumped back to so nearly every
+ * instruction timed is of the family. They run a second of frames a call so the time is the instructions' own */
+struct SUITE_MICRO
+{
+    const char* name;
+    std::vector<u16> setup;
+    std::vector<u16> body;
+    u32 repeat;
+};
+
+struct SUITE_RESULT
+{
+    std::string name;
+    u64 instructions;
+    double ns;
+    u64 frames;
+    u64 allocations;
+};
+
+static const SUITE_MICRO suiteMicros[] = {
+    // Every 8xyN, V0 and V1 keep changing so the carries and borrows go both ways
+    {"alu_8xyn", {0x6001, 0x6102}, {0x8014, 0x8125, 0x8016, 0x8012, 0x8011, 0x8103, 0x8017, 0x810E, 0x8010}, 3},
+    {"add_7xkk", {}, {0x7001, 0x7103, 0x7205, 0x7307}, 6},
+    {"skip_3xkk", {0x6000}, {0x3001, 0x4001, 0x5010, 0x9010}, 6},
+    // The digit 0 drawn across the screen, each draw moves on so it wraps and collides
+    {"draw_dxyn", {0xA000}, {0xD015, 0x7009, 0x7103}, 8},
+    {"clear_00e0", {0xA000}, {0x00E0, 0xD015}, 12},
+    {"bcd_fx33", {0xA300}, {0xF033, 0x7007}, 12},
+    {"store_load_fx55_fx65", {0xA300}, {0xF755, 0xF765}, 12},
+    {"add_i_fx1e", {0x6001}, {0xF01E, 0xF01E, 0xF029}, 8},
+    {"timers_fx15_fx07", {0x6020}, {0xF015, 0xF107, 0xF018}, 8},
+    {"random_cxkk", {}, {0xC0FF, 0xC10F}, 12}
+};
+
+// Calls and returns are timed on their own, 0x200 and 0x202 both call the "00EE" at 0x206 and 0x204 jumps back
+static const u16 suiteCalls[] = {0x2206, 0x2206, 0x1200, 0x00EE};
+
+// Builds the program of a microbenchmark
+static std::vector<u8> microProgram(const SUITE_MICRO& micro)
+{
+    std::vector<u16> opcodes = micro.setup;
+    u16 loop = CHIP8_PROGRAM_LOAD_ADDRESS + opcodes.size() * 2;
+    for (u32 r = 0; r < micro.repeat; r++)
+        opcodes.insert(opcodes.end(), micro.body.begin(), micro.body.end());
+    opcodes.push_back(0x1000 | loop);
+
+    std::vector<u8> program;
+    for (u16 opcode : opcodes)
+    {
+        program.push_back(opcode >> 8);
+        program.push_back(opcode & 0xff);
+    }
+    return program;
+}
+
+/* Runs "program" for "instructions" instructions in calls of "chunk". A ROM's input is scripted so it plays the same way
+ * every run, each of the keys in turn is held down for ten frames of every thirty. Frames are counted as the frontend
+ * would run them, CHIP8_INSTRUCTIONS_PER_FRAME instructions each */
+static SUITE_RESULT runProgram(const std::string& name, const std::vector<u8>& program, bool scripted, u32 chunk,
+                               u64 instructions)
+{
+    static const u8 keys[] = {1, 4, 5, 6, 7, 0xc, 0xd};
+    SUITE_RESULT best = {name, 0, 1e18, 0, 0};
+    for (u32 r = 0; r < SUITE_REPEATS; r++)
+    {
+        BenchCore core;
+        core.loadMemory(program.data(), program.size());
+
+        u64 allocations = suiteAllocations.load(std::memory_order_relaxed);
+        u64 start = benchNow();
+        u64 done = 0;
+        while (done < instructions && !core.hasQuit())
+        {
+            u64 frame = done / CHIP8_INSTRUCTIONS_PER_FRAME;
+            if (scripted && frame % 30 == 0)
+                core.setKeyDown(keys[(frame / 30) % sizeof(keys)]);
+            if (scripted && frame % 30 == 10)
+                core.setKeyUp(keys[(frame / 30) % sizeof(keys)]);
+            u32 ran = core.execute(chunk);
+            if (ran == 0)
+                break;
+            done += ran;
+        }
+        double ns = (double) (benchNow() - start) / (done ? done : 1);
+        benchKeep(core.getState());
+
+        if (ns < best.ns)
+        {
+            best.instructions = done;
+            best.ns = ns;
+            best.frames = done / CHIP8_INSTRUCTIONS_PER_FRAME;
+            best.allocations = suiteAllocations.load(std::memory_order_relaxed) - allocations;
+        }
+    }
+    return best;
+}
+
+static std::vector<SUITE_RESULT> runSuite()
+{
+    std::vector<SUITE_RESULT> results;
+    for (const SUITE_MICRO& micro : suiteMicros)
+        results.push_back(runProgram(std::string("micro/") + micro.name, microProgram(micro), false,
+                                     CHIP8_INSTRUCTIONS_PER_FRAME * CHIP8_FRAMES_PER_SECOND, SUITE_MICRO_INSTRUCTIONS));
+
+    std::vector<u8> calls;
+    for (u16 opcode : suiteCalls)
+    {
+        calls.push_back(opcode >> 8);
+        calls.push_back(opcode & 0xff);
+    }
+    results.push_back(runProgram("micro/call_ret_2nnn_00ee", calls, false, CHIP8_INSTRUCTIONS_PER_FRAME * CHIP8_FRAMES_PER_SECOND,
+                                 SUITE_MICRO_INSTRUCTIONS));
+
+    for (const char* rom : benchRoms)
+    {
+        BenchCore loader;
+        if (!loader.loadFile(rom))
+            continue;
+        const u8* memory = loader.getState().memory;
+        std::vector<u8> program(memory + CHIP8_PROGRAM_LOAD_ADDRESS, memory + CHIP8_MEMORY_SIZE);
+        results.push_back(runProgram(std::string("rom/") + rom, program, true, CHIP8_INSTRUCTIONS_PER_FRAME, SUITE_ROM_INSTRUCTIONS));
+    }
+    return results;
+}
+
+// One result a line so "readBaseline" can read it back without a JSON library
+static std::string toJson(const std::vector<SUITE_RESULT>& results)
+{
+    std::ostringstream json;
+    json << std::fixed << "{" << std::endl << "  \"version\": " << SUITE_VERSION << "," << std::endl << "  \"results\": [" << std::endl;
+    for (u32 r = 0; r < results.size(); r++)
+    {
+        const SUITE_RESULT& result = results[r];
+        double seconds = result.ns * result.instructions / 1e9;
+        json << "    {\"name\": \"" << result.name << "\", \"instructions\": " << result.instructions
+             << ", \"ns_per_instruction\": " << std::setprecision(3) << result.ns
+             << ", \"instructions_per_second\": " << std::setprecision(0) << result.instructions / seconds
+             << ", \"frames_per_second\": " << result.frames / seconds
+             << ", \"allocations\": " << result.allocations << "}" << (r + 1 < results.size() ? "," : "") << std::endl;
+    }
+    json << "  ]" << std::endl << "}" << std::endl;
+    return json.str();
+}
+
+// The nanoseconds an instruction of each result in a file "toJson" wrote, empty if it could not be read
+static std::map<std::string, double> readBaseline(const char* fname)
+{
+    std::map<std::string, double> baseline;
+    std::ifstream file(fname);
+    std::string line;
+    while (std::getline(file, line))
+    {
+        size_t name = line.find("\"name\": \"");
+        size_t ns = line.find("\"ns_per_instruction\": ");
+        if (name == std::string::npos || ns == std::string::npos)
+            continue;
+        name += 9;
+        baseline[line.substr(name, line.find('"', name) - name)] = strtod(line.c_str() + ns + 22, NULL);
+    }
+    return baseline;
+}
+
+// Prints each result against the baseline, returns the number that are more than "tolerance" percent slower
+static u32 compare(const std::vector<SUITE_RESULT>& results, const std::map<std::string, double>& baseline, double tolerance)
+{
+    u32 regressions = 0;
+    std::cout << std::fixed << std::setprecision(3);
+    for (const SUITE_RESULT& result : results)
+    {
+        auto before = baseline.find(result.name);
+        std::cout << "  " << std::left << std::setw(28) << result.name << std::right;
+        if (before == baseline.end())
+        {
+            std::cout << std::setw(9) << result.ns << " ns, not in the baseline" << std::endl;
+            continue;
+        }
+        double change = 100.0 * (result.ns - before->second) / before->second;
+        bool regressed = change > tolerance;
+        regressions += regressed;
+        std::cout << std::setw(9) << before->second << " ns -> " << std::setw(9) << result.ns << " ns " << std::showpos
+                  << std::setprecision(1) << std::setw(7) << change << "%" << std::noshowpos << std::setprecision(3)
+                  << (regressed ? "  REGRESSION" : "") << std::endl;
+    }
+    return regressions;
+}
+
+int benchSuite(int argc, char* argv[])
+{
+    std::string mode = argc > 0 ? argv[0] : "";
+    if ((mode == "save" || mode == "compare") && argc < 2)
+    {
+        std::cout << "Give the file to " << mode << (mode == "save" ? " the results to" : " against") << std::endl;
+        return 1;
+    }
+    if (!mode.empty() && mode != "save" && mode != "compare")
+    {
+        std::cout << "Unknown mode " << mode << ", use save or compare" << std::endl;
+        return 1;
+    }
+
+    std::map<std::string, double> baseline;
+    if (mode == "compare")
+    {
+        baseline = readBaseline(argv[1]);
+        if (baseline.empty())
+        {
+            std::cout << argv[1] << " holds no results to compare against" << std::endl;
+            return 1;
+        }
+    }
+
+    std::vector<SUITE_RESULT> results = runSuite();
+    std::string json = toJson(results);
+    std::cout << json;
+
+    if (mode == "save")
+    {
+        std::ofstream file(argv[1], std::ios::trunc);
+        file << json;
+        if (file.fail())
+        {
+            std::cout << "Could not write " << argv[1] << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+    if (mode == "compare")
+    {
+        double tolerance = argc > 2 ? atof(argv[2]) : SUITE_TOLERANCE_PERCENT;
+        std::cout << "Against " << argv[1] << ", slower by more than " << tolerance << "% an instruction is a regression" << std::endl;
+        u32 regressions = compare(results, baseline, tolerance);
+        std::cout << regressions << " regressions" << std::endl;
+        return regressions ? 1 : 0;
+    }
+    return 0;
+}
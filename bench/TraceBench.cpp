@@ -0,0 +1,209 @@
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#include <stdlib.h>
+#include "Bench.h"
+#include "Handlers.h"
+#include "Trace.h"
+
+// The files the benchmark traces into, they are removed afterwards
+#define TRACE_BENCH_FILE "trace_bench.c8t"
+#define TRACE_BENCH_OTHER_FILE "trace_bench_other.c8t"
+
+// The PONG key that moves the left paddle, pressed part way through one of the runs "diff" is checked on
+#define TRACE_BENCH_KEY 1
+
+// Traces "frames" frames of "rom" into "fname", pressing TRACE_BENCH_KEY from frame "pressAt" on if it is set
+static bool traceRom(const char* rom, const char* fname, u32 frames, u32 ringBlocks, u32 pressAt, Chip8Tracer& tracer, BenchCore& core)
+{
+    if (!core.loadFile(rom) || !tracer.create(fname, ringBlocks))
+        return false;
+    core.setKeyDown(5);
+    core.setTracer(&tracer);
+    for (u32 f = 0; f < frames; f++)
+    {
+        if (pressAt && f == pressAt)
+            core.setKeyDown(TRACE_BENCH_KEY);
+        core.execute(CHIP8_INSTRUCTIONS_PER_FRAME);
+    }
+    core.setTracer(NULL);
+    tracer.close();
+    return true;
+}
+
+// True if the registers of "record" are the ones "state" holds
+static bool sameRegisters(const TRACE_RECORD& record, const CHIP8_STATE& state)
+{
+    return memcmp(record.V, state.V, sizeof(record.V)) == 0 && record.I == state.I && record.SP == state.SP &&
+           record.DT == state.DT && record.ST == state.ST;
+}
+
+/* Reads a trace of "rom" back and steps a second core an instruction at a time beside it, every record must carry the
+ * count, "PC" and opcode the core was at and the registers it was left with. Returns the records checked */
+static u64 checkTrace(const char* rom, u32 frames, bool& ok)
+{
+    Chip8Tracer tracer;
+    BenchCore traced;
+    ok = traceRom(rom, TRACE_BENCH_FILE, frames, 0, 0, tracer, traced);
+    Chip8TraceReader reader;
+    ok = ok && reader.load(TRACE_BENCH_FILE);
+
+    BenchCore reference;
+    reference.loadFile(rom);
+    reference.setKeyDown(5);
+    TRACE_RECORD record;
+    u64 checked = 0;
+    while (ok && reader.next(record))
+    {
+        CHIP8_STATE& state = reference.getState();
+        u16 opcode = Handlers::fetch(state);
+        if (record.instruction != state.instructions || record.PC != state.PC || record.opcode != opcode)
+            ok = false;
+        reference.execute(1);
+        if (!sameRegisters(record, state))
+            ok = false;
+        if (!ok)
+            std::cout << "    record " << checked << " differs, PC " << std::hex << record.PC << " opcode " << record.opcode
+                      << std::dec << std::endl;
+        checked++;
+    }
+    ok = ok && !reader.isCorrupt() && checked == traced.getInstructions() && checked == tracer.getRecords();
+    remove(TRACE_BENCH_FILE);
+    return checked;
+}
+
+// Traces into a ring of "ringBlocks" blocks, the ring must hold only the last blocks and end at the machine's state
+static bool checkRing(const char* rom, u32 frames, u32 ringBlocks, u64& lost)
+{
+    Chip8Tracer tracer;
+    BenchCore core;
+    bool ok = traceRom(rom, TRACE_BENCH_FILE, frames, ringBlocks, 0, tracer, core);
+    Chip8TraceReader reader;
+    ok = ok && reader.load(TRACE_BENCH_FILE);
+
+    TRACE_RECORD record;
+    TRACE_RECORD last;
+    u64 records = 0;
+    u64 expected = 0;
+    while (ok && reader.next(record))
+    {
+        // The records left must still run on one from the next without a gap
+        if (records && record.instruction != expected)
+            ok = false;
+        expected = record.instruction + 1;
+        last = record;
+        records++;
+    }
+    lost = reader.getLostBlocks();
+    ok = ok && records == reader.getRecords() && reader.getBlocks() == ringBlocks && lost > 0 && !reader.isCorrupt() &&
+         last.instruction + 1 == core.getInstructions() && last.PC + 2 != 0 && sameRegisters(last, core.getState());
+    remove(TRACE_BENCH_FILE);
+    return ok;
+}
+
+/* Traces the same run twice with a key pressed in the second at "pressAt", the traces must first part at or after the
+ * instruction the key went down at */
+static bool checkDiff(const char* rom, u32 frames, u32 pressAt, TRACE_DIFF& difference)
+{
+    Chip8Tracer tracer;
+    BenchCore a;
+    BenchCore b;
+    bool ok = traceRom(rom, TRACE_BENCH_FILE, frames, 0, 0, tracer, a) &&
+              traceRom(rom, TRACE_BENCH_OTHER_FILE, frames, 0, pressAt, tracer, b);
+    Chip8TraceReader readerA;
+    Chip8TraceReader readerB;
+    ok = ok && readerA.load(TRACE_BENCH_FILE) && readerB.load(TRACE_BENCH_OTHER_FILE);
+    if (ok)
+        difference = traceDiff(readerA, readerB);
+    remove(TRACE_BENCH_FILE);
+    remove(TRACE_BENCH_OTHER_FILE);
+    return ok && difference.found && difference.a.instruction >= (u64) pressAt * CHIP8_INSTRUCTIONS_PER_FRAME;
+}
+
+// Returns the nanoseconds an instruction of "rom" takes with or without tracing, "bytes" is what the trace took
+static double timeRun(const char* rom, DISPATCH_ENGINE engine, bool trace, u32 instructions, u64& bytes)
+{
+    BenchCore core;
+    core.loadFile(rom);
+    core.setDispatchEngine(engine);
+    core.setKeyDown(5);
+    Chip8Tracer tracer;
+    if (trace)
+    {
+        tracer.create(TRACE_BENCH_FILE);
+        core.setTracer(&tracer);
+    }
+
+    u64 start = benchNow();
+    u32 done = 0;
+    while (done < instructions)
+    {
+        u32 ran = core.execute(CHIP8_INSTRUCTIONS_PER_FRAME * 60);
+        if (ran == 0)
+            break;
+        done += ran;
+    }
+    double ns = (double) (benchNow() - start) / (done ? done : 1);
+    benchKeep(core.getState());
+
+    bytes = tracer.getBytes();
+    core.setTracer(NULL);
+    tracer.close();
+    remove(TRACE_BENCH_FILE);
+    return ns;
+}
+
+int benchTrace(int argc, char* argv[])
+{
+    u32 instructions = argc > 0 ? atoi(argv[0]) : 5000000;
+    if (instructions < 100000)
+        instructions = 100000;
+    bool ok = true;
+
+    for (const char* rom : benchRoms)
+    {
+        bool right = false;
+        u64 checked = checkTrace(rom, 6000, right);
+        ok = ok && right;
+        std::cout << "  " << std::setw(8) << rom << ": " << checked << " records decoded and checked against a stepped core"
+                  << (right ? "" : " WRONG") << std::endl;
+    }
+
+    u64 lost = 0;
+    bool ring = checkRing(benchRoms[0], 60000, 4, lost);
+    ok = ok && ring;
+    std::cout << "A ring of 4 blocks over 600000 instructions: " << lost << " blocks written over, the rest decodes to the end"
+              << (ring ? "" : " WRONG") << std::endl;
+
+    TRACE_DIFF difference;
+    bool diff = checkDiff(benchRoms[0], 3000, 1000, difference);
+    ok = ok && diff;
+    std::cout << "Key " << TRACE_BENCH_KEY << " pressed at instruction " << 1000 * CHIP8_INSTRUCTIONS_PER_FRAME
+              << ", the traces first part at instruction " << difference.a.instruction << ", PC " << std::hex
+              << difference.a.PC << std::dec << (diff ? "" : " WRONG") << std::endl;
+
+    /* Tracing dispatches as the switch engine does and the goto engine is the default, the runs are taken in turn and
+     * the best of three kept as the host is noisy */
+    std::cout << std::fixed << std::setprecision(2);
+    for (const char* rom : benchRoms)
+    {
+        u64 bytes = 0;
+        u64 unused = 0;
+        double traced = 1e9;
+        double bare = 1e9;
+        double fastest = 1e9;
+        for (u32 r = 0; r < 3; r++)
+        {
+            traced = std::min(traced, timeRun(rom, DISPATCH_SWITCH, true, instructions, bytes));
+            bare = std::min(bare, timeRun(rom, DISPATCH_SWITCH, false, instructions, unused));
+            fastest = std::min(fastest, timeRun(rom, DISPATCH_GOTO, false, instructions, unused));
+        }
+        std::cout << "  " << std::setw(8) << rom << ": " << std::setw(6) << traced << " ns an instruction traced, "
+                  << std::setw(6) << bare << " on switch, " << traced / bare << "x, " << std::setw(6) << fastest << " on goto, "
+                  << traced / fastest << "x, " << (double) bytes / instructions << " bytes an instruction, "
+                  << std::setprecision(4) << traced * CHIP8_FRAMES_PER_SECOND * CHIP8_INSTRUCTIONS_PER_FRAME / 1e7
+                  << "% of a core traced at 1x" << std::setprecision(2) << std::endl;
+    }
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,995 @@
+// Generated by tools/Recompiler from PONG.c8, do not edit
+#include "Chip8Core.h"
+#include "Compiled.h"
+#include "Handlers.h"
+
+static const u8 rom[] = {
+    0x6a, 0x02, 0x6b, 0x0c, 0x6c, 0x3f, 0x6d, 0x0c, 0xa2, 0xea, 0xda, 0xb6, 0xdc, 0xd6, 0x6e, 0x00,
+    0x22, 0xd4, 0x66, 0x03, 0x68, 0x02, 0x60, 0x60, 0xf0, 0x15, 0xf0, 0x07, 0x30, 0x00, 0x12, 0x1a,
+    0xc7, 0x17, 0x77, 0x08, 0x69, 0xff, 0xa2, 0xf0, 0xd6, 0x71, 0xa2, 0xea, 0xda, 0xb6, 0xdc, 0xd6,
+    0x60, 0x01, 0xe0, 0xa1, 0x7b, 0xfe, 0x60, 0x04, 0xe0, 0xa1, 0x7b, 0x02, 0x60, 0x1f, 0x8b, 0x02,
+    0xda, 0xb6, 0x60, 0x0c, 0xe0, 0xa1, 0x7d, 0xfe, 0x60, 0x0d, 0xe0, 0xa1, 0x7d, 0x02, 0x60, 0x1f,
+    0x8d, 0x02, 0xdc, 0xd6, 0xa2, 0xf0, 0xd6, 0x71, 0x86, 0x84, 0x87, 0x94, 0x60, 0x3f, 0x86, 0x02,
+    0x61, 0x1f, 0x87, 0x12, 0x46, 0x02, 0x12, 0x78, 0x46, 0x3f, 0x12, 0x82, 0x47, 0x1f, 0x69, 0xff,
+    0x47, 0x00, 0x69, 0x01, 0xd6, 0x71, 0x12, 0x2a, 0x68, 0x02, 0x63, 0x01, 0x80, 0x70, 0x80, 0xb5,
+    0x12, 0x8a, 0x68, 0xfe, 0x63, 0x0a, 0x80, 0x70, 0x80, 0xd5, 0x3f, 0x01, 0x12, 0xa2, 0x61, 0x02,
+    0x80, 0x15, 0x3f, 0x01, 0x12, 0xba, 0x80, 0x15, 0x3f, 0x01, 0x12, 0xc8, 0x80, 0x15, 0x3f, 0x01,
+    0x12, 0xc2, 0x60, 0x20, 0xf0, 0x18, 0x22, 0xd4, 0x8e, 0x34, 0x22, 0xd4, 0x66, 0x3e, 0x33, 0x01,
+    0x66, 0x03, 0x68, 0xfe, 0x33, 0x01, 0x68, 0x02, 0x12, 0x16, 0x79, 0xff, 0x49, 0xfe, 0x69, 0xff,
+    0x12, 0xc8, 0x79, 0x01, 0x49, 0x02, 0x69, 0x01, 0x60, 0x04, 0xf0, 0x18, 0x76, 0x01, 0x46, 0x40,
+    0x76, 0xfe, 0x12, 0x6c, 0xa2, 0xf2, 0xfe, 0x33, 0xf2, 0x65, 0xf1, 0x29, 0x64, 0x14, 0x65, 0x00,
+    0xd4, 0x55, 0x74, 0x15, 0xf2, 0x29, 0xd4, 0x55, 0x00, 0xee, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+    0x80, 0x00, 0x00, 0x00, 0x00, 0x00
+};
+
+static u32 run(Chip8Core& core, u32 count)
+{
+    CHIP8_STATE& s = core.getState();
+    u32 done = 0;
+    goto dispatch;
+
+block_200:
+    {
+        if (count - done < 9)
+            return done;
+        done += 9;
+        // 0x200: 6a02 6xkk
+        Handlers::LD_VX_KK(core, {OPCODE_LD_VX_KK, 0xa, 0x0, 0x2, 0x02, 0xa02, 0x6a02});
+        Handlers::tickTimers(core);
+        // 0x202: 6b0c 6xkk
+        Handlers::LD_VX_KK(core, {OPCODE_LD_VX_KK, 0xb, 0x0, 0xc, 0x0c, 0xb0c, 0x6b0c});
+        Handlers::tickTimers(core);
+        // 0x204: 6c3f 6xkk
+        Handlers::LD_VX_KK(core, {OPCODE_LD_VX_KK, 0xc, 0x3, 0xf, 0x3f, 0xc3f, 0x6c3f});
+        Handlers::tickTimers(core);
+        // 0x206: 6d0c 6xkk
+        Handlers::LD_VX_KK(core, {OPCODE_LD_VX_KK, 0xd, 0x0, 0xc, 0x0c, 0xd0c, 0x6d0c});
+        Handlers::tickTimers(core);
+        // 0x208: a2ea Annn
+        Handlers::LD_I(core, {OPCODE_LD_I, 0x2, 0xe, 0xa, 0xea, 0x2ea, 0xa2ea});
+        Handlers::tickTimers(core);
+        // 0x20a: dab6 Dxyn
+        Handlers::DRW(core, {OPCODE_DRW, 0xa, 0xb, 0x6, 0xb6, 0xab6, 0xdab6});
+        Handlers::tickTimers(core);
+        // 0x20c: dcd6 Dxyn
+        Handlers::DRW(core, {OPCODE_DRW, 0xc, 0xd, 0x6, 0xd6, 0xcd6, 0xdcd6});
+        Handlers::tickTimers(core);
+        // 0x20e: 6e00 6xkk
+        Handlers::LD_VX_KK(core, {OPCODE_LD_VX_KK, 0xe, 0x0, 0x0, 0x00, 0xe00, 0x6e00});
+        Handlers::tickTimers(core);
+        // 0x210: 22d4 2nnn
+        s.PC = 0x212;
+        Handlers::CALL(core, {OPCODE_CALL, 0x2, 0xd, 0x4, 0xd4, 0x2d4, 0x22d4});
+        Handlers::tickTimers(core);
+        if (core.hasQuit())
+            return done;
+        s.PC = 0x2d4;
+        goto block_2d4;
+    }
+
+block_212:
+    {
+        if (count - done < 2)
+            return done;
+        done += 2;
+        // 0x212: 6603 6xkk
+        Handlers::LD_VX_KK(core, {OPCODE_LD_VX_KK, 0x6, 0x0, 0x3, 0x03, 0x603, 0x6603});
+        Handlers::tickTimers(core);
+        // 0x214: 6802 6xkk
+        Handlers::LD_VX_KK(core, {OPCODE_LD_VX_KK, 0x8, 0x0, 0x2, 0x02, 0x802, 0x6802});
+        Handlers::tickTimers(core);
+        s.PC = 0x216;
+        goto block_216;
+    }
+
+block_216:
+    {
+        if (count - done < 2)
+            return done;
+        done += 2;
+        // 0x216: 6060 6xkk
+        Handlers::LD_VX_KK(core, {OPCODE_LD_VX_KK, 0x0, 0x6, 0x0, 0x60, 0x060, 0x6060});
+        Handlers::tickTimers(core);
+        // 0x218: f015 Fx15
+        Handlers::LD_DT_VX(core, {OPCODE_LD_DT_VX, 0x0, 0x1, 0x5, 0x15, 0x015, 0xf015});
+        Handlers::tickTimers(core);
+        s.PC = 0x21a;
+        goto block_21a;
+    }
+
+block_21a:
+    {
+        if (count - done < 2)
+            return done;
+        done += 2;
+        // 0x21a: f007 Fx07
+        Handlers::LD_VX_DT(core, {OPCODE_LD_VX_DT, 0x0, 0x0, 0x7, 0x07, 0x007, 0xf007});
+        Handlers::tickTimers(core);
+        // 0x21c: 3000 3xkk
+        bool skip = s.V[0x0] == 0x00;
+        Handlers::tickTimers(core);
+        if (skip)
+        {
+            s.PC = 0x220;
+            goto block_220;
+        }
+        s.PC = 0x21e;
+        goto block_21e;
+    }
+
+block_21e:
+    {
+        if (count - done < 1)
+            return done;
+        done += 1;
+        // 0x21e: 121a 1nnn
+        Handlers::tickTimers(core);
+        s.PC = 0x21a;
+        goto block_21a;
+    }
+
+block_220:
+    {
+        if (count - done < 5)
+            return done;
+        done += 5;
+        // 0x220: c717 Cxkk
+        Handlers::RND(core, {OPCODE_RND, 0x7, 0x1, 0x7, 0x17, 0x717, 0xc717});
+        Handlers::tickTimers(core);
+        // 0x222: 7708 7xkk
+        Handlers::ADD_VX_KK(core, {OPCODE_ADD_VX_KK, 0x7, 0x0, 0x8, 0x08, 0x708, 0x7708});
+        Handlers::tickTimers(core);
+        // 0x224: 69ff 6xkk
+        Handlers::LD_VX_KK(core, {OPCODE_LD_VX_KK, 0x9, 0xf, 0xf, 0xff, 0x9ff, 0x69ff});
+        Handlers::tickTimers(core);
+        // 0x226: a2f0 Annn
+        Handlers::LD_I(core, {OPCODE_LD_I, 0x2, 0xf, 0x0, 0xf0, 0x2f0, 0xa2f0});
+        Handlers::tickTimers(core);
+        // 0x228: d671 Dxyn
+        Handlers::DRW(core, {OPCODE_DRW, 0x6, 0x7, 0x1, 0x71, 0x671, 0xd671});
+        Handlers::tickTimers(core);
+        s.PC = 0x22a;
+        goto block_22a;
+    }
+
+block_22a:
+    {
+        if (count - done < 5)
+            return done;
+        done += 5;
+        // 0x22a: a2ea Annn
+        Handlers::LD_I(core, {OPCODE_LD_I, 0x2, 0xe, 0xa, 0xea, 0x2ea, 0xa2ea});
+        Handlers::tickTimers(core);
+        // 0x22c: dab6 Dxyn
+        Handlers::DRW(core, {OPCODE_DRW, 0xa, 0xb, 0x6, 0xb6, 0xab6, 0xdab6});
+        Handlers::tickTimers(core);
+        // 0x22e: dcd6 Dxyn
+        Handlers::DRW(core, {OPCODE_DRW, 0xc, 0xd, 0x6, 0xd6, 0xcd6, 0xdcd6});
+        Handlers::tickTimers(core);
+        // 0x230: 6001 6xkk
+        Handlers::LD_VX_KK(core, {OPCODE_LD_VX_KK, 0x0, 0x0, 0x1, 0x01, 0x001, 0x6001});
+        Handlers::tickTimers(core);
+        // 0x232: e0a1 ExA1
+        bool skip = s.keys[s.V[0x0] & 0x0f] == 0;
+        Handlers::tickTimers(core);
+        if (skip)
+        {
+            s.PC = 0x236;
+            goto block_236;
+        }
+        s.PC = 0x234;
+        goto block_234;
+    }
+
+block_234:
+    {
+        if (count - done < 1)
+            return done;
+        done += 1;
+        // 0x234: 7bfe 7xkk
+        Handlers::ADD_VX_KK(core, {OPCODE_ADD_VX_KK, 0xb, 0xf, 0xe, 0xfe, 0xbfe, 0x7bfe});
+        Handlers::tickTimers(core);
+        s.PC = 0x236;
+        goto block_236;
+    }
+
+block_236:
+    {
+        if (count - done < 2)
+            return done;
+        done += 2;
+        // 0x236: 6004 6xkk
+        Handlers::LD_VX_KK(core, {OPCODE_LD_VX_KK, 0x0, 0x0, 0x4, 0x04, 0x004, 0x6004});
+        Handlers::tickTimers(core);
+        // 0x238: e0a1 ExA1
+        bool skip = s.keys[s.V[0x0] & 0x0f] == 0;
+        Handlers::tickTimers(core);
+        if (skip)
+        {
+            s.PC = 0x23c;
+            goto block_23c;
+        }
+        s.PC = 0x23a;
+        goto block_23a;
+    }
+
+block_23a:
+    {
+        if (count - done < 1)
+            return done;
+        done += 1;
+        // 0x23a: 7b02 7xkk
+        Handlers::ADD_VX_KK(core, {OPCODE_ADD_VX_KK, 0xb, 0x0, 0x2, 0x02, 0xb02, 0x7b02});
+        Handlers::tickTimers(core);
+        s.PC = 0x23c;
+        goto block_23c;
+    }
+
+block_23c:
+    {
+        if (count - done < 5)
+            return done;
+        done += 5;
+        // 0x23c: 601f 6xkk
+        Handlers::LD_VX_KK(core, {OPCODE_LD_VX_KK, 0x0, 0x1, 0xf, 0x1f, 0x01f, 0x601f});
+        Handlers::tickTimers(core);
+        // 0x23e: 8b02 8xy2
+        Handlers::AND(core, {OPCODE_AND, 0xb, 0x0, 0x2, 0x02, 0xb02, 0x8b02});
+        Handlers::tickTimers(core);
+        // 0x240: dab6 Dxyn
+        Handlers::DRW(core, {OPCODE_DRW, 0xa, 0xb, 0x6, 0xb6, 0xab6, 0xdab6});
+        Handlers::tickTimers(core);
+        // 0x242: 600c 6xkk
+        Handlers::LD_VX_KK(core, {OPCODE_LD_VX_KK, 0x0, 0x0, 0xc, 0x0c, 0x00c, 0x600c});
+        Handlers::tickTimers(core);
+        // 0x244: e0a1 ExA1
+        bool skip = s.keys[s.V[0x0] & 0x0f] == 0;
+        Handlers::tickTimers(core);
+        if (skip)
+        {
+            s.PC = 0x248;
+            goto block_248;
+        }
+        s.PC = 0x246;
+        goto block_246;
+    }
+
+block_246:
+    {
+        if (count - done < 1)
+            return done;
+        done += 1;
+        // 0x246: 7dfe 7xkk
+        Handlers::ADD_VX_KK(core, {OPCODE_ADD_VX_KK, 0xd, 0xf, 0xe, 0xfe, 0xdfe, 0x7dfe});
+        Handlers::tickTimers(core);
+        s.PC = 0x248;
+        goto block_248;
+    }
+
+block_248:
+    {
+        if (count - done < 2)
+            return done;
+        done += 2;
+        // 0x248: 600d 6xkk
+        Handlers::LD_VX_KK(core, {OPCODE_LD_VX_KK, 0x0, 0x0, 0xd, 0x0d, 0x00d, 0x600d});
+        Handlers::tickTimers(core);
+        // 0x24a: e0a1 ExA1
+        bool skip = s.keys[s.V[0x0] & 0x0f] == 0;
+        Handlers::tickTimers(core);
+        if (skip)
+        {
+            s.PC = 0x24e;
+            goto block_24e;
+        }
+        s.PC = 0x24c;
+        goto block_24c;
+    }
+
+block_24c:
+    {
+        if (count - done < 1)
+            return done;
+        done += 1;
+        // 0x24c: 7d02 7xkk
+        Handlers::ADD_VX_KK(core, {OPCODE_ADD_VX_KK, 0xd, 0x0, 0x2, 0x02, 0xd02, 0x7d02});
+        Handlers::tickTimers(core);
+        s.PC = 0x24e;
+        goto block_24e;
+    }
+
+block_24e:
+    {
+        if (count - done < 12)
+            return done;
+        done += 12;
+        // 0x24e: 601f 6xkk
+        Handlers::LD_VX_KK(core, {OPCODE_LD_VX_KK, 0x0, 0x1, 0xf, 0x1f, 0x01f, 0x601f});
+        Handlers::tickTimers(core);
+        // 0x250: 8d02 8xy2
+        Handlers::AND(core, {OPCODE_AND, 0xd, 0x0, 0x2, 0x02, 0xd02, 0x8d02});
+        Handlers::tickTimers(core);
+        // 0x252: dcd6 Dxyn
+        Handlers::DRW(core, {OPCODE_DRW, 0xc, 0xd, 0x6, 0xd6, 0xcd6, 0xdcd6});
+        Handlers::tickTimers(core);
+        // 0x254: a2f0 Annn
+        Handlers::LD_I(core, {OPCODE_LD_I, 0x2, 0xf, 0x0, 0xf0, 0x2f0, 0xa2f0});
+        Handlers::tickTimers(core);
+        // 0x256: d671 Dxyn
+        Handlers::DRW(core, {OPCODE_DRW, 0x6, 0x7, 0x1, 0x71, 0x671, 0xd671});
+        Handlers::tickTimers(core);
+        // 0x258: 8684 8xy4
+        Handlers::ADD_VX_VY(core, {OPCODE_ADD_VX_VY, 0x6, 0x8, 0x4, 0x84, 0x684, 0x8684});
+        Handlers::tickTimers(core);
+        // 0x25a: 8794 8xy4
+        Handlers::ADD_VX_VY(core, {OPCODE_ADD_VX_VY, 0x7, 0x9, 0x4, 0x94, 0x794, 0x8794});
+        Handlers::tickTimers(core);
+        // 0x25c: 603f 6xkk
+        Handlers::LD_VX_KK(core, {OPCODE_LD_VX_KK, 0x0, 0x3, 0xf, 0x3f, 0x03f, 0x603f});
+        Handlers::tickTimers(core);
+        // 0x25e: 8602 8xy2
+        Handlers::AND(core, {OPCODE_AND, 0x6, 0x0, 0x2, 0x02, 0x602, 0x8602});
+        Handlers::tickTimers(core);
+        // 0x260: 611f 6xkk
+        Handlers::LD_VX_KK(core, {OPCODE_LD_VX_KK, 0x1, 0x1, 0xf, 0x1f, 0x11f, 0x611f});
+        Handlers::tickTimers(core);
+        // 0x262: 8712 8xy2
+        Handlers::AND(core, {OPCODE_AND, 0x7, 0x1, 0x2, 0x12, 0x712, 0x8712});
+        Handlers::tickTimers(core);
+        // 0x264: 4602 4xkk
+        bool skip = s.V[0x6] != 0x02;
+        Handlers::tickTimers(core);
+        if (skip)
+        {
+            s.PC = 0x268;
+            goto block_268;
+        }
+        s.PC = 0x266;
+        goto block_266;
+    }
+
+block_266:
+    {
+        if (count - done < 1)
+            return done;
+        done += 1;
+        // 0x266: 1278 1nnn
+        Handlers::tickTimers(core);
+        s.PC = 0x278;
+        goto block_278;
+    }
+
+block_268:
+    {
+        if (count - done < 1)
+            return done;
+        done += 1;
+        // 0x268: 463f 4xkk
+        bool skip = s.V[0x6] != 0x3f;
+        Handlers::tickTimers(core);
+        if (skip)
+        {
+            s.PC = 0x26c;
+            goto block_26c;
+        }
+        s.PC = 0x26a;
+        goto block_26a;
+    }
+
+block_26a:
+    {
+        if (count - done < 1)
+            return done;
+        done += 1;
+        // 0x26a: 1282 1nnn
+        Handlers::tickTimers(core);
+        s.PC = 0x282;
+        goto block_282;
+    }
+
+block_26c:
+    {
+        if (count - done < 1)
+            return done;
+        done += 1;
+        // 0x26c: 471f 4xkk
+        bool skip = s.V[0x7] != 0x1f;
+        Handlers::tickTimers(core);
+        if (skip)
+        {
+            s.PC = 0x270;
+            goto block_270;
+        }
+        s.PC = 0x26e;
+        goto block_26e;
+    }
+
+block_26e:
+    {
+        if (count - done < 1)
+            return done;
+        done += 1;
+        // 0x26e: 69ff 6xkk
+        Handlers::LD_VX_KK(core, {OPCODE_LD_VX_KK, 0x9, 0xf, 0xf, 0xff, 0x9ff, 0x69ff});
+        Handlers::tickTimers(core);
+        s.PC = 0x270;
+        goto block_270;
+    }
+
+block_270:
+    {
+        if (count - done < 1)
+            return done;
+        done += 1;
+        // 0x270: 4700 4xkk
+        bool skip = s.V[0x7] != 0x00;
+        Handlers::tickTimers(core);
+        if (skip)
+        {
+            s.PC = 0x274;
+            goto block_274;
+        }
+        s.PC = 0x272;
+        goto block_272;
+    }
+
+block_272:
+    {
+        if (count - done < 1)
+            return done;
+        done += 1;
+        // 0x272: 6901 6xkk
+        Handlers::LD_VX_KK(core, {OPCODE_LD_VX_KK, 0x9, 0x0, 0x1, 0x01, 0x901, 0x6901});
+        Handlers::tickTimers(core);
+        s.PC = 0x274;
+        goto block_274;
+    }
+
+block_274:
+    {
+        if (count - done < 2)
+            return done;
+        done += 2;
+        // 0x274: d671 Dxyn
+        Handlers::DRW(core, {OPCODE_DRW, 0x6, 0x7, 0x1, 0x71, 0x671, 0xd671});
+        Handlers::tickTimers(core);
+        // 0x276: 122a 1nnn
+        Handlers::tickTimers(core);
+        s.PC = 0x22a;
+        goto block_22a;
+    }
+
+block_278:
+    {
+        if (count - done < 5)
+            return done;
+        done += 5;
+        // 0x278: 6802 6xkk
+        Handlers::LD_VX_KK(core, {OPCODE_LD_VX_KK, 0x8, 0x0, 0x2, 0x02, 0x802, 0x6802});
+        Handlers::tickTimers(core);
+        // 0x27a: 6301 6xkk
+        Handlers::LD_VX_KK(core, {OPCODE_LD_VX_KK, 0x3, 0x0, 0x1, 0x01, 0x301, 0x6301});
+        Handlers::tickTimers(core);
+        // 0x27c: 8070 8xy0
+        Handlers::LD_VX_VY(core, {OPCODE_LD_VX_VY, 0x0, 0x7, 0x0, 0x70, 0x070, 0x8070});
+        Handlers::tickTimers(core);
+        // 0x27e: 80b5 8xy5
+        Handlers::SUB(core, {OPCODE_SUB, 0x0, 0xb, 0x5, 0xb5, 0x0b5, 0x80b5});
+        Handlers::tickTimers(core);
+        // 0x280: 128a 1nnn
+        Handlers::tickTimers(core);
+        s.PC = 0x28a;
+        goto block_28a;
+    }
+
+block_282:
+    {
+        if (count - done < 4)
+            return done;
+        done += 4;
+        // 0x282: 68fe 6xkk
+        Handlers::LD_VX_KK(core, {OPCODE_LD_VX_KK, 0x8, 0xf, 0xe, 0xfe, 0x8fe, 0x68fe});
+        Handlers::tickTimers(core);
+        // 0x284: 630a 6xkk
+        Handlers::LD_VX_KK(core, {OPCODE_LD_VX_KK, 0x3, 0x0, 0xa, 0x0a, 0x30a, 0x630a});
+        Handlers::tickTimers(core);
+        // 0x286: 8070 8xy0
+        Handlers::LD_VX_VY(core, {OPCODE_LD_VX_VY, 0x0, 0x7, 0x0, 0x70, 0x070, 0x8070});
+        Handlers::tickTimers(core);
+        // 0x288: 80d5 8xy5
+        Handlers::SUB(core, {OPCODE_SUB, 0x0, 0xd, 0x5, 0xd5, 0x0d5, 0x80d5});
+        Handlers::tickTimers(core);
+        s.PC = 0x28a;
+        goto block_28a;
+    }
+
+block_28a:
+    {
+        if (count - done < 1)
+            return done;
+        done += 1;
+        // 0x28a: 3f01 3xkk
+        bool skip = s.V[0xf] == 0x01;
+        Handlers::tickTimers(core);
+        if (skip)
+        {
+            s.PC = 0x28e;
+            goto block_28e;
+        }
+        s.PC = 0x28c;
+        goto block_28c;
+    }
+
+block_28c:
+    {
+        if (count - done < 1)
+            return done;
+        done += 1;
+        // 0x28c: 12a2 1nnn
+        Handlers::tickTimers(core);
+        s.PC = 0x2a2;
+        goto block_2a2;
+    }
+
+block_28e:
+    {
+        if (count - done < 3)
+            return done;
+        done += 3;
+        // 0x28e: 6102 6xkk
+        Handlers::LD_VX_KK(core, {OPCODE_LD_VX_KK, 0x1, 0x0, 0x2, 0x02, 0x102, 0x6102});
+        Handlers::tickTimers(core);
+        // 0x290: 8015 8xy5
+        Handlers::SUB(core, {OPCODE_SUB, 0x0, 0x1, 0x5, 0x15, 0x015, 0x8015});
+        Handlers::tickTimers(core);
+        // 0x292: 3f01 3xkk
+        bool skip = s.V[0xf] == 0x01;
+        Handlers::tickTimers(core);
+        if (skip)
+        {
+            s.PC = 0x296;
+            goto block_296;
+        }
+        s.PC = 0x294;
+        goto block_294;
+    }
+
+block_294:
+    {
+        if (count - done < 1)
+            return done;
+        done += 1;
+        // 0x294: 12ba 1nnn
+        Handlers::tickTimers(core);
+        s.PC = 0x2ba;
+        goto block_2ba;
+    }
+
+block_296:
+    {
+        if (count - done < 2)
+            return done;
+        done += 2;
+        // 0x296: 8015 8xy5
+        Handlers::SUB(core, {OPCODE_SUB, 0x0, 0x1, 0x5, 0x15, 0x015, 0x8015});
+        Handlers::tickTimers(core);
+        // 0x298: 3f01 3xkk
+        bool skip = s.V[0xf] == 0x01;
+        Handlers::tickTimers(core);
+        if (skip)
+        {
+            s.PC = 0x29c;
+            goto block_29c;
+        }
+        s.PC = 0x29a;
+        goto block_29a;
+    }
+
+block_29a:
+    {
+        if (count - done < 1)
+            return done;
+        done += 1;
+        // 0x29a: 12c8 1nnn
+        Handlers::tickTimers(core);
+        s.PC = 0x2c8;
+        goto block_2c8;
+    }
+
+block_29c:
+    {
+        if (count - done < 2)
+            return done;
+        done += 2;
+        // 0x29c: 8015 8xy5
+        Handlers::SUB(core, {OPCODE_SUB, 0x0, 0x1, 0x5, 0x15, 0x015, 0x8015});
+        Handlers::tickTimers(core);
+        // 0x29e: 3f01 3xkk
+        bool skip = s.V[0xf] == 0x01;
+        Handlers::tickTimers(core);
+        if (skip)
+        {
+            s.PC = 0x2a2;
+            goto block_2a2;
+        }
+        s.PC = 0x2a0;
+        goto block_2a0;
+    }
+
+block_2a0:
+    {
+        if (count - done < 1)
+            return done;
+        done += 1;
+        // 0x2a0: 12c2 1nnn
+        Handlers::tickTimers(core);
+        s.PC = 0x2c2;
+        goto block_2c2;
+    }
+
+block_2a2:
+    {
+        if (count - done < 3)
+            return done;
+        done += 3;
+        // 0x2a2: 6020 6xkk
+        Handlers::LD_VX_KK(core, {OPCODE_LD_VX_KK, 0x0, 0x2, 0x0, 0x20, 0x020, 0x6020});
+        Handlers::tickTimers(core);
+        // 0x2a4: f018 Fx18
+        Handlers::LD_ST_VX(core, {OPCODE_LD_ST_VX, 0x0, 0x1, 0x8, 0x18, 0x018, 0xf018});
+        Handlers::tickTimers(core);
+        // 0x2a6: 22d4 2nnn
+        s.PC = 0x2a8;
+        Handlers::CALL(core, {OPCODE_CALL, 0x2, 0xd, 0x4, 0xd4, 0x2d4, 0x22d4});
+        Handlers::tickTimers(core);
+        if (core.hasQuit())
+            return done;
+        s.PC = 0x2d4;
+        goto block_2d4;
+    }
+
+block_2a8:
+    {
+        if (count - done < 2)
+            return done;
+        done += 2;
+        // 0x2a8: 8e34 8xy4
+        Handlers::ADD_VX_VY(core, {OPCODE_ADD_VX_VY, 0xe, 0x3, 0x4, 0x34, 0xe34, 0x8e34});
+        Handlers::tickTimers(core);
+        // 0x2aa: 22d4 2nnn
+        s.PC = 0x2ac;
+        Handlers::CALL(core, {OPCODE_CALL, 0x2, 0xd, 0x4, 0xd4, 0x2d4, 0x22d4});
+        Handlers::tickTimers(core);
+        if (core.hasQuit())
+            return done;
+        s.PC = 0x2d4;
+        goto block_2d4;
+    }
+
+block_2ac:
+    {
+        if (count - done < 2)
+            return done;
+        done += 2;
+        // 0x2ac: 663e 6xkk
+        Handlers::LD_VX_KK(core, {OPCODE_LD_VX_KK, 0x6, 0x3, 0xe, 0x3e, 0x63e, 0x663e});
+        Handlers::tickTimers(core);
+        // 0x2ae: 3301 3xkk
+        bool skip = s.V[0x3] == 0x01;
+        Handlers::tickTimers(core);
+        if (skip)
+        {
+            s.PC = 0x2b2;
+            goto block_2b2;
+        }
+        s.PC = 0x2b0;
+        goto block_2b0;
+    }
+
+block_2b0:
+    {
+        if (count - done < 1)
+            return done;
+        done += 1;
+        // 0x2b0: 6603 6xkk
+        Handlers::LD_VX_KK(core, {OPCODE_LD_VX_KK, 0x6, 0x0, 0x3, 0x03, 0x603, 0x6603});
+        Handlers::tickTimers(core);
+        s.PC = 0x2b2;
+        goto block_2b2;
+    }
+
+block_2b2:
+    {
+        if (count - done < 2)
+            return done;
+        done += 2;
+        // 0x2b2: 68fe 6xkk
+        Handlers::LD_VX_KK(core, {OPCODE_LD_VX_KK, 0x8, 0xf, 0xe, 0xfe, 0x8fe, 0x68fe});
+        Handlers::tickTimers(core);
+        // 0x2b4: 3301 3xkk
+        bool skip = s.V[0x3] == 0x01;
+        Handlers::tickTimers(core);
+        if (skip)
+        {
+            s.PC = 0x2b8;
+            goto block_2b8;
+        }
+        s.PC = 0x2b6;
+        goto block_2b6;
+    }
+
+block_2b6:
+    {
+        if (count - done < 1)
+            return done;
+        done += 1;
+        // 0x2b6: 6802 6xkk
+        Handlers::LD_VX_KK(core, {OPCODE_LD_VX_KK, 0x8, 0x0, 0x2, 0x02, 0x802, 0x6802});
+        Handlers::tickTimers(core);
+        s.PC = 0x2b8;
+        goto block_2b8;
+    }
+
+block_2b8:
+    {
+        if (count - done < 1)
+            return done;
+        done += 1;
+        // 0x2b8: 1216 1nnn
+        Handlers::tickTimers(core);
+        s.PC = 0x216;
+        goto block_216;
+    }
+
+block_2ba:
+    {
+        if (count - done < 2)
+            return done;
+        done += 2;
+        // 0x2ba: 79ff 7xkk
+        Handlers::ADD_VX_KK(core, {OPCODE_ADD_VX_KK, 0x9, 0xf, 0xf, 0xff, 0x9ff, 0x79ff});
+        Handlers::tickTimers(core);
+        // 0x2bc: 49fe 4xkk
+        bool skip = s.V[0x9] != 0xfe;
+        Handlers::tickTimers(core);
+        if (skip)
+        {
+            s.PC = 0x2c0;
+            goto block_2c0;
+        }
+        s.PC = 0x2be;
+        goto block_2be;
+    }
+
+block_2be:
+    {
+        if (count - done < 1)
+            return done;
+        done += 1;
+        // 0x2be: 69ff 6xkk
+        Handlers::LD_VX_KK(core, {OPCODE_LD_VX_KK, 0x9, 0xf, 0xf, 0xff, 0x9ff, 0x69ff});
+        Handlers::tickTimers(core);
+        s.PC = 0x2c0;
+        goto block_2c0;
+    }
+
+block_2c0:
+    {
+        if (count - done < 1)
+            return done;
+        done += 1;
+        // 0x2c0: 12c8 1nnn
+        Handlers::tickTimers(core);
+        s.PC = 0x2c8;
+        goto block_2c8;
+    }
+
+block_2c2:
+    {
+        if (count - done < 2)
+            return done;
+        done += 2;
+        // 0x2c2: 7901 7xkk
+        Handlers::ADD_VX_KK(core, {OPCODE_ADD_VX_KK, 0x9, 0x0, 0x1, 0x01, 0x901, 0x7901});
+        Handlers::tickTimers(core);
+        // 0x2c4: 4902 4xkk
+        bool skip = s.V[0x9] != 0x02;
+        Handlers::tickTimers(core);
+        if (skip)
+        {
+            s.PC = 0x2c8;
+            goto block_2c8;
+        }
+        s.PC = 0x2c6;
+        goto block_2c6;
+    }
+
+block_2c6:
+    {
+        if (count - done < 1)
+            return done;
+        done += 1;
+        // 0x2c6: 6901 6xkk
+        Handlers::LD_VX_KK(core, {OPCODE_LD_VX_KK, 0x9, 0x0, 0x1, 0x01, 0x901, 0x6901});
+        Handlers::tickTimers(core);
+        s.PC = 0x2c8;
+        goto block_2c8;
+    }
+
+block_2c8:
+    {
+        if (count - done < 4)
+            return done;
+        done += 4;
+        // 0x2c8: 6004 6xkk
+        Handlers::LD_VX_KK(core, {OPCODE_LD_VX_KK, 0x0, 0x0, 0x4, 0x04, 0x004, 0x6004});
+        Handlers::tickTimers(core);
+        // 0x2ca: f018 Fx18
+        Handlers::LD_ST_VX(core, {OPCODE_LD_ST_VX, 0x0, 0x1, 0x8, 0x18, 0x018, 0xf018});
+        Handlers::tickTimers(core);
+        // 0x2cc: 7601 7xkk
+        Handlers::ADD_VX_KK(core, {OPCODE_ADD_VX_KK, 0x6, 0x0, 0x1, 0x01, 0x601, 0x7601});
+        Handlers::tickTimers(core);
+        // 0x2ce: 4640 4xkk
+        bool skip = s.V[0x6] != 0x40;
+        Handlers::tickTimers(core);
+        if (skip)
+        {
+            s.PC = 0x2d2;
+            goto block_2d2;
+        }
+        s.PC = 0x2d0;
+        goto block_2d0;
+    }
+
+block_2d0:
+    {
+        if (count - done < 1)
+            return done;
+        done += 1;
+        // 0x2d0: 76fe 7xkk
+        Handlers::ADD_VX_KK(core, {OPCODE_ADD_VX_KK, 0x6, 0xf, 0xe, 0xfe, 0x6fe, 0x76fe});
+        Handlers::tickTimers(core);
+        s.PC = 0x2d2;
+        goto block_2d2;
+    }
+
+block_2d2:
+    {
+        if (count - done < 1)
+            return done;
+        done += 1;
+        // 0x2d2: 126c 1nnn
+        Handlers::tickTimers(core);
+        s.PC = 0x26c;
+        goto block_26c;
+    }
+
+block_2d4:
+    {
+        if (count - done < 11)
+            return done;
+        done += 11;
+        // 0x2d4: a2f2 Annn
+        Handlers::LD_I(core, {OPCODE_LD_I, 0x2, 0xf, 0x2, 0xf2, 0x2f2, 0xa2f2});
+        Handlers::tickTimers(core);
+        // 0x2d6: fe33 Fx33
+        s.PC = 0x2d8;
+        Handlers::LD_B_VX(core, {OPCODE_LD_B_VX, 0xe, 0x3, 0x3, 0x33, 0xe33, 0xfe33});
+        Handlers::tickTimers(core);
+        if (core.isCompiledCodeStale())
+            return done - 9;
+        // 0x2d8: f265 Fx65
+        Handlers::LD_VX_I(core, {OPCODE_LD_VX_I, 0x2, 0x6, 0x5, 0x65, 0x265, 0xf265});
+        Handlers::tickTimers(core);
+        // 0x2da: f129 Fx29
+        Handlers::LD_F_VX(core, {OPCODE_LD_F_VX, 0x1, 0x2, 0x9, 0x29, 0x129, 0xf129});
+        Handlers::tickTimers(core);
+        // 0x2dc: 6414 6xkk
+        Handlers::LD_VX_KK(core, {OPCODE_LD_VX_KK, 0x4, 0x1, 0x4, 0x14, 0x414, 0x6414});
+        Handlers::tickTimers(core);
+        // 0x2de: 6500 6xkk
+        Handlers::LD_VX_KK(core, {OPCODE_LD_VX_KK, 0x5, 0x0, 0x0, 0x00, 0x500, 0x6500});
+        Handlers::tickTimers(core);
+        // 0x2e0: d455 Dxyn
+        Handlers::DRW(core, {OPCODE_DRW, 0x4, 0x5, 0x5, 0x55, 0x455, 0xd455});
+        Handlers::tickTimers(core);
+        // 0x2e2: 7415 7xkk
+        Handlers::ADD_VX_KK(core, {OPCODE_ADD_VX_KK, 0x4, 0x1, 0x5, 0x15, 0x415, 0x7415});
+        Handlers::tickTimers(core);
+        // 0x2e4: f229 Fx29
+        Handlers::LD_F_VX(core, {OPCODE_LD_F_VX, 0x2, 0x2, 0x9, 0x29, 0x229, 0xf229});
+        Handlers::tickTimers(core);
+        // 0x2e6: d455 Dxyn
+        Handlers::DRW(core, {OPCODE_DRW, 0x4, 0x5, 0x5, 0x55, 0x455, 0xd455});
+        Handlers::tickTimers(core);
+        // 0x2e8: 00ee 00EE
+        s.PC = 0x2ea;
+        Handlers::RET(core, {OPCODE_RET, 0x0, 0xe, 0xe, 0xee, 0x0ee, 0x00ee});
+        Handlers::tickTimers(core);
+        goto dispatch;
+    }
+
+dispatch:
+    if (core.hasQuit())
+        return done;
+    switch(s.PC)
+    {
+        case 0x200: goto block_200;
+        case 0x212: goto block_212;
+        case 0x216: goto block_216;
+        case 0x21a: goto block_21a;
+        case 0x21e: goto block_21e;
+        case 0x220: goto block_220;
+        case 0x22a: goto block_22a;
+        case 0x234: goto block_234;
+        case 0x236: goto block_236;
+        case 0x23a: goto block_23a;
+        case 0x23c: goto block_23c;
+        case 0x246: goto block_246;
+        case 0x248: goto block_248;
+        case 0x24c: goto block_24c;
+        case 0x24e: goto block_24e;
+        case 0x266: goto block_266;
+        case 0x268: goto block_268;
+        case 0x26a: goto block_26a;
+        case 0x26c: goto block_26c;
+        case 0x26e: goto block_26e;
+        case 0x270: goto block_270;
+        case 0x272: goto block_272;
+        case 0x274: goto block_274;
+        case 0x278: goto block_278;
+        case 0x282: goto block_282;
+        case 0x28a: goto block_28a;
+        case 0x28c: goto block_28c;
+        case 0x28e: goto block_28e;
+        case 0x294: goto block_294;
+        case 0x296: goto block_296;
+        case 0x29a: goto block_29a;
+        case 0x29c: goto block_29c;
+        case 0x2a0: goto block_2a0;
+        case 0x2a2: goto block_2a2;
+        case 0x2a8: goto block_2a8;
+        case 0x2ac: goto block_2ac;
+        case 0x2b0: goto block_2b0;
+        case 0x2b2: goto block_2b2;
+        case 0x2b6: goto block_2b6;
+        case 0x2b8: goto block_2b8;
+        case 0x2ba: goto block_2ba;
+        case 0x2be: goto block_2be;
+        case 0x2c0: goto block_2c0;
+        case 0x2c2: goto block_2c2;
+        case 0x2c6: goto block_2c6;
+        case 0x2c8: goto block_2c8;
+        case 0x2d0: goto block_2d0;
+        case 0x2d2: goto block_2d2;
+        case 0x2d4: goto block_2d4;
+    }
+    return done;
+}
+
+static const COMPILED_PROGRAM program = {
+    "PONG",
+    rom,
+    sizeof(rom),
+    {0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull,
+     0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull,
+     0xffffffffffffffffull, 0xffffffffffffffffull, 0xffffffffffffffffull, 0x000003ffffffffffull,
+     0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull,
+     0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull,
+     0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull,
+     0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull,
+     0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull,
+     0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull,
+     0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull,
+     0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull,
+     0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull,
+     0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull,
+     0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull,
+     0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull,
+     0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull},
+    &run,
+    0x0
+};
+
+static COMPILED_PROGRAM_REGISTRAR registrar(&program);
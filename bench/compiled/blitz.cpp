@@ -0,0 +1,1019 @@
+// Generated by tools/Recompiler from blitz.c8, do not edit
+#include "Chip8Core.h"
+#include "Compiled.h"
+#include "Handlers.h"
+
+static const u8 rom[] = {
+    0x12, 0x17, 0x42, 0x4c, 0x49, 0x54, 0x5a, 0x20, 0x42, 0x79, 0x20, 0x44, 0x61, 0x76, 0x69, 0x64,
+    0x20, 0x57, 0x49, 0x4e, 0x54, 0x45, 0x52, 0xa3, 0x41, 0x60, 0x04, 0x61, 0x09, 0x62, 0x0e, 0x67,
+    0x04, 0xd0, 0x1e, 0xf2, 0x1e, 0x70, 0x0c, 0x30, 0x40, 0x12, 0x21, 0xf0, 0x0a, 0x00, 0xe0, 0x22,
+    0xd9, 0xf0, 0x0a, 0x00, 0xe0, 0x8e, 0x70, 0xa3, 0x1e, 0x6b, 0x1f, 0xcc, 0x1f, 0x8c, 0xc4, 0xdc,
+    0xb2, 0x3f, 0x01, 0x12, 0x49, 0xdc, 0xb2, 0x12, 0x39, 0xca, 0x07, 0x7a, 0x01, 0x7b, 0xfe, 0xdc,
+    0xb2, 0x7a, 0xff, 0x3a, 0x00, 0x12, 0x4d, 0x7e, 0xff, 0x3e, 0x00, 0x12, 0x39, 0x6b, 0x00, 0x8c,
+    0x70, 0x6d, 0x00, 0x6e, 0x00, 0xa3, 0x1b, 0xdd, 0xe3, 0x3f, 0x00, 0x12, 0xc1, 0x3b, 0x00, 0x12,
+    0x81, 0x60, 0x05, 0xe0, 0x9e, 0x12, 0x87, 0x6b, 0x01, 0x88, 0xd0, 0x78, 0x02, 0x89, 0xe0, 0x79,
+    0x03, 0xa3, 0x1e, 0xd8, 0x91, 0x81, 0xf0, 0x60, 0x05, 0xf0, 0x15, 0xf0, 0x07, 0x30, 0x00, 0x12,
+    0x8b, 0x3b, 0x01, 0x12, 0xab, 0xa3, 0x1e, 0x31, 0x01, 0xd8, 0x91, 0x79, 0x01, 0x39, 0x20, 0x12,
+    0xab, 0x6b, 0x00, 0x31, 0x00, 0x7c, 0xff, 0x4c, 0x00, 0x12, 0xbb, 0xa3, 0x1b, 0xdd, 0xe3, 0x7d,
+    0x02, 0x3d, 0x40, 0x12, 0xb9, 0x6d, 0x00, 0x7e, 0x01, 0x12, 0x65, 0x00, 0xe0, 0x77, 0x02, 0x12,
+    0x2d, 0xa3, 0x1b, 0xdd, 0xe3, 0x60, 0x14, 0x61, 0x02, 0x62, 0x0b, 0xa3, 0x20, 0xd0, 0x1b, 0xf2,
+    0x1e, 0x70, 0x08, 0x30, 0x2c, 0x12, 0xcd, 0x12, 0xd7, 0x60, 0x0a, 0x61, 0x0d, 0x62, 0x05, 0xa3,
+    0x07, 0xd0, 0x15, 0xf2, 0x1e, 0x70, 0x08, 0x30, 0x2a, 0x12, 0xe1, 0x80, 0x70, 0x70, 0xfe, 0x80,
+    0x06, 0xa3, 0x87, 0xf0, 0x33, 0xf2, 0x65, 0x60, 0x2d, 0xf1, 0x29, 0x61, 0x0d, 0xd0, 0x15, 0x70,
+    0x05, 0xf2, 0x29, 0xd0, 0x15, 0x00, 0xee, 0x83, 0x82, 0x83, 0x82, 0xfb, 0xe8, 0x08, 0x88, 0x05,
+    0xe2, 0xbe, 0xa0, 0xb8, 0x20, 0x3e, 0x80, 0x80, 0x80, 0x80, 0xf8, 0x80, 0xf8, 0xfc, 0xc0, 0xc0,
+    0xf9, 0x81, 0xdb, 0xcb, 0xfb, 0x00, 0xfa, 0x8a, 0x9a, 0x99, 0xf8, 0xef, 0x2a, 0xe8, 0x29, 0x29,
+    0x00, 0x6f, 0x68, 0x2e, 0x4c, 0x8f, 0xbe, 0xa0, 0xb8, 0xb0, 0xbe, 0x00, 0xbe, 0x22, 0x3e, 0x34,
+    0xb2, 0xd8, 0xd8, 0x00, 0xc3, 0xc3, 0x00, 0xd8, 0xd8, 0x00, 0xc3, 0xc3, 0x00, 0xd8, 0xd8, 0xc0,
+    0xc0, 0x00, 0xc0, 0xc0, 0x00, 0xc0, 0xc0, 0x00, 0xc0, 0xc0, 0x00, 0xdb, 0xdb, 0xdb, 0xdb, 0x00,
+    0x18, 0x18, 0x00, 0x18, 0x18, 0x00, 0x18, 0x18, 0x00, 0xdb, 0xdb, 0xdb, 0xdb, 0x00, 0x18, 0x18,
+    0x00, 0x18, 0x18, 0x00, 0x18, 0x18, 0x00, 0x18, 0x18, 0xdb, 0xdb, 0x00, 0x03, 0x03, 0x00, 0x18,
+    0x18, 0x00, 0xc0, 0xc0, 0x00, 0xdb, 0xdb
+};
+
+static u32 run(Chip8Core& core, u32 count)
+{
+    CHIP8_STATE& s = core.getState();
+    u32 done = 0;
+    goto dispatch;
+
+block_200:
+    {
+        if (count - done < 1)
+            return done;
+        done += 1;
+        // 0x200: 1217 1nnn
+        Handlers::tickTimers(core);
+        s.PC = 0x217;
+        goto block_217;
+    }
+
+block_217:
+    {
+        if (count - done < 5)
+            return done;
+        done += 5;
+        // 0x217: a341 Annn
+        Handlers::LD_I(core, {OPCODE_LD_I, 0x3, 0x4, 0x1, 0x41, 0x341, 0xa341});
+        Handlers::tickTimers(core);
+        // 0x219: 6004 6xkk
+        Handlers::LD_VX_KK(core, {OPCODE_LD_VX_KK, 0x0, 0x0, 0x4, 0x04, 0x004, 0x6004});
+        Handlers::tickTimers(core);
+        // 0x21b: 6109 6xkk
+        Handlers::LD_VX_KK(core, {OPCODE_LD_VX_KK, 0x1, 0x0, 0x9, 0x09, 0x109, 0x6109});
+        Handlers::tickTimers(core);
+        // 0x21d: 620e 6xkk
+        Handlers::LD_VX_KK(core, {OPCODE_LD_VX_KK, 0x2, 0x0, 0xe, 0x0e, 0x20e, 0x620e});
+        Handlers::tickTimers(core);
+        // 0x21f: 6704 6xkk
+        Handlers::LD_VX_KK(core, {OPCODE_LD_VX_KK, 0x7, 0x0, 0x4, 0x04, 0x704, 0x6704});
+        Handlers::tickTimers(core);
+        s.PC = 0x221;
+        goto block_221;
+    }
+
+block_221:
+    {
+        if (count - done < 4)
+            return done;
+        done += 4;
+        // 0x221: d01e Dxyn
+        Handlers::DRW(core, {OPCODE_DRW, 0x0, 0x1, 0xe, 0x1e, 0x01e, 0xd01e});
+        Handlers::tickTimers(core);
+        // 0x223: f21e Fx1E
+        Handlers::ADD_I_VX(core, {OPCODE_ADD_I_VX, 0x2, 0x1, 0xe, 0x1e, 0x21e, 0xf21e});
+        Handlers::tickTimers(core);
+        // 0x225: 700c 7xkk
+        Handlers::ADD_VX_KK(core, {OPCODE_ADD_VX_KK, 0x0, 0x0, 0xc, 0x0c, 0x00c, 0x700c});
+        Handlers::tickTimers(core);
+        // 0x227: 3040 3xkk
+        bool skip = s.V[0x0] == 0x40;
+        Handlers::tickTimers(core);
+        if (skip)
+        {
+            s.PC = 0x22b;
+            goto block_22b;
+        }
+        s.PC = 0x229;
+        goto block_229;
+    }
+
+block_229:
+    {
+        if (count - done < 1)
+            return done;
+        done += 1;
+        // 0x229: 1221 1nnn
+        Handlers::tickTimers(core);
+        s.PC = 0x221;
+        goto block_221;
+    }
+
+block_22b:
+    {
+        if (count - done < 1)
+            return done;
+        done += 1;
+        // 0x22b: f00a Fx0A
+        s.PC = 0x22d;
+        Handlers::LD_VX_K(core, {OPCODE_LD_VX_K, 0x0, 0x0, 0xa, 0x0a, 0x00a, 0xf00a});
+        Handlers::tickTimers(core);
+        if (s.keyWait)
+            return done;
+        s.PC = 0x22d;
+        goto block_22d;
+    }
+
+block_22d:
+    {
+        if (count - done < 2)
+            return done;
+        done += 2;
+        // 0x22d: 00e0 00E0
+        Handlers::CLS(core, {OPCODE_CLS, 0x0, 0xe, 0x0, 0xe0, 0x0e0, 0x00e0});
+        Handlers::tickTimers(core);
+        // 0x22f: 22d9 2nnn
+        s.PC = 0x231;
+        Handlers::CALL(core, {OPCODE_CALL, 0x2, 0xd, 0x9, 0xd9, 0x2d9, 0x22d9});
+        Handlers::tickTimers(core);
+        if (core.hasQuit())
+            return done;
+        s.PC = 0x2d9;
+        goto block_2d9;
+    }
+
+block_231:
+    {
+        if (count - done < 1)
+            return done;
+        done += 1;
+        // 0x231: f00a Fx0A
+        s.PC = 0x233;
+        Handlers::LD_VX_K(core, {OPCODE_LD_VX_K, 0x0, 0x0, 0xa, 0x0a, 0x00a, 0xf00a});
+        Handlers::tickTimers(core);
+        if (s.keyWait)
+            return done;
+        s.PC = 0x233;
+        goto block_233;
+    }
+
+block_233:
+    {
+        if (count - done < 3)
+            return done;
+        done += 3;
+        // 0x233: 00e0 00E0
+        Handlers::CLS(core, {OPCODE_CLS, 0x0, 0xe, 0x0, 0xe0, 0x0e0, 0x00e0});
+        Handlers::tickTimers(core);
+        // 0x235: 8e70 8xy0
+        Handlers::LD_VX_VY(core, {OPCODE_LD_VX_VY, 0xe, 0x7, 0x0, 0x70, 0xe70, 0x8e70});
+        Handlers::tickTimers(core);
+        // 0x237: a31e Annn
+        Handlers::LD_I(core, {OPCODE_LD_I, 0x3, 0x1, 0xe, 0x1e, 0x31e, 0xa31e});
+        Handlers::tickTimers(core);
+        s.PC = 0x239;
+        goto block_239;
+    }
+
+block_239:
+    {
+        if (count - done < 5)
+            return done;
+        done += 5;
+        // 0x239: 6b1f 6xkk
+        Handlers::LD_VX_KK(core, {OPCODE_LD_VX_KK, 0xb, 0x1, 0xf, 0x1f, 0xb1f, 0x6b1f});
+        Handlers::tickTimers(core);
+        // 0x23b: cc1f Cxkk
+        Handlers::RND(core, {OPCODE_RND, 0xc, 0x1, 0xf, 0x1f, 0xc1f, 0xcc1f});
+        Handlers::tickTimers(core);
+        // 0x23d: 8cc4 8xy4
+        Handlers::ADD_VX_VY(core, {OPCODE_ADD_VX_VY, 0xc, 0xc, 0x4, 0xc4, 0xcc4, 0x8cc4});
+        Handlers::tickTimers(core);
+        // 0x23f: dcb2 Dxyn
+        Handlers::DRW(core, {OPCODE_DRW, 0xc, 0xb, 0x2, 0xb2, 0xcb2, 0xdcb2});
+        Handlers::tickTimers(core);
+        // 0x241: 3f01 3xkk
+        bool skip = s.V[0xf] == 0x01;
+        Handlers::tickTimers(core);
+        if (skip)
+        {
+            s.PC = 0x245;
+            goto block_245;
+        }
+        s.PC = 0x243;
+        goto block_243;
+    }
+
+block_243:
+    {
+        if (count - done < 1)
+            return done;
+        done += 1;
+        // 0x243: 1249 1nnn
+        Handlers::tickTimers(core);
+        s.PC = 0x249;
+        goto block_249;
+    }
+
+block_245:
+    {
+        if (count - done < 2)
+            return done;
+        done += 2;
+        // 0x245: dcb2 Dxyn
+        Handlers::DRW(core, {OPCODE_DRW, 0xc, 0xb, 0x2, 0xb2, 0xcb2, 0xdcb2});
+        Handlers::tickTimers(core);
+        // 0x247: 1239 1nnn
+        Handlers::tickTimers(core);
+        s.PC = 0x239;
+        goto block_239;
+    }
+
+block_249:
+    {
+        if (count - done < 2)
+            return done;
+        done += 2;
+        // 0x249: ca07 Cxkk
+        Handlers::RND(core, {OPCODE_RND, 0xa, 0x0, 0x7, 0x07, 0xa07, 0xca07});
+        Handlers::tickTimers(core);
+        // 0x24b: 7a01 7xkk
+        Handlers::ADD_VX_KK(core, {OPCODE_ADD_VX_KK, 0xa, 0x0, 0x1, 0x01, 0xa01, 0x7a01});
+        Handlers::tickTimers(core);
+        s.PC = 0x24d;
+        goto block_24d;
+    }
+
+block_24d:
+    {
+        if (count - done < 4)
+            return done;
+        done += 4;
+        // 0x24d: 7bfe 7xkk
+        Handlers::ADD_VX_KK(core, {OPCODE_ADD_VX_KK, 0xb, 0xf, 0xe, 0xfe, 0xbfe, 0x7bfe});
+        Handlers::tickTimers(core);
+        // 0x24f: dcb2 Dxyn
+        Handlers::DRW(core, {OPCODE_DRW, 0xc, 0xb, 0x2, 0xb2, 0xcb2, 0xdcb2});
+        Handlers::tickTimers(core);
+        // 0x251: 7aff 7xkk
+        Handlers::ADD_VX_KK(core, {OPCODE_ADD_VX_KK, 0xa, 0xf, 0xf, 0xff, 0xaff, 0x7aff});
+        Handlers::tickTimers(core);
+        // 0x253: 3a00 3xkk
+        bool skip = s.V[0xa] == 0x00;
+        Handlers::tickTimers(core);
+        if (skip)
+        {
+            s.PC = 0x257;
+            goto block_257;
+        }
+        s.PC = 0x255;
+        goto block_255;
+    }
+
+block_255:
+    {
+        if (count - done < 1)
+            return done;
+        done += 1;
+        // 0x255: 124d 1nnn
+        Handlers::tickTimers(core);
+        s.PC = 0x24d;
+        goto block_24d;
+    }
+
+block_257:
+    {
+        if (count - done < 2)
+            return done;
+        done += 2;
+        // 0x257: 7eff 7xkk
+        Handlers::ADD_VX_KK(core, {OPCODE_ADD_VX_KK, 0xe, 0xf, 0xf, 0xff, 0xeff, 0x7eff});
+        Handlers::tickTimers(core);
+        // 0x259: 3e00 3xkk
+        bool skip = s.V[0xe] == 0x00;
+        Handlers::tickTimers(core);
+        if (skip)
+        {
+            s.PC = 0x25d;
+            goto block_25d;
+        }
+        s.PC = 0x25b;
+        goto block_25b;
+    }
+
+block_25b:
+    {
+        if (count - done < 1)
+            return done;
+        done += 1;
+        // 0x25b: 1239 1nnn
+        Handlers::tickTimers(core);
+        s.PC = 0x239;
+        goto block_239;
+    }
+
+block_25d:
+    {
+        if (count - done < 4)
+            return done;
+        done += 4;
+        // 0x25d: 6b00 6xkk
+        Handlers::LD_VX_KK(core, {OPCODE_LD_VX_KK, 0xb, 0x0, 0x0, 0x00, 0xb00, 0x6b00});
+        Handlers::tickTimers(core);
+        // 0x25f: 8c70 8xy0
+        Handlers::LD_VX_VY(core, {OPCODE_LD_VX_VY, 0xc, 0x7, 0x0, 0x70, 0xc70, 0x8c70});
+        Handlers::tickTimers(core);
+        // 0x261: 6d00 6xkk
+        Handlers::LD_VX_KK(core, {OPCODE_LD_VX_KK, 0xd, 0x0, 0x0, 0x00, 0xd00, 0x6d00});
+        Handlers::tickTimers(core);
+        // 0x263: 6e00 6xkk
+        Handlers::LD_VX_KK(core, {OPCODE_LD_VX_KK, 0xe, 0x0, 0x0, 0x00, 0xe00, 0x6e00});
+        Handlers::tickTimers(core);
+        s.PC = 0x265;
+        goto block_265;
+    }
+
+block_265:
+    {
+        if (count - done < 3)
+            return done;
+        done += 3;
+        // 0x265: a31b Annn
+        Handlers::LD_I(core, {OPCODE_LD_I, 0x3, 0x1, 0xb, 0x1b, 0x31b, 0xa31b});
+        Handlers::tickTimers(core);
+        // 0x267: dde3 Dxyn
+        Handlers::DRW(core, {OPCODE_DRW, 0xd, 0xe, 0x3, 0xe3, 0xde3, 0xdde3});
+        Handlers::tickTimers(core);
+        // 0x269: 3f00 3xkk
+        bool skip = s.V[0xf] == 0x00;
+        Handlers::tickTimers(core);
+        if (skip)
+        {
+            s.PC = 0x26d;
+            goto block_26d;
+        }
+        s.PC = 0x26b;
+        goto block_26b;
+    }
+
+block_26b:
+    {
+        if (count - done < 1)
+            return done;
+        done += 1;
+        // 0x26b: 12c1 1nnn
+        Handlers::tickTimers(core);
+        s.PC = 0x2c1;
+        goto block_2c1;
+    }
+
+block_26d:
+    {
+        if (count - done < 1)
+            return done;
+        done += 1;
+        // 0x26d: 3b00 3xkk
+        bool skip = s.V[0xb] == 0x00;
+        Handlers::tickTimers(core);
+        if (skip)
+        {
+            s.PC = 0x271;
+            goto block_271;
+        }
+        s.PC = 0x26f;
+        goto block_26f;
+    }
+
+block_26f:
+    {
+        if (count - done < 1)
+            return done;
+        done += 1;
+        // 0x26f: 1281 1nnn
+        Handlers::tickTimers(core);
+        s.PC = 0x281;
+        goto block_281;
+    }
+
+block_271:
+    {
+        if (count - done < 2)
+            return done;
+        done += 2;
+        // 0x271: 6005 6xkk
+        Handlers::LD_VX_KK(core, {OPCODE_LD_VX_KK, 0x0, 0x0, 0x5, 0x05, 0x005, 0x6005});
+        Handlers::tickTimers(core);
+        // 0x273: e09e Ex9E
+        bool skip = s.keys[s.V[0x0] & 0x0f] != 0;
+        Handlers::tickTimers(core);
+        if (skip)
+        {
+            s.PC = 0x277;
+            goto block_277;
+        }
+        s.PC = 0x275;
+        goto block_275;
+    }
+
+block_275:
+    {
+        if (count - done < 1)
+            return done;
+        done += 1;
+        // 0x275: 1287 1nnn
+        Handlers::tickTimers(core);
+        s.PC = 0x287;
+        goto block_287;
+    }
+
+block_277:
+    {
+        if (count - done < 5)
+            return done;
+        done += 5;
+        // 0x277: 6b01 6xkk
+        Handlers::LD_VX_KK(core, {OPCODE_LD_VX_KK, 0xb, 0x0, 0x1, 0x01, 0xb01, 0x6b01});
+        Handlers::tickTimers(core);
+        // 0x279: 88d0 8xy0
+        Handlers::LD_VX_VY(core, {OPCODE_LD_VX_VY, 0x8, 0xd, 0x0, 0xd0, 0x8d0, 0x88d0});
+        Handlers::tickTimers(core);
+        // 0x27b: 7802 7xkk
+        Handlers::ADD_VX_KK(core, {OPCODE_ADD_VX_KK, 0x8, 0x0, 0x2, 0x02, 0x802, 0x7802});
+        Handlers::tickTimers(core);
+        // 0x27d: 89e0 8xy0
+        Handlers::LD_VX_VY(core, {OPCODE_LD_VX_VY, 0x9, 0xe, 0x0, 0xe0, 0x9e0, 0x89e0});
+        Handlers::tickTimers(core);
+        // 0x27f: 7903 7xkk
+        Handlers::ADD_VX_KK(core, {OPCODE_ADD_VX_KK, 0x9, 0x0, 0x3, 0x03, 0x903, 0x7903});
+        Handlers::tickTimers(core);
+        s.PC = 0x281;
+        goto block_281;
+    }
+
+block_281:
+    {
+        if (count - done < 3)
+            return done;
+        done += 3;
+        // 0x281: a31e Annn
+        Handlers::LD_I(core, {OPCODE_LD_I, 0x3, 0x1, 0xe, 0x1e, 0x31e, 0xa31e});
+        Handlers::tickTimers(core);
+        // 0x283: d891 Dxyn
+        Handlers::DRW(core, {OPCODE_DRW, 0x8, 0x9, 0x1, 0x91, 0x891, 0xd891});
+        Handlers::tickTimers(core);
+        // 0x285: 81f0 8xy0
+        Handlers::LD_VX_VY(core, {OPCODE_LD_VX_VY, 0x1, 0xf, 0x0, 0xf0, 0x1f0, 0x81f0});
+        Handlers::tickTimers(core);
+        s.PC = 0x287;
+        goto block_287;
+    }
+
+block_287:
+    {
+        if (count - done < 2)
+            return done;
+        done += 2;
+        // 0x287: 6005 6xkk
+        Handlers::LD_VX_KK(core, {OPCODE_LD_VX_KK, 0x0, 0x0, 0x5, 0x05, 0x005, 0x6005});
+        Handlers::tickTimers(core);
+        // 0x289: f015 Fx15
+        Handlers::LD_DT_VX(core, {OPCODE_LD_DT_VX, 0x0, 0x1, 0x5, 0x15, 0x015, 0xf015});
+        Handlers::tickTimers(core);
+        s.PC = 0x28b;
+        goto block_28b;
+    }
+
+block_28b:
+    {
+        if (count - done < 2)
+            return done;
+        done += 2;
+        // 0x28b: f007 Fx07
+        Handlers::LD_VX_DT(core, {OPCODE_LD_VX_DT, 0x0, 0x0, 0x7, 0x07, 0x007, 0xf007});
+        Handlers::tickTimers(core);
+        // 0x28d: 3000 3xkk
+        bool skip = s.V[0x0] == 0x00;
+        Handlers::tickTimers(core);
+        if (skip)
+        {
+            s.PC = 0x291;
+            goto block_291;
+        }
+        s.PC = 0x28f;
+        goto block_28f;
+    }
+
+block_28f:
+    {
+        if (count - done < 1)
+            return done;
+        done += 1;
+        // 0x28f: 128b 1nnn
+        Handlers::tickTimers(core);
+        s.PC = 0x28b;
+        goto block_28b;
+    }
+
+block_291:
+    {
+        if (count - done < 1)
+            return done;
+        done += 1;
+        // 0x291: 3b01 3xkk
+        bool skip = s.V[0xb] == 0x01;
+        Handlers::tickTimers(core);
+        if (skip)
+        {
+            s.PC = 0x295;
+            goto block_295;
+        }
+        s.PC = 0x293;
+        goto block_293;
+    }
+
+block_293:
+    {
+        if (count - done < 1)
+            return done;
+        done += 1;
+        // 0x293: 12ab 1nnn
+        Handlers::tickTimers(core);
+        s.PC = 0x2ab;
+        goto block_2ab;
+    }
+
+block_295:
+    {
+        if (count - done < 2)
+            return done;
+        done += 2;
+        // 0x295: a31e Annn
+        Handlers::LD_I(core, {OPCODE_LD_I, 0x3, 0x1, 0xe, 0x1e, 0x31e, 0xa31e});
+        Handlers::tickTimers(core);
+        // 0x297: 3101 3xkk
+        bool skip = s.V[0x1] == 0x01;
+        Handlers::tickTimers(core);
+        if (skip)
+        {
+            s.PC = 0x29b;
+            goto block_29b;
+        }
+        s.PC = 0x299;
+        goto block_299;
+    }
+
+block_299:
+    {
+        if (count - done < 1)
+            return done;
+        done += 1;
+        // 0x299: d891 Dxyn
+        Handlers::DRW(core, {OPCODE_DRW, 0x8, 0x9, 0x1, 0x91, 0x891, 0xd891});
+        Handlers::tickTimers(core);
+        s.PC = 0x29b;
+        goto block_29b;
+    }
+
+block_29b:
+    {
+        if (count - done < 2)
+            return done;
+        done += 2;
+        // 0x29b: 7901 7xkk
+        Handlers::ADD_VX_KK(core, {OPCODE_ADD_VX_KK, 0x9, 0x0, 0x1, 0x01, 0x901, 0x7901});
+        Handlers::tickTimers(core);
+        // 0x29d: 3920 3xkk
+        bool skip = s.V[0x9] == 0x20;
+        Handlers::tickTimers(core);
+        if (skip)
+        {
+            s.PC = 0x2a1;
+            goto block_2a1;
+        }
+        s.PC = 0x29f;
+        goto block_29f;
+    }
+
+block_29f:
+    {
+        if (count - done < 1)
+            return done;
+        done += 1;
+        // 0x29f: 12ab 1nnn
+        Handlers::tickTimers(core);
+        s.PC = 0x2ab;
+        goto block_2ab;
+    }
+
+block_2a1:
+    {
+        if (count - done < 2)
+            return done;
+        done += 2;
+        // 0x2a1: 6b00 6xkk
+        Handlers::LD_VX_KK(core, {OPCODE_LD_VX_KK, 0xb, 0x0, 0x0, 0x00, 0xb00, 0x6b00});
+        Handlers::tickTimers(core);
+        // 0x2a3: 3100 3xkk
+        bool skip = s.V[0x1] == 0x00;
+        Handlers::tickTimers(core);
+        if (skip)
+        {
+            s.PC = 0x2a7;
+            goto block_2a7;
+        }
+        s.PC = 0x2a5;
+        goto block_2a5;
+    }
+
+block_2a5:
+    {
+        if (count - done < 1)
+            return done;
+        done += 1;
+        // 0x2a5: 7cff 7xkk
+        Handlers::ADD_VX_KK(core, {OPCODE_ADD_VX_KK, 0xc, 0xf, 0xf, 0xff, 0xcff, 0x7cff});
+        Handlers::tickTimers(core);
+        s.PC = 0x2a7;
+        goto block_2a7;
+    }
+
+block_2a7:
+    {
+        if (count - done < 1)
+            return done;
+        done += 1;
+        // 0x2a7: 4c00 4xkk
+        bool skip = s.V[0xc] != 0x00;
+        Handlers::tickTimers(core);
+        if (skip)
+        {
+            s.PC = 0x2ab;
+            goto block_2ab;
+        }
+        s.PC = 0x2a9;
+        goto block_2a9;
+    }
+
+block_2a9:
+    {
+        if (count - done < 1)
+            return done;
+        done += 1;
+        // 0x2a9: 12bb 1nnn
+        Handlers::tickTimers(core);
+        s.PC = 0x2bb;
+        goto block_2bb;
+    }
+
+block_2ab:
+    {
+        if (count - done < 4)
+            return done;
+        done += 4;
+        // 0x2ab: a31b Annn
+        Handlers::LD_I(core, {OPCODE_LD_I, 0x3, 0x1, 0xb, 0x1b, 0x31b, 0xa31b});
+        Handlers::tickTimers(core);
+        // 0x2ad: dde3 Dxyn
+        Handlers::DRW(core, {OPCODE_DRW, 0xd, 0xe, 0x3, 0xe3, 0xde3, 0xdde3});
+        Handlers::tickTimers(core);
+        // 0x2af: 7d02 7xkk
+        Handlers::ADD_VX_KK(core, {OPCODE_ADD_VX_KK, 0xd, 0x0, 0x2, 0x02, 0xd02, 0x7d02});
+        Handlers::tickTimers(core);
+        // 0x2b1: 3d40 3xkk
+        bool skip = s.V[0xd] == 0x40;
+        Handlers::tickTimers(core);
+        if (skip)
+        {
+            s.PC = 0x2b5;
+            goto block_2b5;
+        }
+        s.PC = 0x2b3;
+        goto block_2b3;
+    }
+
+block_2b3:
+    {
+        if (count - done < 1)
+            return done;
+        done += 1;
+        // 0x2b3: 12b9 1nnn
+        Handlers::tickTimers(core);
+        s.PC = 0x2b9;
+        goto block_2b9;
+    }
+
+block_2b5:
+    {
+        if (count - done < 2)
+            return done;
+        done += 2;
+        // 0x2b5: 6d00 6xkk
+        Handlers::LD_VX_KK(core, {OPCODE_LD_VX_KK, 0xd, 0x0, 0x0, 0x00, 0xd00, 0x6d00});
+        Handlers::tickTimers(core);
+        // 0x2b7: 7e01 7xkk
+        Handlers::ADD_VX_KK(core, {OPCODE_ADD_VX_KK, 0xe, 0x0, 0x1, 0x01, 0xe01, 0x7e01});
+        Handlers::tickTimers(core);
+        s.PC = 0x2b9;
+        goto block_2b9;
+    }
+
+block_2b9:
+    {
+        if (count - done < 1)
+            return done;
+        done += 1;
+        // 0x2b9: 1265 1nnn
+        Handlers::tickTimers(core);
+        s.PC = 0x265;
+        goto block_265;
+    }
+
+block_2bb:
+    {
+        if (count - done < 3)
+            return done;
+        done += 3;
+        // 0x2bb: 00e0 00E0
+        Handlers::CLS(core, {OPCODE_CLS, 0x0, 0xe, 0x0, 0xe0, 0x0e0, 0x00e0});
+        Handlers::tickTimers(core);
+        // 0x2bd: 7702 7xkk
+        Handlers::ADD_VX_KK(core, {OPCODE_ADD_VX_KK, 0x7, 0x0, 0x2, 0x02, 0x702, 0x7702});
+        Handlers::tickTimers(core);
+        // 0x2bf: 122d 1nnn
+        Handlers::tickTimers(core);
+        s.PC = 0x22d;
+        goto block_22d;
+    }
+
+block_2c1:
+    {
+        if (count - done < 6)
+            return done;
+        done += 6;
+        // 0x2c1: a31b Annn
+        Handlers::LD_I(core, {OPCODE_LD_I, 0x3, 0x1, 0xb, 0x1b, 0x31b, 0xa31b});
+        Handlers::tickTimers(core);
+        // 0x2c3: dde3 Dxyn
+        Handlers::DRW(core, {OPCODE_DRW, 0xd, 0xe, 0x3, 0xe3, 0xde3, 0xdde3});
+        Handlers::tickTimers(core);
+        // 0x2c5: 6014 6xkk
+        Handlers::LD_VX_KK(core, {OPCODE_LD_VX_KK, 0x0, 0x1, 0x4, 0x14, 0x014, 0x6014});
+        Handlers::tickTimers(core);
+        // 0x2c7: 6102 6xkk
+        Handlers::LD_VX_KK(core, {OPCODE_LD_VX_KK, 0x1, 0x0, 0x2, 0x02, 0x102, 0x6102});
+        Handlers::tickTimers(core);
+        // 0x2c9: 620b 6xkk
+        Handlers::LD_VX_KK(core, {OPCODE_LD_VX_KK, 0x2, 0x0, 0xb, 0x0b, 0x20b, 0x620b});
+        Handlers::tickTimers(core);
+        // 0x2cb: a320 Annn
+        Handlers::LD_I(core, {OPCODE_LD_I, 0x3, 0x2, 0x0, 0x20, 0x320, 0xa320});
+        Handlers::tickTimers(core);
+        s.PC = 0x2cd;
+        goto block_2cd;
+    }
+
+block_2cd:
+    {
+        if (count - done < 4)
+            return done;
+        done += 4;
+        // 0x2cd: d01b Dxyn
+        Handlers::DRW(core, {OPCODE_DRW, 0x0, 0x1, 0xb, 0x1b, 0x01b, 0xd01b});
+        Handlers::tickTimers(core);
+        // 0x2cf: f21e Fx1E
+        Handlers::ADD_I_VX(core, {OPCODE_ADD_I_VX, 0x2, 0x1, 0xe, 0x1e, 0x21e, 0xf21e});
+        Handlers::tickTimers(core);
+        // 0x2d1: 7008 7xkk
+        Handlers::ADD_VX_KK(core, {OPCODE_ADD_VX_KK, 0x0, 0x0, 0x8, 0x08, 0x008, 0x7008});
+        Handlers::tickTimers(core);
+        // 0x2d3: 302c 3xkk
+        bool skip = s.V[0x0] == 0x2c;
+        Handlers::tickTimers(core);
+        if (skip)
+        {
+            s.PC = 0x2d7;
+            goto block_2d7;
+        }
+        s.PC = 0x2d5;
+        goto block_2d5;
+    }
+
+block_2d5:
+    {
+        if (count - done < 1)
+            return done;
+        done += 1;
+        // 0x2d5: 12cd 1nnn
+        Handlers::tickTimers(core);
+        s.PC = 0x2cd;
+        goto block_2cd;
+    }
+
+block_2d7:
+    {
+        if (count - done < 1)
+            return done;
+        done += 1;
+        // 0x2d7: 12d7 1nnn
+        Handlers::tickTimers(core);
+        s.PC = 0x2d7;
+        goto block_2d7;
+    }
+
+block_2d9:
+    {
+        if (count - done < 4)
+            return done;
+        done += 4;
+        // 0x2d9: 600a 6xkk
+        Handlers::LD_VX_KK(core, {OPCODE_LD_VX_KK, 0x0, 0x0, 0xa, 0x0a, 0x00a, 0x600a});
+        Handlers::tickTimers(core);
+        // 0x2db: 610d 6xkk
+        Handlers::LD_VX_KK(core, {OPCODE_LD_VX_KK, 0x1, 0x0, 0xd, 0x0d, 0x10d, 0x610d});
+        Handlers::tickTimers(core);
+        // 0x2dd: 6205 6xkk
+        Handlers::LD_VX_KK(core, {OPCODE_LD_VX_KK, 0x2, 0x0, 0x5, 0x05, 0x205, 0x6205});
+        Handlers::tickTimers(core);
+        // 0x2df: a307 Annn
+        Handlers::LD_I(core, {OPCODE_LD_I, 0x3, 0x0, 0x7, 0x07, 0x307, 0xa307});
+        Handlers::tickTimers(core);
+        s.PC = 0x2e1;
+        goto block_2e1;
+    }
+
+block_2e1:
+    {
+        if (count - done < 4)
+            return done;
+        done += 4;
+        // 0x2e1: d015 Dxyn
+        Handlers::DRW(core, {OPCODE_DRW, 0x0, 0x1, 0x5, 0x15, 0x015, 0xd015});
+        Handlers::tickTimers(core);
+        // 0x2e3: f21e Fx1E
+        Handlers::ADD_I_VX(core, {OPCODE_ADD_I_VX, 0x2, 0x1, 0xe, 0x1e, 0x21e, 0xf21e});
+        Handlers::tickTimers(core);
+        // 0x2e5: 7008 7xkk
+        Handlers::ADD_VX_KK(core, {OPCODE_ADD_VX_KK, 0x0, 0x0, 0x8, 0x08, 0x008, 0x7008});
+        Handlers::tickTimers(core);
+        // 0x2e7: 302a 3xkk
+        bool skip = s.V[0x0] == 0x2a;
+        Handlers::tickTimers(core);
+        if (skip)
+        {
+            s.PC = 0x2eb;
+            goto block_2eb;
+        }
+        s.PC = 0x2e9;
+        goto block_2e9;
+    }
+
+block_2e9:
+    {
+        if (count - done < 1)
+            return done;
+        done += 1;
+        // 0x2e9: 12e1 1nnn
+        Handlers::tickTimers(core);
+        s.PC = 0x2e1;
+        goto block_2e1;
+    }
+
+block_2eb:
+    {
+        if (count - done < 14)
+            return done;
+        done += 14;
+        // 0x2eb: 8070 8xy0
+        Handlers::LD_VX_VY(core, {OPCODE_LD_VX_VY, 0x0, 0x7, 0x0, 0x70, 0x070, 0x8070});
+        Handlers::tickTimers(core);
+        // 0x2ed: 70fe 7xkk
+        Handlers::ADD_VX_KK(core, {OPCODE_ADD_VX_KK, 0x0, 0xf, 0xe, 0xfe, 0x0fe, 0x70fe});
+        Handlers::tickTimers(core);
+        // 0x2ef: 8006 8xy6
+        Handlers::SHR(core, {OPCODE_SHR, 0x0, 0x0, 0x6, 0x06, 0x006, 0x8006});
+        Handlers::tickTimers(core);
+        // 0x2f1: a387 Annn
+        Handlers::LD_I(core, {OPCODE_LD_I, 0x3, 0x8, 0x7, 0x87, 0x387, 0xa387});
+        Handlers::tickTimers(core);
+        // 0x2f3: f033 Fx33
+        s.PC = 0x2f5;
+        Handlers::LD_B_VX(core, {OPCODE_LD_B_VX, 0x0, 0x3, 0x3, 0x33, 0x033, 0xf033});
+        Handlers::tickTimers(core);
+        if (core.isCompiledCodeStale())
+            return done - 9;
+        // 0x2f5: f265 Fx65
+        Handlers::LD_VX_I(core, {OPCODE_LD_VX_I, 0x2, 0x6, 0x5, 0x65, 0x265, 0xf265});
+        Handlers::tickTimers(core);
+        // 0x2f7: 602d 6xkk
+        Handlers::LD_VX_KK(core, {OPCODE_LD_VX_KK, 0x0, 0x2, 0xd, 0x2d, 0x02d, 0x602d});
+        Handlers::tickTimers(core);
+        // 0x2f9: f129 Fx29
+        Handlers::LD_F_VX(core, {OPCODE_LD_F_VX, 0x1, 0x2, 0x9, 0x29, 0x129, 0xf129});
+        Handlers::tickTimers(core);
+        // 0x2fb: 610d 6xkk
+        Handlers::LD_VX_KK(core, {OPCODE_LD_VX_KK, 0x1, 0x0, 0xd, 0x0d, 0x10d, 0x610d});
+        Handlers::tickTimers(core);
+        // 0x2fd: d015 Dxyn
+        Handlers::DRW(core, {OPCODE_DRW, 0x0, 0x1, 0x5, 0x15, 0x015, 0xd015});
+        Handlers::tickTimers(core);
+        // 0x2ff: 7005 7xkk
+        Handlers::ADD_VX_KK(core, {OPCODE_ADD_VX_KK, 0x0, 0x0, 0x5, 0x05, 0x005, 0x7005});
+        Handlers::tickTimers(core);
+        // 0x301: f229 Fx29
+        Handlers::LD_F_VX(core, {OPCODE_LD_F_VX, 0x2, 0x2, 0x9, 0x29, 0x229, 0xf229});
+        Handlers::tickTimers(core);
+        // 0x303: d015 Dxyn
+        Handlers::DRW(core, {OPCODE_DRW, 0x0, 0x1, 0x5, 0x15, 0x015, 0xd015});
+        Handlers::tickTimers(core);
+        // 0x305: 00ee 00EE
+        s.PC = 0x307;
+        Handlers::RET(core, {OPCODE_RET, 0x0, 0xe, 0xe, 0xee, 0x0ee, 0x00ee});
+        Handlers::tickTimers(core);
+        goto dispatch;
+    }
+
+dispatch:
+    if (core.hasQuit())
+        return done;
+    switch(s.PC)
+    {
+        case 0x200: goto block_200;
+        case 0x217: goto block_217;
+        case 0x221: goto block_221;
+        case 0x229: goto block_229;
+        case 0x22b: goto block_22b;
+        case 0x22d: goto block_22d;
+        case 0x231: goto block_231;
+        case 0x233: goto block_233;
+        case 0x239: goto block_239;
+        case 0x243: goto block_243;
+        case 0x245: goto block_245;
+        case 0x249: goto block_249;
+        case 0x24d: goto block_24d;
+        case 0x255: goto block_255;
+        case 0x257: goto block_257;
+        case 0x25b: goto block_25b;
+        case 0x25d: goto block_25d;
+        case 0x265: goto block_265;
+        case 0x26b: goto block_26b;
+        case 0x26d: goto block_26d;
+        case 0x26f: goto block_26f;
+        case 0x271: goto block_271;
+        case 0x275: goto block_275;
+        case 0x277: goto block_277;
+        case 0x281: goto block_281;
+        case 0x287: goto block_287;
+        case 0x28b: goto block_28b;
+        case 0x28f: goto block_28f;
+        case 0x291: goto block_291;
+        case 0x293: goto block_293;
+        case 0x295: goto block_295;
+        case 0x299: goto block_299;
+        case 0x29b: goto block_29b;
+        case 0x29f: goto block_29f;
+        case 0x2a1: goto block_2a1;
+        case 0x2a5: goto block_2a5;
+        case 0x2a7: goto block_2a7;
+        case 0x2a9: goto block_2a9;
+        case 0x2ab: goto block_2ab;
+        case 0x2b3: goto block_2b3;
+        case 0x2b5: goto block_2b5;
+        case 0x2b9: goto block_2b9;
+        case 0x2bb: goto block_2bb;
+        case 0x2c1: goto block_2c1;
+        case 0x2cd: goto block_2cd;
+        case 0x2d5: goto block_2d5;
+        case 0x2d7: goto block_2d7;
+        case 0x2d9: goto block_2d9;
+        case 0x2e1: goto block_2e1;
+        case 0x2e9: goto block_2e9;
+        case 0x2eb: goto block_2eb;
+    }
+    return done;
+}
+
+static const COMPILED_PROGRAM program = {
+    "blitz",
+    rom,
+    sizeof(rom),
+    {0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull,
+     0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull,
+     0xffffffffff800003ull, 0xffffffffffffffffull, 0xffffffffffffffffull, 0xffffffffffffffffull,
+     0x000000000000007full, 0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull,
+     0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull,
+     0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull,
+     0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull,
+     0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull,
+     0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull,
+     0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull,
+     0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull,
+     0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull,
+     0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull,
+     0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull,
+     0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull,
+     0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull},
+    &run,
+    0x0
+};
+
+static COMPILED_PROGRAM_REGISTRAR registrar(&program);
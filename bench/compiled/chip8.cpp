@@ -0,0 +1,331 @@
+// Generated by tools/Recompiler from chip8.c8, do not edit
+#include "Chip8Core.h"
+#include "Compiled.h"
+#include "Handlers.h"
+
+static const u8 rom[] = {
+    0x12, 0x25, 0x53, 0x50, 0x41, 0x43, 0x45, 0x20, 0x49, 0x4e, 0x56, 0x41, 0x44, 0x45, 0x52, 0x53,
+    0x20, 0x76, 0x30, 0x2e, 0x39, 0x20, 0x42, 0x79, 0x20, 0x44, 0x61, 0x76, 0x69, 0x64, 0x20, 0x57,
+    0x49, 0x4e, 0x54, 0x45, 0x52, 0x60, 0x00, 0x61, 0x00, 0x62, 0x08, 0xa3, 0xd3, 0xd0, 0x18, 0x71,
+    0x08, 0xf2, 0x1e, 0x31, 0x20, 0x12, 0x2d, 0x70, 0x08, 0x61, 0x00, 0x30, 0x40, 0x12, 0x2d, 0x69,
+    0x05, 0x6c, 0x15, 0x6e, 0x00, 0x23, 0x87, 0x60, 0x0d, 0x0a, 0xf0, 0x15, 0xf0, 0x07, 0x30, 0x00,
+    0x12, 0x4b, 0x23, 0x87, 0x7e, 0x01, 0x12, 0x45, 0x66, 0x00, 0x68, 0x1c, 0x69, 0x00, 0x6a, 0x04,
+    0x6b, 0x0d, 0x0a, 0x6c, 0x04, 0x6d, 0x3c, 0x6e, 0x0f, 0x00, 0xe0, 0x23, 0x6b, 0x23, 0x47, 0xfd,
+    0x15, 0x60, 0x04, 0xe0, 0x9e, 0x12, 0x7d, 0x23, 0x6b, 0x38, 0x00, 0x78, 0xff, 0x23, 0x6b, 0x60,
+    0x06, 0xe0, 0x9e, 0x12, 0x8b, 0x23, 0x6b, 0x38, 0x39, 0x78, 0x01, 0x23, 0x6b, 0x36, 0x00, 0x12,
+    0x9f, 0x60, 0x05, 0xe0, 0x9e, 0x12, 0xe9, 0x66, 0x01, 0x65, 0x1b, 0x84, 0x80, 0xa3, 0xcf, 0xd4,
+    0x51, 0xa3, 0xcf, 0xd4, 0x51, 0x75, 0xff, 0x35, 0xff, 0x12, 0xad, 0x66, 0x00, 0x12, 0xe9, 0xd4,
+    0x51, 0x3f, 0x01, 0x12, 0xe9, 0xd4, 0x51, 0x66, 0x00, 0x83, 0x40, 0x73, 0x03, 0x83, 0xb5, 0x62,
+    0xf8, 0x83, 0x22, 0x62, 0x08, 0x33, 0x00, 0x12, 0xc9, 0x23, 0x73, 0x82, 0x06, 0x43, 0x08, 0x12,
+    0xd3, 0x33, 0x10, 0x12, 0xd5, 0x23, 0x73, 0x82, 0x06, 0x33, 0x18, 0x12, 0xdd, 0x23, 0x73, 0x82,
+    0x06, 0x43, 0x20, 0x12, 0xe7, 0x33, 0x28, 0x12, 0xe9, 0x23, 0x73, 0x3e, 0x00, 0x13, 0x07, 0x79,
+    0x06, 0x49, 0x18, 0x69, 0x00, 0x6a, 0x04, 0x6b, 0x0d, 0x0a, 0x6c, 0x04, 0x7d, 0xf4, 0x6e, 0x0f,
+    0x00, 0xe0, 0x23, 0x47, 0x23, 0x6b, 0xfd, 0x15, 0x12, 0x6f, 0xf7, 0x07, 0x37, 0x00, 0x12, 0x6f,
+    0xfd, 0x15, 0x23, 0x47, 0x8b, 0xa4, 0x3b, 0x12, 0x13, 0x1b, 0x7c, 0x02, 0x6a, 0xfc, 0x3b, 0x02,
+    0x13, 0x23, 0x7c, 0x02, 0x6a, 0x04, 0x23, 0x47, 0x3c, 0x18, 0x12, 0x6f, 0x00, 0xe0, 0xa4, 0xd3,
+    0x60, 0x14, 0x61, 0x08, 0x62, 0x0f, 0xd0, 0x1f, 0x70, 0x08, 0xf2, 0x1e, 0x30, 0x2c, 0x13, 0x33,
+    0xf0, 0x0d, 0x0a, 0x00, 0xe0, 0xa6, 0xf4, 0xfe, 0x65, 0x12, 0x25, 0xa3, 0xb7, 0xf9, 0x1e, 0x61,
+    0x08, 0x23, 0x5f, 0x81, 0x06, 0x23, 0x5f, 0x81, 0x06, 0x23, 0x5f, 0x81, 0x06, 0x23, 0x5f, 0x7b,
+    0xd0, 0x00, 0xee, 0x80, 0xe0, 0x80, 0x12, 0x30, 0x00, 0xdb, 0xc6, 0x7b, 0x0c, 0x00, 0xee, 0xa3,
+    0xcf, 0x60, 0x1c, 0xd8, 0x04, 0x00, 0xee, 0x23, 0x47, 0x8e, 0x23, 0x23, 0x47, 0x60, 0x05, 0xf0,
+    0x18, 0xf0, 0x15, 0xf0, 0x07, 0x30, 0x00, 0x13, 0x7f, 0x00, 0xee, 0x6a, 0x00, 0x8d, 0xe0, 0x6b,
+    0x04, 0xe9, 0xa1, 0x12, 0x57, 0xa6, 0x02, 0xfd, 0x1e, 0xf0, 0x65, 0x30, 0xff, 0x13, 0xa5, 0x6a,
+    0x00, 0x6b, 0x04, 0x6d, 0x01, 0x6e, 0x01, 0x13, 0x8d, 0xa5, 0x00, 0xf0, 0x1e, 0xdb, 0xc6, 0x7b,
+    0x08, 0x7d, 0x01, 0x7a, 0x01, 0x3a, 0x07, 0x13, 0x8d, 0x00, 0xee, 0x3c, 0x7e, 0xff, 0xff, 0x99,
+    0x99, 0x7e, 0xff, 0xff, 0x24, 0x24, 0xe7, 0x7e, 0xff, 0x3c, 0x3c, 0x7e, 0xdb, 0x81, 0x42, 0x3c,
+    0x7e, 0xff, 0xdb, 0x10, 0x38, 0x7c, 0xfe, 0x00, 0x00, 0x7f, 0x00, 0x3f, 0x00, 0x7f, 0x00, 0x00,
+    0x00, 0x01, 0x01, 0x01, 0x03, 0x03, 0x03, 0x03, 0x00, 0x00, 0x3f, 0x20, 0x20, 0x20, 0x20, 0x20,
+    0x20, 0x20, 0x20, 0x3f, 0x08, 0x08, 0xff, 0x00, 0x00, 0xfe, 0x00, 0xfc, 0x00, 0xfe, 0x00, 0x00,
+    0x00, 0x7e, 0x42, 0x42, 0x62, 0x62, 0x62, 0x62, 0x00, 0x00, 0xff, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0xff, 0x00, 0x00, 0xff, 0x00, 0x7d, 0x00, 0x41, 0x7d, 0x05, 0x7d, 0x7d, 0x00,
+    0x00, 0xc2, 0xc2, 0xc6, 0x44, 0x6c, 0x28, 0x38, 0x00, 0x00, 0xff, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0xff, 0x00, 0x00, 0xff, 0x00, 0xf7, 0x10, 0x14, 0xf7, 0xf7, 0x04, 0x04, 0x00,
+    0x00, 0x7c, 0x44, 0xfe, 0xc2, 0xc2, 0xc2, 0xc2, 0x00, 0x00, 0xff, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0xff, 0x00, 0x00, 0xff, 0x00, 0xef, 0x20, 0x28, 0xe8, 0xe8, 0x2f, 0x2f, 0x00,
+    0x00, 0xf9, 0x85, 0xc5, 0xc5, 0xc5, 0xc5, 0xf9, 0x00, 0x00, 0xff, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0xff, 0x00, 0x00, 0xff, 0x00, 0xbe, 0x00, 0x20, 0x30, 0x20, 0xbe, 0xbe, 0x00,
+    0x00, 0xf7, 0x04, 0xe7, 0x85, 0x85, 0x84, 0xf4, 0x00, 0x00, 0xff, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0xff, 0x00, 0x00, 0xff, 0x00, 0x00, 0x7f, 0x00, 0x3f, 0x00, 0x7f, 0x00, 0x00,
+    0x00, 0xef, 0x28, 0xef, 0x00, 0xe0, 0x60, 0x6f, 0x00, 0x00, 0xff, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0xff, 0x00, 0x00, 0xff, 0x00, 0x00, 0xfe, 0x00, 0xfc, 0x00, 0xfe, 0x00, 0x00,
+    0x00, 0xc0, 0x00, 0xc0, 0xc0, 0xc0, 0xc0, 0xc0, 0x00, 0x00, 0xfc, 0x04, 0x04, 0x04, 0x04, 0x04,
+    0x04, 0x04, 0x04, 0xfc, 0x10, 0x10, 0xff, 0xf9, 0x81, 0xb9, 0x8b, 0x9a, 0x9a, 0xfa, 0x00, 0xfa,
+    0x8a, 0x9a, 0x9a, 0x9b, 0x99, 0xf8, 0xe6, 0x25, 0x25, 0xf4, 0x34, 0x34, 0x34, 0x00, 0x17, 0x14,
+    0x34, 0x37, 0x36, 0x26, 0xc7, 0xdf, 0x50, 0x50, 0x5c, 0xd8, 0xd8, 0xdf, 0x00, 0xdf, 0x11, 0x1f,
+    0x12, 0x1b, 0x19, 0xd9, 0x7c, 0x44, 0xfe, 0x86, 0x86, 0x86, 0xfc, 0x84, 0xfe, 0x82, 0x82, 0xfe,
+    0xfe, 0x80, 0xc0, 0xc0, 0xc0, 0xfe, 0xfc, 0x82, 0xc2, 0xc2, 0xc2, 0xfc, 0xfe, 0x80, 0xf8, 0xc0,
+    0xc0, 0xfe, 0xfe, 0x80, 0xf0, 0xc0, 0xc0, 0xc0, 0xfe, 0x80, 0xbe, 0x86, 0x86, 0xfe, 0x86, 0x86,
+    0xfe, 0x86, 0x86, 0x86, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x18, 0x18, 0x18, 0x48, 0x48, 0x78,
+    0x9c, 0x90, 0xb0, 0xc0, 0xb0, 0x9c, 0x80, 0x80, 0xc0, 0xc0, 0xc0, 0xfe, 0xee, 0x92, 0x92, 0x86,
+    0x86, 0x86, 0xfe, 0x82, 0x86, 0x86, 0x86, 0x86, 0x7c, 0x82, 0x86, 0x86, 0x86, 0x7c, 0xfe, 0x82,
+    0xfe, 0xc0, 0xc0, 0xc0, 0x7c, 0x82, 0xc2, 0xca, 0xc4, 0x7a, 0xfe, 0x86, 0xfe, 0x90, 0x9c, 0x84,
+    0xfe, 0xc0, 0xfe, 0x02, 0x02, 0xfe, 0xfe, 0x10, 0x30, 0x30, 0x30, 0x30, 0x82, 0x82, 0xc2, 0xc2,
+    0xc2, 0xfe, 0x82, 0x82, 0x82, 0xee, 0x38, 0x10, 0x86, 0x86, 0x96, 0x92, 0x92, 0xee, 0x82, 0x44,
+    0x38, 0x38, 0x44, 0x82, 0x82, 0x82, 0xfe, 0x30, 0x30, 0x30, 0xfe, 0x02, 0x1e, 0xf0, 0x80, 0xfe,
+    0x00, 0x00, 0x00, 0x00, 0x06, 0x06, 0x00, 0x00, 0x00, 0x60, 0x60, 0xc0, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x18, 0x18, 0x18, 0x18, 0x00, 0x18, 0x7c, 0xc6, 0x0c, 0x18, 0x00, 0x18, 0x00, 0x00,
+    0xfe, 0xfe, 0x00, 0x00, 0xfe, 0x82, 0x86, 0x86, 0x86, 0xfe, 0x08, 0x08, 0x08, 0x18, 0x18, 0x18,
+    0xfe, 0x02, 0xfe, 0xc0, 0xc0, 0xfe, 0xfe, 0x02, 0x1e, 0x06, 0x06, 0xfe, 0x84, 0xc4, 0xc4, 0xfe,
+    0x04, 0x04, 0xfe, 0x80, 0xfe, 0x06, 0x06, 0xfe, 0xc0, 0xc0, 0xc0, 0xfe, 0x82, 0xfe, 0xfe, 0x02,
+    0x02, 0x06, 0x06, 0x06, 0x7c, 0x44, 0xfe, 0x86, 0x86, 0xfe, 0xfe, 0x82, 0xfe, 0x06, 0x06, 0x06,
+    0x44, 0xfe, 0x44, 0x44, 0xfe, 0x44, 0xa8, 0xa8, 0xa8, 0xa8, 0xa8, 0xa8, 0xa8, 0x6c, 0x5a, 0x00,
+    0x0c, 0x18, 0xa8, 0x30, 0x4e, 0x7e, 0x00, 0x12, 0x18, 0x66, 0x6c, 0xa8, 0x5a, 0x66, 0x54, 0x24,
+    0x66, 0x00, 0x48, 0x48, 0x18, 0x12, 0xa8, 0x06, 0x90, 0xa8, 0x12, 0x00, 0x7e, 0x30, 0x12, 0xa8,
+    0x84, 0x30, 0x4e, 0x72, 0x18, 0x66, 0xa8, 0xa8, 0xa8, 0xa8, 0xa8, 0xa8, 0x90, 0x54, 0x78, 0xa8,
+    0x48, 0x78, 0x6c, 0x72, 0xa8, 0x12, 0x18, 0x6c, 0x72, 0x66, 0x54, 0x90, 0xa8, 0x72, 0x2a, 0x18,
+    0xa8, 0x30, 0x4e, 0x7e, 0x00, 0x12, 0x18, 0x66, 0x6c, 0xa8, 0x72, 0x54, 0xa8, 0x5a, 0x66, 0x18,
+    0x7e, 0x18, 0x4e, 0x72, 0xa8, 0x72, 0x2a, 0x18, 0x30, 0x66, 0xa8, 0x30, 0x4e, 0x7e, 0x00, 0x6c,
+    0x30, 0x54, 0x4e, 0x9c, 0xa8, 0xa8, 0xa8, 0xa8, 0xa8, 0xa8, 0xa8, 0x48, 0x54, 0x7e, 0x18, 0xa8,
+    0x90, 0x54, 0x78, 0x66, 0xa8, 0x6c, 0x2a, 0x30, 0x5a, 0xa8, 0x84, 0x30, 0x72, 0x2a, 0xa8, 0xd8,
+    0xa8, 0x00, 0x4e, 0x12, 0xa8, 0xe4, 0xa2, 0xa8, 0x00, 0x4e, 0x12, 0xa8, 0x6c, 0x2a, 0x54, 0x54,
+    0x72, 0xa8, 0x84, 0x30, 0x72, 0x2a, 0xa8, 0xde, 0x9c, 0xa8, 0x72, 0x2a, 0x18, 0xa8, 0x0c, 0x54,
+    0x48, 0x5a, 0x78, 0x72, 0x18, 0x66, 0xa8, 0x72, 0x18, 0x42, 0x42, 0x6c, 0xa8, 0x72, 0x2a, 0x00,
+    0x72, 0xa8, 0x72, 0x2a, 0x18, 0xa8, 0x30, 0x4e, 0x7e, 0x00, 0x12, 0x18, 0x66, 0x6c, 0xa8, 0x30,
+    0x4e, 0x0c, 0x66, 0x18, 0x00, 0x6c, 0x18, 0xa8, 0x72, 0x2a, 0x18, 0x30, 0x66, 0xa8, 0x1e, 0x54,
+    0x66, 0x0c, 0x18, 0x9c, 0xa8, 0x24, 0x54, 0x54, 0x12, 0xa8, 0x42, 0x78, 0x0c, 0x3c, 0xa8, 0xae,
+    0xa8, 0xa8, 0xa8, 0xa8, 0xa8, 0xa8, 0xa8, 0xff, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+};
+
+static u32 run(Chip8Core& core, u32 count)
+{
+    CHIP8_STATE& s = core.getState();
+    u32 done = 0;
+    goto dispatch;
+
+block_200:
+    {
+        if (count - done < 1)
+            return done;
+        done += 1;
+        // 0x200: 1225 1nnn
+        Handlers::tickTimers(core);
+        s.PC = 0x225;
+        goto block_225;
+    }
+
+block_225:
+    {
+        if (count - done < 4)
+            return done;
+        done += 4;
+        // 0x225: 6000 6xkk
+        Handlers::LD_VX_KK(core, {OPCODE_LD_VX_KK, 0x0, 0x0, 0x0, 0x00, 0x000, 0x6000});
+        Handlers::tickTimers(core);
+        // 0x227: 6100 6xkk
+        Handlers::LD_VX_KK(core, {OPCODE_LD_VX_KK, 0x1, 0x0, 0x0, 0x00, 0x100, 0x6100});
+        Handlers::tickTimers(core);
+        // 0x229: 6208 6xkk
+        Handlers::LD_VX_KK(core, {OPCODE_LD_VX_KK, 0x2, 0x0, 0x8, 0x08, 0x208, 0x6208});
+        Handlers::tickTimers(core);
+        // 0x22b: a3d3 Annn
+        Handlers::LD_I(core, {OPCODE_LD_I, 0x3, 0xd, 0x3, 0xd3, 0x3d3, 0xa3d3});
+        Handlers::tickTimers(core);
+        s.PC = 0x22d;
+        goto block_22d;
+    }
+
+block_22d:
+    {
+        if (count - done < 4)
+            return done;
+        done += 4;
+        // 0x22d: d018 Dxyn
+        Handlers::DRW(core, {OPCODE_DRW, 0x0, 0x1, 0x8, 0x18, 0x018, 0xd018});
+        Handlers::tickTimers(core);
+        // 0x22f: 7108 7xkk
+        Handlers::ADD_VX_KK(core, {OPCODE_ADD_VX_KK, 0x1, 0x0, 0x8, 0x08, 0x108, 0x7108});
+        Handlers::tickTimers(core);
+        // 0x231: f21e Fx1E
+        Handlers::ADD_I_VX(core, {OPCODE_ADD_I_VX, 0x2, 0x1, 0xe, 0x1e, 0x21e, 0xf21e});
+        Handlers::tickTimers(core);
+        // 0x233: 3120 3xkk
+        bool skip = s.V[0x1] == 0x20;
+        Handlers::tickTimers(core);
+        if (skip)
+        {
+            s.PC = 0x237;
+            goto block_237;
+        }
+        s.PC = 0x235;
+        goto block_235;
+    }
+
+block_235:
+    {
+        if (count - done < 1)
+            return done;
+        done += 1;
+        // 0x235: 122d 1nnn
+        Handlers::tickTimers(core);
+        s.PC = 0x22d;
+        goto block_22d;
+    }
+
+block_237:
+    {
+        if (count - done < 3)
+            return done;
+        done += 3;
+        // 0x237: 7008 7xkk
+        Handlers::ADD_VX_KK(core, {OPCODE_ADD_VX_KK, 0x0, 0x0, 0x8, 0x08, 0x008, 0x7008});
+        Handlers::tickTimers(core);
+        // 0x239: 6100 6xkk
+        Handlers::LD_VX_KK(core, {OPCODE_LD_VX_KK, 0x1, 0x0, 0x0, 0x00, 0x100, 0x6100});
+        Handlers::tickTimers(core);
+        // 0x23b: 3040 3xkk
+        bool skip = s.V[0x0] == 0x40;
+        Handlers::tickTimers(core);
+        if (skip)
+        {
+            s.PC = 0x23f;
+            goto block_23f;
+        }
+        s.PC = 0x23d;
+        goto block_23d;
+    }
+
+block_23d:
+    {
+        if (count - done < 1)
+            return done;
+        done += 1;
+        // 0x23d: 122d 1nnn
+        Handlers::tickTimers(core);
+        s.PC = 0x22d;
+        goto block_22d;
+    }
+
+block_23f:
+    {
+        if (count - done < 4)
+            return done;
+        done += 4;
+        // 0x23f: 6905 6xkk
+        Handlers::LD_VX_KK(core, {OPCODE_LD_VX_KK, 0x9, 0x0, 0x5, 0x05, 0x905, 0x6905});
+        Handlers::tickTimers(core);
+        // 0x241: 6c15 6xkk
+        Handlers::LD_VX_KK(core, {OPCODE_LD_VX_KK, 0xc, 0x1, 0x5, 0x15, 0xc15, 0x6c15});
+        Handlers::tickTimers(core);
+        // 0x243: 6e00 6xkk
+        Handlers::LD_VX_KK(core, {OPCODE_LD_VX_KK, 0xe, 0x0, 0x0, 0x00, 0xe00, 0x6e00});
+        Handlers::tickTimers(core);
+        // 0x245: 2387 2nnn
+        s.PC = 0x247;
+        Handlers::CALL(core, {OPCODE_CALL, 0x3, 0x8, 0x7, 0x87, 0x387, 0x2387});
+        Handlers::tickTimers(core);
+        if (core.hasQuit())
+            return done;
+        s.PC = 0x387;
+        goto block_387;
+    }
+
+block_247:
+    {
+        if (count - done < 2)
+            return done;
+        done += 2;
+        // 0x247: 600d 6xkk
+        Handlers::LD_VX_KK(core, {OPCODE_LD_VX_KK, 0x0, 0x0, 0xd, 0x0d, 0x00d, 0x600d});
+        Handlers::tickTimers(core);
+        // 0x249: 0af0 bad
+        s.PC = 0x24b;
+        Handlers::BAD(core, {OPCODE_BAD, 0xa, 0xf, 0x0, 0xf0, 0xaf0, 0x0af0});
+        Handlers::tickTimers(core);
+        goto dispatch;
+    }
+
+block_37f:
+    {
+        if (count - done < 4)
+            return done;
+        done += 4;
+        // 0x37f: f018 Fx18
+        Handlers::LD_ST_VX(core, {OPCODE_LD_ST_VX, 0x0, 0x1, 0x8, 0x18, 0x018, 0xf018});
+        Handlers::tickTimers(core);
+        // 0x381: f015 Fx15
+        Handlers::LD_DT_VX(core, {OPCODE_LD_DT_VX, 0x0, 0x1, 0x5, 0x15, 0x015, 0xf015});
+        Handlers::tickTimers(core);
+        // 0x383: f007 Fx07
+        Handlers::LD_VX_DT(core, {OPCODE_LD_VX_DT, 0x0, 0x0, 0x7, 0x07, 0x007, 0xf007});
+        Handlers::tickTimers(core);
+        // 0x385: 3000 3xkk
+        bool skip = s.V[0x0] == 0x00;
+        Handlers::tickTimers(core);
+        if (skip)
+        {
+            s.PC = 0x389;
+            goto block_389;
+        }
+        s.PC = 0x387;
+        goto block_387;
+    }
+
+block_387:
+    {
+        if (count - done < 1)
+            return done;
+        done += 1;
+        // 0x387: 137f 1nnn
+        Handlers::tickTimers(core);
+        s.PC = 0x37f;
+        goto block_37f;
+    }
+
+block_389:
+    {
+        if (count - done < 1)
+            return done;
+        done += 1;
+        // 0x389: 00ee 00EE
+        s.PC = 0x38b;
+        Handlers::RET(core, {OPCODE_RET, 0x0, 0xe, 0xe, 0xee, 0x0ee, 0x00ee});
+        Handlers::tickTimers(core);
+        goto dispatch;
+    }
+
+dispatch:
+    if (core.hasQuit())
+        return done;
+    switch(s.PC)
+    {
+        case 0x200: goto block_200;
+        case 0x225: goto block_225;
+        case 0x22d: goto block_22d;
+        case 0x235: goto block_235;
+        case 0x237: goto block_237;
+        case 0x23d: goto block_23d;
+        case 0x23f: goto block_23f;
+        case 0x247: goto block_247;
+        case 0x37f: goto block_37f;
+        case 0x387: goto block_387;
+        case 0x389: goto block_389;
+    }
+    return done;
+}
+
+static const COMPILED_PROGRAM program = {
+    "chip8",
+    rom,
+    sizeof(rom),
+    {0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull,
+     0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull,
+     0xffffffe000000003ull, 0x00000000000007ffull, 0x0000000000000000ull, 0x0000000000000000ull,
+     0x0000000000000000ull, 0x8000000000000000ull, 0x00000000000007ffull, 0x0000000000000000ull,
+     0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull,
+     0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull,
+     0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull,
+     0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull,
+     0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull,
+     0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull,
+     0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull,
+     0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull,
+     0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull,
+     0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull,
+     0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull,
+     0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull},
+    &run,
+    0x0
+};
+
+static COMPILED_PROGRAM_REGISTRAR registrar(&program);
@@ -0,0 +1,80 @@
+// Generated by tools/Recompiler from benchSelfModifyingProgram in bench/Bench.h, do not edit
+#include "Chip8Core.h"
+#include "Compiled.h"
+#include "Handlers.h"
+
+static const u8 rom[] = {
+    0x60, 0x72, 0x61, 0x00, 0xa2, 0x0a, 0x71, 0x01, 0xf1, 0x55, 0x00, 0x00, 0x12, 0x04
+};
+
+static u32 run(Chip8Core& core, u32 count)
+{
+    CHIP8_STATE& s = core.getState();
+    u32 done = 0;
+    goto dispatch;
+
+block_200:
+    {
+        if (count - done < 6)
+            return done;
+        done += 6;
+        // 0x200: 6072 6xkk
+        Handlers::LD_VX_KK(core, {OPCODE_LD_VX_KK, 0x0, 0x7, 0x2, 0x72, 0x072, 0x6072});
+        Handlers::tickTimers(core);
+        // 0x202: 6100 6xkk
+        Handlers::LD_VX_KK(core, {OPCODE_LD_VX_KK, 0x1, 0x0, 0x0, 0x00, 0x100, 0x6100});
+        Handlers::tickTimers(core);
+        // 0x204: a20a Annn
+        Handlers::LD_I(core, {OPCODE_LD_I, 0x2, 0x0, 0xa, 0x0a, 0x20a, 0xa20a});
+        Handlers::tickTimers(core);
+        // 0x206: 7101 7xkk
+        Handlers::ADD_VX_KK(core, {OPCODE_ADD_VX_KK, 0x1, 0x0, 0x1, 0x01, 0x101, 0x7101});
+        Handlers::tickTimers(core);
+        // 0x208: f155 Fx55
+        s.PC = 0x20a;
+        Handlers::LD_I_VX(core, {OPCODE_LD_I_VX, 0x1, 0x5, 0x5, 0x55, 0x155, 0xf155});
+        Handlers::tickTimers(core);
+        if (core.isCompiledCodeStale())
+            return done - 1;
+        // 0x20a: 0000 bad
+        s.PC = 0x20c;
+        Handlers::BAD(core, {OPCODE_BAD, 0x0, 0x0, 0x0, 0x00, 0x000, 0x0000});
+        Handlers::tickTimers(core);
+        goto dispatch;
+    }
+
+dispatch:
+    if (core.hasQuit())
+        return done;
+    switch(s.PC)
+    {
+        case 0x200: goto block_200;
+    }
+    return done;
+}
+
+static const COMPILED_PROGRAM program = {
+    "selfmodify",
+    rom,
+    sizeof(rom),
+    {0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull,
+     0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull,
+     0x0000000000000fffull, 0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull,
+     0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull,
+     0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull,
+     0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull,
+     0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull,
+     0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull,
+     0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull,
+     0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull,
+     0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull,
+     0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull,
+     0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull,
+     0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull,
+     0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull,
+     0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull},
+    &run,
+    0x0
+};
+
+static COMPILED_PROGRAM_REGISTRAR registrar(&program);
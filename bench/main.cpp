@@ -0,0 +1,52 @@
+#include <iostream>
+#include <string>
+#include "Bench.h"
+
+struct BENCHMARK
+{
+    const char* name;
+    const char* description;
+    int (*function)(int argc, char* argv[]);
+};
+
+static const BENCHMARK benchmarks[] = {
+    {"state", "Core construction time and the size of the machine state", &benchState},
+    {"sprite", "Dxyn sprite drawing on the packed framebuffer against per pixel drawing, [rom] [rounds]", &benchSprite},
+    {"dispatch", "Instructions per second of each dispatch engine on the shipped ROMs, [instructions]", &benchDispatch},
+    {"jit", "Runs the jit engine in lockstep with the switch engine and reports what it translated, [instructions]", &benchJit},
+    {"compiled", "Runs ROMs compiled by tools/Recompiler in lockstep with the switch engine, [instructions]", &benchCompiled},
+    {"fusion", "Profiles each ROM, fuses its hot instruction runs and reports the dispatches saved, [instructions] [min share]", &benchFusion},
+    {"batch", "Instructions per second of the SIMD batch against independent cores, checks every lane against a core, [instructions]", &benchBatch},
+    {"quirks", "Checks every quirk profile on every engine and times the default profile against the fixed loop, [instructions]", &benchQuirks},
+    {"savestate", "Checks savestates restore bit identical execution on every engine, times save, load and streaming to a file, [iterations]", &benchSavestate},
+    {"pool", "Checks branches forked through the pool and times forks with the pool full, [live forks]", &benchPool},
+    {"rewind", "Records minutes of each ROM into the rewind buffer, checks every frame rewinds exactly and reports the cost, [minutes]", &benchRewind},
+    {"replay", "Records sessions of each ROM with input, checks they replay exactly on every engine, or plays back [file.c8r]", &benchReplay},
+    {"runahead", "Checks running ahead puts every engine back exactly, measures input latency with 0 to 4 frames ahead and the cost, [points]", &benchRunAhead},
+    {"pacing", "Checks the timers tick once a frame on every engine, paces PONG at 60 frames a second and reports drift, jitter and idle time, [seconds]", &benchPacing},
+    {"idle", "Checks idle loop skipping leaves every engine exactly as stepping would and reports the instructions and host time saved, [frames]", &benchIdle},
+    {"keywait", "Checks Fx0A halts and resumes on every engine, profile and the batch and times a halted frame against polling, [frames]", &benchKeyWait},
+    {"breakpoints", "Checks break points, conditions and watch points on every engine and times execute with none, many and the old list, [instructions]", &benchBreakpoints},
+    {"debugger", "Checks the debugger queues and register snapshots across threads, plays a session and times the machine with it attached, [frames]", &benchDebugger},
+    {"audio", "Checks the buzzer lasts exactly as long as the sound timer, writes a WAV, plays at 1x to a device thread and times the audio across instances, [seconds]", &benchAudio},
+    {"trace", "Checks traces decode to exactly what a stepped core did, in a ring and across a diff, and times tracing against the engines, [instructions]", &benchTrace},
+    {"profile", "Checks the profiler counts every address, class and call exactly, writes a callgrind file and times profiling against the engines, [instructions]", &benchProfile},
+    {"heatmap", "Checks every read, write and execute of memory is counted exactly, finds self-modifying code, writes CSV and binary dumps and times counting against the engines, [instructions]", &benchHeatmap},
+    {"suite", "Times each opcode family and the ROMs with scripted input, prints JSON and compares against a saved baseline, [save file.json | compare file.json [percent]]", &benchSuite},
+};
+
+int main(int argc, char* argv[])
+{
+    std::string name = argc > 1 ? argv[1] : "";
+    for (const BENCHMARK& benchmark : benchmarks)
+    {
+        if (name == benchmark.name)
+            return benchmark.function(argc - 2, argv + 2);
+    }
+
+    std::cout << "Usage: " << argv[0] << " <benchmark> [arguments]" << std::endl;
+    for (const BENCHMARK& benchmark : benchmarks)
+        std::cout << "    " << benchmark.name << " ; " << benchmark.description << std::endl;
+
+    return name.empty() ? 0 : 1;
+}
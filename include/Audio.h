@@ -0,0 +1,154 @@
+#ifndef AUDIO_H
+#define AUDIO_H
+
+#include <fstream>
+#include <string>
+#include "Def.h"
+#include "LockFree.h"
+
+class Chip8Core;
+
+// The rate samples are made at and the pitch and loudness of the buzzer
+#define CHIP8_AUDIO_RATE 44100
+#define CHIP8_AUDIO_TONE 400
+#define CHIP8_AUDIO_VOLUME 4096
+/* Samples the audio device asks for at a time, and the silence put ahead of the first frame, two periods so the device
+ * has one in hand whatever point of its period a frame lands at */
+#define CHIP8_AUDIO_DEVICE_SAMPLES 128
+#define CHIP8_AUDIO_PRIME (2 * CHIP8_AUDIO_DEVICE_SAMPLES)
+// The most samples that can wait between the machine and the device
+#define CHIP8_AUDIO_RING_SIZE 4096
+
+// Where the samples of a Chip8Audio go, mono signed 16 bit at the rate the Chip8Audio was made with
+class AudioSink
+{
+    public:
+        virtual ~AudioSink();
+        virtual void write(const s16* samples, u32 count) = 0;
+};
+
+// Throws the samples away, counting them and the ones that were not silent
+class NullAudioSink : public AudioSink
+{
+    public:
+        NullAudioSink();
+        virtual void write(const s16* samples, u32 count);
+        u64 getSamples();
+        u64 getLoudSamples();
+    private:
+        u64 samples;
+        u64 loudSamples;
+};
+
+// Writes the samples to a WAV file, the header is filled in with the length when the file is closed
+class WavAudioSink : public AudioSink
+{
+    public:
+        WavAudioSink(u32 rate = CHIP8_AUDIO_RATE);
+        virtual ~WavAudioSink();
+        bool open(const std::string& fname);
+        virtual void write(const s16* samples, u32 count);
+        void close();
+        u64 getSamples();
+    private:
+        void writeHeader();
+
+        std::ofstream file;
+        u32 rate;
+        u64 samples;
+};
+
+// How well a RingAudioSink has kept the device fed
+struct AUDIO_RING_STATS
+{
+    // Samples the machine wrote and the ones dropped, because the ring was full or to keep the latency down
+    u64 written;
+    u64 dropped;
+    // Samples the device read and the ones it asked for that were not there, played as silence
+    u64 read;
+    u64 underruns;
+    // Device reads that came up short
+    u64 shortReads;
+    // Samples already waiting each time the machine wrote more, how long the first of the new ones waits to play
+    u64 latencyTotal;
+    u64 latencyWrites;
+    u32 latencyMax;
+};
+
+/* The RingAudioSink hands samples from the thread running the machine to the audio device's callback through a lock
+ * free queue, neither side ever waits on the other. The machine writes a frame at a time and the device reads a period
+ * at a time, so the queue is primed with "prime" samples of silence whenever it runs dry to cover the gap between the
+ * two. The device side throws away the oldest samples once more than "maxQueued" are waiting, which keeps the latency
+ * bounded when the host clock runs ahead of the device's. */
+class RingAudioSink : public AudioSink
+{
+    public:
+        RingAudioSink(u32 rate = CHIP8_AUDIO_RATE, u32 prime = CHIP8_AUDIO_PRIME);
+        // Machine side
+        virtual void write(const s16* samples, u32 count);
+        // Device side, fills "samples" and plays silence for whatever is missing
+        void read(s16* samples, u32 count);
+        // Any thread, the samples waiting
+        u32 getQueued() const;
+        // Machine side, the device side counts are as of the call
+        AUDIO_RING_STATS getStats() const;
+        void setMaxQueued(u32 samples);
+    private:
+        SpscQueue<s16, CHIP8_AUDIO_RING_SIZE> ring;
+        u32 prime;
+        u32 maxQueued;
+        // Machine side
+        u64 written;
+        u64 dropped;
+        u64 latencyTotal;
+        u64 latencyWrites;
+        u32 latencyMax;
+        // Device side, read by "getStats" from the machine's thread
+        std::atomic<u64> deviceRead;
+        std::atomic<u64> underruns;
+        std::atomic<u64> shortReads;
+        std::atomic<u64> trimmed;
+};
+
+/* The Chip8Audio turns the sound timer into a square wave in emulated time. The machine is run through "execute" up to
+ * the end of a frame at a time and the buzzer sounds for each instruction's share of the frame when "ST" was non-zero
+ * before it, the core notes where in a frame "Fx18" turned the buzzer on or off. A frame of samples is "rate" / 60 whatever the host is doing, so a beep lasts exactly as
+ * long as the machine had the timer set for, down to a single instruction, and the samples always match the emulated
+ * time that passed. The wave's phase carries on from one call to the next so the tone has no clicks. */
+class Chip8Audio
+{
+    public:
+        Chip8Audio(u32 rate = CHIP8_AUDIO_RATE, u32 tone = CHIP8_AUDIO_TONE);
+        virtual ~Chip8Audio();
+        // Where the samples go, NULL throws them away without making them
+        void setSink(AudioSink* sink);
+        AudioSink* getSink();
+        /* Executes up to "count" instructions as "Chip8Core::execute" does, stopping early on a break or quit, and writes
+         * the samples for the time they took. Returns how many were executed */
+        u32 execute(Chip8Core& core, u32 count);
+        // Writes silence for "count" instructions' worth of time that passed without the machine running
+        void silence(Chip8Core& core, u32 count);
+        u32 getRate();
+        // Samples made so far and the ones the buzzer sounded in
+        u64 getSamples();
+        u64 getLoudSamples();
+    private:
+        // Samples owed for "instructions" more at "instructionsPerFrame", the remainder is kept for the next
+        inline u32 samplesFor(u32 instructionsPerFrame, u32 instructions);
+        void generate(bool loud, u32 count);
+        void flush();
+
+        AudioSink* sink;
+        u32 rate;
+        // The wave's phase as a fraction of a cycle in 32 bits and how far it moves a sample
+        u32 phase;
+        u32 step;
+        u64 owed;
+        u64 samples;
+        u64 loudSamples;
+        // Samples are gathered here and written a call at a time
+        s16 buffer[CHIP8_AUDIO_RING_SIZE];
+        u32 buffered;
+};
+
+#endif // AUDIO_H
@@ -0,0 +1,110 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <memory>
+#include "Def.h"
+#include "State.h"
+
+// The most machines a batch holds, one byte per machine fills an AVX2 register
+#define CHIP8_BATCH_MAX_LANES 32
+
+/* The machine state of a whole batch laid out structure of arrays, each register is a row with one entry per lane
+ * so one SIMD instruction works on the same register of every machine. Each lane's framebuffer and memory stay
+ * contiguous so they can be handed to a renderer or copied back into a CHIP8_STATE. */
+struct alignas(CHIP8_CACHE_LINE_SIZE) CHIP8_BATCH_STATE
+{
+    u8 V[CHIP8_TOTAL_GENERAL_PURPOSE_REGISTERS][CHIP8_BATCH_MAX_LANES];
+    u8 DT[CHIP8_BATCH_MAX_LANES];
+    u8 ST[CHIP8_BATCH_MAX_LANES];
+    u8 SP[CHIP8_BATCH_MAX_LANES];
+    u8 lastKeyPressed[CHIP8_BATCH_MAX_LANES];
+    u16 I[CHIP8_BATCH_MAX_LANES];
+    u16 PC[CHIP8_BATCH_MAX_LANES];
+    u16 stack[CHIP8_STACK_SIZE][CHIP8_BATCH_MAX_LANES];
+    u8 keys[CHIP8_TOTAL_KEYS][CHIP8_BATCH_MAX_LANES];
+    // The state of each lane's random number generator for "Cxkk"
+    u32 random[CHIP8_BATCH_MAX_LANES];
+    // Instructions each lane has executed since its timers last ticked
+    u32 timerPhase[CHIP8_BATCH_MAX_LANES];
+    // CHIP8_KEY_WAITING with the register to fill while "Fx0A" has a lane halted
+    u8 keyWait[CHIP8_BATCH_MAX_LANES];
+    // Instructions each lane has executed since it was reset
+    u64 instructions[CHIP8_BATCH_MAX_LANES];
+
+    // The packed display rows of each lane, a lane's 32 rows are contiguous
+    alignas(CHIP8_CACHE_LINE_SIZE) u64 pixels[CHIP8_BATCH_MAX_LANES][CHIP8_ORIGINAL_DISPLAY_HEIGHT];
+    alignas(CHIP8_CACHE_LINE_SIZE) u8 memory[CHIP8_BATCH_MAX_LANES][CHIP8_MEMORY_SIZE];
+};
+
+struct BATCH_STATS
+{
+    // Groups of lanes that shared a "PC" and opcode and were executed together
+    u64 groups;
+    // Groups that went through the SIMD kernels rather than lane by lane
+    u64 vectorGroups;
+    // Instructions executed summed over every lane
+    u64 instructions;
+};
+
+/* The Chip8Batch runs up to 32 machines together. Lanes sharing a "PC" and opcode form a group which executes the opcode
+ * once across all of its lanes with SSE2 or AVX2 kernels under a lane mask, instructions without a kernel such as
+ * "Dxyn" run lane by lane. The group with the lowest "PC" always runs next so lanes that took different paths
+ * through a branch catch up with each other and run as one group again. */
+class Chip8Batch
+{
+    public:
+        Chip8Batch(u32 lanes);
+        virtual ~Chip8Batch();
+        u32 getLanes();
+        // Starts every lane from "state", usually a core that has just loaded a ROM, each lane keeps its own seed
+        void loadState(const CHIP8_STATE& state);
+        // Copies a lane back out into a normal machine state
+        void getLaneState(u32 lane, CHIP8_STATE& state);
+        // Seeds the random number generator of a lane, a zero seed is replaced with one
+        void setSeed(u32 lane, u32 seed);
+        // A key going down resumes a lane halted on "Fx0A", lanes always resume on the press whatever the profile
+        void setKeyDown(u32 lane, u8 key);
+        void setKeyUp(u32 lane, u8 key);
+        // Returns the 32 packed display rows of a lane
+        const u64* getPixels(u32 lane);
+        // True once a lane has hit a stack error, it is not stepped any more
+        bool hasQuit(u32 lane);
+        // True while "Fx0A" has a lane halted
+        bool isWaitingForKey(u32 lane);
+        // Executes "count" instructions on every running lane, returns the instructions executed over all lanes
+        u64 run(u32 count);
+        BATCH_STATS getStats();
+        // Returns the name of the SIMD kernels compiled in, "avx2", "sse2" or "scalar"
+        static const char* getKernelName();
+        // The random number generator each lane uses for "Cxkk", the same one a core uses
+        static inline u8 nextRandom(u32& seed)
+        {
+            return chip8Random(seed);
+        }
+    protected:
+    private:
+        // Returns a bit for each lane whose "PC" is "pc"
+        u32 lanesAt(u16 pc);
+        // Executes one opcode across every lane in "mask"
+        void executeGroup(u16 opcode, u32 mask);
+        // Executes the opcode across the lanes with the SIMD kernels, returns false if there is no kernel for it
+        bool executeVector(u16 opcode, u32 mask);
+        // Executes the opcode on a single lane
+        void executeLane(u32 lane, u16 opcode);
+        // Counts an instruction towards the next timer tick for every lane in "mask"
+        void tickTimers(u32 mask);
+
+        std::unique_ptr<CHIP8_BATCH_STATE> state;
+        u32 lanes;
+        // Every lane runs at the speed of the state it was loaded from
+        u16 instructionsPerFrame;
+        // A bit for each lane that is still running
+        u32 runningMask;
+        // A bit for each lane halted on "Fx0A", it spends each run waiting until a key goes down
+        u32 waitingMask;
+        // For each 256 byte page of memory a bit for each lane that has written to it, unwritten pages hold the same code
+        u32 pageWriters[CHIP8_MEMORY_SIZE / 256];
+        BATCH_STATS stats;
+};
+
+#endif // BATCH_H
@@ -0,0 +1,168 @@
+#ifndef BREAKPOINTS_H
+#define BREAKPOINTS_H
+
+#include <string>
+#include <vector>
+#include "Def.h"
+#include "Opcode.h"
+#include "State.h"
+
+// The registers break conditions and watch points can name past "V0" to "VF", which are 0 to 15
+#define CHIP8_REGISTER_I 16
+#define CHIP8_REGISTER_DT 17
+#define CHIP8_REGISTER_ST 18
+#define CHIP8_REGISTER_SP 19
+#define CHIP8_REGISTER_PC 20
+#define CHIP8_REGISTER_COUNT 21
+
+// Watch points fire on these accesses, a register or a byte of memory can be watched for either or both
+#define CHIP8_WATCH_READ 0x01
+#define CHIP8_WATCH_WRITE 0x02
+
+// A break point location whose condition is tested before every instruction rather than at one address
+#define CHIP8_BREAK_ANYWHERE 0xffff
+
+// The deepest a compiled break condition's stack can get, deeper expressions are refused when compiled
+#define CHIP8_BREAK_STACK_SIZE 16
+
+// Returns the register with the name given such as "V3" or "dt", CHIP8_REGISTER_COUNT if there is none
+u8 findRegister(const std::string& name);
+// Returns the name of a register such as "VF" or "PC"
+const char* registerName(u8 reg);
+u16 readRegister(const CHIP8_STATE& s, u8 reg);
+// Stores "value" in a register, cut down to the register's width
+void writeRegister(CHIP8_STATE& s, u8 reg, u16 value);
+
+// The registers and memory an instruction is about to read and write, a bit per register
+struct INSTRUCTION_ACCESS
+{
+    u32 readRegisters;
+    u32 writeRegisters;
+    u16 readAddress;
+    u8 readLength;
+    u16 writeAddress;
+    u8 writeLength;
+};
+
+// Works out what "ins" will access when it executes on "s" under "quirks", the timers ticking afterwards are not part of it
+INSTRUCTION_ACCESS instructionAccess(const INSTRUCTION& ins, const CHIP8_STATE& s, u32 quirks);
+
+enum BREAK_KIND : u8
+{
+    BREAK_NONE,
+    // An execution break point at "PC"
+    BREAK_EXECUTE,
+    // A break point whose condition held
+    BREAK_CONDITION,
+    // A watch point on "reg", or on memory at "address" when "reg" is CHIP8_REGISTER_COUNT
+    BREAK_READ,
+    BREAK_WRITE
+};
+
+// Why the core last stopped, "number" counts the breaks so a poller can tell a new one from the last
+struct BREAK_EVENT
+{
+    u64 number;
+    // The instruction count of the machine, it stops before executing the instruction at "PC"
+    u64 instruction;
+    u16 PC;
+    u16 address;
+    u8 kind;
+    u8 reg;
+};
+
+// The operations of a compiled break condition, each works on a stack of 32 bit values
+enum BREAK_OP : u16
+{
+    // Pushes the operand that follows
+    BREAK_OP_CONST,
+    // Pushes the register numbered by the operand that follows
+    BREAK_OP_REGISTER,
+    // Replaces the address on the top of the stack with the byte of memory at it
+    BREAK_OP_MEMORY,
+    BREAK_OP_NOT,
+    // The rest pop two values and push the result
+    BREAK_OP_ADD,
+    BREAK_OP_SUB,
+    BREAK_OP_BITAND,
+    BREAK_OP_EQ,
+    BREAK_OP_NE,
+    BREAK_OP_LT,
+    BREAK_OP_LE,
+    BREAK_OP_GT,
+    BREAK_OP_GE,
+    BREAK_OP_AND,
+    BREAK_OP_OR
+};
+
+/* A condition such as "V3 == 0x10 && I > 0x300" compiled once into a short postfix program, testing it is a single
+ * pass over the program with no parsing. Registers are named as the debugger names them, numbers are decimal or "0x"
+ * hexadecimal and "[expression]" reads a byte of memory. The operators are "+ - &", the comparisons, "&& || !" and
+ * brackets, with C's precedence */
+class BreakCondition
+{
+    public:
+        BreakCondition();
+        // Returns false with the reason in "error" if "text" does not compile, the condition is left as it was
+        bool compile(const std::string& text, std::string& error);
+        inline bool evaluate(const CHIP8_STATE& s) const
+        {
+            u32 stack[CHIP8_BREAK_STACK_SIZE];
+            u32 top = 0;
+            const u16* op = code.data();
+            const u16* end = op + code.size();
+            while (op < end)
+            {
+                switch(*op++)
+                {
+                    case BREAK_OP_CONST: stack[top++] = *op++; break;
+                    case BREAK_OP_REGISTER: stack[top++] = readRegister(s, *op++); break;
+                    case BREAK_OP_MEMORY: stack[top - 1] = s.memory[stack[top - 1] & (CHIP8_MEMORY_SIZE - 1)]; break;
+                    case BREAK_OP_NOT: stack[top - 1] = !stack[top - 1]; break;
+                    case BREAK_OP_ADD: top--; stack[top - 1] += stack[top]; break;
+                    case BREAK_OP_SUB: top--; stack[top - 1] -= stack[top]; break;
+                    case BREAK_OP_BITAND: top--; stack[top - 1] &= stack[top]; break;
+                    case BREAK_OP_EQ: top--; stack[top - 1] = stack[top - 1] == stack[top]; break;
+                    case BREAK_OP_NE: top--; stack[top - 1] = stack[top - 1] != stack[top]; break;
+                    case BREAK_OP_LT: top--; stack[top - 1] = stack[top - 1] < stack[top]; break;
+                    case BREAK_OP_LE: top--; stack[top - 1] = stack[top - 1] <= stack[top]; break;
+                    case BREAK_OP_GT: top--; stack[top - 1] = stack[top - 1] > stack[top]; break;
+                    case BREAK_OP_GE: top--; stack[top - 1] = stack[top - 1] >= stack[top]; break;
+                    case BREAK_OP_AND: top--; stack[top - 1] = stack[top - 1] && stack[top]; break;
+                    case BREAK_OP_OR: top--; stack[top - 1] = stack[top - 1] || stack[top]; break;
+                }
+            }
+            return top && stack[0] != 0;
+        }
+        const std::string& getText() const;
+        const std::vector<u16>& getCode() const;
+    private:
+        // Recursive descent, one method per level of precedence, each appends its postfix code
+        bool parseOr();
+        bool parseAnd();
+        bool parseCompare();
+        bool parseSum();
+        bool parseUnary();
+        void skipSpace();
+        // Consumes "token" if the text continues with it
+        bool accept(const char* token);
+        void emit(u16 op, s32 stackChange);
+
+        std::string text;
+        std::vector<u16> code;
+        // While compiling, the text being compiled, the position in it, the stack depth and the first error
+        std::string source;
+        size_t at;
+        s32 depth;
+        s32 maxDepth;
+        std::string error;
+};
+
+// A break point at "location", or CHIP8_BREAK_ANYWHERE, that only breaks when its condition holds
+struct BREAK_POINT
+{
+    u16 location;
+    BreakCondition condition;
+};
+
+#endif // BREAKPOINTS_H
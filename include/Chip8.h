@@ -3,103 +3,95 @@
 
 #include <iostream>
 #include <vector>
+#include <Windows.h>
 #include <SDL/SDL.h>
 #include "Def.h"
-
-struct REGISTERS
-{
-        public:
-            // 16 8 bit general purpose registers
-            u8 V[CHIP8_TOTAL_GENERAL_PURPOSE_REGISTERS];
-            // I register 16 bit
-            u16 I;
-            // The PC(Program counter) 16 bit holds the address that holds the instruction to execute
-            u16 PC;
-            // The SP(Stack Pointer) holds the address on the stack ready for when a subroutine returns
-            u8 SP;
-
-            // Delay Timer, decrements at 60Mhz while non-zero
-            u16 DT;
-            // Sound Timer, while non-zero will sound a buzzer and decrement at 60Mhz
-            u16 ST;
-};
+#include "Audio.h"
+#include "Chip8Core.h"
+#include "Debugger.h"
+#include "Replay.h"
+#include "Rewind.h"
+#include "RunAhead.h"
+#include "Scheduler.h"
 
 class Display;
-class Keyboard;
-class Chip8
+/* The Chip8 is the SDL frontend, it drives a headless Chip8Core and handles the window, input and sound. It belongs to
+ * the thread that calls "process", other threads only use "sendDebugCommand" and read through "getDebugger" */
+class Chip8 : public Chip8Core
 {
     public:
         Chip8();
         virtual ~Chip8();
         void Init(u32 w, u32 h, PIXEL_COLOUR pcol_on, PIXEL_COLOUR pcol_off);
-        bool loadFile(char* fname);
-        bool isRunning();
-        bool hasQuit();
-        void process();
-        void reset();
-        void run();
-        void stop();
-        bool setReg(std::string reg, u16 value);
-        bool setBreakPoint(u16 location);
-        bool hasBreakPoint(u16 location);
-        u8 getMemory(u16 mLocation);
-        REGISTERS getRegs();
+        virtual void process();
+        u64 getFramesPresented();
+        u64 getFramesSkipped();
+        // The frames recorded for rewinding, holding backspace scrubs back through them
+        Chip8Rewind& getHistory();
+        // Key presses go through the replay so a session can be recorded and played back headless
+        Chip8Replay& getReplay();
+        // Presents the display "frames" frames ahead of the machine, 0 turns running ahead off
+        void setRunAhead(u32 frames);
+        Chip8RunAhead& getRunAhead();
+        // Each call to "process" runs a frame and sleeps until the next is due
+        Chip8Scheduler& getScheduler();
+        /* Presses and lets go of a key from outside the window, through the replay so a recording keeps it. Returns true
+         * if the machine was halted waiting for a key */
+        bool pressKey(u8 key);
+        /* The debugger's commands are applied at the start of each "process" and its events sent at the end. Send commands
+         * from the debugger thread through "sendDebugCommand", which also wakes the frame loop if it is asleep */
+        Chip8Debugger& getDebugger();
+        bool sendDebugCommand(const DEBUG_COMMAND& command);
+        // The buzzer is made from "ST" a frame at a time and played through the SDL audio callback
+        Chip8Audio& getAudio();
+        AUDIO_RING_STATS getAudioStats();
     protected:
+        virtual void badOpcode(u16 opcode);
     private:
-        // A sound thread to handle the bleeps separately
-        static LPTHREAD_START_ROUTINE soundThread(LPVOID lpvoid);
-        // Pushes a 16 bit value on to the stack then increments the "SP" by 1
-        bool stack_push(u16 value);
-        // Pops a 16 value off the stack then decrements the "SP" by 1
-        u16 stack_pop();
+        // Called by SDL on its audio thread for "len" bytes of samples
+        static void audioCallback(void* userdata, Uint8* stream, int len);
+        // Starts or pauses the audio device, it is paused while the frame loop sleeps so the silence is not underruns
+        void playAudio(bool play);
         // Processes the keyboard
         void processKeyboard();
-        // Process the SDL event if their is any
+        // Process the SDL events if their are any
         void processSDLEvent();
-        // Decodes and processes the current opcode
-        void processOpcode();
+        // Presents the machine's display or the one running ahead reached
+        void present();
+        // Applies every debugger command waiting, on the thread running the machine
+        void applyDebugCommands();
+        // Applies a command only the frontend knows and sends its reply
+        void applyFrontendCommand(const DEBUG_COMMAND& command);
 
-        // A handle to the sound thread
-        HANDLE sThread;
+        Chip8Audio audio;
+        // The samples waiting for the audio callback
+        RingAudioSink audioRing;
+        bool audioOpen;
+        bool audioPlaying;
 
-        // This is true if the chip8 is running
-        bool running;
-        // This is true if the chip8 has quit
-        bool quit;
-        // The chip 8 memory
-        u8 memory[CHIP8_MEMORY_SIZE];
-        // The charset
-        const static u8 charset[CHIP8_CHARSET_SIZE];
-        // The stack memory, chip8 uses 16 bit values and up to 16 elements
-        u16 stack[CHIP8_STACK_SIZE];
-        // 16 8 bit general purpose registers
-        u8 V[CHIP8_TOTAL_GENERAL_PURPOSE_REGISTERS];
-        // I register 16 bit
-        u16 I;
-        // The PC(Program counter) 16 bit holds the address that holds the instruction to execute
-        u16 PC;
-        // The SP(Stack Pointer) holds the address on the stack ready for when a subroutine returns
-        u8 SP;
+        // This is the display of the chip8
+        Display* display;
 
-        // Delay Timer, decrements at 60Mhz while non-zero
-        u16 DT;
-        // Sound Timer, while non-zero will sound a buzzer and decrement at 60Mhz
-        u16 ST;
+        // A frame is recorded each time the display is presented and while rewinding a frame is stepped back instead
+        Chip8Rewind history;
+        bool rewinding;
 
-        // The time of the last cycle the ticks are based on when SDL started rather than system time.
-        u32 lastCycleTime;
+        Chip8Replay replay;
 
-        // This is the display of the chip8
-        Display* display;
+        Chip8RunAhead runAhead;
+        // Set when the display has been pointed at another framebuffer and has to be presented in full
+        u32 redrawRows;
+
+        // Tab in the window shows the debugger's heatmap over the display while one is being counted
+        bool showHeatmap;
+        u32 heatmapColours[CHIP8_MEMORY_SIZE];
 
-        // This is the chip8's keyboard
-        Keyboard* keyboard;
+        Chip8Scheduler scheduler;
+
+        Chip8Debugger debugger;
 
         // This is the SDL event that contains information about an event by SDL
         SDL_Event sdl_event;
-
-        // Break points, used for debugging
-        std::vector<u16> breakPoints;
 };
 
 #endif // CHIP8_H
@@ -0,0 +1,388 @@
+#ifndef CHIP8CORE_H
+#define CHIP8CORE_H
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "Breakpoints.h"
+#include "Compiled.h"
+#include "Def.h"
+#include "Fusion.h"
+#include "Heatmap.h"
+#include "Idle.h"
+#include "Jit.h"
+#include "Opcode.h"
+#include "Profiler.h"
+#include "Quirks.h"
+#include "Savestate.h"
+#include "State.h"
+#include "Trace.h"
+
+struct REGISTERS
+{
+        public:
+            // 16 8 bit general purpose registers
+            u8 V[CHIP8_TOTAL_GENERAL_PURPOSE_REGISTERS];
+            // I register 16 bit
+            u16 I;
+            // The PC(Program counter) 16 bit holds the address that holds the instruction to execute
+            u16 PC;
+            // The SP(Stack Pointer) holds the address on the stack ready for when a subroutine returns
+            u8 SP;
+
+            // Delay Timer, decrements at 60Mhz while non-zero
+            u16 DT;
+            // Sound Timer, while non-zero will sound a buzzer and decrement at 60Mhz
+            u16 ST;
+};
+
+enum DISPATCH_ENGINE
+{
+    DISPATCH_SWITCH = CHIP8_DISPATCH_SWITCH,
+    DISPATCH_TABLE = CHIP8_DISPATCH_TABLE,
+    DISPATCH_GOTO = CHIP8_DISPATCH_GOTO,
+    DISPATCH_CACHE = CHIP8_DISPATCH_CACHE,
+    DISPATCH_JIT = CHIP8_DISPATCH_JIT,
+    DISPATCH_COMPILED = CHIP8_DISPATCH_COMPILED
+};
+
+// How well the predecoded instruction cache is doing
+struct DECODE_CACHE_STATS
+{
+    // Instructions executed straight from the cache
+    u64 hits;
+    // Instructions that had to be decoded into the cache first
+    u64 misses;
+    // Cached instructions thrown away because memory they were decoded from was written to
+    u64 invalidations;
+};
+
+// How long "Fx0A" has kept the machine halted
+struct KEY_WAIT_STATS
+{
+    // Times the machine halted waiting for a key
+    u64 waits;
+    // Instructions' worth of emulated time spent halted, they are counted as executed so the timers and replays keep time
+    u64 instructions;
+};
+
+// The writes to "ST" a frame can hold on to, see "getSoundWrites"
+#define CHIP8_SOUND_WRITES 16
+
+// A write to "ST" that turned the buzzer on or off, "phase" is the "timerPhase" of the instruction after it
+struct SOUND_WRITE
+{
+    u32 phase;
+    bool loud;
+};
+
+/* The Chip8Core is the headless emulation core, it has no knowledge of SDL or the operating system.
+ * All of the machine state lives in a single CHIP8_STATE block so constructing a core is just filling that block. */
+class Chip8Core
+{
+    public:
+        Chip8Core();
+        virtual ~Chip8Core();
+        bool loadFile(const char* fname);
+        bool loadMemory(const u8* data, u32 size);
+        bool isRunning();
+        bool hasQuit();
+        virtual void process();
+        /* Executes up to "count" instructions stopping early on a break point, watch point or quit, returns how many were
+         * executed. While "Fx0A" has the machine halted the rest of "count" passes as time spent waiting and is counted
+         * too. Running on after a break carries on past the instruction broken on */
+        u32 execute(u32 count);
+        // Chooses the engine opcodes are dispatched with, CHIP8_DISPATCH_ENGINE picks the default
+        void setDispatchEngine(DISPATCH_ENGINE engine);
+        DISPATCH_ENGINE getDispatchEngine();
+        // Chooses the quirk profile, every engine has a copy of its loop compiled for each profile
+        void setQuirkProfile(QUIRK_PROFILE profile);
+        QUIRK_PROFILE getQuirkProfile();
+        void reset();
+        void run();
+        void stop();
+        bool setReg(std::string reg, u16 value);
+
+        // Break points are a bit per address, testing for one costs the same however many are set
+        bool setBreakPoint(u16 location);
+        /* A break point that only breaks when "condition" holds, such as "V3 == 0x10 && I > 0x300", the condition is
+         * compiled here rather than parsed on every test. At CHIP8_BREAK_ANYWHERE it is tested before every instruction.
+         * Returns false with the reason in "error" if the condition does not compile. A break point replaces any already
+         * at "location" */
+        bool setBreakPoint(u16 location, const std::string& condition, std::string& error);
+        inline bool hasBreakPoint(u16 location)
+        {
+            location &= CHIP8_MEMORY_SIZE - 1;
+            return (breakBits[location >> 6] >> (location & 63)) & 1;
+        }
+        void clearBreakPoint(u16 location);
+        void clearBreakPoints();
+        // Every address with a break point, in order
+        std::vector<u16> getBreakPoints();
+        // The break points that have conditions
+        const std::vector<BREAK_POINT>& getBreakConditions();
+        // Breaks before an instruction accesses any of "length" bytes from "address" in one of the "access" ways, CHIP8_WATCH_READ and CHIP8_WATCH_WRITE
+        void setWatchPoint(u16 address, u16 length, u8 access);
+        // Breaks before an instruction accesses "reg", as "findRegister" numbers them. "PC" cannot be watched, use a condition
+        bool setRegisterWatchPoint(u8 reg, u8 access);
+        void clearWatchPoints();
+        // Why the machine last broke, "number" is zero until it first does
+        BREAK_EVENT getLastBreak();
+
+        u8 getMemory(u16 mLocation);
+        // Writes memory for the debugger, any cached instruction at the location is thrown away
+        void setMemory(u16 mLocation, u8 value);
+        REGISTERS getRegs();
+        // Seeds the random number generator "Cxkk" draws from, a zero seed is replaced with one
+        void setSeed(u32 seed);
+        // Instructions executed since the last reset, the clock replays are timed against
+        u64 getInstructions();
+        // The instructions in a 60Hz frame of emulated time, the timers tick once every frame and the frontend runs this many a frame
+        void setInstructionsPerFrame(u16 instructions);
+        u16 getInstructionsPerFrame();
+        /* The writes to "ST" that turned the buzzer on or off since "clearSoundWrites", in the order they were made, so
+         * a frame run in one call can be split where it sounded. Only CHIP8_SOUND_WRITES are kept, any after that take
+         * the place of the last one */
+        void clearSoundWrites();
+        u32 getSoundWrites(const SOUND_WRITE*& writes);
+        // Copies the whole machine into "to", the copy and its checksum are a single pass
+        void saveState(SAVESTATE& to);
+        // Restores a machine saved by "saveState", a savestate that fails its checks is refused and nothing changes
+        bool loadState(const SAVESTATE& from);
+
+        // Predecoded instruction cache
+        DECODE_CACHE_STATS getDecodeCacheStats();
+        // Throws away every cached instruction and translated block, call this after changing memory through "getState"
+        void flushDecodeCache();
+        // Superinstructions, "mask" has a bit for each FUSED_PATTERN the cache engine should fuse
+        void setFusedPatterns(u32 mask);
+        u32 getFusedPatterns();
+        FUSION_STATS getFusionStats();
+        // While profiling is on every engine is replaced by one that records runs of opcode classes into the profile
+        void setProfiling(bool on);
+        // Returns NULL if profiling has never been turned on
+        const OPCODE_PROFILE* getOpcodeProfile();
+        /* While a tracer is set every engine is replaced by one that records each instruction into it and idle loops
+         * are stepped rather than skipped, NULL stops tracing. The core does not own the tracer */
+        void setTracer(Chip8Tracer* tracer);
+        Chip8Tracer* getTracer();
+        /* While a profiler is set every instruction is counted into it by address, the same engine as tracing runs and
+         * idle loops are stepped, NULL stops profiling. The core does not own the profiler */
+        void setProfiler(Chip8Profiler* profiler);
+        Chip8Profiler* getProfiler();
+        /* While a heatmap is set the reads, writes and executes of every byte of memory are counted into it, the same
+         * engine as tracing runs and idle loops are stepped, NULL stops counting. The core does not own the heatmap */
+        void setHeatmap(Chip8Heatmap* heatmap);
+        Chip8Heatmap* getHeatmap();
+
+        /* Idle loop skipping, a short loop that only waits on the delay timer or the keys is run once to check it and
+         * then skipped to the next timer tick, or to the end of the "execute" call if it never reads the timer */
+        void setIdleSkipping(bool on);
+        bool getIdleSkipping();
+        IDLE_STATS getIdleStats();
+
+        // How much of the program the jit engine has translated
+        JIT_STATS getJitStats();
+        // How much of the program the compiled engine ran from compiled code
+        COMPILED_STATS getCompiledStats();
+        // True once an instruction has written over code the loaded compiled program was built from
+        inline bool isCompiledCodeStale()
+        {
+            return compiledStale;
+        }
+
+        // Keyboard
+        void setKeyDown(u8 key);
+        void setKeyUp(u8 key);
+        bool keyDown(u8 key);
+        bool keyUp(u8 key);
+        u8 getLastKeyPressed();
+        // True while "Fx0A" has the machine halted, a key press resumes it, or letting go of the key under CHIP8_QUIRK_KEY_RELEASE
+        bool isWaitingForKey();
+        // Presses and lets go of "key" for headless drivers, returns true if the machine was waiting for a key
+        bool injectKey(u8 key);
+        KEY_WAIT_STATS getKeyWaitStats();
+
+        // Display
+        void clearScreen();
+        void setPixel(u16 x, u16 y, bool on, bool XOR = false);
+        bool getPixel(u16 x, u16 y);
+        // Draws "n" rows of "sprite" at "x", "y" wrapping around the edges, returns true if any pixel was turned off
+        bool drawSprite(u8 x, u8 y, const u8* sprite, u8 n);
+        // The same as "drawSprite" but the parts of the sprite past the right and bottom edges are not drawn
+        bool drawSpriteClipped(u8 x, u8 y, const u8* sprite, u8 n);
+        // Returns the packed display rows, the most significant bit of a row is its left most pixel
+        const u64* getPixels();
+        // Returns a bit per display row that has changed since the last call, bit 0 is the top row
+        u32 takeDirtyRows();
+
+        // Direct access to the whole machine state
+        CHIP8_STATE& getState();
+    protected:
+        friend struct Handlers;
+        template<u32 QUIRKS> friend struct QuirkHandlers;
+        friend class Chip8Pool;
+        friend class Chip8Rewind;
+        friend class Chip8RunAhead;
+        // Decodes and processes the current opcode
+        void processOpcode();
+        // Called when an opcode that is not supported is met
+        virtual void badOpcode(u16 opcode);
+
+        // This is true if the chip8 is running
+        bool running;
+        // This is true if the chip8 has quit
+        bool quit;
+    private:
+        typedef u32 (Chip8Core::*ENGINE)(u32 count);
+
+        // The interpreter engines and handler table instantiated for the quirks of one profile
+        struct QUIRK_ENGINES
+        {
+            u32 quirks;
+            ENGINE switchEngine;
+            ENGINE tableEngine;
+            ENGINE gotoEngine;
+            ENGINE instrumentedEngine;
+            const OPCODE_HANDLER* handlers;
+        };
+        static const QUIRK_ENGINES quirkEngines[QUIRK_PROFILE_COUNT];
+
+        // The engines stop on a quit and when "Fx0A" halts the machine
+        inline bool stopped()
+        {
+            return quit || state.keyWait;
+        }
+        // Notes an instruction turning the buzzer on or off, it is called before the timers tick for the instruction
+        inline void noteSoundWrite(bool loud)
+        {
+            u32 n = soundWriteCount < CHIP8_SOUND_WRITES ? soundWriteCount++ : CHIP8_SOUND_WRITES - 1;
+            soundWrites[n].phase = state.timerPhase + 1;
+            soundWrites[n].loud = loud;
+        }
+        // Stores "key" in the register "Fx0A" is waiting to fill and lets the machine carry on
+        void resumeKeyWait(u8 key);
+        // Executes up to "count" instructions on the current engine without checking break points and counts them
+        u32 dispatch(u32 count);
+        // Steps up to "count" instructions one at a time checking the break and watch points before each
+        u32 executeDebugging(u32 count);
+        // Returns true, recording why in "lastBreak", if the machine should break before the instruction at "PC"
+        bool checkBreak();
+        bool recordBreak(u8 kind, u16 address, u8 reg);
+        // Works out whether any break or watch point is set, "execute" only steps one instruction at a time while one is
+        void updateDebugging();
+        // Executes up to "count" instructions on the current engine, or the instrumented or profiling one while one is on
+        u32 runEngine(u32 count);
+        // Runs the engine in slices between looks for idle loops
+        u32 dispatchSkippingIdle(u32 count);
+        /* Looks for an idle loop through "PC" and skips as much of it as "count" allows, returns the instructions
+         * stepped and skipped and the instructions to run before looking again in "resume" */
+        u32 skipIdle(u32 count, u32& resume);
+        // Puts off the next look at an address whose look found no idle loop
+        void missIdle(IDLE_BACKOFF& backoff);
+        // The dispatch engines, each executes up to "count" instructions and returns how many were executed
+        template<u32 QUIRKS> u32 executeSwitch(u32 count);
+        template<u32 QUIRKS> u32 executeTable(u32 count);
+        template<u32 QUIRKS> u32 executeGoto(u32 count);
+        u32 executeCached(u32 count);
+        u32 executeJit(u32 count);
+        u32 executeCompiled(u32 count);
+        u32 executeProfiled(u32 count);
+        template<u32 QUIRKS> u32 executeInstrumented(u32 count);
+
+        // Every write to memory made by an instruction goes through here so the decode cache, jit and compiled code see it
+        inline void writeMemory(u16 address, u8 value)
+        {
+            address &= CHIP8_MEMORY_SIZE - 1;
+            state.memory[address] = value;
+            if (decodeCache)
+                invalidateDecodeCache(address);
+            if (jit)
+                jit->invalidate(address);
+            if (compiled && (compiled->code[address >> 6] >> (address & 63)) & 1)
+                compiledStale = true;
+        }
+        // Throws away the cached instructions that were decoded from "address"
+        void invalidateDecodeCache(u16 address);
+        // Fuses the cached instruction at "address" with the ones after it if they match an enabled pattern
+        void fuseDecodeCache(u16 address);
+
+        // Pushes a 16 bit value on to the stack then increments the "SP" by 1
+        bool stack_push(u16 value);
+        // Pops a 16 value off the stack then decrements the "SP" by 1
+        u16 stack_pop();
+
+        // The charset
+        const static u8 charset[CHIP8_CHARSET_SIZE];
+
+        // The whole machine state
+        CHIP8_STATE state;
+
+        // A bit per display row that has been touched by "00E0" or "Dxyn" since the frontend last presented
+        u32 dirtyRows;
+
+        // The engine opcodes are dispatched with
+        DISPATCH_ENGINE engine;
+        // The quirk profile and the engines compiled for it
+        QUIRK_PROFILE quirkProfile;
+        const QUIRK_ENGINES* quirks;
+
+        /* The predecoded instruction cache, one entry for every address an instruction can start at. It is only
+         * allocated when the cache engine first runs so cores that never use it stay small and quick to build */
+        std::unique_ptr<CACHED_INSTRUCTION[]> decodeCache;
+        DECODE_CACHE_STATS decodeCacheStats;
+
+        // The FUSED_PATTERN bits the cache engine fuses
+        u32 fusedPatternMask;
+        FUSION_STATS fusionStats;
+
+        // The opcode profile, allocated when profiling is first turned on, and the last two classes executed
+        bool profiling;
+        std::unique_ptr<OPCODE_PROFILE> opcodeProfile;
+        u8 profileHistory[2];
+
+        // The tracer every instruction is recorded into, NULL when not tracing
+        Chip8Tracer* tracer;
+        // The profiler every instruction is counted into, NULL when not profiling
+        Chip8Profiler* profiler;
+        // The heatmap every memory access is counted into, NULL when not counting
+        Chip8Heatmap* heatmap;
+
+        // Idle loop skipping and, allocated when it first looks, a count of looks still to skip at each address
+        bool idleSkipping;
+        IDLE_STATS idleStats;
+        std::unique_ptr<IDLE_BACKOFF[]> idleBackoff;
+
+        // Time spent halted on "Fx0A"
+        KEY_WAIT_STATS keyWaitStats;
+
+        // Where "Fx18" turned the buzzer on or off since "clearSoundWrites"
+        SOUND_WRITE soundWrites[CHIP8_SOUND_WRITES];
+        u32 soundWriteCount;
+
+        // The block translator, allocated when the jit engine first runs
+        std::unique_ptr<Jit> jit;
+
+        // The compiled program for the loaded ROM, looked up when the compiled engine first runs after a load
+        const COMPILED_PROGRAM* compiled;
+        bool compiledLookedUp;
+        bool compiledStale;
+        COMPILED_STATS compiledStats;
+
+        // Break points, a bit for every address, and the conditions on the ones that have them
+        u64 breakBits[CHIP8_MEMORY_SIZE / 64];
+        std::vector<BREAK_POINT> breakConditions;
+        // A CHIP8_WATCH_READ and CHIP8_WATCH_WRITE flag per address, allocated with the first watch point on memory
+        std::unique_ptr<u8[]> watchedMemory;
+        bool watchingMemory;
+        // A bit per register watched for reads and for writes
+        u32 watchedReads;
+        u32 watchedWrites;
+        // True while any break or watch point is set
+        bool debugging;
+        // The last break and whether the instruction it stopped before is let through when execution carries on
+        BREAK_EVENT lastBreak;
+        bool breakResume;
+};
+
+#endif // CHIP8CORE_H
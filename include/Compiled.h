@@ -0,0 +1,48 @@
+#ifndef COMPILED_H
+#define COMPILED_H
+
+#include "Def.h"
+#include "State.h"
+
+class Chip8Core;
+
+/* A ROM that tools/Recompiler turned into C++ ahead of time. "run" executes compiled blocks for up to "count"
+ * instructions and returns how many it executed, it returns early whenever "PC" is not the start of a compiled
+ * block or the code it was compiled from has been written over so the interpreter can take the next instruction. */
+struct COMPILED_PROGRAM
+{
+    // The name of the ROM the program was compiled from
+    const char* name;
+    // The ROM, it has to match what is loaded at 0x200 for the compiled code to be used
+    const u8* rom;
+    u32 romSize;
+    // A bit for every byte of memory that compiled code was built from, bit 0 of code[0] is address 0
+    u64 code[CHIP8_MEMORY_SIZE / 64];
+    u32 (*run)(Chip8Core& core, u32 count);
+    // The quirk bits the program was compiled for, it is only used by cores with the same quirks
+    u32 quirks;
+};
+
+// How much of the work the compiled code did
+struct COMPILED_STATS
+{
+    // Instructions executed by compiled code
+    u64 compiled;
+    // Instructions the interpreter had to execute
+    u64 interpreted;
+};
+
+// Makes a compiled program available to every core, generated files do this from a static COMPILED_PROGRAM_REGISTRAR
+void registerCompiledProgram(const COMPILED_PROGRAM* program);
+// Returns the compiled program for the ROM loaded in "state", NULL if there is none
+const COMPILED_PROGRAM* findCompiledProgram(const CHIP8_STATE& state);
+
+struct COMPILED_PROGRAM_REGISTRAR
+{
+    COMPILED_PROGRAM_REGISTRAR(const COMPILED_PROGRAM* program)
+    {
+        registerCompiledProgram(program);
+    }
+};
+
+#endif // COMPILED_H
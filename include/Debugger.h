@@ -0,0 +1,207 @@
+#ifndef DEBUGGER_H
+#define DEBUGGER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include "Breakpoints.h"
+#include "Def.h"
+#include "Heatmap.h"
+#include "LockFree.h"
+#include "Profiler.h"
+#include "Trace.h"
+
+class Chip8Core;
+
+// Commands waiting to be applied and events waiting to be taken, a full queue refuses commands and drops events
+#define CHIP8_DEBUG_COMMANDS 64
+#define CHIP8_DEBUG_EVENTS 256
+// The longest break condition or message a command or event carries, including its terminator
+#define CHIP8_DEBUG_TEXT_SIZE 64
+// The most memory a single read returns
+#define CHIP8_DEBUG_READ_SIZE 16
+
+enum DEBUG_COMMAND_KIND : u8
+{
+    DEBUG_RUN,
+    DEBUG_STOP,
+    // Executes "value" instructions whether the machine is running or not
+    DEBUG_STEP,
+    // Stores "value" in the register "reg", numbered as "findRegister" numbers them
+    DEBUG_SET_REGISTER,
+    // Reads "length" bytes from "address", the bytes come back in a DEBUG_EVENT_MEMORY
+    DEBUG_READ_MEMORY,
+    DEBUG_WRITE_MEMORY,
+    // Sets a break point at "address" on the condition in "text", which is empty for none
+    DEBUG_BREAK,
+    DEBUG_UNBREAK,
+    DEBUG_CLEAR_BREAKS,
+    // Sends a DEBUG_EVENT_BREAK_POINT for each break point
+    DEBUG_LIST_BREAKS,
+    // Watches "length" bytes from "address" for the "access" given
+    DEBUG_WATCH,
+    DEBUG_WATCH_REGISTER,
+    DEBUG_UNWATCH,
+    // Presses and lets go of the key "reg"
+    DEBUG_KEY,
+    /* Traces every instruction into the file named in "text", keeping only the last "value" blocks if it is non-zero.
+     * An empty "text" stops tracing */
+    DEBUG_TRACE,
+    /* Counts every instruction by address from now on if "value" is non-zero. Zero stops, sends a summary and writes
+     * the profile for callgrind viewers to the file named in "text" if there is one */
+    DEBUG_PROFILE,
+    /* Counts the reads, writes and executes of every byte of memory from now on if "value" is non-zero. Zero stops,
+     * sends a summary and writes the counts to the file named in "text" if there is one, as CSV if it ends in ".csv" */
+    DEBUG_HEATMAP,
+    // Runs "value" instructions in each 60Hz frame
+    DEBUG_INSTRUCTIONS_PER_FRAME,
+    // Sends how many idle loops were found and the instructions they skipped
+    DEBUG_IDLE,
+    /* The frontend's commands, a core on its own refuses them with a DEBUG_EVENT_ERROR. The frontend applies them on
+     * the thread running the machine like the rest and replies with DEBUG_EVENT_INFO */
+    // Presents the display "value" frames ahead of the machine, 0 turns running ahead off
+    DEBUG_RUN_AHEAD,
+    // Runs at 60 frames a second if "value" is non-zero and as fast as the host can otherwise
+    DEBUG_PACE,
+    // Sends how many frames were presented and skipped
+    DEBUG_FRAMES,
+    // Sends how much rewind history is held
+    DEBUG_HISTORY,
+    // Sends how closely the frames kept to 60 a second
+    DEBUG_PACING,
+    /* Records key presses from now on if "value" is non-zero. Zero stops and saves the recording to the file named in
+     * "text" */
+    DEBUG_RECORD
+};
+
+// A command from the debugger, it is applied between "execute" calls so never part way through an instruction
+struct DEBUG_COMMAND
+{
+    u8 kind;
+    u8 reg;
+    u8 access;
+    u16 address;
+    u16 length;
+    u32 value;
+    char text[CHIP8_DEBUG_TEXT_SIZE];
+};
+
+// The registers as they were between two "execute" calls
+struct DEBUG_SNAPSHOT
+{
+    u64 instructions;
+    // Breaks so far, the "number" of the last BREAK_EVENT
+    u64 breaks;
+    u16 I;
+    u16 PC;
+    u8 V[CHIP8_TOTAL_GENERAL_PURPOSE_REGISTERS];
+    u8 SP;
+    u8 DT;
+    u8 ST;
+    u8 keyWait;
+    bool running;
+};
+
+enum DEBUG_EVENT_KIND : u8
+{
+    // The machine broke, "why" says why
+    DEBUG_EVENT_BREAK,
+    // A DEBUG_STEP finished without breaking after "value" instructions
+    DEBUG_EVENT_STEPPED,
+    // "length" bytes read from "address"
+    DEBUG_EVENT_MEMORY,
+    // A break point at "address", CHIP8_BREAK_ANYWHERE for a condition tested everywhere, on the condition in "text"
+    DEBUG_EVENT_BREAK_POINT,
+    // A command could not be applied, "text" says why
+    DEBUG_EVENT_ERROR,
+    // Tracing stopped, "text" says what was recorded
+    DEBUG_EVENT_TRACED,
+    // Profiling stopped, one of these for each line of the summary in "text"
+    DEBUG_EVENT_PROFILED,
+    // A heatmap stopped, one of these for each line of the summary in "text"
+    DEBUG_EVENT_HEATMAP,
+    // A command's reply, one of these for each line of it in "text"
+    DEBUG_EVENT_INFO
+};
+
+struct DEBUG_EVENT
+{
+    u8 kind;
+    BREAK_EVENT why;
+    // The registers when the event was sent
+    DEBUG_SNAPSHOT registers;
+    u16 address;
+    u8 length;
+    u8 bytes[CHIP8_DEBUG_READ_SIZE];
+    u32 value;
+    char text[CHIP8_DEBUG_TEXT_SIZE];
+};
+
+/* Connects a debugger thread to the thread running the machine without either locking the machine. Commands go one way
+ * and events the other through single producer, single consumer queues, and the registers are published through a
+ * seqlock any thread can read. A thread with nothing to do sleeps in "waitCommand" or "waitEvent" and is woken by the
+ * other side, the mutex behind that is only taken when a side is asleep. One thread sends commands and takes events,
+ * one thread runs the machine */
+class Chip8Debugger
+{
+    public:
+        Chip8Debugger();
+        virtual ~Chip8Debugger();
+
+        // Debugger side, returns false if the command queue is full
+        bool send(const DEBUG_COMMAND& command);
+        bool pollEvent(DEBUG_EVENT& event);
+        // Sleeps until an event arrives, returns false once the debugger is closed and every event has been taken
+        bool waitEvent(DEBUG_EVENT& event);
+        // Any thread, the registers as of the last "publish"
+        DEBUG_SNAPSHOT getSnapshot() const;
+        // Events dropped because the debugger side was not taking them
+        u64 getDroppedEvents() const;
+
+        // Machine side
+        bool nextCommand(DEBUG_COMMAND& command);
+        // Sleeps until a command arrives or the debugger is closed
+        void waitCommand();
+        void apply(Chip8Core& core, const DEBUG_COMMAND& command);
+        // Applies every command waiting then publishes, returns how many were applied
+        u32 applyCommands(Chip8Core& core);
+        // Sends an event for a break the machine made since the last call and publishes the registers
+        void publish(Chip8Core& core);
+        // Sends an event of "kind" carrying "text", cut short if it does not fit
+        void sendText(Chip8Core& core, u8 kind, const std::string& text);
+
+        // Wakes both sides for good, "waitEvent" returns false once the events are drained
+        void close();
+        bool isClosed() const;
+    private:
+        // A side's way to sleep, the other side only takes the mutex to wake it if "sleeping" is set
+        struct WAKE
+        {
+            std::atomic<bool> sleeping;
+            std::mutex lock;
+            std::condition_variable wake;
+        };
+        template<typename READY> void sleep(WAKE& side, READY ready);
+        void wake(WAKE& side);
+        DEBUG_SNAPSHOT snapshotOf(Chip8Core& core);
+        void sendEvent(DEBUG_EVENT& event, Chip8Core& core);
+
+        SpscQueue<DEBUG_COMMAND, CHIP8_DEBUG_COMMANDS> commands;
+        SpscQueue<DEBUG_EVENT, CHIP8_DEBUG_EVENTS> events;
+        SeqLock<DEBUG_SNAPSHOT> snapshot;
+        // The tracer DEBUG_TRACE records into, only touched on the machine side
+        Chip8Tracer tracer;
+        // The profiler DEBUG_PROFILE counts into, only touched on the machine side
+        Chip8Profiler profiler;
+        // The heatmap DEBUG_HEATMAP counts into, only touched on the machine side
+        Chip8Heatmap heatmap;
+        WAKE machineSide;
+        WAKE debuggerSide;
+        std::atomic<bool> closed;
+        std::atomic<u64> droppedEvents;
+        // The last break an event was sent for, only touched on the machine side
+        u64 breaksSent;
+};
+
+#endif // DEBUGGER_H
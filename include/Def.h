@@ -2,17 +2,62 @@
 #define DEF_H_INCLUDED
 
 #define CHIP8_DEBUG_MODE true
-#define CHIP8_NO_DELAY true
+// With no delay the frontend runs frames as fast as the host can instead of 60 a second
+#define CHIP8_NO_DELAY false
 
 /* Definitions that need to be used throughout the project should be declared here */
 #define CHIP8_ORIGINAL_DISPLAY_WIDTH 64
 #define CHIP8_ORIGINAL_DISPLAY_HEIGHT 32
 #define CHIP8_RESOLUTION CHIP8_ORIGINAL_DISPLAY_WIDTH * CHIP8_ORIGINAL_DISPLAY_HEIGHT
-#define CHIP8_MEMORY_SIZE 0xfff
+#define CHIP8_MEMORY_SIZE 0x1000
+#define CHIP8_PROGRAM_LOAD_ADDRESS 0x200
 #define CHIP8_STACK_SIZE 16
 #define CHIP8_TOTAL_GENERAL_PURPOSE_REGISTERS 16
+#define CHIP8_TOTAL_KEYS 16
+// Set in the state's "keyWait" while "Fx0A" has the machine halted, the low nibble holds the register or key
+#define CHIP8_KEY_WAITING 0x80
 #define CHIP8_CHARSET_SIZE 80
-#define CHIP8_SPEED_MS 17
+// The display is presented at most this many times a second
+#define CHIP8_FRAMES_PER_SECOND 60
+// Instructions run in each 60Hz frame of emulated time, the timers tick once a frame. 10 is about what a COSMAC VIP managed
+#define CHIP8_INSTRUCTIONS_PER_FRAME 10
+// The frontend's rewind history, the bytes of deltas and the frames it holds, ten minutes at 60 frames a second
+#define CHIP8_REWIND_BYTES (16 * 1024 * 1024)
+#define CHIP8_REWIND_FRAMES (CHIP8_FRAMES_PER_SECOND * 60 * 10)
+// Frames the frontend presents ahead of the machine to hide input lag, off until the 'runahead' command turns it on
+#define CHIP8_RUN_AHEAD_FRAMES 0
+#define CHIP8_RUN_AHEAD_MAX_FRAMES 4
+// The frontend skips loops that only wait on the delay timer or the keys instead of stepping through them
+#define CHIP8_IDLE_SKIPPING true
+
+/* The engine the core dispatches opcodes with. The switch engine is the plain reference, the table engine calls through
+ * a table of handlers, the goto engine uses computed gotos which only GCC and Clang support, the cache engine
+ * executes from a cache of instructions that were decoded the first time their address was executed, the jit
+ * engine translates basic blocks into x86-64 code and the compiled engine runs ROMs that tools/Recompiler turned
+ * into C++ ahead of time. */
+#define CHIP8_DISPATCH_SWITCH 0
+#define CHIP8_DISPATCH_TABLE 1
+#define CHIP8_DISPATCH_GOTO 2
+#define CHIP8_DISPATCH_CACHE 3
+#define CHIP8_DISPATCH_JIT 4
+#define CHIP8_DISPATCH_COMPILED 5
+#if defined(__GNUC__) || defined(__clang__)
+    #define CHIP8_DISPATCH_ENGINE CHIP8_DISPATCH_GOTO
+#else
+    #define CHIP8_DISPATCH_ENGINE CHIP8_DISPATCH_TABLE
+#endif
+
+/* Forces a function inline wherever it is called. The handlers and the decoder are built into a dozen engines in
+ * Dispatch.cpp and GCC runs out of its inlining budget part way through that file, leaving calls in the hottest
+ * loops otherwise */
+#if defined(__GNUC__) || defined(__clang__)
+    #define CHIP8_ALWAYS_INLINE inline __attribute__((always_inline))
+#else
+    #define CHIP8_ALWAYS_INLINE inline
+#endif
+
+// The machine state is aligned to this so that the registers never straddle a cache line
+#define CHIP8_CACHE_LINE_SIZE 64
 
 typedef unsigned short u16;
 typedef unsigned char u8;
@@ -20,6 +65,8 @@ typedef signed short s16;
 typedef signed char s8;
 typedef unsigned int u32;
 typedef signed int s32;
+typedef unsigned long long u64;
+typedef signed long long s64;
 
 typedef u32 PIXEL_COLOUR;
 
@@ -3,21 +3,26 @@
 
 #include <SDL/SDL.h>
 #include "Def.h"
+/* The Display renders the framebuffer of a chip8 core to an SDL surface, it does not own the pixels */
 class Display
 {
     public:
         Display();
         virtual ~Display();
-        void Init(u32 w, u32 h, PIXEL_COLOUR pcol_on, PIXEL_COLOUR pcol_off);
-        void process();
-        bool* getPixels();
-        void setPixel(u16 x, u16 y, bool on, bool XOR = false);
-        bool getPixel(u16 x, u16 y);
-        void clear();
+        void Init(u32 w, u32 h, PIXEL_COLOUR pcol_on, PIXEL_COLOUR pcol_off, const u64* pixels);
+        // Presents a frame, only the rows set in "dirtyRows" are redrawn and nothing is flipped when it is zero
+        void process(u32 dirtyRows);
+        // Points the display at another framebuffer, the caller presents every row next
+        void setPixels(const u64* pixels);
+        /* Covers the window with a cell for each byte of memory, 64 to a row, in the 0x00RRGGBB colours "colours" holds.
+         * The frame after it goes has to be presented in full */
+        void drawHeatmap(const u32* colours);
+        u64 getFramesPresented();
+        u64 getFramesSkipped();
     protected:
     private:
-        void draw();
-        void drawPixel(u16 x, u16 y, bool on);
+        void draw(u32 dirtyRows);
+        void drawRow(u16 y, u64 row);
         // The screen SDL surface
         SDL_Surface* screen;
         // The width of the display
@@ -35,8 +40,13 @@ class Display
         // The 32 bit RGB colour when the pixel is turned off
         PIXEL_COLOUR pcol_off;
 
-        /* Pixel array for chip8 display, chip 8 uses a 64*32 display you can use bools as the display is monochrome
-         * and only uses two colours one for on and one for off. E.g black for off white for on.*/
-        bool pixels[CHIP8_RESOLUTION];
+        /* Packed pixel rows of the chip8 display, one 64 bit word per row with the left most pixel in the most
+         * significant bit. The pixels live in the machine state of the core. */
+        const u64* pixels;
+
+        // Frames that were drawn and flipped to the screen
+        u64 framesPresented;
+        // Frames that were skipped because the framebuffer had not changed
+        u64 framesSkipped;
 };
 #endif // DISPLAY_H
@@ -0,0 +1,70 @@
+#ifndef FUSION_H
+#define FUSION_H
+
+#include "Def.h"
+#include "Opcode.h"
+
+/* Superinstructions, a run of two or three instructions that ROMs execute back to back is dispatched once through a
+ * fused handler. A fused handler runs the same handlers in the same order with the timers ticking after each one so
+ * the result is exactly what the interpreter would do, it stops early if an instruction changes "PC".
+ * The first column is the enum name, then the name used in reports, the length and the classes in order. */
+#define CHIP8_FUSED_PATTERNS(X) \
+    X(WAIT_DT,  "Fx07 3xkk 1nnn", 3, OPCODE_LD_VX_DT, OPCODE_SE_VX_KK, OPCODE_JP)   /* Delay timer wait loop */ \
+    X(LD_LD,    "6xkk 6ykk",      2, OPCODE_LD_VX_KK, OPCODE_LD_VX_KK, OPCODE_BAD)  /* Pair of loads */ \
+    X(LD_I_DRW, "Annn Dxyn",      2, OPCODE_LD_I,     OPCODE_DRW,      OPCODE_BAD)  /* Point at a sprite and draw it */ \
+    X(LD_SKNP,  "6xkk ExA1",      2, OPCODE_LD_VX_KK, OPCODE_SKNP,     OPCODE_BAD)  /* Load a key number and test it */ \
+    X(LD_AND,   "6xkk 8xy2",      2, OPCODE_LD_VX_KK, OPCODE_AND,      OPCODE_BAD)  /* Load a mask and apply it */ \
+    X(SNE_SNE,  "4xkk 4xkk",      2, OPCODE_SNE_VX_KK, OPCODE_SNE_VX_KK, OPCODE_BAD) /* Range checks */
+
+#define CHIP8_FUSED_PATTERN_ENUM(name, text, length, a, b, c) FUSED_##name,
+enum FUSED_PATTERN : u8
+{
+    CHIP8_FUSED_PATTERNS(CHIP8_FUSED_PATTERN_ENUM)
+    FUSED_PATTERN_COUNT
+};
+#undef CHIP8_FUSED_PATTERN_ENUM
+
+// The longest run of instructions a fused handler covers
+#define CHIP8_MAX_FUSED_LENGTH 3
+
+// Every pattern, for "setFusedPatterns"
+#define CHIP8_ALL_FUSED_PATTERNS ((1u << FUSED_PATTERN_COUNT) - 1)
+
+struct FUSED_PATTERN_INFO
+{
+    // The name used in reports such as "Annn Dxyn"
+    const char* name;
+    u8 length;
+    u8 classes[CHIP8_MAX_FUSED_LENGTH];
+    FUSED_HANDLER handler;
+};
+
+extern const FUSED_PATTERN_INFO fusedPatterns[FUSED_PATTERN_COUNT];
+
+/* How often each run of opcode classes was executed, recorded while profiling is on. A run is only counted when each
+ * instruction fell through to the one at the next address, as those are the only runs a fused handler can cover */
+struct OPCODE_PROFILE
+{
+    // Instructions executed while profiling
+    u64 total;
+    // pairs[a][b] counts "b" executed straight after the "a" before it in memory
+    u64 pairs[OPCODE_CLASS_COUNT][OPCODE_CLASS_COUNT];
+    // triples[a][b][c] counts "c" executed straight after the "a" then "b" before it in memory
+    u64 triples[OPCODE_CLASS_COUNT][OPCODE_CLASS_COUNT][OPCODE_CLASS_COUNT];
+};
+
+// How much work each fused pattern did
+struct FUSION_STATS
+{
+    // Times the fused handler was dispatched
+    u64 dispatches[FUSED_PATTERN_COUNT];
+    // Instructions those dispatches executed, the dispatches saved are instructions - dispatches
+    u64 instructions[FUSED_PATTERN_COUNT];
+};
+
+// Returns how many times the run of classes in a pattern was executed in a profile
+u64 fusedPatternCount(const OPCODE_PROFILE& profile, u8 pattern);
+// Picks the patterns that would save at least "minShare" of all dispatches in a profile, as a mask for "setFusedPatterns"
+u32 chooseFusedPatterns(const OPCODE_PROFILE& profile, double minShare);
+
+#endif // FUSION_H
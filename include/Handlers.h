@@ -0,0 +1,443 @@
+#ifndef HANDLERS_H
+#define HANDLERS_H
+
+#include <stdlib.h>
+#include "Chip8Core.h"
+#include "Opcode.h"
+#include "Quirks.h"
+
+// Every memory access is wrapped to the 4KB address space so a bad "I" can never reach outside of the state block
+#define CHIP8_ADDRESS(a) ((a) & (CHIP8_MEMORY_SIZE - 1))
+
+/* The handlers hold the behaviour of every opcode class. They are forced inline so each dispatch engine compiles them
+ * straight into its own loop, a handler left out of line that takes "ins" would also make the engine store the whole
+ * instruction to memory on every dispatch. "PC" has already been moved past the instruction when a handler is called. */
+struct Handlers
+{
+    typedef OPCODE_HANDLER HANDLER;
+
+    /* Called once for every instruction executed. The timers count down at 60Hz of emulated time, a frame is
+     * "instructionsPerFrame" instructions so they tick every time that many have run */
+    static CHIP8_ALWAYS_INLINE void tickTimers(Chip8Core& core)
+    {
+        CHIP8_STATE& s = core.state;
+        if (++s.timerPhase < s.instructionsPerFrame)
+            return;
+        s.timerPhase = 0;
+        // Decrement the delay timer if its non-zero
+        if (s.DT > 0)
+            s.DT--;
+        // Decrement the sound timer if its non-zero
+        if (s.ST > 0)
+            s.ST--;
+    }
+
+    // The same as calling "tickTimers" once for each of "instructions"
+    static CHIP8_ALWAYS_INLINE void tickTimers(Chip8Core& core, u32 instructions)
+    {
+        CHIP8_STATE& s = core.state;
+        u32 phase = s.timerPhase + instructions;
+        if (phase < s.instructionsPerFrame)
+        {
+            s.timerPhase = phase;
+            return;
+        }
+        u32 frames = phase / s.instructionsPerFrame;
+        s.timerPhase = phase % s.instructionsPerFrame;
+        s.DT = s.DT > frames ? s.DT - frames : 0;
+        s.ST = s.ST > frames ? s.ST - frames : 0;
+    }
+
+    // Fetches the opcode at "PC"
+    static CHIP8_ALWAYS_INLINE u16 fetch(const CHIP8_STATE& s)
+    {
+        return (s.memory[CHIP8_ADDRESS(s.PC)] << 8) | s.memory[CHIP8_ADDRESS(s.PC + 1)];
+    }
+
+    /* Any opcode that is not supported ends up here, the report is kept out of line as it should never happen and only
+     * takes the opcode so "ins" never has to be stored for it */
+    static CHIP8_ALWAYS_INLINE void BAD(Chip8Core& core, const INSTRUCTION& ins)
+    {
+        reportBad(core, ins.opcode);
+    }
+
+    static __attribute__((noinline, cold)) void reportBad(Chip8Core& core, u16 opcode)
+    {
+        core.badOpcode(opcode);
+    }
+
+    // CLS, clears the display
+    static CHIP8_ALWAYS_INLINE void CLS(Chip8Core& core, const INSTRUCTION& ins)
+    {
+        core.clearScreen();
+    }
+
+    // RET, return from subroutine by popping the address off of the stack into "PC"
+    static CHIP8_ALWAYS_INLINE void RET(Chip8Core& core, const INSTRUCTION& ins)
+    {
+        core.state.PC = core.stack_pop();
+    }
+
+    // JP, Jump to memory location "nnn"
+    static CHIP8_ALWAYS_INLINE void JP(Chip8Core& core, const INSTRUCTION& ins)
+    {
+        core.state.PC = ins.nnn;
+    }
+
+    // CALL, push "PC" onto the stack so the subroutine can return then jump to "nnn"
+    static CHIP8_ALWAYS_INLINE void CALL(Chip8Core& core, const INSTRUCTION& ins)
+    {
+        core.stack_push(core.state.PC);
+        core.state.PC = ins.nnn;
+    }
+
+    // SE, Skip the next instruction if register "Vx" = "kk"
+    static CHIP8_ALWAYS_INLINE void SE_VX_KK(Chip8Core& core, const INSTRUCTION& ins)
+    {
+        if (core.state.V[ins.x] == ins.kk)
+            core.state.PC += 2;
+    }
+
+    // SNE, Skip the next instruction if register "Vx" does not equal "kk"
+    static CHIP8_ALWAYS_INLINE void SNE_VX_KK(Chip8Core& core, const INSTRUCTION& ins)
+    {
+        if (core.state.V[ins.x] != ins.kk)
+            core.state.PC += 2;
+    }
+
+    // SE Vx, Vy, Skip the next instruction if register "Vx" equals register "Vy"
+    static CHIP8_ALWAYS_INLINE void SE_VX_VY(Chip8Core& core, const INSTRUCTION& ins)
+    {
+        if (core.state.V[ins.x] == core.state.V[ins.y])
+            core.state.PC += 2;
+    }
+
+    // LD, Loads the value "kk" into register "Vx"
+    static CHIP8_ALWAYS_INLINE void LD_VX_KK(Chip8Core& core, const INSTRUCTION& ins)
+    {
+        core.state.V[ins.x] = ins.kk;
+    }
+
+    // ADD, adds "kk" to "Vx"
+    static CHIP8_ALWAYS_INLINE void ADD_VX_KK(Chip8Core& core, const INSTRUCTION& ins)
+    {
+        core.state.V[ins.x] += ins.kk;
+    }
+
+    // LD, store value of "Vy" into "Vx"
+    static CHIP8_ALWAYS_INLINE void LD_VX_VY(Chip8Core& core, const INSTRUCTION& ins)
+    {
+        core.state.V[ins.x] = core.state.V[ins.y];
+    }
+
+    // OR, preforms a bitwize OR with "Vx" and "Vy" then stores the result in "Vx"
+    static CHIP8_ALWAYS_INLINE void OR(Chip8Core& core, const INSTRUCTION& ins)
+    {
+        core.state.V[ins.x] |= core.state.V[ins.y];
+    }
+
+    // AND, preforms a bitwize AND with "Vx" and "Vy" then stores the result in "Vx"
+    static CHIP8_ALWAYS_INLINE void AND(Chip8Core& core, const INSTRUCTION& ins)
+    {
+        core.state.V[ins.x] &= core.state.V[ins.y];
+    }
+
+    // XOR, preforms a bitwize XOR with "Vx" and "Vy" then stores the result in "Vx"
+    static CHIP8_ALWAYS_INLINE void XOR(Chip8Core& core, const INSTRUCTION& ins)
+    {
+        core.state.V[ins.x] ^= core.state.V[ins.y];
+    }
+
+    // ADD, adds "Vx" and "Vy" together, "VF" is set if the result is above 8 bits and the first 8 bits are stored in "Vx"
+    static CHIP8_ALWAYS_INLINE void ADD_VX_VY(Chip8Core& core, const INSTRUCTION& ins)
+    {
+        u8* V = core.state.V;
+        u16 result = V[ins.x] + V[ins.y];
+        V[0xf] = result > 255;
+        V[ins.x] = result & 0x00ff;
+    }
+
+    // SUB, "VF" is set if "Vx" is above "Vy" then "Vy" is subtracted from "Vx"
+    static CHIP8_ALWAYS_INLINE void SUB(Chip8Core& core, const INSTRUCTION& ins)
+    {
+        u8* V = core.state.V;
+        V[0xf] = V[ins.x] > V[ins.y];
+        V[ins.x] = V[ins.x] - V[ins.y];
+    }
+
+    // SHR, "VF" is set to the least significant bit of "Vx" then "Vx" is divided by 2
+    static CHIP8_ALWAYS_INLINE void SHR(Chip8Core& core, const INSTRUCTION& ins)
+    {
+        u8* V = core.state.V;
+        V[0xf] = V[ins.x] & 0x01;
+        V[ins.x] >>= 1;
+    }
+
+    // SUBN, "VF" is set if "Vy" is greater than "Vx" then "Vx" is subtracted from "Vy" and the result is stored in "Vx"
+    static CHIP8_ALWAYS_INLINE void SUBN(Chip8Core& core, const INSTRUCTION& ins)
+    {
+        u8* V = core.state.V;
+        V[0xf] = V[ins.y] > V[ins.x];
+        V[ins.x] = V[ins.y] - V[ins.x];
+    }
+
+    // SHL, "VF" is set to the most significant bit of "Vx" then "Vx" is multiplied by 2
+    static CHIP8_ALWAYS_INLINE void SHL(Chip8Core& core, const INSTRUCTION& ins)
+    {
+        u8* V = core.state.V;
+        V[0xf] = V[ins.x] >> 7;
+        V[ins.x] <<= 1;
+    }
+
+    // SNE, skip next instruction if "Vx" does not equal "Vy"
+    static CHIP8_ALWAYS_INLINE void SNE_VX_VY(Chip8Core& core, const INSTRUCTION& ins)
+    {
+        if (core.state.V[ins.x] != core.state.V[ins.y])
+            core.state.PC += 2;
+    }
+
+    // LD, Set register "I" to "nnn"
+    static CHIP8_ALWAYS_INLINE void LD_I(Chip8Core& core, const INSTRUCTION& ins)
+    {
+        core.state.I = ins.nnn;
+    }
+
+    // JP, the PC(Program Counter) is set to "nnn" added with register "V0"
+    static CHIP8_ALWAYS_INLINE void JP_V0(Chip8Core& core, const INSTRUCTION& ins)
+    {
+        core.state.PC = ins.nnn + core.state.V[0];
+    }
+
+    // RND, a random number from 0 to 255 is ANDED with the value "kk" and stored in register "Vx"
+    static CHIP8_ALWAYS_INLINE void RND(Chip8Core& core, const INSTRUCTION& ins)
+    {
+        core.state.V[ins.x] = chip8Random(core.state.random) & ins.kk;
+    }
+
+    // DRW, Draws a sprite at screen coordinates X: "Vx", Y: "Vy" and sets "VF" if it collides with a pixel that is on
+    static CHIP8_ALWAYS_INLINE void DRW(Chip8Core& core, const INSTRUCTION& ins)
+    {
+        CHIP8_STATE& s = core.state;
+        u16 address = CHIP8_ADDRESS(s.I);
+
+        // Sprites are drawn straight from memory unless they run past the end of it
+        const u8* sprite = &s.memory[address];
+        u8 wrapped[16];
+        if (address + ins.n > CHIP8_MEMORY_SIZE)
+        {
+            for (int c = 0; c < ins.n; c++)
+            {
+                wrapped[c] = s.memory[CHIP8_ADDRESS(address + c)];
+            }
+            sprite = wrapped;
+        }
+
+        s.V[0xf] = core.drawSprite(s.V[ins.x], s.V[ins.y], sprite, ins.n);
+    }
+
+    // SKP, Skip the next instruction if the key with the value of "Vx" is pressed
+    static CHIP8_ALWAYS_INLINE void SKP(Chip8Core& core, const INSTRUCTION& ins)
+    {
+        if (core.state.keys[core.state.V[ins.x] & 0x0f])
+            core.state.PC += 2;
+    }
+
+    // SKNP, Skip the next instruction if the key with the value of "Vx" is not pressed
+    static CHIP8_ALWAYS_INLINE void SKNP(Chip8Core& core, const INSTRUCTION& ins)
+    {
+        if (!core.state.keys[core.state.V[ins.x] & 0x0f])
+            core.state.PC += 2;
+    }
+
+    // LD, Set "Vx" to the delay timer value
+    static CHIP8_ALWAYS_INLINE void LD_VX_DT(Chip8Core& core, const INSTRUCTION& ins)
+    {
+        core.state.V[ins.x] = core.state.DT;
+    }
+
+    // The key "Fx0A" takes when one is already down, the last one pressed if it is still held or else the lowest held
+    static CHIP8_ALWAYS_INLINE u8 heldKey(const CHIP8_STATE& s)
+    {
+        if (s.keys[s.lastKeyPressed])
+            return s.lastKeyPressed;
+        u8 k = 0;
+        while (k < CHIP8_TOTAL_KEYS && !s.keys[k])
+            k++;
+        return k;
+    }
+
+    /* LD, waits for a key press and stores the key in the "Vx" register. A key already down is taken straight away,
+     * otherwise the machine halts and the engines stop until "setKeyDown" stores the next key and resumes it */
+    static CHIP8_ALWAYS_INLINE void LD_VX_K(Chip8Core& core, const INSTRUCTION& ins)
+    {
+        CHIP8_STATE& s = core.state;
+        u8 key = heldKey(s);
+        if (key < CHIP8_TOTAL_KEYS)
+        {
+            s.V[ins.x] = key;
+            return;
+        }
+
+        s.keyWait = CHIP8_KEY_WAITING | ins.x;
+        s.keyWaitKey = 0;
+        core.keyWaitStats.waits++;
+    }
+
+    // LD, set delay timer to the value of "Vx"
+    static CHIP8_ALWAYS_INLINE void LD_DT_VX(Chip8Core& core, const INSTRUCTION& ins)
+    {
+        core.state.DT = core.state.V[ins.x];
+    }
+
+    // LD, set sound timer to value of "Vx", the core notes where in the frame the buzzer turned on or off
+    static CHIP8_ALWAYS_INLINE void LD_ST_VX(Chip8Core& core, const INSTRUCTION& ins)
+    {
+        u8 value = core.state.V[ins.x];
+        if ((value > 0) != (core.state.ST > 0))
+            core.noteSoundWrite(value > 0);
+        core.state.ST = value;
+    }
+
+    // ADD, I is added with "Vx" and the result is stored in I
+    static CHIP8_ALWAYS_INLINE void ADD_I_VX(Chip8Core& core, const INSTRUCTION& ins)
+    {
+        core.state.I += core.state.V[ins.x];
+    }
+
+    // LD, set I to the location of the sprite for the digit in "Vx", sprites start at position "0" in memory
+    static CHIP8_ALWAYS_INLINE void LD_F_VX(Chip8Core& core, const INSTRUCTION& ins)
+    {
+        core.state.I = (core.state.V[ins.x] & 0x0f) * 5;
+    }
+
+    // LD, stores BCD(Binary Coded Decimal) of Vx in memory locations I, I+1, and I+2
+    static CHIP8_ALWAYS_INLINE void LD_B_VX(Chip8Core& core, const INSTRUCTION& ins)
+    {
+        CHIP8_STATE& s = core.state;
+        u8 value = s.V[ins.x];
+        core.writeMemory(s.I, value / 100);
+        core.writeMemory(s.I + 1, (value / 10) % 10);
+        core.writeMemory(s.I + 2, value % 10);
+    }
+
+    // LD, stores registers V0 to Vx into memory starting at location I
+    static CHIP8_ALWAYS_INLINE void LD_I_VX(Chip8Core& core, const INSTRUCTION& ins)
+    {
+        CHIP8_STATE& s = core.state;
+        for (int c = 0; c <= ins.x; c++)
+        {
+            core.writeMemory(s.I + c, s.V[c]);
+        }
+    }
+
+    // LD, reads memory in memory location I into registers V0 to Vx
+    static CHIP8_ALWAYS_INLINE void LD_VX_I(Chip8Core& core, const INSTRUCTION& ins)
+    {
+        CHIP8_STATE& s = core.state;
+        for (int c = 0; c <= ins.x; c++)
+        {
+            s.V[c] = s.memory[CHIP8_ADDRESS(s.I + c)];
+        }
+    }
+};
+
+/* The handlers for one set of quirk bits, only the opcodes a quirk changes are replaced and everything else is the
+ * plain handler. The quirks are a template parameter so each engine instantiated with them has no quirk tests left
+ * in it, with no quirks set these are exactly the handlers above. */
+template<u32 QUIRKS>
+struct QuirkHandlers : public Handlers
+{
+    static CHIP8_ALWAYS_INLINE void SHR(Chip8Core& core, const INSTRUCTION& ins)
+    {
+        if constexpr (QUIRKS & CHIP8_QUIRK_SHIFT_VY)
+        {
+            u8* V = core.state.V;
+            V[0xf] = V[ins.y] & 0x01;
+            V[ins.x] = V[ins.y] >> 1;
+        }
+        else
+        {
+            Handlers::SHR(core, ins);
+        }
+    }
+
+    static CHIP8_ALWAYS_INLINE void SHL(Chip8Core& core, const INSTRUCTION& ins)
+    {
+        if constexpr (QUIRKS & CHIP8_QUIRK_SHIFT_VY)
+        {
+            u8* V = core.state.V;
+            V[0xf] = V[ins.y] >> 7;
+            V[ins.x] = V[ins.y] << 1;
+        }
+        else
+        {
+            Handlers::SHL(core, ins);
+        }
+    }
+
+    static CHIP8_ALWAYS_INLINE void JP_V0(Chip8Core& core, const INSTRUCTION& ins)
+    {
+        if constexpr (QUIRKS & CHIP8_QUIRK_JUMP_VX)
+            core.state.PC = ins.nnn + core.state.V[ins.x];
+        else
+            Handlers::JP_V0(core, ins);
+    }
+
+    static CHIP8_ALWAYS_INLINE void DRW(Chip8Core& core, const INSTRUCTION& ins)
+    {
+        if constexpr (QUIRKS & CHIP8_QUIRK_CLIP_SPRITES)
+        {
+            CHIP8_STATE& s = core.state;
+            u16 address = CHIP8_ADDRESS(s.I);
+            const u8* sprite = &s.memory[address];
+            u8 wrapped[16];
+            if (address + ins.n > CHIP8_MEMORY_SIZE)
+            {
+                for (int c = 0; c < ins.n; c++)
+                {
+                    wrapped[c] = s.memory[CHIP8_ADDRESS(address + c)];
+                }
+                sprite = wrapped;
+            }
+
+            s.V[0xf] = core.drawSpriteClipped(s.V[ins.x], s.V[ins.y], sprite, ins.n);
+        }
+        else
+        {
+            Handlers::DRW(core, ins);
+        }
+    }
+
+    static CHIP8_ALWAYS_INLINE void LD_VX_K(Chip8Core& core, const INSTRUCTION& ins)
+    {
+        if constexpr (QUIRKS & CHIP8_QUIRK_KEY_RELEASE)
+        {
+            // Always halts, "setKeyUp" resumes it once the key that would have been taken is let go
+            CHIP8_STATE& s = core.state;
+            u8 key = Handlers::heldKey(s);
+            s.keyWait = CHIP8_KEY_WAITING | ins.x;
+            s.keyWaitKey = key < CHIP8_TOTAL_KEYS ? CHIP8_KEY_WAITING | key : 0;
+            core.keyWaitStats.waits++;
+        }
+        else
+        {
+            Handlers::LD_VX_K(core, ins);
+        }
+    }
+
+    static CHIP8_ALWAYS_INLINE void LD_I_VX(Chip8Core& core, const INSTRUCTION& ins)
+    {
+        Handlers::LD_I_VX(core, ins);
+        if constexpr (QUIRKS & CHIP8_QUIRK_LOAD_STORE_I)
+            core.state.I += ins.x + 1;
+    }
+
+    static CHIP8_ALWAYS_INLINE void LD_VX_I(Chip8Core& core, const INSTRUCTION& ins)
+    {
+        Handlers::LD_VX_I(core, ins);
+        if constexpr (QUIRKS & CHIP8_QUIRK_LOAD_STORE_I)
+            core.state.I += ins.x + 1;
+    }
+};
+
+#endif // HANDLERS_H
@@ -0,0 +1,110 @@
+#ifndef HEATMAP_H
+#define HEATMAP_H
+
+#include <vector>
+#include "Breakpoints.h"
+#include "Def.h"
+#include "Opcode.h"
+#include "State.h"
+
+// "C8HM" read as a little endian word, the first bytes of a binary heatmap
+#define CHIP8_HEATMAP_MAGIC 0x4d483843
+#define CHIP8_HEATMAP_VERSION 1
+// The data regions a heatmap summary lists
+#define CHIP8_HEATMAP_REGIONS 4
+
+/* The start of a binary heatmap, the reads, writes and executes of every byte follow as three arrays of
+ * CHIP8_MEMORY_SIZE little endian u64 */
+struct HEATMAP_FILE_HEADER
+{
+    // CHIP8_HEATMAP_MAGIC
+    u32 magic;
+    // CHIP8_HEATMAP_VERSION
+    u16 version;
+    u16 reserved;
+    u64 instructions;
+};
+
+// What a heatmap has seen of memory, each count is of bytes
+struct HEATMAP_STATS
+{
+    u32 read;
+    u32 written;
+    u32 executed;
+    // Bytes that were both written and executed, a ROM with any rewrites its own code and defeats the decode cache and jit
+    u32 codeWritten;
+    // The lowest of them, CHIP8_MEMORY_SIZE if there are none
+    u16 firstCodeWritten;
+};
+
+// A run of neighbouring bytes that were read or written but never executed, a table, a sprite or spilled registers
+struct HEATMAP_REGION
+{
+    u16 address;
+    u16 length;
+    u64 reads;
+    u64 writes;
+};
+
+/* The Chip8Heatmap counts the reads, writes and executes of every byte of memory, set it on a core with "setHeatmap".
+ * The accesses come from "instructionAccess", the one description of what an instruction reads and writes that watch
+ * points use too, so sprite fetches in "Dxyn", the digits "Fx33" stores and the registers "Fx55" and "Fx65" move are
+ * all counted without the handlers knowing. Both bytes of an opcode count as executed. */
+class Chip8Heatmap
+{
+    public:
+        Chip8Heatmap();
+        virtual ~Chip8Heatmap();
+        void reset();
+        // Counts the instruction "ins" at "pc" before it executes on "s" under "quirks"
+        inline void count(const CHIP8_STATE& s, u16 pc, const INSTRUCTION& ins, u32 quirks);
+
+        u64 getInstructions();
+        const u64* getReads();
+        const u64* getWrites();
+        const u64* getExecutes();
+        HEATMAP_STATS getStats();
+        // The data regions with the most accesses first, at most "count" of them
+        std::vector<HEATMAP_REGION> getDataRegions(u32 count);
+        /* Fills "colours" with a 0x00RRGGBB colour for each byte of memory, red for writes, green for reads and blue for
+         * executes. Each is scaled by the log of its count against the most any byte has so rare accesses still show */
+        void getColours(u32* colours);
+
+        // One line a byte, "address,reads,writes,executes", for a spreadsheet or a plotting script
+        bool writeCsv(const char* fname);
+        // A HEATMAP_FILE_HEADER and the counts, "load" reads it back
+        bool save(const char* fname);
+        bool load(const char* fname);
+    private:
+        u64 instructions;
+        u64 reads[CHIP8_MEMORY_SIZE];
+        u64 writes[CHIP8_MEMORY_SIZE];
+        u64 executes[CHIP8_MEMORY_SIZE];
+};
+
+inline void Chip8Heatmap::count(const CHIP8_STATE& s, u16 pc, const INSTRUCTION& ins, u32 quirks)
+{
+    instructions++;
+    executes[pc & (CHIP8_MEMORY_SIZE - 1)]++;
+    executes[(pc + 1) & (CHIP8_MEMORY_SIZE - 1)]++;
+    // Most instructions touch no memory, only the ones that do are worked out
+    switch(ins.cls)
+    {
+        case OPCODE_DRW:
+        case OPCODE_LD_B_VX:
+        case OPCODE_LD_I_VX:
+        case OPCODE_LD_VX_I:
+        {
+            INSTRUCTION_ACCESS access = instructionAccess(ins, s, quirks);
+            for (u32 a = 0; a < access.readLength; a++)
+                reads[(access.readAddress + a) & (CHIP8_MEMORY_SIZE - 1)]++;
+            for (u32 a = 0; a < access.writeLength; a++)
+                writes[(access.writeAddress + a) & (CHIP8_MEMORY_SIZE - 1)]++;
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+#endif // HEATMAP_H
@@ -0,0 +1,57 @@
+#ifndef IDLE_H
+#define IDLE_H
+
+#include "Def.h"
+#include "Opcode.h"
+
+// The longest loop, in instructions, that is looked at for being idle
+#define CHIP8_IDLE_MAX_LOOP 8
+// Instructions run between looks for an idle loop, a look only costs the instructions it steps
+#define CHIP8_IDLE_SLICE 256
+/* A look steps up to two passes of a loop one instruction at a time before it can skip any, with fewer than this many
+ * instructions left it could not skip enough to pay for them so none is made */
+#define CHIP8_IDLE_MIN_BUDGET (CHIP8_IDLE_MAX_LOOP * 2)
+/* Looks skipped at an address after it turned out not to be in an idle loop, doubled for each miss in a row there up
+ * to CHIP8_IDLE_MAX_BACKOFF_SHIFT times */
+#define CHIP8_IDLE_BACKOFF 16
+#define CHIP8_IDLE_MAX_BACKOFF_SHIFT 8
+
+/* The classes an idle loop can be made of, none of them write memory, the display or the stack, draw a random
+ * number or halt the machine, "Fx0A" waits without looping. A loop of them that leaves "V", "I" and the timers as
+ * they were does exactly the same on every pass until a timer it reads or writes ticks or a key changes, and keys
+ * only change between calls to "execute" */
+constexpr bool idleClass(u8 cls)
+{
+    return cls == OPCODE_JP || cls == OPCODE_SE_VX_KK || cls == OPCODE_SNE_VX_KK || cls == OPCODE_SE_VX_VY ||
+           cls == OPCODE_LD_VX_KK || cls == OPCODE_ADD_VX_KK || cls == OPCODE_LD_VX_VY || cls == OPCODE_OR ||
+           cls == OPCODE_AND || cls == OPCODE_XOR || cls == OPCODE_ADD_VX_VY || cls == OPCODE_SUB ||
+           cls == OPCODE_SHR || cls == OPCODE_SUBN || cls == OPCODE_SHL || cls == OPCODE_SNE_VX_VY ||
+           cls == OPCODE_LD_I || cls == OPCODE_JP_V0 || cls == OPCODE_SKP || cls == OPCODE_SKNP ||
+           cls == OPCODE_LD_VX_DT || cls == OPCODE_LD_DT_VX || cls == OPCODE_LD_ST_VX || cls == OPCODE_ADD_I_VX ||
+           cls == OPCODE_LD_F_VX || cls == OPCODE_LD_VX_I;
+}
+
+// The idle classes whose passes stop being the same once the timers tick
+constexpr bool idleTimerClass(u8 cls)
+{
+    return cls == OPCODE_LD_VX_DT || cls == OPCODE_LD_DT_VX || cls == OPCODE_LD_ST_VX;
+}
+
+// The looks still to skip at an address and the misses in a row that made it that many
+struct IDLE_BACKOFF
+{
+    u16 skips;
+    u8 misses;
+};
+
+// How much idle looping was skipped
+struct IDLE_STATS
+{
+    // Looks for an idle loop and the ones that found one
+    u64 looks;
+    u64 loops;
+    // Instructions that were skipped rather than executed, they are still counted as executed
+    u64 elided;
+};
+
+#endif // IDLE_H
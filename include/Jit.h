@@ -0,0 +1,90 @@
+#ifndef JIT_H
+#define JIT_H
+
+#include "Def.h"
+#include "Quirks.h"
+#include "State.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+    #define CHIP8_JIT_SUPPORTED 1
+#else
+    #define CHIP8_JIT_SUPPORTED 0
+#endif
+
+// The executable arena translated blocks are emitted into
+#define CHIP8_JIT_ARENA_SIZE (1024 * 1024)
+// The most instructions a single block will hold
+#define CHIP8_JIT_MAX_BLOCK_INSTRUCTIONS 32
+
+struct JIT_STATS
+{
+    // Blocks translated into native code
+    u64 blocks;
+    // Addresses that could not start a block and are left to the interpreter
+    u64 interpreted;
+    // Exits of one block that were patched to jump straight into another
+    u64 links;
+    // Times every block was thrown away because code was written to or the arena filled up
+    u64 flushes;
+};
+
+/* The Jit translates basic blocks of chip8 code into x86-64 code. A block runs until a jump, skip or an instruction
+ * the Jit does not handle such as "Dxyn", "V" registers used by the block and "I" are kept in host registers while
+ * it runs and blocks are chained straight into each other. Anything that is not translated is left to the
+ * interpreter, so a block always leaves the state exactly as the interpreter would. */
+class Jit
+{
+    public:
+        Jit();
+        virtual ~Jit();
+        // Returns false if executable memory could not be allocated, in which case everything is interpreted
+        bool isAvailable();
+        // Returns the block starting at "address" translating it if needed, NULL means interpret the instruction
+        const u8* getBlock(const CHIP8_STATE& state, u16 address);
+        // Runs a block and any blocks chained after it for up to "budget" instructions, returns how many were executed
+        u32 run(CHIP8_STATE& state, u32 budget, const u8* block);
+        // Called on every write to memory, blocks are thrown away if the write lands on translated code
+        inline void invalidate(u16 address)
+        {
+            if (covered[address])
+                flush();
+        }
+        // Throws away every translated block
+        void flush();
+        // Sets the quirk bits of the core, opcodes they change are left to the interpreter
+        void setQuirks(u32 quirks);
+        JIT_STATS getStats();
+    protected:
+    private:
+        typedef u32 (*ENTRY)(CHIP8_STATE* state, u32 budget, const u8* block);
+
+        // Translates the block at "address", returns NULL if its first instruction cannot be translated
+        u8* translate(const CHIP8_STATE& state, u16 address);
+        // Emits the code that enters and leaves translated code
+        void emitTrampolines();
+
+        // The executable arena
+        u8* arena;
+        // How much of the arena has been used
+        u32 used;
+        // The trampoline blocks are entered through
+        ENTRY entry;
+        // Where a block jumps to return to the interpreter
+        u8* exitStub;
+        // The quirk bits of the core the blocks are translated for
+        u32 quirks;
+
+        // The block starting at each address, NULL if it has not been translated
+        u8* blocks[CHIP8_MEMORY_SIZE];
+        // Non-zero for addresses that have been found to need the interpreter
+        u8 interpretOnly[CHIP8_MEMORY_SIZE];
+        // Non-zero for every byte of memory that translation has read
+        u8 covered[CHIP8_MEMORY_SIZE];
+        // Offsets of exits that jump to the exit stub and want to be chained to the block at their target once it exists
+        u32 pendingLinks[CHIP8_MEMORY_SIZE][4];
+        u8 totalPendingLinks[CHIP8_MEMORY_SIZE];
+
+        JIT_STATS stats;
+};
+
+#endif // JIT_H
@@ -0,0 +1,158 @@
+#ifndef LOCKFREE_H
+#define LOCKFREE_H
+
+#include <atomic>
+#include <string.h>
+#include <type_traits>
+#include "Def.h"
+
+/* A fixed size queue for exactly one thread pushing and one thread popping, neither ever waits on the other. "SIZE" has
+ * to be a power of two. Each side keeps its own position and its last look at the other's on a cache line of its own
+ * so a push and a pop do not fight over a line */
+template<typename T, u32 SIZE>
+class SpscQueue
+{
+    static_assert((SIZE & (SIZE - 1)) == 0, "The queue size must be a power of two");
+    static_assert(std::is_trivially_copyable<T>::value, "Items are copied in and out of the queue");
+
+    public:
+        SpscQueue() : head(0), tailSeen(0), tail(0), headSeen(0)
+        {
+        }
+
+        // Producer only, returns false rather than waiting if the queue is full
+        bool push(const T& item)
+        {
+            u32 t = tail.load(std::memory_order_relaxed);
+            if (t - headSeen == SIZE)
+            {
+                headSeen = head.load(std::memory_order_acquire);
+                if (t - headSeen == SIZE)
+                    return false;
+            }
+            items[t & (SIZE - 1)] = item;
+            tail.store(t + 1, std::memory_order_release);
+            return true;
+        }
+
+        // Consumer only, returns false if the queue is empty
+        bool pop(T& item)
+        {
+            u32 h = head.load(std::memory_order_relaxed);
+            if (h == tailSeen)
+            {
+                tailSeen = tail.load(std::memory_order_acquire);
+                if (h == tailSeen)
+                    return false;
+            }
+            item = items[h & (SIZE - 1)];
+            head.store(h + 1, std::memory_order_release);
+            return true;
+        }
+
+        // Producer only, pushes as many of "count" items as there is room for and returns how many that was
+        u32 pushMany(const T* from, u32 count)
+        {
+            u32 t = tail.load(std::memory_order_relaxed);
+            if (SIZE - (t - headSeen) < count)
+                headSeen = head.load(std::memory_order_acquire);
+            u32 room = SIZE - (t - headSeen);
+            u32 n = count < room ? count : room;
+            for (u32 i = 0; i < n; i++)
+                items[(t + i) & (SIZE - 1)] = from[i];
+            tail.store(t + n, std::memory_order_release);
+            return n;
+        }
+
+        // Consumer only, pops up to "count" items and returns how many there were
+        u32 popMany(T* to, u32 count)
+        {
+            u32 h = head.load(std::memory_order_relaxed);
+            if (tailSeen - h < count)
+                tailSeen = tail.load(std::memory_order_acquire);
+            u32 waiting = tailSeen - h;
+            u32 n = count < waiting ? count : waiting;
+            for (u32 i = 0; i < n; i++)
+                to[i] = items[(h + i) & (SIZE - 1)];
+            head.store(h + n, std::memory_order_release);
+            return n;
+        }
+
+        // Either side, the items waiting as of the call
+        u32 size() const
+        {
+            return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire);
+        }
+
+        // Either side, the other side may change it straight after
+        bool empty() const
+        {
+            return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+        }
+
+    private:
+        // The consumer's line
+        alignas(64) std::atomic<u32> head;
+        u32 tailSeen;
+        // The producer's line
+        alignas(64) std::atomic<u32> tail;
+        u32 headSeen;
+        alignas(64) T items[SIZE];
+};
+
+/* A value one thread writes and any number of threads read without locks. A reader copies the value and retries if a
+ * write overlapped it, so it never sees half of one write and half of another and the writer never waits. The value is
+ * held as atomic words so the copy is not a data race */
+template<typename T>
+class SeqLock
+{
+    static_assert(std::is_trivially_copyable<T>::value, "The value is copied word by word");
+
+    public:
+        SeqLock() : sequence(0)
+        {
+            for (u32 w = 0; w < WORDS; w++)
+                words[w].store(0, std::memory_order_relaxed);
+        }
+
+        // Writer only
+        void write(const T& value)
+        {
+            u64 buffer[WORDS] = {};
+            memcpy(buffer, &value, sizeof(T));
+            u32 s = sequence.load(std::memory_order_relaxed);
+            // An odd sequence tells readers a write is under way
+            sequence.store(s + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            for (u32 w = 0; w < WORDS; w++)
+                words[w].store(buffer[w], std::memory_order_relaxed);
+            sequence.store(s + 2, std::memory_order_release);
+        }
+
+        // Any thread, returns the value as a single write left it
+        T read() const
+        {
+            u64 buffer[WORDS];
+            u32 before;
+            u32 after;
+            do
+            {
+                before = sequence.load(std::memory_order_acquire);
+                for (u32 w = 0; w < WORDS; w++)
+                    buffer[w] = words[w].load(std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_acquire);
+                after = sequence.load(std::memory_order_relaxed);
+            } while ((before & 1) || before != after);
+
+            T value;
+            memcpy(&value, buffer, sizeof(T));
+            return value;
+        }
+
+    private:
+        static constexpr u32 WORDS = (sizeof(T) + 7) / 8;
+        alignas(64) std::atomic<u32> sequence;
+        std::atomic<u64> words[WORDS];
+};
+
+#endif // LOCKFREE_H
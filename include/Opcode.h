@@ -0,0 +1,172 @@
+#ifndef OPCODE_H
+#define OPCODE_H
+
+#include "Def.h"
+
+/* Every chip8 instruction belongs to one opcode class. The list below is the single place the classes are named,
+ * the enum, the handler tables and the computed goto labels are all generated from it so they can never disagree.
+ * The first column is the enum name and the second column is the name used in reports. */
+#define CHIP8_OPCODE_CLASSES(X) \
+    X(BAD,        "bad")        /* Any opcode that is not supported */ \
+    X(CLS,        "00E0")       /* CLS */ \
+    X(RET,        "00EE")       /* RET */ \
+    X(JP,         "1nnn")       /* JP nnn */ \
+    X(CALL,       "2nnn")       /* CALL nnn */ \
+    X(SE_VX_KK,   "3xkk")       /* SE Vx, kk */ \
+    X(SNE_VX_KK,  "4xkk")       /* SNE Vx, kk */ \
+    X(SE_VX_VY,   "5xy0")       /* SE Vx, Vy */ \
+    X(LD_VX_KK,   "6xkk")       /* LD Vx, kk */ \
+    X(ADD_VX_KK,  "7xkk")       /* ADD Vx, kk */ \
+    X(LD_VX_VY,   "8xy0")       /* LD Vx, Vy */ \
+    X(OR,         "8xy1")       /* OR Vx, Vy */ \
+    X(AND,        "8xy2")       /* AND Vx, Vy */ \
+    X(XOR,        "8xy3")       /* XOR Vx, Vy */ \
+    X(ADD_VX_VY,  "8xy4")       /* ADD Vx, Vy */ \
+    X(SUB,        "8xy5")       /* SUB Vx, Vy */ \
+    X(SHR,        "8xy6")       /* SHR Vx */ \
+    X(SUBN,       "8xy7")       /* SUBN Vx, Vy */ \
+    X(SHL,        "8xyE")       /* SHL Vx */ \
+    X(SNE_VX_VY,  "9xy0")       /* SNE Vx, Vy */ \
+    X(LD_I,       "Annn")       /* LD I, nnn */ \
+    X(JP_V0,      "Bnnn")       /* JP V0, nnn */ \
+    X(RND,        "Cxkk")       /* RND Vx, kk */ \
+    X(DRW,        "Dxyn")       /* DRW Vx, Vy, n */ \
+    X(SKP,        "Ex9E")       /* SKP Vx */ \
+    X(SKNP,       "ExA1")       /* SKNP Vx */ \
+    X(LD_VX_DT,   "Fx07")       /* LD Vx, DT */ \
+    X(LD_VX_K,    "Fx0A")       /* LD Vx, K */ \
+    X(LD_DT_VX,   "Fx15")       /* LD DT, Vx */ \
+    X(LD_ST_VX,   "Fx18")       /* LD ST, Vx */ \
+    X(ADD_I_VX,   "Fx1E")       /* ADD I, Vx */ \
+    X(LD_F_VX,    "Fx29")       /* LD F, Vx */ \
+    X(LD_B_VX,    "Fx33")       /* LD B, Vx */ \
+    X(LD_I_VX,    "Fx55")       /* LD [I], Vx */ \
+    X(LD_VX_I,    "Fx65")       /* LD Vx, [I] */
+
+#define CHIP8_OPCODE_ENUM(name, text) OPCODE_##name,
+enum OPCODE_CLASS : u8
+{
+    CHIP8_OPCODE_CLASSES(CHIP8_OPCODE_ENUM)
+    OPCODE_CLASS_COUNT
+};
+#undef CHIP8_OPCODE_ENUM
+
+// An opcode with its class and every operand already pulled out of it
+struct INSTRUCTION
+{
+    // The OPCODE_CLASS of the instruction
+    u8 cls;
+    // The register "x" from 0x0x00
+    u8 x;
+    // The register "y" from 0x00y0
+    u8 y;
+    // The nibble "n" from 0x000n
+    u8 n;
+    // The byte "kk" from 0x00kk
+    u8 kk;
+    // The address "nnn" from 0x0nnn
+    u16 nnn;
+    // The opcode the instruction was decoded from
+    u16 opcode;
+};
+
+class Chip8Core;
+struct CACHED_INSTRUCTION;
+// A handler executes one opcode class on a core
+typedef void (*OPCODE_HANDLER)(Chip8Core& core, const INSTRUCTION& ins);
+// A fused handler executes the run of instructions cached from "entry" onwards and returns how many it executed
+typedef u32 (*FUSED_HANDLER)(Chip8Core& core, const CACHED_INSTRUCTION* entry);
+
+// An entry of the predecoded instruction cache, the handler is NULL until the address has been executed
+struct CACHED_INSTRUCTION
+{
+    OPCODE_HANDLER handler;
+    // Set when the instructions from this address on were fused into one superinstruction
+    FUSED_HANDLER fused;
+    INSTRUCTION ins;
+    // The FUSED_PATTERN and how many instructions it covers
+    u8 fusedPattern;
+    u8 fusedLength;
+};
+
+// Works out the class of an opcode, this is the reference decoder that the dispatch tables are generated from
+constexpr OPCODE_CLASS classifyOpcode(u16 opcode)
+{
+    switch(opcode >> 12)
+    {
+        case 0x0:
+            if (opcode == 0x00E0) return OPCODE_CLS;
+            if (opcode == 0x00EE) return OPCODE_RET;
+            return OPCODE_BAD;
+        case 0x1: return OPCODE_JP;
+        case 0x2: return OPCODE_CALL;
+        case 0x3: return OPCODE_SE_VX_KK;
+        case 0x4: return OPCODE_SNE_VX_KK;
+        case 0x5: return OPCODE_SE_VX_VY;
+        case 0x6: return OPCODE_LD_VX_KK;
+        case 0x7: return OPCODE_ADD_VX_KK;
+        case 0x8:
+            switch(opcode & 0x000f)
+            {
+                case 0x0: return OPCODE_LD_VX_VY;
+                case 0x1: return OPCODE_OR;
+                case 0x2: return OPCODE_AND;
+                case 0x3: return OPCODE_XOR;
+                case 0x4: return OPCODE_ADD_VX_VY;
+                case 0x5: return OPCODE_SUB;
+                case 0x6: return OPCODE_SHR;
+                case 0x7: return OPCODE_SUBN;
+                case 0xE: return OPCODE_SHL;
+                default: return OPCODE_BAD;
+            }
+        case 0x9: return OPCODE_SNE_VX_VY;
+        case 0xA: return OPCODE_LD_I;
+        case 0xB: return OPCODE_JP_V0;
+        case 0xC: return OPCODE_RND;
+        case 0xD: return OPCODE_DRW;
+        case 0xE:
+            if ((opcode & 0x00ff) == 0x9E) return OPCODE_SKP;
+            if ((opcode & 0x00ff) == 0xA1) return OPCODE_SKNP;
+            return OPCODE_BAD;
+        default:
+            switch(opcode & 0x00ff)
+            {
+                case 0x07: return OPCODE_LD_VX_DT;
+                case 0x0A: return OPCODE_LD_VX_K;
+                case 0x15: return OPCODE_LD_DT_VX;
+                case 0x18: return OPCODE_LD_ST_VX;
+                case 0x1E: return OPCODE_ADD_I_VX;
+                case 0x29: return OPCODE_LD_F_VX;
+                case 0x33: return OPCODE_LD_B_VX;
+                case 0x55: return OPCODE_LD_I_VX;
+                case 0x65: return OPCODE_LD_VX_I;
+                default: return OPCODE_BAD;
+            }
+    }
+}
+
+// The class of every one of the 64K opcodes, generated at compile time from "classifyOpcode"
+struct OPCODE_CLASS_TABLE
+{
+    u8 classes[0x10000];
+};
+extern const OPCODE_CLASS_TABLE opcodeClassTable;
+
+// Decodes an opcode into an instruction, the operands are extracted here once so handlers never touch the opcode
+CHIP8_ALWAYS_INLINE INSTRUCTION decodeOpcode(u16 opcode)
+{
+    INSTRUCTION ins;
+    ins.cls = opcodeClassTable.classes[opcode];
+    ins.x = (opcode & 0x0f00) >> 8;
+    ins.y = (opcode & 0x00f0) >> 4;
+    ins.n = opcode & 0x000f;
+    ins.kk = opcode & 0x00ff;
+    ins.nnn = opcode & 0x0fff;
+    ins.opcode = opcode;
+    return ins;
+}
+
+// Returns the name of an opcode class for reports, such as "8xy4"
+const char* opcodeClassName(u8 cls);
+
+#endif // OPCODE_H
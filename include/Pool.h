@@ -0,0 +1,97 @@
+#ifndef POOL_H
+#define POOL_H
+
+#include <cstddef>
+#include <memory>
+#include "Def.h"
+#include "Quirks.h"
+#include "State.h"
+
+class Chip8Core;
+
+// Memory is shared between forks in pages of this many bytes
+#define CHIP8_POOL_PAGE_SIZE 256
+#define CHIP8_POOL_PAGES (CHIP8_MEMORY_SIZE / CHIP8_POOL_PAGE_SIZE)
+// Returned by "fork" when the pool is out of slots or pages and passed as a parent when there is none
+#define CHIP8_POOL_NONE 0xffffffff
+
+// Everything in CHIP8_STATE before the memory, a fork copies this whole and shares the memory a page at a time
+#define CHIP8_POOL_MACHINE_SIZE offsetof(CHIP8_STATE, memory)
+static_assert(CHIP8_POOL_MACHINE_SIZE + CHIP8_MEMORY_SIZE == sizeof(CHIP8_STATE), "Memory has to be the last thing in CHIP8_STATE");
+
+/* A machine held in the pool, its memory is the pages it points at. It is not padded out to a cache line as a pool can
+ * hold millions of them */
+struct CHIP8_FORK
+{
+    // The start of the machine's CHIP8_STATE, registers, keys and display
+    u8 machine[CHIP8_POOL_MACHINE_SIZE];
+    // The page of the pool holding each 256 bytes of memory
+    u32 pages[CHIP8_POOL_PAGES];
+    // The next free slot while this one is free
+    u32 nextFree;
+    QUIRK_PROFILE quirkProfile;
+    bool quit;
+};
+
+struct POOL_STATS
+{
+    // Slots holding a machine and the pages they point at
+    u32 liveSlots;
+    u32 livePages;
+    // Forks made over the life of the pool and pages copied because a fork wrote to memory it shared
+    u64 forks;
+    u64 pageCopies;
+    // Bytes of the slots and pages that are live
+    u64 liveBytes;
+};
+
+/* The Chip8Pool holds many machines for searches that branch a game at every decision. The slots and pages are all
+ * allocated when the pool is built so forking never touches the heap, a freed slot or page goes back on a free list.
+ * Forks share memory pages and a page is only copied when a machine stored back into its slot has changed it. With
+ * copy on write off every fork copies all of its pages. */
+class Chip8Pool
+{
+    public:
+        Chip8Pool(u32 slots, u32 pages, bool copyOnWrite = true);
+        virtual ~Chip8Pool();
+        // Clones a core into a new slot sharing any page that matches the page of "parent", returns CHIP8_POOL_NONE if full
+        u32 fork(Chip8Core& core, u32 parent = CHIP8_POOL_NONE);
+        // Clones a slot into a new slot, returns CHIP8_POOL_NONE if the pool is full
+        u32 fork(u32 slot);
+        // Frees a slot, its pages are freed once no other slot shares them
+        void release(u32 slot);
+        // Loads a slot into a core to be run, anything decoded from the core's old memory is thrown away
+        void load(u32 slot, Chip8Core& core);
+        /* Writes a core back into its slot, only the pages the core changed are copied. Returns false and leaves the slot
+         * as it was if there are not enough free pages */
+        bool store(Chip8Core& core, u32 slot);
+        // Copies a slot out into a normal machine state
+        void getState(u32 slot, CHIP8_STATE& state);
+        bool isCopyOnWrite();
+        POOL_STATS getStats();
+    protected:
+    private:
+        // Takes a page off the free list, CHIP8_POOL_NONE if there are none left
+        u32 allocatePage();
+        void releasePage(u32 page);
+        // Takes a slot off the free list, CHIP8_POOL_NONE if there are none left
+        u32 allocateSlot();
+        // Gives back a slot whose fork ran out of pages along with the first "pagesTaken" pages it took
+        void abandon(u32 slot, u32 pagesTaken);
+
+        std::unique_ptr<CHIP8_FORK[]> slots;
+        u32 totalSlots;
+        u32 freeSlot;
+
+        // The pages, how many slots point at each and a stack of the free ones
+        std::unique_ptr<u8[][CHIP8_POOL_PAGE_SIZE]> pages;
+        std::unique_ptr<u32[]> pageRefs;
+        std::unique_ptr<u32[]> freePages;
+        u32 totalPages;
+        u32 totalFreePages;
+
+        bool copyOnWrite;
+        POOL_STATS stats;
+};
+
+#endif // POOL_H
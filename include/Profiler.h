@@ -0,0 +1,86 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <vector>
+#include "Def.h"
+#include "Opcode.h"
+#include "State.h"
+
+// The addresses a profile summary lists
+#define CHIP8_PROFILE_HOTTEST 8
+
+// The calls made from one "2nnn" and the instructions they took, up to and including the "00EE" that returned
+struct PROFILE_CALL
+{
+    u64 calls;
+    u64 inclusive;
+    // Where the last call from here went, "2nnn" only ever calls "nnn" unless the program rewrote it
+    u16 callee;
+};
+
+/* The Chip8Profiler counts every instruction a core executes by address and by opcode class, set it on a core with
+ * "setProfiler". It never samples, so the counts are exact. Everything is kept in flat arrays indexed by address so
+ * counting an instruction is three increments and a store.
+ *
+ * Calls are followed through "SP". A function is named by the address a "2nnn" called, and the program starts in the
+ * one at 0x200. A shadow of the stack holds the function running at each depth, the call site that entered it and the
+ * instruction count then. When "SP" rises the call is counted against its "2nnn", and when it falls the instructions
+ * since are added to the call's inclusive cost. Each address belongs to the function it last ran in, which only loses
+ * detail for code that more than one function jumps into. */
+class Chip8Profiler
+{
+    public:
+        Chip8Profiler();
+        virtual ~Chip8Profiler();
+        /* Clears the counts to start profiling "s". The calls already on its stack are read back from the "2nnn" before
+         * each return address so they are known when they return */
+        void reset(const CHIP8_STATE& s);
+        // Counts an instruction of "cls" at "pc", "s" is the machine after it
+        inline void count(const CHIP8_STATE& s, u16 pc, u8 cls);
+
+        // Instructions counted, and counted at each address and of each opcode class
+        u64 getInstructions();
+        const u64* getExecutions();
+        const u64* getClassCounts();
+        // The calls made from the "2nnn" at "site"
+        const PROFILE_CALL& getCall(u16 site);
+        // The function "address" last ran in
+        u16 getFunction(u16 address);
+        // Up to "count" addresses executed the most, the most first
+        std::vector<u16> getHottest(u32 count);
+
+        /* Writes the profile in callgrind's format for KCachegrind and other viewers. Positions are addresses, each
+         * function is named after its entry and the one cost is instructions. Calls still running count as far as they
+         * have got. "command" is the ROM the profile is of */
+        bool writeCallgrind(const char* fname, const char* command);
+    private:
+        // Follows "SP" from "depth" to where the instruction at "pc" left it
+        void changeDepth(const CHIP8_STATE& s, u16 pc);
+
+        u64 instructions;
+        u64 executions[CHIP8_MEMORY_SIZE];
+        u64 classes[OPCODE_CLASS_COUNT];
+        u16 functions[CHIP8_MEMORY_SIZE];
+        // Indexed by the address of the "2nnn"
+        PROFILE_CALL calls[CHIP8_MEMORY_SIZE];
+
+        // The shadow of the stack, the function running at each depth, the call into it and the count when it was made
+        u8 depth;
+        u16 running[CHIP8_STACK_SIZE];
+        u16 sites[CHIP8_STACK_SIZE];
+        u64 entered[CHIP8_STACK_SIZE];
+};
+
+inline void Chip8Profiler::count(const CHIP8_STATE& s, u16 pc, u8 cls)
+{
+    u16 address = pc & (CHIP8_MEMORY_SIZE - 1);
+    executions[address]++;
+    classes[cls]++;
+    functions[address] = running[depth];
+    instructions++;
+    // Only "2nnn", "00EE" and programs that play with the stack move it
+    if (s.SP != depth)
+        changeDepth(s, address);
+}
+
+#endif // PROFILER_H
@@ -0,0 +1,54 @@
+#ifndef QUIRKS_H
+#define QUIRKS_H
+
+#include "Def.h"
+#include "Opcode.h"
+
+/* Quirks are the places where chip8 interpreters disagree, each one is a bit of a quirk profile. With no bits set the
+ * core behaves as it always has. */
+// "8xy6" and "8xyE" shift "Vy" and store the result in "Vx" rather than shifting "Vx" in place
+#define CHIP8_QUIRK_SHIFT_VY 0x01
+// "Fx55" and "Fx65" leave "I" pointing just past the last register stored or loaded
+#define CHIP8_QUIRK_LOAD_STORE_I 0x02
+// "Bnnn" jumps to "nnn" plus "Vx" where "x" is the top nibble of "nnn" rather than plus "V0"
+#define CHIP8_QUIRK_JUMP_VX 0x04
+// "Dxyn" clips sprites at the edges of the display rather than wrapping them around
+#define CHIP8_QUIRK_CLIP_SPRITES 0x08
+// "Fx0A" halts until the key pressed is let go rather than until it goes down, a key already down counts as pressed
+#define CHIP8_QUIRK_KEY_RELEASE 0x10
+
+/* The quirk profiles, each is compiled into its own copy of every interpreter loop so a profile costs nothing per
+ * instruction. The first column is the enum name, then the name used to pick it and its quirk bits. */
+#define CHIP8_QUIRK_PROFILES(X) \
+    X(DEFAULT, "default", 0)                                                                        /* This core's own */ \
+    X(COSMAC,  "cosmac",  CHIP8_QUIRK_SHIFT_VY | CHIP8_QUIRK_LOAD_STORE_I | CHIP8_QUIRK_CLIP_SPRITES | \
+                          CHIP8_QUIRK_KEY_RELEASE)                                                  /* COSMAC VIP */ \
+    X(SCHIP,   "schip",   CHIP8_QUIRK_JUMP_VX | CHIP8_QUIRK_CLIP_SPRITES)                          /* SUPER-CHIP 1.1 */ \
+    X(XOCHIP,  "xochip",  CHIP8_QUIRK_SHIFT_VY | CHIP8_QUIRK_LOAD_STORE_I)                         /* XO-CHIP */
+
+#define CHIP8_QUIRK_PROFILE_ENUM(name, text, quirks) QUIRK_PROFILE_##name,
+enum QUIRK_PROFILE : u8
+{
+    CHIP8_QUIRK_PROFILES(CHIP8_QUIRK_PROFILE_ENUM)
+    QUIRK_PROFILE_COUNT
+};
+#undef CHIP8_QUIRK_PROFILE_ENUM
+
+// Returns the quirk bits of a profile
+u32 quirkProfileQuirks(QUIRK_PROFILE profile);
+// Returns the name of a profile such as "cosmac"
+const char* quirkProfileName(QUIRK_PROFILE profile);
+// Returns the profile with the name given, QUIRK_PROFILE_COUNT if there is none
+QUIRK_PROFILE findQuirkProfile(const char* name);
+
+// True if an opcode class behaves differently under "quirks" than it does with no quirks
+constexpr bool quirksAffect(u8 cls, u32 quirks)
+{
+    return ((cls == OPCODE_SHR || cls == OPCODE_SHL) && (quirks & CHIP8_QUIRK_SHIFT_VY)) ||
+           ((cls == OPCODE_LD_I_VX || cls == OPCODE_LD_VX_I) && (quirks & CHIP8_QUIRK_LOAD_STORE_I)) ||
+           (cls == OPCODE_JP_V0 && (quirks & CHIP8_QUIRK_JUMP_VX)) ||
+           (cls == OPCODE_DRW && (quirks & CHIP8_QUIRK_CLIP_SPRITES)) ||
+           (cls == OPCODE_LD_VX_K && (quirks & CHIP8_QUIRK_KEY_RELEASE));
+}
+
+#endif // QUIRKS_H
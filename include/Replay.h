@@ -0,0 +1,86 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <memory>
+#include <vector>
+#include "Def.h"
+#include "Savestate.h"
+
+class Chip8Core;
+
+// "C8RP" read as a little endian word, the first bytes of a replay file
+#define CHIP8_REPLAY_MAGIC 0x50523843
+#define CHIP8_REPLAY_VERSION 1
+
+// A key going down or up, timed by the instruction count of the machine when it happened
+struct REPLAY_EVENT
+{
+    u64 instruction;
+    u8 key;
+    bool down;
+};
+
+/* The start of a replay file. The machine the recording started from follows as a SAVESTATE then the events, each is the
+ * instructions since the event before as a LEB128 number and a byte holding the key with 0x80 set for a press. A
+ * replay has to end on the machine whose checksum and display are in the header */
+struct REPLAY_FILE_HEADER
+{
+    // CHIP8_REPLAY_MAGIC
+    u32 magic;
+    // CHIP8_REPLAY_VERSION
+    u16 version;
+    u16 reserved;
+    // The events and the bytes they take after the savestate
+    u32 events;
+    u32 eventBytes;
+    // The instruction count of the machine when the recording finished
+    u64 instructions;
+    // Checksum of the whole machine from "savestateChecksum" and its display when the recording finished
+    u64 checksum;
+    u64 pixels[CHIP8_ORIGINAL_DISPLAY_HEIGHT];
+};
+
+/* The Chip8Replay records a session as the machine it started from and the key presses made during it. Every other
+ * input to a machine comes from its own state, "Cxkk" draws from the seed in it and the timers tick per instruction,
+ * so playing the keys back at the same instruction counts reproduces the session exactly at whatever speed it runs. */
+class Chip8Replay
+{
+    public:
+        Chip8Replay();
+        virtual ~Chip8Replay();
+        // Starts a new recording from the machine as it is now
+        void record(Chip8Core& core);
+        // Presses or lets go of a key on the core, logging it if a recording is going
+        void setKey(Chip8Core& core, u8 key, bool down);
+        /* Call after rewinding a machine that is being recorded, the events from the frame rewound to on are dropped. A
+         * machine rewound to before the recording started is recorded again from there */
+        void truncate(Chip8Core& core);
+        // Ends the recording, a replay has to finish on the machine as it is now
+        void finish(Chip8Core& core);
+        bool isRecording();
+        // Writes and reads replay files, "load" refuses a file whose savestate fails its checks
+        bool save(const char* fname);
+        bool load(const char* fname);
+        // Runs a finished recording on "core" as fast as it will go, returns true if it ended on the recorded machine
+        bool play(Chip8Core& core);
+        // The instructions the recording covers and the key presses in it
+        u64 getInstructions();
+        const std::vector<REPLAY_EVENT>& getEvents();
+        // Bytes the recording takes as a file
+        u64 getFileSize();
+    protected:
+    private:
+        // Runs "core" until its instruction count reaches "instruction", returns false if it stopped first
+        bool runTo(Chip8Core& core, u64 instruction);
+        // Encodes the events the way the file holds them
+        std::vector<u8> encodeEvents();
+
+        // The machine the recording starts from
+        std::unique_ptr<SAVESTATE> start;
+        std::vector<REPLAY_EVENT> events;
+        REPLAY_FILE_HEADER header;
+        bool recording;
+        bool finished;
+};
+
+#endif // REPLAY_H
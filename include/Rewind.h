@@ -0,0 +1,91 @@
+#ifndef REWIND_H
+#define REWIND_H
+
+#include <memory>
+#include "Def.h"
+#include "State.h"
+
+class Chip8Core;
+
+// How much history the rewind buffer holds
+struct REWIND_STATS
+{
+    // Frames held and the keyframes among them
+    u32 frames;
+    u32 keyframes;
+    // Bytes the held frames take in the buffer
+    u64 bytes;
+    // The most frames and bytes the buffer holds
+    u32 maxFrames;
+    u64 maxBytes;
+};
+
+// Where a frame's delta sits in the buffer
+struct REWIND_FRAME
+{
+    u32 offset;
+    u32 size;
+    // A keyframe holds the whole machine rather than a delta against the frame before
+    bool keyframe;
+};
+
+/* The Chip8Rewind records the machine once a frame into a fixed size ring so a session can be scrubbed back. Each frame
+ * is the XOR of the machine against the frame before run length encoded, so a frame that only moved a sprite and
+ * ticked the timers takes a few dozen bytes. Because it is an XOR the same delta steps a frame back or forward again.
+ * Every "keyframeInterval" frames the whole machine is stored instead so any frame can be reached from the keyframe
+ * before it, and when the ring is full the oldest keyframe and the frames after it are dropped together. */
+class Chip8Rewind
+{
+    public:
+        Chip8Rewind(u32 bytes, u32 frames, u32 keyframeInterval = CHIP8_FRAMES_PER_SECOND);
+        virtual ~Chip8Rewind();
+        // Records the machine as the newest frame, any frames after the one rewound to are thrown away first
+        void record(Chip8Core& core);
+        // Steps the machine back "frames" frames, returns false without changing it if there are not that many
+        bool rewind(Chip8Core& core, u32 frames = 1);
+        // Steps the machine forward again after a rewind, returns false if there are not that many frames to go
+        bool forward(Chip8Core& core, u32 frames = 1);
+        // Puts the machine at any frame still held, frames are numbered from the first one recorded
+        bool seek(Chip8Core& core, u64 frame);
+        // Throws away all of the history
+        void clear();
+        // The oldest and newest frames held and the frame the machine was last put at
+        u64 getOldestFrame();
+        u64 getNewestFrame();
+        u64 getFrame();
+        bool isEmpty();
+        REWIND_STATS getStats();
+    protected:
+    private:
+        // Moves "current" to "frame" without touching the core
+        void moveTo(u64 frame);
+        // Copies "current" into the core
+        void loadCore(Chip8Core& core);
+        // Drops the oldest keyframe and the frames after it up to the next keyframe
+        void dropOldest();
+        inline REWIND_FRAME& frameAt(u64 frame)
+        {
+            return frames[frame % maxFrames];
+        }
+
+        // The encoded frames, a ring of bytes from the oldest frame's offset round to "head"
+        std::unique_ptr<u8[]> buffer;
+        u32 bufferSize;
+        u32 head;
+        std::unique_ptr<REWIND_FRAME[]> frames;
+        u32 maxFrames;
+        u32 keyframeInterval;
+
+        // The frames held are "oldest" up to but not including "next", "position" is the one "current" holds
+        u64 oldest;
+        u64 next;
+        u64 position;
+        // Frames since the last keyframe
+        u32 sinceKeyframe;
+
+        // The machine at "position" and somewhere to encode a frame before it is copied into the ring
+        std::unique_ptr<CHIP8_STATE> current;
+        std::unique_ptr<u8[]> scratch;
+};
+
+#endif // REWIND_H
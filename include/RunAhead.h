@@ -0,0 +1,57 @@
+#ifndef RUNAHEAD_H
+#define RUNAHEAD_H
+
+#include <memory>
+#include "Def.h"
+#include "State.h"
+
+class Chip8Core;
+
+// What running ahead has cost
+struct RUN_AHEAD_STATS
+{
+    // Frames presented from a run ahead and the instructions run to reach them
+    u64 frames;
+    u64 instructions;
+    // Time spent saving, running ahead and restoring, in total and for the slowest frame
+    u64 totalNs;
+    u64 slowestNs;
+};
+
+/* The Chip8RunAhead hides the frames a ROM waits between reading a key and drawing what it did. Each frame the machine is
+ * run "frames" frames further on with the keys held now, the display it reaches is presented and the machine is put back
+ * exactly as it was. Only the bytes of memory the run ahead wrote are put back, through the core's memory path, so the
+ * decode cache, jit and compiled code only lose what really changed. */
+class Chip8RunAhead
+{
+    public:
+        Chip8RunAhead(u32 frames = CHIP8_RUN_AHEAD_FRAMES);
+        virtual ~Chip8RunAhead();
+        // Frames to run ahead, at most CHIP8_RUN_AHEAD_MAX_FRAMES. With none the machine's own display is presented
+        void setFrames(u32 frames);
+        u32 getFrames();
+        /* Runs the core ahead "instructionsPerFrame" instructions a frame and puts it back, returns a bit for each row of
+         * "getPixels" that changed since the last call, every row the first time */
+        u32 run(Chip8Core& core, u32 instructionsPerFrame);
+        // The display the last run ahead reached, packed the same way as the core's
+        const u64* getPixels();
+        RUN_AHEAD_STATS getStats();
+    protected:
+    private:
+        // Puts the core back to "saved"
+        void restore(Chip8Core& core);
+
+        u32 frames;
+        // The machine before running ahead and the parts of the core outside of it that running can change
+        std::unique_ptr<CHIP8_STATE> saved;
+        bool savedRunning;
+        bool savedQuit;
+        bool savedStale;
+        u32 savedDirtyRows;
+
+        u64 pixels[CHIP8_ORIGINAL_DISPLAY_HEIGHT];
+        bool presented;
+        RUN_AHEAD_STATS stats;
+};
+
+#endif // RUNAHEAD_H
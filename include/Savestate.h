@@ -0,0 +1,100 @@
+#ifndef SAVESTATE_H
+#define SAVESTATE_H
+
+#include "Def.h"
+#include "State.h"
+
+class Chip8Core;
+
+// "C8SS" and "C8SF" read as little endian words, the first bytes of a savestate and of a savestate file
+#define CHIP8_SAVESTATE_MAGIC 0x53533843
+#define CHIP8_SAVESTATE_FILE_MAGIC 0x46533843
+// Bump this whenever CHIP8_STATE changes, states saved by another version are refused rather than misread
+#define CHIP8_SAVESTATE_VERSION 4
+
+/* A saved machine, the header takes the first cache line and the CHIP8_STATE block follows exactly as it is in the core
+ * so saving and loading are a single copy. The layout is the host's own, states move between little endian hosts
+ * built from the same version. */
+struct alignas(CHIP8_CACHE_LINE_SIZE) SAVESTATE
+{
+    // CHIP8_SAVESTATE_MAGIC
+    u32 magic;
+    // CHIP8_SAVESTATE_VERSION
+    u16 version;
+    // The QUIRK_PROFILE the machine ran under, it is restored with the state
+    u8 quirkProfile;
+    // Non-zero if the machine had quit on a stack error, it is still stopped when loaded
+    u8 quit;
+    // sizeof(CHIP8_STATE) when saved
+    u32 stateSize;
+    u32 reserved;
+    // Checksum of "state" from "savestateChecksum"
+    u64 checksum;
+
+    alignas(CHIP8_CACHE_LINE_SIZE) CHIP8_STATE state;
+};
+
+static_assert(sizeof(CHIP8_STATE) % 32 == 0, "The checksum works on four 64 bit words at a time");
+
+// Returns the checksum a savestate of "state" carries
+u64 savestateChecksum(const CHIP8_STATE& state);
+// Copies "from" into "to" returning the checksum of what was copied, the copy and the checksum are the same pass
+u64 savestateCopy(CHIP8_STATE& to, const CHIP8_STATE& from);
+// True if the savestate has the right magic, version, size and checksum
+bool savestateValid(const SAVESTATE& savestate);
+
+// The first cache line of a savestate file, SAVESTATE slots follow it one after another
+struct alignas(CHIP8_CACHE_LINE_SIZE) SAVESTATE_FILE_HEADER
+{
+    // CHIP8_SAVESTATE_FILE_MAGIC
+    u32 magic;
+    // CHIP8_SAVESTATE_VERSION
+    u16 version;
+    u16 reserved;
+    // sizeof(SAVESTATE), the distance from one slot to the next
+    u32 slotSize;
+    // The number of states in the file
+    u32 count;
+};
+
+/* Streams many savestates into one memory mapped file, appending a state is a copy straight into the mapping. The
+ * file grows by doubling and is cut back to the states written when it is closed. */
+class SavestateFile
+{
+    public:
+        SavestateFile();
+        virtual ~SavestateFile();
+        // Creates "fname" for writing, any file already there is replaced
+        bool create(const char* fname);
+        // Opens a file written by "create", states can be loaded from it and more appended after them
+        bool open(const char* fname);
+        void close();
+        bool isOpen();
+        // Saves the state of "core" after the last state in the file
+        bool append(Chip8Core& core);
+        // Loads the state at "index" into "core", returns false if there is no such state or it fails its checksum
+        bool load(u32 index, Chip8Core& core);
+        // Returns the state at "index" in the mapping, NULL if there is none. It is only valid until the next "append"
+        const SAVESTATE* getSavestate(u32 index);
+        u32 getCount();
+    protected:
+    private:
+        // Resizes the file to hold "capacity" states and maps all of it
+        bool map(u32 capacity);
+        void unmap();
+
+#ifdef _WIN32
+        // The file and file mapping handles
+        void* file;
+        void* fileMapping;
+#else
+        int file;
+#endif
+        // The whole file, the header and then the slots
+        SAVESTATE_FILE_HEADER* header;
+        SAVESTATE* slots;
+        // The number of slots the file has room for
+        u32 capacity;
+};
+
+#endif // SAVESTATE_H
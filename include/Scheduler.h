@@ -0,0 +1,74 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <chrono>
+#include "Def.h"
+
+// Wake up lateness is counted in buckets of a microsecond up to this many, later wake ups share the last bucket
+#define CHIP8_SCHEDULER_JITTER_BUCKETS 4096
+// Frames the machine can fall behind before the schedule restarts from now
+#define CHIP8_SCHEDULER_MAX_BEHIND 4
+
+// How well frames have kept to their deadlines
+struct SCHEDULER_STATS
+{
+    // Frames waited for, those whose deadline had already passed and the times the schedule was given up and restarted
+    u64 frames;
+    u64 lateFrames;
+    u64 resyncs;
+    /* Wall clock time since the schedule started less the emulated time of the frames waited for, it stays near zero
+     * when the deadlines are kept however long the machine runs */
+    s64 driftNs;
+    // How late the sleeps woke up past their deadlines
+    u64 jitterMeanNs;
+    u64 jitterP99Ns;
+    u64 jitterMaxNs;
+    // Time spent between waits running the machine and presenting, and the wall clock time covered
+    u64 busyNs;
+    u64 elapsedNs;
+    // The fraction of the wall clock time spent asleep
+    double idle;
+};
+
+/* The Chip8Scheduler paces the machine at 60 frames of emulated time a second. Deadlines are absolute, frame "n" is due
+ * "n" periods after the schedule started, so the time spent running a frame and oversleeping are never added up and the
+ * machine does not drift. Waiting is a sleep until the deadline on the steady clock, the host does no busy waiting. A
+ * machine that falls more than a few frames behind, after a breakpoint or the window being dragged, carries on from
+ * now rather than rushing to catch up. */
+class Chip8Scheduler
+{
+    public:
+        Chip8Scheduler(u32 framesPerSecond = CHIP8_FRAMES_PER_SECOND);
+        virtual ~Chip8Scheduler();
+        // Starts the schedule from now and clears the stats
+        void start();
+        // Sleeps until the next frame is due, with pacing off it only counts the frame
+        void wait();
+        /* Carries on from now after the caller has slept on something else, such as input while the machine is halted,
+         * the time slept is not a late frame and is left out of the stats */
+        void resume();
+        // Pacing off runs the machine as fast as the host can
+        void setPaced(bool paced);
+        bool isPaced();
+        SCHEDULER_STATS getStats();
+    protected:
+    private:
+        typedef std::chrono::steady_clock CLOCK;
+
+        std::chrono::nanoseconds period;
+        bool paced;
+        bool started;
+        // When the schedule started, "origin" is kept through resyncs for the drift
+        CLOCK::time_point origin;
+        CLOCK::time_point epoch;
+        // Frames since "epoch", the next is due one period after the last
+        u64 scheduled;
+        // When the last wait returned, the time up to the next wait is busy
+        CLOCK::time_point awake;
+
+        SCHEDULER_STATS stats;
+        u64 jitterTotalNs;
+        u32 jitter[CHIP8_SCHEDULER_JITTER_BUCKETS];
+};
+
+#endif // SCHEDULER_H
@@ -0,0 +1,65 @@
+#ifndef STATE_H
+#define STATE_H
+
+#include <type_traits>
+#include "Def.h"
+
+/* The complete machine state of a chip8 lives in this one block so that it can be created, copied and compared
+ * without touching SDL or the operating system. The registers come first so they share the first cache line,
+ * the key state and framebuffer follow and the 4KB of main memory is last. */
+struct alignas(CHIP8_CACHE_LINE_SIZE) CHIP8_STATE
+{
+    // 16 8 bit general purpose registers
+    u8 V[CHIP8_TOTAL_GENERAL_PURPOSE_REGISTERS];
+    // The stack memory, chip8 uses 16 bit values and up to 16 elements
+    u16 stack[CHIP8_STACK_SIZE];
+    // I register 16 bit
+    u16 I;
+    // The PC(Program counter) 16 bit holds the address that holds the instruction to execute
+    u16 PC;
+    // The SP(Stack Pointer) holds the address on the stack ready for when a subroutine returns
+    u8 SP;
+    // Delay Timer, decrements at 60Hz while non-zero
+    u8 DT;
+    // Sound Timer, while non-zero will sound a buzzer and decrement at 60Hz
+    u8 ST;
+    // The last key that was pressed
+    u8 lastKeyPressed;
+    // The state of the random number generator "Cxkk" draws from, never zero
+    u32 random;
+    /* The timers tick at 60Hz of emulated time, once every "instructionsPerFrame" instructions, "timerPhase" counts the
+     * instructions since they last ticked */
+    u32 timerPhase;
+    u16 instructionsPerFrame;
+    /* Non-zero while "Fx0A" has the machine halted waiting for a key, CHIP8_KEY_WAITING with "x" in the low nibble.
+     * "keyWaitKey" is CHIP8_KEY_WAITING with the key in the low nibble once a key has gone down under a profile that
+     * resumes when the key is let go */
+    u8 keyWait;
+    u8 keyWaitKey;
+
+    // 0 to F are the keys available for chip8, non-zero when the key is down
+    u8 keys[CHIP8_TOTAL_KEYS];
+    // Instructions executed since the machine was reset, the clock input is logged against so replays are exact
+    u64 instructions;
+
+    /* Pixel rows for chip8 display, chip 8 uses a 64*32 display so each row is packed into one 64 bit word
+     * as the display is monochrome. The most significant bit is the left most pixel of the row. */
+    alignas(CHIP8_CACHE_LINE_SIZE) u64 pixels[CHIP8_ORIGINAL_DISPLAY_HEIGHT];
+
+    // The chip 8 memory
+    alignas(CHIP8_CACHE_LINE_SIZE) u8 memory[CHIP8_MEMORY_SIZE];
+};
+
+// The random number generator "Cxkk" uses, a xorshift so a machine's random numbers are part of its state
+inline u8 chip8Random(u32& random)
+{
+    random ^= random << 13;
+    random ^= random >> 17;
+    random ^= random << 5;
+    return random >> 24;
+}
+
+static_assert(std::is_trivially_copyable<CHIP8_STATE>::value, "CHIP8_STATE must stay a plain block of data");
+static_assert(std::is_standard_layout<CHIP8_STATE>::value, "CHIP8_STATE must stay a plain block of data");
+
+#endif // STATE_H
@@ -0,0 +1,324 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <memory>
+#include <string.h>
+#include <vector>
+#include "Def.h"
+#include "State.h"
+
+#if defined(__SSE2__) || defined(_M_X64)
+    #include <emmintrin.h>
+#endif
+
+// "C8TF" and "C8TB" read as little endian words, the first bytes of a trace file and of each block in it
+#define CHIP8_TRACE_MAGIC 0x46543843
+#define CHIP8_TRACE_BLOCK_MAGIC 0x42543843
+#define CHIP8_TRACE_VERSION 1
+// The bytes of records a block holds, every block can be decoded on its own
+#define CHIP8_TRACE_BLOCK_SIZE 65536
+// The most bytes one record can take, a block is finished rather than let one cross its end
+#define CHIP8_TRACE_MAX_RECORD 48
+// A growing trace file starts out with room for this many blocks
+#define CHIP8_TRACE_MIN_BLOCKS 16
+
+/* What follows the flags byte of a record, in this order. Only what the instruction changed from the record before is
+ * there, differences are zigzag LEB128 numbers */
+enum TRACE_FLAG : u8
+{
+    // The instruction count is not one on from the record before, after a halt, a rewind or a state load
+    TRACE_GAP = 0x01,
+    // "PC" is not 2 on from the record before's, the difference follows
+    TRACE_JUMP = 0x02,
+    // The opcode is not the one last executed at this "PC" in the block, it follows big endian as it is in memory
+    TRACE_OPCODE = 0x04,
+    /* A mask of the register bytes that changed in V0-V7, in V8-VF and in "I" low, "I" high, "SP", "DT" and "ST", each
+     * mask only if any of its bytes changed. The new value of every changed byte follows the masks in that order */
+    TRACE_V_LOW = 0x08,
+    TRACE_V_HIGH = 0x10,
+    TRACE_OTHER = 0x20
+};
+
+// The first cache line of a trace file, the blocks follow it in slots of sizeof(TRACE_BLOCK_HEADER) + "blockSize"
+struct alignas(CHIP8_CACHE_LINE_SIZE) TRACE_FILE_HEADER
+{
+    // CHIP8_TRACE_MAGIC
+    u32 magic;
+    // CHIP8_TRACE_VERSION
+    u16 version;
+    u16 reserved;
+    // CHIP8_TRACE_BLOCK_SIZE
+    u32 blockSize;
+    // The slots a ring goes round, 0 for a file that grows to hold every block
+    u32 ringSlots;
+    // Blocks started since tracing began, a ring holds the last "ringSlots" of them
+    u64 blocks;
+};
+
+/* Starts each block with the registers as the record before its first one left them, so the block decodes without
+ * the ones before it. "bytes" and "records" are brought up to date after every record, so a trace cut short by a crash
+ * still decodes up to its last whole record */
+struct alignas(CHIP8_CACHE_LINE_SIZE) TRACE_BLOCK_HEADER
+{
+    // CHIP8_TRACE_BLOCK_MAGIC, a slot never written to is zero
+    u32 magic;
+    u32 bytes;
+    // Blocks started before this one, the order the blocks of a ring are read back in
+    u64 sequence;
+    // The instruction count the first record is expected at and the "PC" of the record before it
+    u64 instruction;
+    u32 records;
+    u16 PC;
+    u16 I;
+    u8 V[CHIP8_TOTAL_GENERAL_PURPOSE_REGISTERS];
+    u8 SP;
+    u8 DT;
+    u8 ST;
+    u8 reserved;
+};
+
+// An instruction as a trace records it, the registers are as the instruction left them
+struct TRACE_RECORD
+{
+    // The machine's instruction count before the instruction
+    u64 instruction;
+    u16 PC;
+    u16 opcode;
+    // A bit for each register the instruction changed, numbered as "findRegister" numbers them
+    u32 changed;
+    u8 V[CHIP8_TOTAL_GENERAL_PURPOSE_REGISTERS];
+    u16 I;
+    u8 SP;
+    u8 DT;
+    u8 ST;
+};
+
+/* The Chip8Tracer records every instruction a core executes into a memory mapped file, set it on a core with
+ * "setTracer". A record is a flags byte followed by only what the instruction changed, so most take one to three
+ * bytes: "PC" is implied unless the instruction before jumped, the opcode unless memory there changed since it last
+ * ran and a register only when it changed. The file either grows or goes round a ring of blocks keeping the last of
+ * them, and as it is mapped whatever was recorded reaches the disk even if the process dies. */
+class Chip8Tracer
+{
+    public:
+        Chip8Tracer();
+        virtual ~Chip8Tracer();
+        /* Creates "fname" and starts recording into it, any file already there is replaced. With "ringBlocks" set only
+         * the last that many blocks are kept */
+        bool create(const char* fname, u32 ringBlocks = 0);
+        // Finishes the file, a growing one is cut back to the blocks written
+        void close();
+        bool isOpen();
+        // Records an instruction, "s" is the machine after it and "instruction" its count before
+        inline void record(const CHIP8_STATE& s, u16 pc, u16 opcode, u64 instruction);
+        // Instructions recorded and the bytes their records took
+        u64 getRecords();
+        u64 getBytes();
+        // True if the file could not be grown, nothing has been recorded since
+        bool hasFailed();
+    private:
+        // Finishes the block being written and starts the next, growing the file or going round the ring
+        void nextBlock();
+        // Starts a block in "slot" from the registers as the last record left them
+        void startBlock(u32 slot);
+        // Records go nowhere, before a file is created or after it could not grow
+        void useScratch();
+        // Resizes the file to "slots" blocks and maps all of it
+        bool map(u32 slots);
+        void unmap();
+        // Appends "value" zigzag encoded as a LEB128 number
+        static inline u8* putSigned(u8* out, s64 value);
+        // A bit for each byte of "difference" that is not zero
+        static inline u32 changedBytes(u64 difference);
+        // A bit for each of V0-VF that differs between "now" and "last"
+        static inline u32 changedV(const u64* now, const u64* last);
+
+#ifdef _WIN32
+        // The file and file mapping handles
+        void* file;
+        void* fileMapping;
+#else
+        int file;
+#endif
+        TRACE_FILE_HEADER* header;
+        u32 slots;
+        u32 slot;
+        // The block being written and where its records go, a scratch block once the file has failed
+        TRACE_BLOCK_HEADER* block;
+        u8* data;
+        u32 used;
+        bool failed;
+        std::unique_ptr<TRACE_BLOCK_HEADER[]> scratch;
+
+        /* The registers as the last record left them, V0-VF in the first two words and "I", "SP", "DT" and "ST" in
+         * the bytes of the third in the order TRACE_OTHER has them */
+        u64 nextInstruction;
+        u16 lastPC;
+        u64 lastRegisters[3];
+        // The opcode last recorded at each address in the block, 0xffffffff for none
+        u32 opcodes[CHIP8_MEMORY_SIZE];
+
+        u64 records;
+        u64 bytes;
+};
+
+/* Reads a trace file back. A ring's blocks are put back in the order they were written, each block is decoded from
+ * the registers in its header */
+class Chip8TraceReader
+{
+    public:
+        Chip8TraceReader();
+        virtual ~Chip8TraceReader();
+        // Reads the whole file, returns false if it is not a trace
+        bool load(const char* fname);
+        // Goes back to the first record
+        void rewind();
+        // Decodes the next record, returns false at the end or at a record that does not decode
+        bool next(TRACE_RECORD& record);
+        // Records and blocks in the file, and blocks a ring went round and wrote over
+        u64 getRecords();
+        u32 getBlocks();
+        u64 getLostBlocks();
+        // Bytes the file takes and the bytes of records in it
+        u64 getFileSize();
+        u64 getRecordBytes();
+        // True once "next" met a record that does not decode
+        bool isCorrupt();
+    private:
+        // Starts decoding the block at "index" of "order"
+        void startBlock(u32 index);
+        // Stops reading at a record that does not decode, returns false for "next" to return
+        bool fail();
+
+        std::vector<u8> bytes;
+        // Offsets of the blocks in "bytes" in the order they were written
+        std::vector<u64> order;
+        u64 records;
+        u64 recordBytes;
+        u64 lost;
+        bool corrupt;
+
+        u32 blockIndex;
+        const u8* in;
+        const u8* end;
+        // The registers as the last record left them
+        TRACE_RECORD last;
+        u64 nextInstruction;
+        u32 opcodes[CHIP8_MEMORY_SIZE];
+};
+
+// Where two traces first disagree
+struct TRACE_DIFF
+{
+    bool found;
+    // Records read from each trace before the first that differs
+    u64 index;
+    // Set if that trace ran out first, its record is then empty
+    bool endedA;
+    bool endedB;
+    TRACE_RECORD a;
+    TRACE_RECORD b;
+};
+
+// Reads both traces from the start to the first record where the instruction count, "PC", opcode or any register differs
+TRACE_DIFF traceDiff(Chip8TraceReader& a, Chip8TraceReader& b);
+
+inline u8* Chip8Tracer::putSigned(u8* out, s64 value)
+{
+    u64 zigzag = ((u64) value << 1) ^ (u64) (value >> 63);
+    while (zigzag >= 0x80)
+    {
+        *out++ = (u8) zigzag | 0x80;
+        zigzag >>= 7;
+    }
+    *out++ = (u8) zigzag;
+    return out;
+}
+
+inline u32 Chip8Tracer::changedBytes(u64 difference)
+{
+    // The top bit of each byte is set if any bit of it is, then the eight top bits are gathered into the low byte
+    const u64 low = 0x7f7f7f7f7f7f7f7full;
+    u64 top = (difference | ((difference & low) + low)) & ~low;
+    return (u32) (((top >> 7) * 0x0102040810204080ull) >> 56);
+}
+
+inline u32 Chip8Tracer::changedV(const u64* now, const u64* last)
+{
+#if defined(__SSE2__) || defined(_M_X64)
+    // One 16 byte compare gives the mask straight from the sign bits of the bytes that are equal
+    __m128i equal = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*) now), _mm_loadu_si128((const __m128i*) last));
+    return ~_mm_movemask_epi8(equal) & 0xffff;
+#else
+    return changedBytes(now[0] ^ last[0]) | changedBytes(now[1] ^ last[1]) << 8;
+#endif
+}
+
+inline void Chip8Tracer::record(const CHIP8_STATE& s, u16 pc, u16 opcode, u64 instruction)
+{
+    if (used > CHIP8_TRACE_BLOCK_SIZE - CHIP8_TRACE_MAX_RECORD)
+        nextBlock();
+
+    /* The record is written straight into the block. Byte stores can alias anything, so everything the record is
+     * worked out from is read into locals first and the compiler keeps them in registers across the stores */
+    u64 now[3];
+    memcpy(now, s.V, sizeof(s.V));
+    now[2] = s.I | ((u64) s.SP << 16) | ((u64) s.DT << 24) | ((u64) s.ST << 32);
+    u32 changed = changedV(now, lastRegisters) | changedBytes(now[2] ^ lastRegisters[2]) << 16;
+    u16 expected = lastPC + 2;
+    s64 gap = (s64) (instruction - nextInstruction);
+    u32& seen = opcodes[pc & (CHIP8_MEMORY_SIZE - 1)];
+    u8* start = data + used;
+    u8* out = start + 1;
+    u8 flags = 0;
+
+    if (gap)
+    {
+        flags |= TRACE_GAP;
+        out = putSigned(out, gap);
+    }
+    if (pc != expected)
+    {
+        flags |= TRACE_JUMP;
+        out = putSigned(out, (s32) pc - (s32) expected);
+    }
+    if (seen != opcode)
+    {
+        flags |= TRACE_OPCODE;
+        seen = opcode;
+        out[0] = opcode >> 8;
+        out[1] = (u8) opcode;
+        out += 2;
+    }
+    // One test for every register, then the masks are written without branching on which of them changed
+    if (changed)
+    {
+        u32 low = changed & 0xff;
+        u32 high = (changed >> 8) & 0xff;
+        u32 other = changed >> 16;
+        flags |= (low != 0) * TRACE_V_LOW | (high != 0) * TRACE_V_HIGH | (other != 0) * TRACE_OTHER;
+        *out = (u8) low;
+        out += low != 0;
+        *out = (u8) high;
+        out += high != 0;
+        *out = (u8) other;
+        out += other != 0;
+        // The bytes of "now" in memory order are V0-VF then TRACE_OTHER's, as the host is little endian
+        const u8* values = (const u8*) now;
+        for (; changed; changed &= changed - 1)
+            *out++ = values[__builtin_ctz(changed)];
+    }
+    *start = flags;
+
+    u32 length = out - start;
+    nextInstruction = instruction + 1;
+    lastPC = pc;
+    memcpy(lastRegisters, now, sizeof(lastRegisters));
+    used += length;
+    bytes += length;
+    records++;
+    block->bytes = used;
+    block->records++;
+}
+
+#endif // TRACE_H
@@ -1,6 +1,7 @@
 #include <memory>
 #include <iostream>
 #include <sstream>
+#include <string.h>
 #include <Windows.h>
 #include "Chip8.h"
 using namespace std;
@@ -27,6 +28,29 @@ u32 getHexOrDecFromTerminal()
     return value;
 }
 
+// Returns a zeroed debugger command of the kind given
+DEBUG_COMMAND newCommand(u8 kind)
+{
+    DEBUG_COMMAND command;
+    memset(&command, 0, sizeof(command));
+    command.kind = kind;
+    return command;
+}
+
+// Commands go to the thread running the chip8 and are applied between frames, anything they print comes back as events
+void sendCommand(const DEBUG_COMMAND& command)
+{
+    if (!chip8->sendDebugCommand(command))
+        cout << "The chip8 is not taking commands yet, try again" << endl;
+}
+
+// The CHIP8_WATCH_READ and CHIP8_WATCH_WRITE flags for "r", "w" or "rw"
+u8 watchAccess(const std::string& access)
+{
+    return (access.find('r') != std::string::npos ? CHIP8_WATCH_READ : 0) |
+           (access.find('w') != std::string::npos ? CHIP8_WATCH_WRITE : 0);
+}
+
 void terminal_command()
 {
     std::string command;
@@ -35,24 +59,27 @@ void terminal_command()
     cin >> command;
         if (command == "run")
         {
-            chip8->run();
+            sendCommand(newCommand(DEBUG_RUN));
         }
         else if(command == "stop")
         {
-            chip8->stop();
+            sendCommand(newCommand(DEBUG_STOP));
         }
         else if(command == "memory")
         {
             u16 memLoc = getHexOrDecFromTerminal();
-            if (memLoc != -1)
+            if (memLoc != (u16) -1)
             {
-                u8 value = chip8->getMemory(memLoc);
-                cout << "Value: x" << std::hex << (int)value << endl;
+                DEBUG_COMMAND read = newCommand(DEBUG_READ_MEMORY);
+                read.address = memLoc;
+                read.length = 1;
+                sendCommand(read);
             }
         }
         else if (command == "regs")
         {
-            REGISTERS regs = chip8->getRegs();
+            // The registers published after the last frame, they are never caught half way through an instruction
+            DEBUG_SNAPSHOT regs = chip8->getDebugger().getSnapshot();
             cout << "General Purpose Registers: " << endl;
             for (int i = 0; i < 16; i++)
             {
@@ -60,34 +87,204 @@ void terminal_command()
             }
 
                 cout << "PC = " << "x" << std::hex << regs.PC << ", SP = x" << std::hex << (int)regs.SP << ", I = "
-                                << std::hex << "x" << regs.I << ", ST = x" << std::hex << regs.ST << ", DT = x" << std::hex << regs.DT << endl;
+                                << std::hex << "x" << regs.I << ", ST = x" << std::hex << (int)regs.ST << ", DT = x" << std::hex << (int)regs.DT << endl;
+                if (regs.keyWait)
+                    cout << "Halted on Fx0A waiting for a key to store in V" << std::hex << (regs.keyWait & 0x0f)
+                         << ", use 'key x5' to press one" << endl;
             } else if(command == "set")
         {
            cin >> reg;
            u16 value = getHexOrDecFromTerminal();
-           if (value != -1)
+           if (value != (u16) -1)
            {
-               bool ok = chip8->setReg(reg, value);
-               if (!ok)
-               {
+               DEBUG_COMMAND set = newCommand(DEBUG_SET_REGISTER);
+               set.reg = findRegister(reg);
+               set.value = value;
+               if (set.reg == CHIP8_REGISTER_COUNT)
                    cout << "Bad register" << endl;
-               }
+               else
+                   sendCommand(set);
            }
-        } else if(command == "break")
+        } else if(command == "break" || command == "when")
         {
-            // The memory location in chip8 to break at
-            u16 loc = getHexOrDecFromTerminal();
-            if (loc != -1)
+            // The memory location in chip8 to break at, "when" breaks wherever its condition holds
+            DEBUG_COMMAND set = newCommand(DEBUG_BREAK);
+            set.address = command == "when" ? CHIP8_BREAK_ANYWHERE : getHexOrDecFromTerminal();
+            std::string condition;
+            std::getline(cin, condition);
+            // A condition on a break point follows "if"
+            size_t start = condition.find_first_not_of(" \t");
+            if (set.address != CHIP8_BREAK_ANYWHERE && start != std::string::npos && condition.compare(start, 2, "if") == 0)
+                condition.erase(0, start + 2);
+            if (condition.size() >= CHIP8_DEBUG_TEXT_SIZE)
+                cout << "Bad break point, the condition is longer than " << CHIP8_DEBUG_TEXT_SIZE - 1 << " characters" << endl;
+            else if (set.address != (u16) -1 || command == "when")
             {
-                chip8->setBreakPoint(loc);
+                memcpy(set.text, condition.c_str(), condition.size() + 1);
+                sendCommand(set);
             }
+        } else if(command == "unbreak")
+        {
+            DEBUG_COMMAND clear = newCommand(DEBUG_UNBREAK);
+            clear.address = getHexOrDecFromTerminal();
+            if (clear.address != (u16) -1)
+                sendCommand(clear);
+        } else if(command == "clearbreaks")
+        {
+            sendCommand(newCommand(DEBUG_CLEAR_BREAKS));
+        } else if(command == "watch")
+        {
+            // The memory to watch, how many bytes of it and "r", "w" or "rw"
+            DEBUG_COMMAND watch = newCommand(DEBUG_WATCH);
+            watch.address = getHexOrDecFromTerminal();
+            watch.length = getHexOrDecFromTerminal();
+            std::string access;
+            cin >> access;
+            watch.access = watchAccess(access);
+            if (watch.address != (u16) -1 && watch.length != (u16) -1)
+            {
+                if (watch.access)
+                    sendCommand(watch);
+                else
+                    cout << "Use 'r', 'w' or 'rw' for the accesses to watch" << endl;
+            }
+        } else if(command == "watchreg")
+        {
+            std::string access;
+            cin >> reg >> access;
+            DEBUG_COMMAND watch = newCommand(DEBUG_WATCH_REGISTER);
+            watch.reg = findRegister(reg);
+            watch.access = watchAccess(access);
+            if (!watch.access || watch.reg >= CHIP8_REGISTER_PC)
+                cout << "Bad register watch point, use a register other than PC and 'r', 'w' or 'rw'" << endl;
+            else
+                sendCommand(watch);
+        } else if(command == "unwatch")
+        {
+            sendCommand(newCommand(DEBUG_UNWATCH));
+        } else if(command == "breaks")
+        {
+            cout << "Break points:" << endl;
+            sendCommand(newCommand(DEBUG_LIST_BREAKS));
+        } else if(command == "step")
+        {
+            DEBUG_COMMAND step = newCommand(DEBUG_STEP);
+            step.value = getHexOrDecFromTerminal();
+            if (step.value != (u32) -1)
+                sendCommand(step);
         } else if(command == "continue")
         {
-            REGISTERS regs = chip8->getRegs();
-            regs.PC+=2;
-            chip8->setReg("PC", regs.PC);
-            // Run chip8 again
-            chip8->run();
+            // Run chip8 again, the instruction it broke on is executed rather than broken on again
+            sendCommand(newCommand(DEBUG_RUN));
+        } else if(command == "frames")
+        {
+            sendCommand(newCommand(DEBUG_FRAMES));
+        } else if(command == "history")
+        {
+            sendCommand(newCommand(DEBUG_HISTORY));
+        } else if(command == "record")
+        {
+            DEBUG_COMMAND record = newCommand(DEBUG_RECORD);
+            record.value = 1;
+            sendCommand(record);
+        } else if(command == "endrecord")
+        {
+            std::string fname;
+            cin >> fname;
+            DEBUG_COMMAND record = newCommand(DEBUG_RECORD);
+            if (fname.size() >= CHIP8_DEBUG_TEXT_SIZE)
+            {
+                cout << "Give a file name shorter than " << CHIP8_DEBUG_TEXT_SIZE << " characters" << endl;
+            }
+            else
+            {
+                strcpy(record.text, fname.c_str());
+                sendCommand(record);
+            }
+        } else if(command == "trace" || command == "tracering")
+        {
+            std::string fname;
+            cin >> fname;
+            DEBUG_COMMAND trace = newCommand(DEBUG_TRACE);
+            trace.value = command == "tracering" ? getHexOrDecFromTerminal() : 0;
+            if (trace.value == (u32) -1 || fname.size() >= CHIP8_DEBUG_TEXT_SIZE)
+            {
+                cout << "Give a file name shorter than " << CHIP8_DEBUG_TEXT_SIZE << " characters and a number of blocks" << endl;
+            }
+            else
+            {
+                strcpy(trace.text, fname.c_str());
+                sendCommand(trace);
+                cout << "Tracing every instruction to " << fname << ", 'TraceTool' reads it back" << endl;
+            }
+        } else if(command == "endtrace")
+        {
+            sendCommand(newCommand(DEBUG_TRACE));
+        } else if(command == "profile")
+        {
+            DEBUG_COMMAND profile = newCommand(DEBUG_PROFILE);
+            profile.value = 1;
+            sendCommand(profile);
+            cout << "Counting every instruction by address, 'endprofile callgrind.out' stops and writes the profile" << endl;
+        } else if(command == "endprofile")
+        {
+            std::string fname;
+            cin >> fname;
+            DEBUG_COMMAND profile = newCommand(DEBUG_PROFILE);
+            if (fname.size() >= CHIP8_DEBUG_TEXT_SIZE)
+            {
+                cout << "Give a file name shorter than " << CHIP8_DEBUG_TEXT_SIZE << " characters" << endl;
+            }
+            else
+            {
+                strcpy(profile.text, fname.c_str());
+                sendCommand(profile);
+            }
+        } else if(command == "heatmap")
+        {
+            DEBUG_COMMAND heatmap = newCommand(DEBUG_HEATMAP);
+            heatmap.value = 1;
+            sendCommand(heatmap);
+            cout << "Counting the reads, writes and executes of every byte, press tab in the window to see them" << endl;
+        } else if(command == "endheatmap")
+        {
+            std::string fname;
+            cin >> fname;
+            DEBUG_COMMAND heatmap = newCommand(DEBUG_HEATMAP);
+            if (fname.size() >= CHIP8_DEBUG_TEXT_SIZE)
+            {
+                cout << "Give a file name shorter than " << CHIP8_DEBUG_TEXT_SIZE << " characters" << endl;
+            }
+            else
+            {
+                strcpy(heatmap.text, fname.c_str());
+                sendCommand(heatmap);
+            }
+        } else if(command == "runahead" || command == "ipf" || command == "pace")
+        {
+            DEBUG_COMMAND setting = newCommand(command == "runahead" ? DEBUG_RUN_AHEAD :
+                                               command == "ipf" ? DEBUG_INSTRUCTIONS_PER_FRAME : DEBUG_PACE);
+            setting.value = getHexOrDecFromTerminal();
+            if (setting.value != (u32) -1)
+                sendCommand(setting);
+        } else if(command == "pacing")
+        {
+            sendCommand(newCommand(DEBUG_PACING));
+        } else if(command == "idle")
+        {
+            sendCommand(newCommand(DEBUG_IDLE));
+        } else if(command == "key")
+        {
+            u32 key = getHexOrDecFromTerminal();
+            if (key != (u32) -1)
+            {
+                DEBUG_COMMAND press = newCommand(DEBUG_KEY);
+                press.reg = key & 0x0f;
+                bool waiting = chip8->getDebugger().getSnapshot().keyWait != 0;
+                sendCommand(press);
+                cout << "Pressed key " << std::hex << (key & 0x0f) << (waiting ? ", the machine was waiting for it" : "")
+                     << std::dec << endl;
+            }
         } else if(command == "help")
         {
             std::cout << "run ; Runs the Chip8 Program currently set" << std::endl
@@ -96,26 +293,80 @@ void terminal_command()
                       << "regs ; Displays all the registers of the Chip8 and their values" << std::endl
                       << "set V0 xff ; Set a Chip8 register where 'V0' is register 'V0' and 'xff' is hexadecimal value to set 'V0' to. Use 'd' instead of 'x' for decimal values." << std::endl
                       << "break xff ; Set a break point at either a hexadecimal location or a decimal location. Use 'd' for decimal and 'x' for hexadecimal" << std::endl
+                      << "break x200 if V3 == 0x10 && I > 0x300 ; Set a break point that only breaks when its condition holds. Conditions use V0-VF, I, DT, ST, SP and PC, numbers like 16 or 0x10, [address] for memory, + - &, comparisons, && || ! and brackets" << std::endl
+                      << "when V3 == 0x10 ; Break before any instruction when the condition holds" << std::endl
+                      << "unbreak x200 ; Remove the break point at a location, 'clearbreaks' removes every break point and condition" << std::endl
+                      << "watch x300 d4 rw ; Break before an instruction reads or writes any of 4 bytes from x300, use 'r' or 'w' for just one" << std::endl
+                      << "watchreg V3 w ; Break before an instruction reads or writes a register, 'unwatch' removes every watch point" << std::endl
+                      << "breaks ; List the break points and their conditions" << std::endl
+                      << "step d1 ; Execute a number of instructions then show where the machine is, whether it is running or not" << std::endl
                       << "continue ; Continue running the program after a breakpoint." << std::endl
+                      << "frames ; Display how many frames were presented and how many were skipped as unchanged" << std::endl
+                      << "history ; Display how much rewind history is held and its size, hold backspace in the window to rewind" << std::endl
+                      << "record ; Start recording key presses so the session can be replayed exactly, the random seed is kept with it" << std::endl
+                      << "endrecord file.c8r ; Stop recording and save it, 'bench replay file.c8r' plays it back headless" << std::endl
+                      << "trace file.c8t ; Record every instruction with the registers it changed into a compact trace file, 'endtrace' stops" << std::endl
+                      << "tracering file.c8t d64 ; Trace into a ring keeping only the last 64 blocks of 64KB, it survives a crash" << std::endl
+                      << "profile ; Count every instruction by address and opcode class and follow the calls between functions" << std::endl
+                      << "endprofile callgrind.out ; Stop profiling, show the hottest addresses and write the profile for KCachegrind" << std::endl
+                      << "heatmap ; Count the reads, writes and executes of every byte of memory, tab in the window shows them over the display" << std::endl
+                      << "endheatmap heat.csv ; Stop counting, show the data touched the most and write the counts as CSV, or binary for other names" << std::endl
+                      << "runahead d2 ; Present the display up to 4 frames ahead of the machine to hide input lag, 'runahead d0' turns it off" << std::endl
+                      << "ipf d10 ; Set the instructions run in each 60Hz frame, the timers tick once a frame" << std::endl
+                      << "pace d1 ; Run at 60 frames a second, 'pace d0' runs as fast as the host can" << std::endl
+                      << "pacing ; Display how closely frames have kept to 60 a second and how idle the host was" << std::endl
+                      << "idle ; Display how many instructions were skipped in loops that only wait on the delay timer or keys" << std::endl
+                      << "key x5 ; Press and let go of a Chip8 key, 'regs' shows if the machine is halted on Fx0A waiting for one" << std::endl
                       << "help ; Display the functions that are possible to use" << std::endl;
 
         }
 
 }
-/* The breakListener thread listens to any breaks their may be in the chip8*/
+/* The breakListener thread prints the events the chip8 sends back, it sleeps until there is one */
 LPTHREAD_START_ROUTINE breakListener(LPVOID lpvoid)
 {
-    s32 lastAddress = -1;
-    while(true)
+    DEBUG_EVENT event;
+    while(chip8->getDebugger().waitEvent(event))
     {
-        REGISTERS regs = chip8->getRegs();
-        // Check to see if their is a break point on the currently executing instruction
-        if (lastAddress != regs.PC && chip8->hasBreakPoint(regs.PC))
+        if (event.kind == DEBUG_EVENT_BREAK)
         {
-            cout << "Break on " << regs.PC << " use command 'continue' to continue executing" << endl;
+            const BREAK_EVENT& why = event.why;
+            cout << "Break on x" << std::hex << why.PC;
+            if (why.kind == BREAK_CONDITION)
+                cout << " as a condition held";
+            else if (why.kind == BREAK_READ || why.kind == BREAK_WRITE)
+            {
+                cout << " before it " << (why.kind == BREAK_READ ? "reads " : "writes ");
+                if (why.reg < CHIP8_REGISTER_COUNT)
+                    cout << registerName(why.reg);
+                else
+                    cout << "memory at x" << why.address;
+            }
+            cout << std::dec << ", use command 'continue' to continue executing" << endl;
+        }
+        else if (event.kind == DEBUG_EVENT_STEPPED)
+        {
+            cout << "Stepped " << std::dec << event.value << " instructions to x" << std::hex << event.registers.PC << std::dec << endl;
+        }
+        else if (event.kind == DEBUG_EVENT_MEMORY)
+        {
+            cout << "Value:";
+            for (u8 b = 0; b < event.length; b++)
+                cout << " x" << std::hex << (int) event.bytes[b];
+            cout << std::dec << endl;
+        }
+        else if (event.kind == DEBUG_EVENT_BREAK_POINT)
+        {
+            if (event.address == CHIP8_BREAK_ANYWHERE)
+                cout << "   anywhere when " << event.text << endl;
+            else
+                cout << "   x" << std::hex << event.address << std::dec << (event.text[0] ? " if " : "") << event.text << endl;
+        }
+        else if (event.kind == DEBUG_EVENT_ERROR || event.kind == DEBUG_EVENT_TRACED || event.kind == DEBUG_EVENT_PROFILED ||
+                 event.kind == DEBUG_EVENT_HEATMAP || event.kind == DEBUG_EVENT_INFO)
+        {
+            cout << event.text << endl;
         }
-
-        lastAddress = regs.PC;
     }
 
     return 0;
@@ -154,6 +405,18 @@ int main(int argc, char* argv[])
         exit(1);
     }
 
+    // An optional quirk profile such as "cosmac" or "schip" for ROMs written for other interpreters
+    if (argc > 2)
+    {
+        QUIRK_PROFILE profile = findQuirkProfile(argv[2]);
+        if (profile == QUIRK_PROFILE_COUNT)
+        {
+            MessageBoxA(0, (LPCSTR)"Unknown quirk profile, use default, cosmac, schip or xochip", (LPCSTR)"Quirk profile", 0);
+            exit(1);
+        }
+        chip8->setQuirkProfile(profile);
+    }
+
     #if CHIP8_DEBUG_MODE == true
         // Start the terminal
         CreateThread(NULL, 0, (LPTHREAD_START_ROUTINE) &terminal, (PVOID) 0, (DWORD) 0, (PDWORD) 0);
@@ -165,14 +428,12 @@ int main(int argc, char* argv[])
              "Recompile with debug mode on to access the terminal and debugger" << std::endl;
     #endif // CHIP8_DEBUG_MODE
 
+    // Process the chip8 file, while it is stopped "process" sleeps until the debugger or the window wakes it
     while(!chip8->hasQuit())
     {
-        if (chip8->isRunning())
-        {
-            // Process the chip8 file
-            chip8->process();
-        }
+        chip8->process();
     }
+    chip8->getDebugger().close();
 
     return 0;
 }
@@ -0,0 +1,340 @@
+#include <string.h>
+#include "Audio.h"
+#include "Chip8Core.h"
+
+AudioSink::~AudioSink()
+{
+
+}
+
+NullAudioSink::NullAudioSink()
+{
+    samples = 0;
+    loudSamples = 0;
+}
+
+void NullAudioSink::write(const s16* samples, u32 count)
+{
+    for (u32 i = 0; i < count; i++)
+        loudSamples += samples[i] != 0;
+    this->samples += count;
+}
+
+u64 NullAudioSink::getSamples()
+{
+    return samples;
+}
+
+u64 NullAudioSink::getLoudSamples()
+{
+    return loudSamples;
+}
+
+// The canonical 44 byte header of a PCM WAV file
+struct WAV_HEADER
+{
+    char riff[4];
+    u32 riffSize;
+    char wave[4];
+    char fmt[4];
+    u32 fmtSize;
+    u16 format;
+    u16 channels;
+    u32 rate;
+    u32 byteRate;
+    u16 blockAlign;
+    u16 bitsPerSample;
+    char data[4];
+    u32 dataSize;
+};
+
+WavAudioSink::WavAudioSink(u32 rate)
+{
+    this->rate = rate;
+    samples = 0;
+}
+
+WavAudioSink::~WavAudioSink()
+{
+    close();
+}
+
+bool WavAudioSink::open(const std::string& fname)
+{
+    close();
+    file.open(fname, std::ios::binary | std::ios::trunc);
+    samples = 0;
+    if (!file)
+        return false;
+    // The lengths are not known yet, "close" writes the header again once they are
+    writeHeader();
+    return (bool) file;
+}
+
+void WavAudioSink::write(const s16* samples, u32 count)
+{
+    if (!file.is_open())
+        return;
+    file.write((const char*) samples, (std::streamsize) count * sizeof(s16));
+    this->samples += count;
+}
+
+void WavAudioSink::close()
+{
+    if (!file.is_open())
+        return;
+    file.seekp(0);
+    writeHeader();
+    file.close();
+}
+
+u64 WavAudioSink::getSamples()
+{
+    return samples;
+}
+
+void WavAudioSink::writeHeader()
+{
+    WAV_HEADER header;
+    u32 dataSize = (u32) (samples * sizeof(s16));
+    memcpy(header.riff, "RIFF", 4);
+    header.riffSize = sizeof(WAV_HEADER) - 8 + dataSize;
+    memcpy(header.wave, "WAVE", 4);
+    memcpy(header.fmt, "fmt ", 4);
+    header.fmtSize = 16;
+    // PCM, mono, 16 bit
+    header.format = 1;
+    header.channels = 1;
+    header.rate = rate;
+    header.byteRate = rate * sizeof(s16);
+    header.blockAlign = sizeof(s16);
+    header.bitsPerSample = 16;
+    memcpy(header.data, "data", 4);
+    header.dataSize = dataSize;
+    file.write((const char*) &header, sizeof(header));
+}
+
+RingAudioSink::RingAudioSink(u32 rate, u32 prime)
+{
+    this->prime = prime;
+    // Right after a write the prime and a frame are waiting, a second frame is as far behind as the device is let fall
+    maxQueued = prime + 2 * (rate / CHIP8_FRAMES_PER_SECOND);
+    written = 0;
+    dropped = 0;
+    latencyTotal = 0;
+    latencyWrites = 0;
+    latencyMax = 0;
+    deviceRead = 0;
+    underruns = 0;
+    shortReads = 0;
+    trimmed = 0;
+}
+
+void RingAudioSink::write(const s16* samples, u32 count)
+{
+    u32 queued = ring.size();
+    if (queued == 0 && prime)
+    {
+        // Run dry, at the start or after the machine stopped, so the device gets silence to read while the next frame is made
+        static const s16 silence[CHIP8_AUDIO_DEVICE_SAMPLES] = {};
+        for (u32 left = prime; left; )
+        {
+            u32 n = ring.pushMany(silence, left < CHIP8_AUDIO_DEVICE_SAMPLES ? left : CHIP8_AUDIO_DEVICE_SAMPLES);
+            if (n == 0)
+                break;
+            queued += n;
+            left -= n;
+        }
+    }
+    latencyTotal += queued;
+    latencyWrites++;
+    if (queued > latencyMax)
+        latencyMax = queued;
+    // Only a device that has stopped reading lets the ring fill, what does not fit is dropped
+    u32 pushed = ring.pushMany(samples, count);
+    written += count;
+    dropped += count - pushed;
+}
+
+void RingAudioSink::read(s16* samples, u32 count)
+{
+    /* A host clock running ahead of the device's leaves a little more waiting each frame, rather than let the latency
+     * grow the oldest samples past "maxQueued" are thrown away. "samples" is overwritten below anyway */
+    u32 waiting = ring.size();
+    for (u32 excess = waiting > maxQueued ? waiting - maxQueued : 0; excess; )
+    {
+        u32 n = ring.popMany(samples, excess < count ? excess : count);
+        trimmed.fetch_add(n, std::memory_order_relaxed);
+        excess -= n;
+    }
+    u32 got = ring.popMany(samples, count);
+    if (got < count)
+    {
+        memset(samples + got, 0, (count - got) * sizeof(s16));
+        underruns.fetch_add(count - got, std::memory_order_relaxed);
+        shortReads.fetch_add(1, std::memory_order_relaxed);
+    }
+    deviceRead.fetch_add(got, std::memory_order_relaxed);
+}
+
+u32 RingAudioSink::getQueued() const
+{
+    return ring.size();
+}
+
+AUDIO_RING_STATS RingAudioSink::getStats() const
+{
+    AUDIO_RING_STATS stats;
+    stats.written = written;
+    stats.dropped = dropped + trimmed.load(std::memory_order_relaxed);
+    stats.read = deviceRead.load(std::memory_order_relaxed);
+    stats.underruns = underruns.load(std::memory_order_relaxed);
+    stats.shortReads = shortReads.load(std::memory_order_relaxed);
+    stats.latencyTotal = latencyTotal;
+    stats.latencyWrites = latencyWrites;
+    stats.latencyMax = latencyMax;
+    return stats;
+}
+
+void RingAudioSink::setMaxQueued(u32 samples)
+{
+    maxQueued = samples;
+}
+
+Chip8Audio::Chip8Audio(u32 rate, u32 tone)
+{
+    sink = NULL;
+    this->rate = rate ? rate : CHIP8_AUDIO_RATE;
+    phase = 0;
+    step = (u32) (((u64) tone << 32) / this->rate);
+    owed = 0;
+    samples = 0;
+    loudSamples = 0;
+    buffered = 0;
+}
+
+Chip8Audio::~Chip8Audio()
+{
+
+}
+
+void Chip8Audio::setSink(AudioSink* sink)
+{
+    this->sink = sink;
+}
+
+AudioSink* Chip8Audio::getSink()
+{
+    return sink;
+}
+
+u32 Chip8Audio::execute(Chip8Core& core, u32 count)
+{
+    if (!sink)
+        return core.execute(count);
+
+    /* "ST" only changes when the timers tick, with the instruction that ends a frame, or when "Fx18" writes it. So the
+     * machine runs up to the end of the frame in one call and the core notes where in it the buzzer was turned on or
+     * off. An instruction sounds if "ST" was non-zero before it, one set by "Fx18" sounds from the instruction after */
+    u32 done = 0;
+    while (done < count)
+    {
+        const CHIP8_STATE& s = core.getState();
+        u32 instructionsPerFrame = s.instructionsPerFrame;
+        u32 start = s.timerPhase;
+        u32 span = instructionsPerFrame - start;
+        if (span > count - done)
+            span = count - done;
+        bool loud = s.ST > 0;
+        core.clearSoundWrites();
+        u32 ran = core.execute(span);
+
+        const SOUND_WRITE* writes;
+        u32 writeCount = core.getSoundWrites(writes);
+        u32 at = start;
+        u32 end = start + ran;
+        for (u32 w = 0; w < writeCount; w++)
+        {
+            u32 to = writes[w].phase < end ? writes[w].phase : end;
+            if (to > at)
+            {
+                generate(loud, samplesFor(instructionsPerFrame, to - at));
+                at = to;
+            }
+            loud = writes[w].loud;
+        }
+        generate(loud, samplesFor(instructionsPerFrame, end - at));
+        done += ran;
+        if (ran < span)
+            break;
+    }
+    flush();
+    return done;
+}
+
+void Chip8Audio::silence(Chip8Core& core, u32 count)
+{
+    if (!sink)
+        return;
+    generate(false, samplesFor(core.getInstructionsPerFrame(), count));
+    flush();
+}
+
+u32 Chip8Audio::getRate()
+{
+    return rate;
+}
+
+u64 Chip8Audio::getSamples()
+{
+    return samples;
+}
+
+u64 Chip8Audio::getLoudSamples()
+{
+    return loudSamples;
+}
+
+inline u32 Chip8Audio::samplesFor(u32 instructionsPerFrame, u32 instructions)
+{
+    // An instruction is 1 / (60 * "instructionsPerFrame") of a second, kept exact by carrying the remainder
+    u64 per = (u64) CHIP8_FRAMES_PER_SECOND * (instructionsPerFrame ? instructionsPerFrame : 1);
+    owed += (u64) rate * instructions;
+    u32 n = (u32) (owed / per);
+    owed -= n * per;
+    return n;
+}
+
+void Chip8Audio::generate(bool loud, u32 count)
+{
+    // More than the buffer holds goes a buffer at a time
+    for (; count > CHIP8_AUDIO_RING_SIZE; count -= CHIP8_AUDIO_RING_SIZE)
+        generate(loud, CHIP8_AUDIO_RING_SIZE);
+    if (buffered + count > CHIP8_AUDIO_RING_SIZE)
+        flush();
+    s16* out = buffer + buffered;
+    if (loud)
+    {
+        // A square wave, high for the first half of each cycle
+        for (u32 i = 0; i < count; i++)
+        {
+            out[i] = (phase & 0x80000000) ? -CHIP8_AUDIO_VOLUME : CHIP8_AUDIO_VOLUME;
+            phase += step;
+        }
+        loudSamples += count;
+    }
+    else
+    {
+        memset(out, 0, count * sizeof(s16));
+        phase += step * count;
+    }
+    buffered += count;
+    samples += count;
+}
+
+void Chip8Audio::flush()
+{
+    if (buffered)
+        sink->write(buffer, buffered);
+    buffered = 0;
+}
@@ -0,0 +1,779 @@
+#include <string.h>
+#include "Batch.h"
+#include "Handlers.h"
+
+#if defined(__AVX2__)
+    #include <immintrin.h>
+    #define CHIP8_BATCH_VECTOR "avx2"
+
+    // The SIMD kernels work on rows of lane bytes through these so the same code builds for AVX2 and SSE2
+    typedef __m256i VECTOR;
+    #define VECTOR_BYTES 32
+    static inline VECTOR vectorLoad(const u8* p) { return _mm256_loadu_si256((const __m256i*) p); }
+    static inline void vectorStore(u8* p, VECTOR v) { _mm256_storeu_si256((__m256i*) p, v); }
+    static inline VECTOR vectorSet(u8 value) { return _mm256_set1_epi8(value); }
+    static inline VECTOR vectorAdd(VECTOR a, VECTOR b) { return _mm256_add_epi8(a, b); }
+    static inline VECTOR vectorAddSaturate(VECTOR a, VECTOR b) { return _mm256_adds_epu8(a, b); }
+    static inline VECTOR vectorSub(VECTOR a, VECTOR b) { return _mm256_sub_epi8(a, b); }
+    static inline VECTOR vectorSubSaturate(VECTOR a, VECTOR b) { return _mm256_subs_epu8(a, b); }
+    static inline VECTOR vectorAnd(VECTOR a, VECTOR b) { return _mm256_and_si256(a, b); }
+    static inline VECTOR vectorOr(VECTOR a, VECTOR b) { return _mm256_or_si256(a, b); }
+    static inline VECTOR vectorXor(VECTOR a, VECTOR b) { return _mm256_xor_si256(a, b); }
+    static inline VECTOR vectorEqual(VECTOR a, VECTOR b) { return _mm256_cmpeq_epi8(a, b); }
+    static inline VECTOR vectorShiftRight(VECTOR a, int bits) { return _mm256_srli_epi16(a, bits); }
+    static inline VECTOR vectorBlend(VECTOR a, VECTOR b, VECTOR mask) { return _mm256_blendv_epi8(a, b, mask); }
+    static inline u32 vectorMoveMask(VECTOR a) { return (u32) _mm256_movemask_epi8(a); }
+#elif defined(__SSE2__) || defined(_M_X64)
+    #include <emmintrin.h>
+    #define CHIP8_BATCH_VECTOR "sse2"
+
+    typedef __m128i VECTOR;
+    #define VECTOR_BYTES 16
+    static inline VECTOR vectorLoad(const u8* p) { return _mm_loadu_si128((const __m128i*) p); }
+    static inline void vectorStore(u8* p, VECTOR v) { _mm_storeu_si128((__m128i*) p, v); }
+    static inline VECTOR vectorSet(u8 value) { return _mm_set1_epi8(value); }
+    static inline VECTOR vectorAdd(VECTOR a, VECTOR b) { return _mm_add_epi8(a, b); }
+    static inline VECTOR vectorAddSaturate(VECTOR a, VECTOR b) { return _mm_adds_epu8(a, b); }
+    static inline VECTOR vectorSub(VECTOR a, VECTOR b) { return _mm_sub_epi8(a, b); }
+    static inline VECTOR vectorSubSaturate(VECTOR a, VECTOR b) { return _mm_subs_epu8(a, b); }
+    static inline VECTOR vectorAnd(VECTOR a, VECTOR b) { return _mm_and_si128(a, b); }
+    static inline VECTOR vectorOr(VECTOR a, VECTOR b) { return _mm_or_si128(a, b); }
+    static inline VECTOR vectorXor(VECTOR a, VECTOR b) { return _mm_xor_si128(a, b); }
+    static inline VECTOR vectorEqual(VECTOR a, VECTOR b) { return _mm_cmpeq_epi8(a, b); }
+    static inline VECTOR vectorShiftRight(VECTOR a, int bits) { return _mm_srli_epi16(a, bits); }
+    static inline VECTOR vectorBlend(VECTOR a, VECTOR b, VECTOR mask) { return _mm_or_si128(_mm_andnot_si128(mask, a), _mm_and_si128(mask, b)); }
+    static inline u32 vectorMoveMask(VECTOR a) { return (u32) _mm_movemask_epi8(a); }
+#endif
+
+#ifdef CHIP8_BATCH_VECTOR
+// 0xff in each byte where "a" is above "b"
+static inline VECTOR vectorGreater(VECTOR a, VECTOR b)
+{
+    return vectorXor(vectorEqual(vectorSubSaturate(a, b), vectorSet(0)), vectorSet(0xff));
+}
+#endif
+
+// Rotates a display row right, the same as the one "Chip8Core::drawSprite" uses
+static inline u64 rotateRight(u64 value, u8 shift)
+{
+    return (value >> (shift & 63)) | (value << ((64 - shift) & 63));
+}
+
+// Spreads 8 lane bits out to 8 bytes of 0x00 or 0xff, the kernels turn a lane mask into a byte mask with it
+struct LANE_BYTES_TABLE
+{
+    u64 bytes[256];
+};
+
+static constexpr LANE_BYTES_TABLE buildLaneBytesTable()
+{
+    LANE_BYTES_TABLE table = {};
+    for (u32 bits = 0; bits < 256; bits++)
+    {
+        for (u32 lane = 0; lane < 8; lane++)
+        {
+            if (bits & (1 << lane))
+                table.bytes[bits] |= 0xffull << (lane * 8);
+        }
+    }
+    return table;
+}
+
+static constexpr LANE_BYTES_TABLE laneBytesTable = buildLaneBytesTable();
+
+#ifdef CHIP8_BATCH_VECTOR
+/* "PC", "I" and the instruction counts are wider than a byte, they are worked on 8 lanes at a time with SSE2 which
+ * every x86-64 has. Returns 0xffff for each of the 8 lanes from "first" that is in "mask" */
+static inline __m128i laneWords(u32 mask, u32 first)
+{
+    __m128i bytes = _mm_loadl_epi64((const __m128i*) &laneBytesTable.bytes[(mask >> first) & 0xff]);
+    return _mm_unpacklo_epi8(bytes, bytes);
+}
+
+static inline __m128i blendWords(__m128i a, __m128i b, __m128i mask)
+{
+    return _mm_or_si128(_mm_andnot_si128(mask, a), _mm_and_si128(mask, b));
+}
+#endif
+
+// Takes one off the instructions left for each lane in "mask", returns a bit for each lane that has none left
+static inline u32 countDown(u32* left, u32 mask)
+{
+    u32 finished = 0;
+    #ifdef CHIP8_BATCH_VECTOR
+        for (u32 first = 0; first < CHIP8_BATCH_MAX_LANES; first += 8)
+        {
+            __m128i m = laneWords(mask, first);
+            __m128i* low = (__m128i*) (left + first);
+            __m128i* high = low + 1;
+            __m128i lowLeft = _mm_add_epi32(_mm_loadu_si128(low), _mm_unpacklo_epi16(m, m));
+            __m128i highLeft = _mm_add_epi32(_mm_loadu_si128(high), _mm_unpackhi_epi16(m, m));
+            _mm_storeu_si128(low, lowLeft);
+            _mm_storeu_si128(high, highLeft);
+            __m128i done = _mm_packs_epi32(_mm_cmpeq_epi32(lowLeft, _mm_setzero_si128()), _mm_cmpeq_epi32(highLeft, _mm_setzero_si128()));
+            finished |= ((u32) _mm_movemask_epi8(_mm_packs_epi16(done, done)) & 0xff) << first;
+        }
+    #else
+        for (u32 lane = 0; lane < CHIP8_BATCH_MAX_LANES; lane++)
+        {
+            left[lane] -= (mask >> lane) & 1;
+            finished |= (u32) (left[lane] == 0) << lane;
+        }
+    #endif
+    return finished;
+}
+
+static inline u32 countLanes(u32 mask)
+{
+    return __builtin_popcount(mask);
+}
+
+Chip8Batch::Chip8Batch(u32 lanes)
+{
+    if (lanes > CHIP8_BATCH_MAX_LANES)
+        lanes = CHIP8_BATCH_MAX_LANES;
+
+    this->lanes = lanes;
+    state.reset(new CHIP8_BATCH_STATE);
+    memset(state.get(), 0, sizeof(CHIP8_BATCH_STATE));
+    runningMask = lanes == 32 ? 0xffffffff : (1u << lanes) - 1;
+    waitingMask = 0;
+    instructionsPerFrame = CHIP8_INSTRUCTIONS_PER_FRAME;
+    memset(pageWriters, 0, sizeof(pageWriters));
+    memset(&stats, 0, sizeof(stats));
+
+    for (u32 lane = 0; lane < CHIP8_BATCH_MAX_LANES; lane++)
+        setSeed(lane, lane + 1);
+}
+
+Chip8Batch::~Chip8Batch()
+{
+
+}
+
+u32 Chip8Batch::getLanes()
+{
+    return lanes;
+}
+
+void Chip8Batch::loadState(const CHIP8_STATE& from)
+{
+    CHIP8_BATCH_STATE& s = *state;
+    for (u32 lane = 0; lane < lanes; lane++)
+    {
+        for (u32 r = 0; r < CHIP8_TOTAL_GENERAL_PURPOSE_REGISTERS; r++)
+            s.V[r][lane] = from.V[r];
+        for (u32 c = 0; c < CHIP8_STACK_SIZE; c++)
+            s.stack[c][lane] = from.stack[c];
+        for (u32 k = 0; k < CHIP8_TOTAL_KEYS; k++)
+            s.keys[k][lane] = from.keys[k];
+        s.DT[lane] = from.DT;
+        s.ST[lane] = from.ST;
+        s.SP[lane] = from.SP;
+        s.lastKeyPressed[lane] = from.lastKeyPressed;
+        s.I[lane] = from.I;
+        s.PC[lane] = from.PC;
+        s.instructions[lane] = from.instructions;
+        s.timerPhase[lane] = from.timerPhase;
+        s.keyWait[lane] = from.keyWait;
+        memcpy(s.pixels[lane], from.pixels, sizeof(from.pixels));
+        memcpy(s.memory[lane], from.memory, sizeof(from.memory));
+    }
+    runningMask = lanes == 32 ? 0xffffffff : (1u << lanes) - 1;
+    waitingMask = from.keyWait ? runningMask : 0;
+    instructionsPerFrame = from.instructionsPerFrame ? from.instructionsPerFrame : 1;
+    memset(pageWriters, 0, sizeof(pageWriters));
+}
+
+void Chip8Batch::getLaneState(u32 lane, CHIP8_STATE& to)
+{
+    CHIP8_BATCH_STATE& s = *state;
+    memset(&to, 0, sizeof(to));
+    for (u32 r = 0; r < CHIP8_TOTAL_GENERAL_PURPOSE_REGISTERS; r++)
+        to.V[r] = s.V[r][lane];
+    for (u32 c = 0; c < CHIP8_STACK_SIZE; c++)
+        to.stack[c] = s.stack[c][lane];
+    for (u32 k = 0; k < CHIP8_TOTAL_KEYS; k++)
+        to.keys[k] = s.keys[k][lane];
+    to.DT = s.DT[lane];
+    to.ST = s.ST[lane];
+    to.SP = s.SP[lane];
+    to.lastKeyPressed = s.lastKeyPressed[lane];
+    to.I = s.I[lane];
+    to.PC = s.PC[lane];
+    to.random = s.random[lane];
+    to.instructions = s.instructions[lane];
+    to.timerPhase = s.timerPhase[lane];
+    to.instructionsPerFrame = instructionsPerFrame;
+    to.keyWait = s.keyWait[lane];
+    memcpy(to.pixels, s.pixels[lane], sizeof(to.pixels));
+    memcpy(to.memory, s.memory[lane], sizeof(to.memory));
+}
+
+void Chip8Batch::setSeed(u32 lane, u32 seed)
+{
+    state->random[lane % CHIP8_BATCH_MAX_LANES] = seed ? seed : 1;
+}
+
+void Chip8Batch::setKeyDown(u32 lane, u8 key)
+{
+    lane %= CHIP8_BATCH_MAX_LANES;
+    state->keys[key & 0x0f][lane] = true;
+    state->lastKeyPressed[lane] = key & 0x0f;
+    if (waitingMask & (1u << lane))
+    {
+        state->V[state->keyWait[lane] & 0x0f][lane] = key & 0x0f;
+        state->keyWait[lane] = 0;
+        waitingMask &= ~(1u << lane);
+    }
+}
+
+void Chip8Batch::setKeyUp(u32 lane, u8 key)
+{
+    state->keys[key & 0x0f][lane % CHIP8_BATCH_MAX_LANES] = false;
+}
+
+const u64* Chip8Batch::getPixels(u32 lane)
+{
+    return state->pixels[lane % CHIP8_BATCH_MAX_LANES];
+}
+
+bool Chip8Batch::hasQuit(u32 lane)
+{
+    return lane < lanes && !(runningMask & (1u << lane));
+}
+
+bool Chip8Batch::isWaitingForKey(u32 lane)
+{
+    return lane < lanes && (waitingMask & (1u << lane));
+}
+
+BATCH_STATS Chip8Batch::getStats()
+{
+    return stats;
+}
+
+const char* Chip8Batch::getKernelName()
+{
+    #ifdef CHIP8_BATCH_VECTOR
+        return CHIP8_BATCH_VECTOR;
+    #else
+        return "scalar";
+    #endif
+}
+
+u32 Chip8Batch::lanesAt(u16 pc)
+{
+    #ifdef CHIP8_BATCH_VECTOR
+        // Eight 16 bit "PC"s are compared at a time and the results packed down to one bit per lane
+        const __m128i* PC = (const __m128i*) state->PC;
+        __m128i target = _mm_set1_epi16(pc);
+        u32 low = _mm_movemask_epi8(_mm_packs_epi16(_mm_cmpeq_epi16(_mm_loadu_si128(PC), target),
+                                                    _mm_cmpeq_epi16(_mm_loadu_si128(PC + 1), target)));
+        u32 high = _mm_movemask_epi8(_mm_packs_epi16(_mm_cmpeq_epi16(_mm_loadu_si128(PC + 2), target),
+                                                     _mm_cmpeq_epi16(_mm_loadu_si128(PC + 3), target)));
+        return low | (high << 16);
+    #else
+        u32 mask = 0;
+        for (u32 lane = 0; lane < CHIP8_BATCH_MAX_LANES; lane++)
+            mask |= (u32) (state->PC[lane] == pc) << lane;
+        return mask;
+    #endif
+}
+
+u64 Chip8Batch::run(u32 count)
+{
+    CHIP8_BATCH_STATE& s = *state;
+    u32 left[CHIP8_BATCH_MAX_LANES];
+    for (u32 lane = 0; lane < CHIP8_BATCH_MAX_LANES; lane++)
+        left[lane] = count;
+
+    u64 executed = 0;
+    u32 active = count ? runningMask & ~waitingMask : 0;
+    u32 lead = active ? __builtin_ctz(active) : 0;
+    while (active)
+    {
+        // Lanes that have converged are usually all still together at the last lead's "PC" so that is tried first
+        if (!(active & (1u << lead)))
+            lead = __builtin_ctz(active);
+        u32 same = lanesAt(s.PC[lead]) & active;
+        if (same != active)
+        {
+            // Otherwise the lowest "PC" runs next, lanes that are behind catch up to the ones waiting further on
+            for (u32 lanesLeft = active & ~same; lanesLeft; lanesLeft &= lanesLeft - 1)
+            {
+                u32 lane = __builtin_ctz(lanesLeft);
+                if (s.PC[lane] < s.PC[lead])
+                    lead = lane;
+            }
+            same = lanesAt(s.PC[lead]) & active;
+        }
+        u16 pc = s.PC[lead];
+
+        /* Every lane starts with the same memory so only lanes that have written to the page can hold a different
+         * opcode, those are checked one by one. If the lead wrote to it every lane is checked against it */
+        u16 address = CHIP8_ADDRESS(pc);
+        u16 next = CHIP8_ADDRESS(pc + 1);
+        u16 opcode = (s.memory[lead][address] << 8) | s.memory[lead][next];
+        u32 writers = (pageWriters[address >> 8] | pageWriters[next >> 8]) & same;
+        if (writers & (1u << lead))
+            writers = same;
+        u32 group = same & ~writers;
+        for (; writers; writers &= writers - 1)
+        {
+            u32 lane = __builtin_ctz(writers);
+            if (((s.memory[lane][address] << 8) | s.memory[lane][next]) == opcode)
+                group |= 1u << lane;
+        }
+
+        executeGroup(opcode, group);
+        executed += countLanes(group);
+        stats.groups++;
+
+        active &= runningMask & ~waitingMask & ~countDown(left, group);
+    }
+
+    // Lanes halted on "Fx0A" wait out the rest of the run with their timers ticking, as a core does
+    for (u32 waiting = waitingMask & runningMask; waiting; waiting &= waiting - 1)
+    {
+        u32 lane = __builtin_ctz(waiting);
+        u32 phase = s.timerPhase[lane] + left[lane];
+        u32 frames = phase / instructionsPerFrame;
+        s.timerPhase[lane] = phase % instructionsPerFrame;
+        s.DT[lane] = s.DT[lane] > frames ? s.DT[lane] - frames : 0;
+        s.ST[lane] = s.ST[lane] > frames ? s.ST[lane] - frames : 0;
+        left[lane] = 0;
+    }
+
+    for (u32 lane = 0; lane < CHIP8_BATCH_MAX_LANES; lane++)
+        s.instructions[lane] += count - left[lane];
+    stats.instructions += executed;
+    return executed;
+}
+
+void Chip8Batch::executeGroup(u16 opcode, u32 mask)
+{
+    // A lone lane is quicker without the kernels
+    if (countLanes(mask) > 1 && executeVector(opcode, mask))
+    {
+        stats.vectorGroups++;
+        return;
+    }
+
+    for (; mask; mask &= mask - 1)
+        executeLane(__builtin_ctz(mask), opcode);
+}
+
+/* The kernels follow the handlers exactly, "VF" is written before the result and the result reads its operands
+ * again afterwards so a "VF" operand behaves just as it does in the interpreter */
+bool Chip8Batch::executeVector(u16 opcode, u32 mask)
+{
+    #ifdef CHIP8_BATCH_VECTOR
+        CHIP8_BATCH_STATE& s = *state;
+        INSTRUCTION ins = decodeOpcode(opcode);
+        u8* vx = s.V[ins.x];
+        u8* vy = s.V[ins.y];
+        u8* vf = s.V[0xf];
+
+        alignas(CHIP8_CACHE_LINE_SIZE) u64 laneMasks[CHIP8_BATCH_MAX_LANES / 8];
+        for (u32 c = 0; c < CHIP8_BATCH_MAX_LANES / 8; c++)
+            laneMasks[c] = laneBytesTable.bytes[(mask >> (c * 8)) & 0xff];
+        const u8* laneBytes = (const u8*) laneMasks;
+
+        // Instructions on "I" work 8 lanes at a time, "PC" is moved on for every kernel further down
+        u32 skip = 0;
+        switch(ins.cls)
+        {
+            case OPCODE_JP:
+            case OPCODE_LD_I:
+            case OPCODE_ADD_I_VX:
+            case OPCODE_LD_F_VX:
+                for (u32 first = 0; first < CHIP8_BATCH_MAX_LANES; first += 8)
+                {
+                    __m128i m = laneWords(mask, first);
+                    __m128i* PC = (__m128i*) (s.PC + first);
+                    __m128i* I = (__m128i*) (s.I + first);
+                    __m128i x = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*) (vx + first)), _mm_setzero_si128());
+                    if (ins.cls == OPCODE_JP)
+                    {
+                        // Every lane in the group moves on by 2 below so the jump lands 2 short
+                        _mm_storeu_si128(PC, blendWords(_mm_loadu_si128(PC), _mm_set1_epi16(ins.nnn - 2), m));
+                    }
+                    else if (ins.cls == OPCODE_LD_I)
+                        _mm_storeu_si128(I, blendWords(_mm_loadu_si128(I), _mm_set1_epi16(ins.nnn), m));
+                    else if (ins.cls == OPCODE_ADD_I_VX)
+                        _mm_storeu_si128(I, _mm_add_epi16(_mm_loadu_si128(I), _mm_and_si128(x, m)));
+                    else
+                        _mm_storeu_si128(I, blendWords(_mm_loadu_si128(I), _mm_mullo_epi16(_mm_and_si128(x, _mm_set1_epi16(0x0f)), _mm_set1_epi16(5)), m));
+                }
+            break;
+            case OPCODE_SKP:
+            case OPCODE_SKNP:
+            {
+                // Each lane looks up its own key so there is nothing to vectorise
+                u32 down = 0;
+                for (u32 lanesLeft = mask; lanesLeft; lanesLeft &= lanesLeft - 1)
+                {
+                    u32 lane = __builtin_ctz(lanesLeft);
+                    down |= (u32) (s.keys[vx[lane] & 0x0f][lane] != 0) << lane;
+                }
+                skip = (ins.cls == OPCODE_SKP ? down : ~down) & mask;
+            }
+            break;
+            default:
+            break;
+        }
+
+        VECTOR one = vectorSet(1);
+        u32 equal = 0;
+        for (u32 o = 0; o < CHIP8_BATCH_MAX_LANES; o += VECTOR_BYTES)
+        {
+            VECTOR m = vectorLoad(laneBytes + o);
+            VECTOR x = vectorLoad(vx + o);
+            VECTOR y = vectorLoad(vy + o);
+            switch(ins.cls)
+            {
+                case OPCODE_LD_VX_KK:
+                    vectorStore(vx + o, vectorBlend(x, vectorSet(ins.kk), m));
+                break;
+                case OPCODE_ADD_VX_KK:
+                    vectorStore(vx + o, vectorBlend(x, vectorAdd(x, vectorSet(ins.kk)), m));
+                break;
+                case OPCODE_LD_VX_VY:
+                    vectorStore(vx + o, vectorBlend(x, y, m));
+                break;
+                case OPCODE_OR:
+                    vectorStore(vx + o, vectorBlend(x, vectorOr(x, y), m));
+                break;
+                case OPCODE_AND:
+                    vectorStore(vx + o, vectorBlend(x, vectorAnd(x, y), m));
+                break;
+                case OPCODE_XOR:
+                    vectorStore(vx + o, vectorBlend(x, vectorXor(x, y), m));
+                break;
+                case OPCODE_ADD_VX_VY:
+                {
+                    // The sum is taken before "VF" changes, it carried wherever the saturating sum differs from it
+                    VECTOR sum = vectorAdd(x, y);
+                    VECTOR carry = vectorXor(vectorEqual(vectorAddSaturate(x, y), sum), vectorSet(0xff));
+                    vectorStore(vf + o, vectorBlend(vectorLoad(vf + o), vectorAnd(carry, one), m));
+                    vectorStore(vx + o, vectorBlend(vectorLoad(vx + o), sum, m));
+                }
+                break;
+                case OPCODE_SUB:
+                    vectorStore(vf + o, vectorBlend(vectorLoad(vf + o), vectorAnd(vectorGreater(x, y), one), m));
+                    x = vectorLoad(vx + o);
+                    y = vectorLoad(vy + o);
+                    vectorStore(vx + o, vectorBlend(x, vectorSub(x, y), m));
+                break;
+                case OPCODE_SUBN:
+                    vectorStore(vf + o, vectorBlend(vectorLoad(vf + o), vectorAnd(vectorGreater(y, x), one), m));
+                    x = vectorLoad(vx + o);
+                    y = vectorLoad(vy + o);
+                    vectorStore(vx + o, vectorBlend(x, vectorSub(y, x), m));
+                break;
+                case OPCODE_SHR:
+                    vectorStore(vf + o, vectorBlend(vectorLoad(vf + o), vectorAnd(x, one), m));
+                    x = vectorLoad(vx + o);
+                    vectorStore(vx + o, vectorBlend(x, vectorAnd(vectorShiftRight(x, 1), vectorSet(0x7f)), m));
+                break;
+                case OPCODE_SHL:
+                    vectorStore(vf + o, vectorBlend(vectorLoad(vf + o), vectorAnd(vectorShiftRight(x, 7), one), m));
+                    x = vectorLoad(vx + o);
+                    vectorStore(vx + o, vectorBlend(x, vectorAdd(x, x), m));
+                break;
+                case OPCODE_SE_VX_KK:
+                case OPCODE_SNE_VX_KK:
+                    equal |= vectorMoveMask(vectorEqual(x, vectorSet(ins.kk))) << o;
+                break;
+                case OPCODE_SE_VX_VY:
+                case OPCODE_SNE_VX_VY:
+                    equal |= vectorMoveMask(vectorEqual(x, y)) << o;
+                break;
+                case OPCODE_LD_VX_DT:
+                    vectorStore(vx + o, vectorBlend(x, vectorLoad(s.DT + o), m));
+                break;
+                case OPCODE_LD_DT_VX:
+                    vectorStore(s.DT + o, vectorBlend(vectorLoad(s.DT + o), x, m));
+                break;
+                case OPCODE_LD_ST_VX:
+                    vectorStore(s.ST + o, vectorBlend(vectorLoad(s.ST + o), x, m));
+                break;
+                case OPCODE_JP:
+                case OPCODE_LD_I:
+                case OPCODE_ADD_I_VX:
+                case OPCODE_LD_F_VX:
+                case OPCODE_SKP:
+                case OPCODE_SKNP:
+                break;
+                default:
+                    return false;
+            }
+        }
+
+        // The lanes that skip the next instruction
+        if (ins.cls == OPCODE_SE_VX_KK || ins.cls == OPCODE_SE_VX_VY)
+            skip = equal & mask;
+        else if (ins.cls == OPCODE_SNE_VX_KK || ins.cls == OPCODE_SNE_VX_VY)
+            skip = ~equal & mask;
+
+        for (u32 first = 0; first < CHIP8_BATCH_MAX_LANES; first += 8)
+        {
+            // The masks are -1 where set, so subtracting twice their sum adds 2 for executing and 2 more for a skip
+            __m128i step = _mm_add_epi16(laneWords(mask, first), laneWords(skip, first));
+            __m128i* PC = (__m128i*) (s.PC + first);
+            _mm_storeu_si128(PC, _mm_sub_epi16(_mm_loadu_si128(PC), _mm_add_epi16(step, step)));
+        }
+
+        tickTimers(mask);
+        return true;
+    #else
+        return false;
+    #endif
+}
+
+// One lane at a time, this mirrors the handlers in Handlers.h
+void Chip8Batch::executeLane(u32 lane, u16 opcode)
+{
+    CHIP8_BATCH_STATE& s = *state;
+    INSTRUCTION ins = decodeOpcode(opcode);
+    u8 (&V)[CHIP8_TOTAL_GENERAL_PURPOSE_REGISTERS][CHIP8_BATCH_MAX_LANES] = s.V;
+    u8* memory = s.memory[lane];
+    u16& PC = s.PC[lane];
+    u16& I = s.I[lane];
+    u8& SP = s.SP[lane];
+
+    PC += 2;
+    switch(ins.cls)
+    {
+        case OPCODE_CLS:
+            memset(s.pixels[lane], 0, sizeof(s.pixels[lane]));
+        break;
+        case OPCODE_RET:
+            if (SP > 0 && SP < CHIP8_STACK_SIZE)
+            {
+                PC = s.stack[SP][lane];
+                SP--;
+            }
+            else
+            {
+                PC = 0;
+                runningMask &= ~(1u << lane);
+            }
+        break;
+        case OPCODE_JP:
+            PC = ins.nnn;
+        break;
+        case OPCODE_CALL:
+            if (SP > CHIP8_STACK_SIZE - 2)
+            {
+                runningMask &= ~(1u << lane);
+            }
+            else
+            {
+                SP++;
+                s.stack[SP][lane] = PC;
+            }
+            PC = ins.nnn;
+        break;
+        case OPCODE_SE_VX_KK:
+            if (V[ins.x][lane] == ins.kk)
+                PC += 2;
+        break;
+        case OPCODE_SNE_VX_KK:
+            if (V[ins.x][lane] != ins.kk)
+                PC += 2;
+        break;
+        case OPCODE_SE_VX_VY:
+            if (V[ins.x][lane] == V[ins.y][lane])
+                PC += 2;
+        break;
+        case OPCODE_LD_VX_KK:
+            V[ins.x][lane] = ins.kk;
+        break;
+        case OPCODE_ADD_VX_KK:
+            V[ins.x][lane] += ins.kk;
+        break;
+        case OPCODE_LD_VX_VY:
+            V[ins.x][lane] = V[ins.y][lane];
+        break;
+        case OPCODE_OR:
+            V[ins.x][lane] |= V[ins.y][lane];
+        break;
+        case OPCODE_AND:
+            V[ins.x][lane] &= V[ins.y][lane];
+        break;
+        case OPCODE_XOR:
+            V[ins.x][lane] ^= V[ins.y][lane];
+        break;
+        case OPCODE_ADD_VX_VY:
+        {
+            u16 result = V[ins.x][lane] + V[ins.y][lane];
+            V[0xf][lane] = result > 255;
+            V[ins.x][lane] = result & 0x00ff;
+        }
+        break;
+        case OPCODE_SUB:
+            V[0xf][lane] = V[ins.x][lane] > V[ins.y][lane];
+            V[ins.x][lane] = V[ins.x][lane] - V[ins.y][lane];
+        break;
+        case OPCODE_SHR:
+            V[0xf][lane] = V[ins.x][lane] & 0x01;
+            V[ins.x][lane] >>= 1;
+        break;
+        case OPCODE_SUBN:
+            V[0xf][lane] = V[ins.y][lane] > V[ins.x][lane];
+            V[ins.x][lane] = V[ins.y][lane] - V[ins.x][lane];
+        break;
+        case OPCODE_SHL:
+            V[0xf][lane] = V[ins.x][lane] >> 7;
+            V[ins.x][lane] <<= 1;
+        break;
+        case OPCODE_SNE_VX_VY:
+            if (V[ins.x][lane] != V[ins.y][lane])
+                PC += 2;
+        break;
+        case OPCODE_LD_I:
+            I = ins.nnn;
+        break;
+        case OPCODE_JP_V0:
+            PC = ins.nnn + V[0][lane];
+        break;
+        case OPCODE_RND:
+            V[ins.x][lane] = nextRandom(s.random[lane]) & ins.kk;
+        break;
+        case OPCODE_DRW:
+        {
+            // The same packed drawing as "Chip8Core::drawSprite"
+            u64* pixels = s.pixels[lane];
+            u8 shift = V[ins.x][lane] % CHIP8_ORIGINAL_DISPLAY_WIDTH;
+            u8 y = V[ins.y][lane];
+            u64 collision = 0;
+            for (u8 c = 0; c < ins.n; c++)
+            {
+                u64 bits = rotateRight((u64) memory[CHIP8_ADDRESS(I + c)] << 56, shift);
+                u32 row = (y + c) % CHIP8_ORIGINAL_DISPLAY_HEIGHT;
+                u64 line = pixels[row];
+                collision |= line & bits;
+                pixels[row] = line ^ bits;
+            }
+            V[0xf][lane] = collision != 0;
+        }
+        break;
+        case OPCODE_SKP:
+            if (s.keys[V[ins.x][lane] & 0x0f][lane])
+                PC += 2;
+        break;
+        case OPCODE_SKNP:
+            if (!s.keys[V[ins.x][lane] & 0x0f][lane])
+                PC += 2;
+        break;
+        case OPCODE_LD_VX_DT:
+            V[ins.x][lane] = s.DT[lane];
+        break;
+        case OPCODE_LD_VX_K:
+        {
+            // The last key pressed if it is still held or else the lowest held, as "Handlers::heldKey"
+            u8 key = s.lastKeyPressed[lane];
+            if (!s.keys[key][lane])
+            {
+                key = 0;
+                while (key < CHIP8_TOTAL_KEYS && !s.keys[key][lane])
+                    key++;
+            }
+            if (key < CHIP8_TOTAL_KEYS)
+                V[ins.x][lane] = key;
+            else
+            {
+                s.keyWait[lane] = CHIP8_KEY_WAITING | ins.x;
+                waitingMask |= 1u << lane;
+            }
+        }
+        break;
+        case OPCODE_LD_DT_VX:
+            s.DT[lane] = V[ins.x][lane];
+        break;
+        case OPCODE_LD_ST_VX:
+            s.ST[lane] = V[ins.x][lane];
+        break;
+        case OPCODE_ADD_I_VX:
+            I += V[ins.x][lane];
+        break;
+        case OPCODE_LD_F_VX:
+            I = (V[ins.x][lane] & 0x0f) * 5;
+        break;
+        case OPCODE_LD_B_VX:
+        {
+            u8 value = V[ins.x][lane];
+            memory[CHIP8_ADDRESS(I)] = value / 100;
+            memory[CHIP8_ADDRESS(I + 1)] = (value / 10) % 10;
+            memory[CHIP8_ADDRESS(I + 2)] = value % 10;
+            pageWriters[CHIP8_ADDRESS(I) >> 8] |= 1u << lane;
+            pageWriters[CHIP8_ADDRESS(I + 2) >> 8] |= 1u << lane;
+        }
+        break;
+        case OPCODE_LD_I_VX:
+            for (int c = 0; c <= ins.x; c++)
+                memory[CHIP8_ADDRESS(I + c)] = V[c][lane];
+            pageWriters[CHIP8_ADDRESS(I) >> 8] |= 1u << lane;
+            pageWriters[CHIP8_ADDRESS(I + ins.x) >> 8] |= 1u << lane;
+        break;
+        case OPCODE_LD_VX_I:
+            for (int c = 0; c <= ins.x; c++)
+                V[c][lane] = memory[CHIP8_ADDRESS(I + c)];
+        break;
+        default:
+            // Bad opcodes are skipped over just as the interpreter does
+        break;
+    }
+
+    if (++s.timerPhase[lane] < instructionsPerFrame)
+        return;
+    s.timerPhase[lane] = 0;
+    if (s.DT[lane] > 0)
+        s.DT[lane]--;
+    if (s.ST[lane] > 0)
+        s.ST[lane]--;
+}
+
+void Chip8Batch::tickTimers(u32 mask)
+{
+    CHIP8_BATCH_STATE& s = *state;
+    u32 due = 0;
+    #ifdef CHIP8_BATCH_VECTOR
+        // The phases are counted 8 lanes at a time, only the lanes reaching the end of a frame tick their timers
+        __m128i last = _mm_set1_epi32(instructionsPerFrame - 1);
+        for (u32 first = 0; first < CHIP8_BATCH_MAX_LANES; first += 8)
+        {
+            __m128i m = laneWords(mask, first);
+            __m128i* low = (__m128i*) (s.timerPhase + first);
+            __m128i* high = low + 1;
+            __m128i lowPhase = _mm_sub_epi32(_mm_loadu_si128(low), _mm_unpacklo_epi16(m, m));
+            __m128i highPhase = _mm_sub_epi32(_mm_loadu_si128(high), _mm_unpackhi_epi16(m, m));
+            __m128i lowDue = _mm_cmpgt_epi32(lowPhase, last);
+            __m128i highDue = _mm_cmpgt_epi32(highPhase, last);
+            _mm_storeu_si128(low, _mm_andnot_si128(lowDue, lowPhase));
+            _mm_storeu_si128(high, _mm_andnot_si128(highDue, highPhase));
+            __m128i words = _mm_packs_epi32(lowDue, highDue);
+            due |= ((u32) _mm_movemask_epi8(_mm_packs_epi16(words, words)) & 0xff) << first;
+        }
+    #else
+        for (u32 lane = 0; lane < CHIP8_BATCH_MAX_LANES; lane++)
+        {
+            s.timerPhase[lane] += (mask >> lane) & 1;
+            if (s.timerPhase[lane] >= instructionsPerFrame)
+            {
+                s.timerPhase[lane] = 0;
+                due |= 1u << lane;
+            }
+        }
+    #endif
+    for (; due; due &= due - 1)
+    {
+        u32 lane = __builtin_ctz(due);
+        if (s.DT[lane] > 0)
+            s.DT[lane]--;
+        if (s.ST[lane] > 0)
+            s.ST[lane]--;
+    }
+}
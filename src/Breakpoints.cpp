@@ -0,0 +1,583 @@
+#include <algorithm>
+#include <ctype.h>
+#include <string.h>
+#include "Breakpoints.h"
+#include "Chip8Core.h"
+#include "Handlers.h"
+
+static const char* const registerNames[CHIP8_REGISTER_COUNT] = {
+    "V0", "V1", "V2", "V3", "V4", "V5", "V6", "V7", "V8", "V9", "VA", "VB", "VC", "VD", "VE", "VF",
+    "I", "DT", "ST", "SP", "PC"
+};
+
+u8 findRegister(const std::string& name)
+{
+    for (u8 r = 0; r < CHIP8_REGISTER_COUNT; r++)
+    {
+        if (strcasecmp(registerNames[r], name.c_str()) == 0)
+            return r;
+    }
+    return CHIP8_REGISTER_COUNT;
+}
+
+const char* registerName(u8 reg)
+{
+    return reg < CHIP8_REGISTER_COUNT ? registerNames[reg] : "?";
+}
+
+u16 readRegister(const CHIP8_STATE& s, u8 reg)
+{
+    switch(reg)
+    {
+        case CHIP8_REGISTER_I: return s.I;
+        case CHIP8_REGISTER_DT: return s.DT;
+        case CHIP8_REGISTER_ST: return s.ST;
+        case CHIP8_REGISTER_SP: return s.SP;
+        case CHIP8_REGISTER_PC: return s.PC;
+        default: return s.V[reg & 0x0f];
+    }
+}
+
+void writeRegister(CHIP8_STATE& s, u8 reg, u16 value)
+{
+    switch(reg)
+    {
+        case CHIP8_REGISTER_I: s.I = value; break;
+        case CHIP8_REGISTER_DT: s.DT = value; break;
+        case CHIP8_REGISTER_ST: s.ST = value; break;
+        case CHIP8_REGISTER_SP: s.SP = value; break;
+        case CHIP8_REGISTER_PC: s.PC = value; break;
+        default: s.V[reg & 0x0f] = value; break;
+    }
+}
+
+static inline u32 registerBit(u8 reg)
+{
+    return 1u << reg;
+}
+
+// The registers "V0" to "Vx"
+static inline u32 registersTo(u8 x)
+{
+    return (registerBit(x) << 1) - 1;
+}
+
+INSTRUCTION_ACCESS instructionAccess(const INSTRUCTION& ins, const CHIP8_STATE& s, u32 quirks)
+{
+    INSTRUCTION_ACCESS a = {};
+    u32 vx = registerBit(ins.x);
+    u32 vy = registerBit(ins.y);
+    u32 vf = registerBit(0xf);
+    u32 i = registerBit(CHIP8_REGISTER_I);
+    switch(ins.cls)
+    {
+        case OPCODE_RET:
+        case OPCODE_CALL:
+            a.readRegisters = a.writeRegisters = registerBit(CHIP8_REGISTER_SP);
+            break;
+        case OPCODE_SE_VX_KK:
+        case OPCODE_SNE_VX_KK:
+        case OPCODE_SKP:
+        case OPCODE_SKNP:
+            a.readRegisters = vx;
+            break;
+        case OPCODE_SE_VX_VY:
+        case OPCODE_SNE_VX_VY:
+            a.readRegisters = vx | vy;
+            break;
+        case OPCODE_LD_VX_KK:
+        case OPCODE_RND:
+        case OPCODE_LD_VX_K:
+            a.writeRegisters = vx;
+            break;
+        case OPCODE_ADD_VX_KK:
+            a.readRegisters = a.writeRegisters = vx;
+            break;
+        case OPCODE_LD_VX_VY:
+            a.readRegisters = vy;
+            a.writeRegisters = vx;
+            break;
+        case OPCODE_OR:
+        case OPCODE_AND:
+        case OPCODE_XOR:
+            a.readRegisters = vx | vy;
+            a.writeRegisters = vx;
+            break;
+        case OPCODE_ADD_VX_VY:
+        case OPCODE_SUB:
+        case OPCODE_SUBN:
+            a.readRegisters = vx | vy;
+            a.writeRegisters = vx | vf;
+            break;
+        case OPCODE_SHR:
+        case OPCODE_SHL:
+            a.readRegisters = quirks & CHIP8_QUIRK_SHIFT_VY ? vy : vx;
+            a.writeRegisters = vx | vf;
+            break;
+        case OPCODE_LD_I:
+            a.writeRegisters = i;
+            break;
+        case OPCODE_JP_V0:
+            a.readRegisters = quirks & CHIP8_QUIRK_JUMP_VX ? vx : registerBit(0);
+            break;
+        case OPCODE_DRW:
+            a.readRegisters = vx | vy | i;
+            a.writeRegisters = vf;
+            a.readAddress = s.I;
+            a.readLength = ins.n;
+            break;
+        case OPCODE_LD_VX_DT:
+            a.readRegisters = registerBit(CHIP8_REGISTER_DT);
+            a.writeRegisters = vx;
+            break;
+        case OPCODE_LD_DT_VX:
+            a.readRegisters = vx;
+            a.writeRegisters = registerBit(CHIP8_REGISTER_DT);
+            break;
+        case OPCODE_LD_ST_VX:
+            a.readRegisters = vx;
+            a.writeRegisters = registerBit(CHIP8_REGISTER_ST);
+            break;
+        case OPCODE_ADD_I_VX:
+            a.readRegisters = vx | i;
+            a.writeRegisters = i;
+            break;
+        case OPCODE_LD_F_VX:
+            a.readRegisters = vx;
+            a.writeRegisters = i;
+            break;
+        case OPCODE_LD_B_VX:
+            a.readRegisters = vx | i;
+            a.writeAddress = s.I;
+            a.writeLength = 3;
+            break;
+        case OPCODE_LD_I_VX:
+            a.readRegisters = registersTo(ins.x) | i;
+            a.writeRegisters = quirks & CHIP8_QUIRK_LOAD_STORE_I ? i : 0;
+            a.writeAddress = s.I;
+            a.writeLength = ins.x + 1;
+            break;
+        case OPCODE_LD_VX_I:
+            a.readRegisters = i;
+            a.writeRegisters = registersTo(ins.x) | (quirks & CHIP8_QUIRK_LOAD_STORE_I ? i : 0);
+            a.readAddress = s.I;
+            a.readLength = ins.x + 1;
+            break;
+    }
+    return a;
+}
+
+BreakCondition::BreakCondition()
+{
+    at = 0;
+    depth = 0;
+    maxDepth = 0;
+}
+
+bool BreakCondition::compile(const std::string& text, std::string& error)
+{
+    source = text;
+    at = 0;
+    depth = 0;
+    maxDepth = 0;
+    this->error.clear();
+    std::vector<u16> compiled;
+    code.swap(compiled);
+
+    bool ok = parseOr();
+    skipSpace();
+    if (ok && at < source.size())
+    {
+        this->error = std::string("unexpected '") + source[at] + "' at column " + std::to_string(at + 1);
+        ok = false;
+    }
+    if (ok && maxDepth > CHIP8_BREAK_STACK_SIZE)
+    {
+        this->error = "too many values waiting on operators, at most " + std::to_string(CHIP8_BREAK_STACK_SIZE) + " can be";
+        ok = false;
+    }
+
+    if (!ok)
+    {
+        // The condition is left as it was before the attempt
+        code.swap(compiled);
+        error = this->error;
+        return false;
+    }
+    this->text = text;
+    return true;
+}
+
+const std::string& BreakCondition::getText() const
+{
+    return text;
+}
+
+const std::vector<u16>& BreakCondition::getCode() const
+{
+    return code;
+}
+
+bool BreakCondition::parseOr()
+{
+    if (!parseAnd())
+        return false;
+    while (accept("||"))
+    {
+        if (!parseAnd())
+            return false;
+        emit(BREAK_OP_OR, -1);
+    }
+    return true;
+}
+
+bool BreakCondition::parseAnd()
+{
+    if (!parseCompare())
+        return false;
+    while (accept("&&"))
+    {
+        if (!parseCompare())
+            return false;
+        emit(BREAK_OP_AND, -1);
+    }
+    return true;
+}
+
+bool BreakCondition::parseCompare()
+{
+    // The two character comparisons are looked for first so "<=" is not taken as "<"
+    static const struct
+    {
+        const char* token;
+        BREAK_OP op;
+    } comparisons[] = {
+        {"==", BREAK_OP_EQ}, {"!=", BREAK_OP_NE}, {"<=", BREAK_OP_LE}, {">=", BREAK_OP_GE}, {"<", BREAK_OP_LT}, {">", BREAK_OP_GT}
+    };
+
+    if (!parseSum())
+        return false;
+    for (const auto& c : comparisons)
+    {
+        if (accept(c.token))
+        {
+            if (!parseSum())
+                return false;
+            emit(c.op, -1);
+            break;
+        }
+    }
+    return true;
+}
+
+bool BreakCondition::parseSum()
+{
+    if (!parseUnary())
+        return false;
+    while (true)
+    {
+        BREAK_OP op;
+        if (accept("+"))
+            op = BREAK_OP_ADD;
+        else if (accept("-"))
+            op = BREAK_OP_SUB;
+        else if (source.compare(at, 2, "&&") != 0 && accept("&"))
+            op = BREAK_OP_BITAND;
+        else
+            return true;
+
+        if (!parseUnary())
+            return false;
+        emit(op, -1);
+    }
+}
+
+bool BreakCondition::parseUnary()
+{
+    skipSpace();
+    if (accept("!"))
+    {
+        if (!parseUnary())
+            return false;
+        emit(BREAK_OP_NOT, 0);
+        return true;
+    }
+    if (accept("(") || accept("["))
+    {
+        bool memory = source[at - 1] == '[';
+        if (!parseOr())
+            return false;
+        if (!accept(memory ? "]" : ")"))
+        {
+            error = std::string("expected '") + (memory ? "]" : ")") + "' at column " + std::to_string(at + 1);
+            return false;
+        }
+        if (memory)
+            emit(BREAK_OP_MEMORY, 0);
+        return true;
+    }
+
+    size_t start = at;
+    if (at < source.size() && isdigit((u8) source[at]))
+    {
+        bool hex = source.compare(at, 2, "0x") == 0 || source.compare(at, 2, "0X") == 0;
+        if (hex)
+            at += 2;
+        u32 value = 0;
+        size_t digits = at;
+        while (at < source.size() && (hex ? isxdigit((u8) source[at]) : isdigit((u8) source[at])))
+        {
+            char c = tolower(source[at++]);
+            value = value * (hex ? 16 : 10) + (isdigit((u8) c) ? c - '0' : c - 'a' + 10);
+            if (value > 0xffff)
+            {
+                error = "the number at column " + std::to_string(start + 1) + " does not fit in 16 bits";
+                return false;
+            }
+        }
+        if (at == digits)
+        {
+            error = "expected hexadecimal digits at column " + std::to_string(at + 1);
+            return false;
+        }
+        emit(BREAK_OP_CONST, 1);
+        code.push_back(value);
+        return true;
+    }
+
+    while (at < source.size() && isalnum((u8) source[at]))
+        at++;
+    if (at == start)
+    {
+        error = "expected a register, a number or a bracket at column " + std::to_string(at + 1);
+        return false;
+    }
+    std::string name = source.substr(start, at - start);
+    u8 reg = findRegister(name);
+    if (reg == CHIP8_REGISTER_COUNT)
+    {
+        error = "unknown register '" + name + "' at column " + std::to_string(start + 1);
+        return false;
+    }
+    emit(BREAK_OP_REGISTER, 1);
+    code.push_back(reg);
+    return true;
+}
+
+void BreakCondition::skipSpace()
+{
+    while (at < source.size() && isspace((u8) source[at]))
+        at++;
+}
+
+bool BreakCondition::accept(const char* token)
+{
+    skipSpace();
+    size_t length = strlen(token);
+    if (source.compare(at, length, token) != 0)
+        return false;
+    at += length;
+    return true;
+}
+
+void BreakCondition::emit(u16 op, s32 stackChange)
+{
+    code.push_back(op);
+    depth += stackChange;
+    maxDepth = std::max(maxDepth, depth);
+}
+
+bool Chip8Core::setBreakPoint(u16 location)
+{
+    std::string error;
+    return setBreakPoint(location, "", error);
+}
+
+bool Chip8Core::setBreakPoint(u16 location, const std::string& condition, std::string& error)
+{
+    BreakCondition compiled;
+    bool conditional = condition.find_first_not_of(" \t") != std::string::npos;
+    if (conditional && !compiled.compile(condition, error))
+        return false;
+    if (location == CHIP8_BREAK_ANYWHERE && !conditional)
+    {
+        error = "a break point anywhere needs a condition";
+        return false;
+    }
+
+    if (location != CHIP8_BREAK_ANYWHERE)
+        location = CHIP8_ADDRESS(location);
+    clearBreakPoint(location);
+    if (conditional)
+        breakConditions.push_back({location, compiled});
+    if (location != CHIP8_BREAK_ANYWHERE)
+        breakBits[location >> 6] |= (u64) 1 << (location & 63);
+    updateDebugging();
+    return true;
+}
+
+void Chip8Core::clearBreakPoint(u16 location)
+{
+    if (location != CHIP8_BREAK_ANYWHERE)
+    {
+        location = CHIP8_ADDRESS(location);
+        breakBits[location >> 6] &= ~((u64) 1 << (location & 63));
+    }
+    breakConditions.erase(std::remove_if(breakConditions.begin(), breakConditions.end(),
+                                         [location](const BREAK_POINT& b) { return b.location == location; }),
+                          breakConditions.end());
+    updateDebugging();
+}
+
+void Chip8Core::clearBreakPoints()
+{
+    memset(breakBits, 0, sizeof(breakBits));
+    breakConditions.clear();
+    updateDebugging();
+}
+
+std::vector<u16> Chip8Core::getBreakPoints()
+{
+    std::vector<u16> locations;
+    for (u32 w = 0; w < CHIP8_MEMORY_SIZE / 64; w++)
+    {
+        for (u64 bits = breakBits[w]; bits; bits &= bits - 1)
+            locations.push_back(w * 64 + __builtin_ctzll(bits));
+    }
+    return locations;
+}
+
+const std::vector<BREAK_POINT>& Chip8Core::getBreakConditions()
+{
+    return breakConditions;
+}
+
+void Chip8Core::setWatchPoint(u16 address, u16 length, u8 access)
+{
+    access &= CHIP8_WATCH_READ | CHIP8_WATCH_WRITE;
+    if (!access || !length)
+        return;
+    if (!watchedMemory)
+    {
+        watchedMemory.reset(new u8[CHIP8_MEMORY_SIZE]);
+        memset(watchedMemory.get(), 0, CHIP8_MEMORY_SIZE);
+    }
+    for (u32 a = 0; a < length && a < CHIP8_MEMORY_SIZE; a++)
+        watchedMemory[CHIP8_ADDRESS(address + a)] |= access;
+    watchingMemory = true;
+    updateDebugging();
+}
+
+bool Chip8Core::setRegisterWatchPoint(u8 reg, u8 access)
+{
+    if (reg >= CHIP8_REGISTER_PC)
+        return false;
+    if (access & CHIP8_WATCH_READ)
+        watchedReads |= 1u << reg;
+    if (access & CHIP8_WATCH_WRITE)
+        watchedWrites |= 1u << reg;
+    updateDebugging();
+    return true;
+}
+
+void Chip8Core::clearWatchPoints()
+{
+    watchedMemory.reset();
+    watchingMemory = false;
+    watchedReads = 0;
+    watchedWrites = 0;
+    updateDebugging();
+}
+
+BREAK_EVENT Chip8Core::getLastBreak()
+{
+    return lastBreak;
+}
+
+void Chip8Core::updateDebugging()
+{
+    debugging = !breakConditions.empty() || watchingMemory || watchedReads || watchedWrites;
+    for (u32 w = 0; w < CHIP8_MEMORY_SIZE / 64 && !debugging; w++)
+        debugging = breakBits[w] != 0;
+}
+
+/* The instruction that was broken on is let through without being checked again so running on from a break carries on
+ * past it, as long as nothing has run and "PC" has not been moved since */
+u32 Chip8Core::executeDebugging(u32 count)
+{
+    u32 done = 0;
+    while (done < count && !quit)
+    {
+        // A halted machine is not about to execute "PC" so it waits out the rest of the call without breaking
+        if (state.keyWait)
+        {
+            done += dispatch(count - done);
+            break;
+        }
+
+        bool resuming = breakResume && CHIP8_ADDRESS(state.PC) == lastBreak.PC && state.instructions == lastBreak.instruction;
+        breakResume = false;
+        if (!resuming && checkBreak())
+        {
+            breakResume = true;
+            this->stop();
+            break;
+        }
+        done += dispatch(1);
+    }
+    return done;
+}
+
+bool Chip8Core::checkBreak()
+{
+    u16 pc = CHIP8_ADDRESS(state.PC);
+    if (hasBreakPoint(pc))
+    {
+        // A location has at most one break point, it only has a condition if one was given
+        auto b = std::find_if(breakConditions.begin(), breakConditions.end(), [pc](const BREAK_POINT& b) { return b.location == pc; });
+        if (b == breakConditions.end())
+            return recordBreak(BREAK_EXECUTE, pc, CHIP8_REGISTER_COUNT);
+        if (b->condition.evaluate(state))
+            return recordBreak(BREAK_CONDITION, pc, CHIP8_REGISTER_COUNT);
+    }
+    for (const BREAK_POINT& b : breakConditions)
+    {
+        if (b.location == CHIP8_BREAK_ANYWHERE && b.condition.evaluate(state))
+            return recordBreak(BREAK_CONDITION, pc, CHIP8_REGISTER_COUNT);
+    }
+
+    if (!watchingMemory && !watchedReads && !watchedWrites)
+        return false;
+    INSTRUCTION_ACCESS access = instructionAccess(decodeOpcode(Handlers::fetch(state)), state, quirks->quirks);
+    if (access.readRegisters & watchedReads)
+        return recordBreak(BREAK_READ, pc, __builtin_ctz(access.readRegisters & watchedReads));
+    if (access.writeRegisters & watchedWrites)
+        return recordBreak(BREAK_WRITE, pc, __builtin_ctz(access.writeRegisters & watchedWrites));
+    if (watchingMemory)
+    {
+        for (u32 a = 0; a < access.readLength; a++)
+        {
+            u16 address = CHIP8_ADDRESS(access.readAddress + a);
+            if (watchedMemory[address] & CHIP8_WATCH_READ)
+                return recordBreak(BREAK_READ, address, CHIP8_REGISTER_COUNT);
+        }
+        for (u32 a = 0; a < access.writeLength; a++)
+        {
+            u16 address = CHIP8_ADDRESS(access.writeAddress + a);
+            if (watchedMemory[address] & CHIP8_WATCH_WRITE)
+                return recordBreak(BREAK_WRITE, address, CHIP8_REGISTER_COUNT);
+        }
+    }
+    return false;
+}
+
+bool Chip8Core::recordBreak(u8 kind, u16 address, u8 reg)
+{
+    lastBreak.number++;
+    lastBreak.instruction = state.instructions;
+    lastBreak.PC = CHIP8_ADDRESS(state.PC);
+    lastBreak.address = address;
+    lastBreak.kind = kind;
+    lastBreak.reg = reg;
+    return true;
+}
@@ -1,260 +1,356 @@
-#include <fstream>
 #include <iostream>
 #include <stdlib.h>
 #include <Windows.h>
-#include <sstream>
 #include <stdio.h>
+#include <string.h>
+#include <time.h>
 #include "Chip8.h"
 #include "Display.h"
-#include "Keyboard.h"
-
-const u8 Chip8::charset[CHIP8_CHARSET_SIZE] = {0xF0, 0x90, 0x90, 0x90, 0xF0, // 0
-                                               0x20, 0x60, 0x20, 0x20, 0x70, // 1
-                                               0xF0, 0x10, 0xF0, 0x80, 0xF0, // 2
-                                               0xF0, 0x10, 0xF0, 0x10, 0xF0, // 3
-                                               0x90, 0x90, 0xF0, 0x10, 0x10, // 4
-                                               0xF0, 0x80, 0xF0, 0x10, 0xF0, // 5
-                                               0xF0, 0x80, 0xF0, 0x90, 0xF0, // 6
-                                               0xF0, 0x10, 0x20, 0x40, 0x40, // 7
-                                               0xF0, 0x90, 0xF0, 0x90, 0xF0, // 8
-                                               0xF0, 0x90, 0xF0, 0x10, 0xF0, // 9
-                                               0xF0, 0x90, 0xF0, 0x90, 0x90, // A
-                                               0xE0, 0x90, 0xE0, 0x90, 0xE0, // B
-                                               0xF0, 0x80, 0x80, 0x80, 0xF0, // C
-                                               0xE0, 0x90, 0x90, 0x90, 0xE0, // D
-                                               0xF0, 0x80, 0xF0, 0x80, 0xF0, // E
-                                               0xF0, 0x80, 0xF0, 0x80, 0x80};// F
-
-Chip8::Chip8()
+
+Chip8::Chip8() : history(CHIP8_REWIND_BYTES, CHIP8_REWIND_FRAMES)
 {
     display = new Display();
-    keyboard = new Keyboard();
-
-    // Initialise SDL
-    SDL_Init(SDL_INIT_EVERYTHING);
-
-    // Set the title
-    SDL_WM_SetCaption("NibbleBits - Chip8 Interpreter", "");
-    // Set the output and error streams back to the console as SDL_Init changes this
-    freopen( "CON", "w", stdout );
+    rewinding = false;
+    audioOpen = false;
+    audioPlaying = false;
+    redrawRows = 0;
+    showHeatmap = false;
+    setIdleSkipping(CHIP8_IDLE_SKIPPING);
 }
 
 Chip8::~Chip8()
 {
     delete display;
-    delete keyboard;
 
-    // Close the sound thread
-    CloseHandle(sThread);
+    // The callback reads the ring so the device is closed before it goes
+    if (audioOpen)
+        SDL_CloseAudio();
 
      // Quit SDL
     SDL_Quit();
 }
 
-// A sound thread to handle the bleeps separately
-LPTHREAD_START_ROUTINE Chip8::soundThread(LPVOID lpvoid)
+void Chip8::audioCallback(void* userdata, Uint8* stream, int len)
 {
-    Chip8* chip8 = (Chip8*)(lpvoid);
-    while (true)
-    {
-        REGISTERS regs = chip8->getRegs();
-        if (regs.ST > 0)
-        {
-            Beep(400, 1000);
-        }
-
-        Sleep(100);
-    }
+    Chip8* chip8 = (Chip8*) userdata;
+    chip8->audioRing.read((s16*) stream, len / sizeof(s16));
+}
 
-    return 0;
+void Chip8::playAudio(bool play)
+{
+    if (audioOpen && play != audioPlaying)
+        SDL_PauseAudio(play ? 0 : 1);
+    audioPlaying = play;
 }
 
 void Chip8::Init(u32 w, u32 h, PIXEL_COLOUR pcol_on, PIXEL_COLOUR pcol_off)
 {
-    // Reset the chip8 Interpreter
+    // Initialise SDL
+    SDL_Init(SDL_INIT_EVERYTHING);
+
+    // Set the title
+    SDL_WM_SetCaption("NibbleBits - Chip8 Interpreter", "");
+    // Set the output and error streams back to the console as SDL_Init changes this
+    freopen( "CON", "w", stdout );
+
+    // Reset the chip8 Interpreter, each session draws different random numbers and a recording keeps the seed it used
     this->reset();
+    this->setSeed(SDL_GetTicks() ^ (u32) time(NULL));
 
-    // Copy the charset into the begining of the main memory
-    memcpy(&this->memory, &this->charset, sizeof(this->charset));
     // Initialise the display
-    display->Init(w, h, pcol_on, pcol_off);
-
-    // Create the sound thread
-    sThread = CreateThread(NULL, 0, (LPTHREAD_START_ROUTINE) &soundThread, (PVOID) this, (DWORD) 0, (PDWORD) 0);
+    display->Init(w, h, pcol_on, pcol_off, this->getPixels());
+
+    // Frames are due from now
+    scheduler.start();
+
+    // Open the audio device, without one the machine runs silent
+    SDL_AudioSpec want;
+    memset(&want, 0, sizeof(want));
+    want.freq = audio.getRate();
+    want.format = AUDIO_S16SYS;
+    want.channels = 1;
+    want.samples = CHIP8_AUDIO_DEVICE_SAMPLES;
+    want.callback = audioCallback;
+    want.userdata = this;
+    audioOpen = SDL_OpenAudio(&want, NULL) == 0;
+    audio.setSink(audioOpen ? &audioRing : NULL);
 }
 
-
-// The "loadFile" method is in charge of loading the file into the Chip8 memory
-bool Chip8::loadFile(char* fname)
+// The process method should be called at frequent intervals and is in charge of processing the chip8
+void Chip8::process()
 {
-    // Load the chip8 file into memory location 0x200
-    std::ifstream file;
-    file.open(fname, std::ios::binary | std::ios::ate);
-    if (file.is_open())
+    // Commands from the debugger land here between frames so never part way through an instruction
+    this->applyDebugCommands();
+    if (!isRunning())
     {
-        int fileSize = file.tellg();
-        if (fileSize > 0xfff)
-        {
-            // File size is too big!
-            return false;
-        }
+        // Stopped there is nothing to run until the debugger sends a command or the window has an event
+        playAudio(false);
+        SDL_WaitEvent(NULL);
+        this->processSDLEvent();
+        scheduler.resume();
+        return;
+    }
 
-        // We have to position the pointer back to the start of the file as std::ios::ate puts it at the end
-        file.seekg(file.beg);
+    /* Halted on "Fx0A" with the timers run down every frame would be the same until a key goes down, so rather than run
+     * them the thread sleeps until SDL has an event for it */
+    if (isWaitingForKey() && !rewinding && getState().DT == 0 && getState().ST == 0)
+    {
+        playAudio(false);
+        SDL_WaitEvent(NULL);
+        scheduler.resume();
+    }
 
-        // Standard chip 8 programs load into memory at 0x200
-        file.read((char*)&memory[0x200], fileSize);
-        if (file.fail())
-        {
-            file.clear();
-            return false;
-        }
-        else
-        {
-            // Reset the chip8
-            this->reset();
-            return true;
-        }
+    this->processSDLEvent();
+    if (rewinding)
+    {
+        // Rewinding steps back a frame each frame so history plays backwards at the speed it was recorded
+        history.rewind(*this);
+        replay.truncate(*this);
+        audio.silence(*this, getInstructionsPerFrame());
     }
     else
-        return false;
+    {
+        /* A frame of emulated time, the timers tick once in it and the buzzer plays for the part of it "ST" was set,
+         * the display skips the flip when nothing was drawn. A break stops it part way */
+        audio.execute(*this, getInstructionsPerFrame());
+        history.record(*this);
+    }
+    // The device starts once a frame is waiting for it
+    playAudio(true);
+    present();
+    // A break in the frame is sent to the debugger and the registers it reads are brought up to date
+    debugger.publish(*this);
+
+    // Sleep until the next frame is due, input that arrives meanwhile is picked up at the start of it
+    scheduler.wait();
+}
 
+void Chip8::present()
+{
+    u32 rows = this->takeDirtyRows() | redrawRows;
+    if (runAhead.getFrames())
+    {
+        // The machine's own rows are not presented, the run ahead says which of its rows changed
+        rows = runAhead.run(*this, getInstructionsPerFrame());
+    }
+    redrawRows = 0;
+    // The heatmap covers the whole window while it is up, the frame after it goes is presented in full
+    if (showHeatmap && getHeatmap())
+    {
+        getHeatmap()->getColours(heatmapColours);
+        display->drawHeatmap(heatmapColours);
+        redrawRows = 0xffffffff;
+        return;
+    }
+    display->process(rows);
 }
 
-// Resets all the registers
-void Chip8::reset()
+u64 Chip8::getFramesPresented()
 {
-   // 0x200 in memory is where the chip8 program is loaded, begin executing their.
-   PC = 0x200;
-   I = 0;
-   SP = 0;
-   for (int i = 0; i < 16; i++)
-   {
-       stack[i] = 0;
-       V[i] = 0;
-   }
-   // Clear the display
-   display->clear();
-   // Stop the chip8 emulator
-   this->stop();
-   // Set the last cycle time
-   lastCycleTime = SDL_GetTicks();
+    return display->getFramesPresented();
 }
 
-// Call this "run" method to run the chip8
-void Chip8::run()
+u64 Chip8::getFramesSkipped()
 {
-    this->running = true;
+    return display->getFramesSkipped();
 }
 
-// Call this "stop" method to stop the chip8
-void Chip8::stop()
+Chip8Rewind& Chip8::getHistory()
 {
-    this->running = false;
+    return history;
 }
 
-// The "isRunning" method will return true if the chip8 is currently running, otherwise it will return false
-bool Chip8::isRunning()
+Chip8Replay& Chip8::getReplay()
 {
-    return running;
+    return replay;
 }
 
-// The process method should be called at frequent intervals and is in charge of processing the chip8
-void Chip8::process()
+void Chip8::setRunAhead(u32 frames)
 {
-    // Return if their is currently a break point
-    if (hasBreakPoint(PC))
-    {
-        // Stop executing
-        this->stop();
-        return;
-    }
+    runAhead.setFrames(frames);
+    display->setPixels(runAhead.getFrames() ? runAhead.getPixels() : this->getPixels());
+    redrawRows = 0xffffffff;
+}
 
-    this->processSDLEvent();
-    this->processOpcode();
-    display->process();
+Chip8RunAhead& Chip8::getRunAhead()
+{
+    return runAhead;
+}
 
-    #if CHIP8_NO_DELAY == false
-        /* Chip8 uses a 60 Hz clock speed.
-         * Their is approximately 16.7 Ms for a 60 Hz clock speed. We will round it to 17 Ms. */
+Chip8Scheduler& Chip8::getScheduler()
+{
+    return scheduler;
+}
 
-        // The total Ms it took for this cycle
-       u32 msForCycle = SDL_GetTicks() - this->lastCycleTime;
-       int delayTimeMs = (CHIP8_SPEED_MS - msForCycle);
+bool Chip8::pressKey(u8 key)
+{
+    bool waiting = isWaitingForKey();
+    replay.setKey(*this, key, true);
+    replay.setKey(*this, key, false);
+    // Wakes the frame loop if it is asleep waiting for input
+    SDL_Event event;
+    memset(&event, 0, sizeof(event));
+    event.type = SDL_USEREVENT;
+    SDL_PushEvent(&event);
+    return waiting;
+}
 
-       // Only if it is above 1 do we delay
-       if (delayTimeMs > 0)
-       {
-            SDL_Delay(delayTimeMs);
-       }
+Chip8Audio& Chip8::getAudio()
+{
+    return audio;
+}
 
-       this->lastCycleTime = SDL_GetTicks();
-    #endif // CHIP8_NO_DELAY
+AUDIO_RING_STATS Chip8::getAudioStats()
+{
+    return audioRing.getStats();
 }
 
-// Returns the memory at the location specified
-u8 Chip8::getMemory(u16 mLocation)
+Chip8Debugger& Chip8::getDebugger()
 {
-    if (mLocation < CHIP8_MEMORY_SIZE)
-        return this->memory[mLocation];
+    return debugger;
+}
 
-    return 0;
+bool Chip8::sendDebugCommand(const DEBUG_COMMAND& command)
+{
+    if (!debugger.send(command))
+        return false;
+    // Wakes the frame loop if it is stopped or halted waiting for input
+    SDL_Event event;
+    memset(&event, 0, sizeof(event));
+    event.type = SDL_USEREVENT;
+    SDL_PushEvent(&event);
+    return true;
 }
-// Pushes a 16 bit value on to the stack then increments the "SP" by 1
-bool Chip8::stack_push(u16 value)
+
+void Chip8::applyDebugCommands()
 {
-    bool ok = false;
-    // If the SP(Stack Pointer) is greater than the stack size then their is a problem and it should be handled
-    if (SP > CHIP8_STACK_SIZE-1)
+    DEBUG_COMMAND command;
+    while (debugger.nextCommand(command))
     {
-        // Error
-        std::cout << "Problem pushing to stack" << std::endl;
-        quit = true;
-        ok = false;
-    }
-    else
-    {
-        // Set the memory pointed to by the "SP(Stack Pointer)" to "value"
-        SP++;
-        stack[SP] = value;
-        ok = true;
+        switch(command.kind)
+        {
+            // Keys go through the replay so a recording keeps them
+            case DEBUG_KEY:
+                pressKey(command.reg & 0x0f);
+                break;
+            case DEBUG_RUN_AHEAD:
+            case DEBUG_PACE:
+            case DEBUG_FRAMES:
+            case DEBUG_HISTORY:
+            case DEBUG_PACING:
+            case DEBUG_RECORD:
+                applyFrontendCommand(command);
+                break;
+            default:
+                debugger.apply(*this, command);
+                break;
+        }
     }
-
-    return ok;
+    debugger.publish(*this);
 }
-// Pops a 16 value off the stack then decrements the "SP" by 1
-u16 Chip8::stack_pop()
+
+void Chip8::applyFrontendCommand(const DEBUG_COMMAND& command)
 {
-    u16 value = 0;
-    /* No need to check if the SP(Stack Pointer) is zero or above as "SP" is not signed but the check will be their anyway
-       Just in case the data type is ever changed in the future for some reason and its then signed
-    */
-    if (SP >= 0 && SP < CHIP8_STACK_SIZE)
+    char line[CHIP8_DEBUG_TEXT_SIZE];
+    switch(command.kind)
     {
-        value = stack[SP];
-        SP--;
-    }
-    else
-    {
-        // Error, handle the error here
-        std::cout << "Problem popping from stack" << std::endl;
-        quit = true;
-
+        case DEBUG_RUN_AHEAD:
+        {
+            setRunAhead(command.value);
+            RUN_AHEAD_STATS stats = runAhead.getStats();
+            snprintf(line, sizeof(line), "Running %u frames ahead", runAhead.getFrames());
+            debugger.sendText(*this, DEBUG_EVENT_INFO, line);
+            if (stats.frames)
+            {
+                snprintf(line, sizeof(line), "So far %llu us a frame on average, %llu us at the slowest",
+                         (unsigned long long) (stats.totalNs / stats.frames / 1000),
+                         (unsigned long long) (stats.slowestNs / 1000));
+                debugger.sendText(*this, DEBUG_EVENT_INFO, line);
+            }
+            break;
+        }
+        case DEBUG_PACE:
+            scheduler.setPaced(command.value != 0);
+            debugger.sendText(*this, DEBUG_EVENT_INFO,
+                              command.value ? "Running at 60 frames a second" : "Running as fast as the host can");
+            break;
+        case DEBUG_FRAMES:
+            snprintf(line, sizeof(line), "Frames presented: %llu, skipped as unchanged: %llu",
+                     (unsigned long long) getFramesPresented(), (unsigned long long) getFramesSkipped());
+            debugger.sendText(*this, DEBUG_EVENT_INFO, line);
+            break;
+        case DEBUG_HISTORY:
+        {
+            REWIND_STATS stats = history.getStats();
+            double seconds = (double) stats.frames / CHIP8_FRAMES_PER_SECOND;
+            snprintf(line, sizeof(line), "Rewind history: %u frames, %.1f seconds, %u keyframes", stats.frames, seconds,
+                     stats.keyframes);
+            debugger.sendText(*this, DEBUG_EVENT_INFO, line);
+            snprintf(line, sizeof(line), "%llu of %llu bytes, %.0f bytes a minute", (unsigned long long) stats.bytes,
+                     (unsigned long long) stats.maxBytes, seconds > 0 ? stats.bytes * 60 / seconds : 0.0);
+            debugger.sendText(*this, DEBUG_EVENT_INFO, line);
+            break;
+        }
+        case DEBUG_PACING:
+        {
+            SCHEDULER_STATS stats = scheduler.getStats();
+            snprintf(line, sizeof(line), "Pacing: %llu frames, %llu late, %llu resyncs, drift %lld us",
+                     (unsigned long long) stats.frames, (unsigned long long) stats.lateFrames,
+                     (unsigned long long) stats.resyncs, (long long) (stats.driftNs / 1000));
+            debugger.sendText(*this, DEBUG_EVENT_INFO, line);
+            snprintf(line, sizeof(line), "Woke %llu us late on average, %llu us at the 99th percentile",
+                     (unsigned long long) (stats.jitterMeanNs / 1000), (unsigned long long) (stats.jitterP99Ns / 1000));
+            debugger.sendText(*this, DEBUG_EVENT_INFO, line);
+            snprintf(line, sizeof(line), "%llu us at the latest, %.1f%% idle",
+                     (unsigned long long) (stats.jitterMaxNs / 1000), 100.0 * stats.idle);
+            debugger.sendText(*this, DEBUG_EVENT_INFO, line);
+            break;
+        }
+        case DEBUG_RECORD:
+            if (command.value)
+            {
+                replay.record(*this);
+                snprintf(line, sizeof(line), "Recording key presses from instruction %llu",
+                         (unsigned long long) getInstructions());
+                debugger.sendText(*this, DEBUG_EVENT_INFO, line);
+                break;
+            }
+            replay.finish(*this);
+            if (!replay.save(command.text))
+            {
+                debugger.sendText(*this, DEBUG_EVENT_ERROR, "Could not save the recording, use 'record' to start one");
+                break;
+            }
+            snprintf(line, sizeof(line), "Saved %llu key presses over %llu instructions",
+                     (unsigned long long) replay.getEvents().size(), (unsigned long long) replay.getInstructions());
+            debugger.sendText(*this, DEBUG_EVENT_INFO, line);
+            snprintf(line, sizeof(line), "%llu bytes", (unsigned long long) replay.getFileSize());
+            debugger.sendText(*this, DEBUG_EVENT_INFO, std::string(line) + " written to " + command.text);
+            break;
     }
-
-    return value;
 }
 
-bool Chip8::hasQuit()
+void Chip8::badOpcode(u16 opcode)
 {
-    return this->quit;
+    MessageBoxA(0, (LPCSTR)"Opcode not supported", (LPCSTR) "Bad opcode", 0);
+    Chip8Core::badOpcode(opcode);
 }
 
 void Chip8::processSDLEvent()
 {
-    if(SDL_PollEvent(&sdl_event))
+    // A frame is long enough for several events to queue up, all of them are handled before it runs
+    while(SDL_PollEvent(&sdl_event))
     {
-        if (sdl_event.type == SDL_KEYDOWN || sdl_event.type == SDL_KEYUP)
+        if ((sdl_event.type == SDL_KEYDOWN || sdl_event.type == SDL_KEYUP) && sdl_event.key.keysym.sym == SDLK_BACKSPACE)
+        {
+            // Letting go of backspace carries on from the frame rewound to
+            rewinding = sdl_event.type == SDL_KEYDOWN;
+        }
+        else if (sdl_event.type == SDL_KEYDOWN && sdl_event.key.keysym.sym == SDLK_TAB)
+        {
+            showHeatmap = !showHeatmap;
+        }
+        else if (sdl_event.type == SDL_KEYDOWN || sdl_event.type == SDL_KEYUP)
         {
            processKeyboard();
         }
@@ -270,514 +366,72 @@ void Chip8::processKeyboard()
     if (sdl_event.type == SDL_KEYDOWN)
     {
         if (sdl_event.key.keysym.sym == SDLK_0)
-            keyboard->setKeyDown(0);
+            replay.setKey(*this, 0, true);
         else if(sdl_event.key.keysym.sym == SDLK_1)
-            keyboard->setKeyDown(1);
+            replay.setKey(*this, 1, true);
         else if(sdl_event.key.keysym.sym == SDLK_2)
-            keyboard->setKeyDown(2);
+            replay.setKey(*this, 2, true);
         else if(sdl_event.key.keysym.sym == SDLK_3)
-            keyboard->setKeyDown(3);
+            replay.setKey(*this, 3, true);
         else if(sdl_event.key.keysym.sym == SDLK_4)
-            keyboard->setKeyDown(4);
+            replay.setKey(*this, 4, true);
         else if(sdl_event.key.keysym.sym == SDLK_5)
-            keyboard->setKeyDown(5);
+            replay.setKey(*this, 5, true);
         else if(sdl_event.key.keysym.sym == SDLK_6)
-            keyboard->setKeyDown(6);
+            replay.setKey(*this, 6, true);
         else if(sdl_event.key.keysym.sym == SDLK_7)
-            keyboard->setKeyDown(7);
+            replay.setKey(*this, 7, true);
         else if(sdl_event.key.keysym.sym == SDLK_8)
-            keyboard->setKeyDown(8);
+            replay.setKey(*this, 8, true);
         else if(sdl_event.key.keysym.sym == SDLK_9)
-            keyboard->setKeyDown(9);
+            replay.setKey(*this, 9, true);
         else if(sdl_event.key.keysym.sym == SDLK_a)
-            keyboard->setKeyDown(0xa);
+            replay.setKey(*this, 0xa, true);
         else if(sdl_event.key.keysym.sym == SDLK_b)
-            keyboard->setKeyDown(0xb);
+            replay.setKey(*this, 0xb, true);
         else if(sdl_event.key.keysym.sym == SDLK_c)
-            keyboard->setKeyDown(0xc);
+            replay.setKey(*this, 0xc, true);
         else if(sdl_event.key.keysym.sym == SDLK_d)
-            keyboard->setKeyDown(0xd);
+            replay.setKey(*this, 0xd, true);
         else if(sdl_event.key.keysym.sym == SDLK_e)
-            keyboard->setKeyDown(0xe);
+            replay.setKey(*this, 0xe, true);
         else if(sdl_event.key.keysym.sym == SDLK_f)
-            keyboard->setKeyDown(0xf);
+            replay.setKey(*this, 0xf, true);
     }
     else if(sdl_event.type == SDL_KEYUP)
     {
         if (sdl_event.key.keysym.sym == SDLK_0)
-            keyboard->setKeyUp(0);
+            replay.setKey(*this, 0, false);
         else if(sdl_event.key.keysym.sym == SDLK_1)
-            keyboard->setKeyUp(1);
+            replay.setKey(*this, 1, false);
         else if(sdl_event.key.keysym.sym == SDLK_2)
-            keyboard->setKeyUp(2);
+            replay.setKey(*this, 2, false);
         else if(sdl_event.key.keysym.sym == SDLK_3)
-            keyboard->setKeyUp(3);
+            replay.setKey(*this, 3, false);
         else if(sdl_event.key.keysym.sym == SDLK_4)
-            keyboard->setKeyUp(4);
+            replay.setKey(*this, 4, false);
         else if(sdl_event.key.keysym.sym == SDLK_5)
-            keyboard->setKeyUp(5);
+            replay.setKey(*this, 5, false);
         else if(sdl_event.key.keysym.sym == SDLK_6)
-            keyboard->setKeyUp(6);
+            replay.setKey(*this, 6, false);
         else if(sdl_event.key.keysym.sym == SDLK_7)
-            keyboard->setKeyUp(7);
+            replay.setKey(*this, 7, false);
         else if(sdl_event.key.keysym.sym == SDLK_8)
-            keyboard->setKeyUp(8);
+            replay.setKey(*this, 8, false);
         else if(sdl_event.key.keysym.sym == SDLK_9)
-            keyboard->setKeyUp(9);
+            replay.setKey(*this, 9, false);
         else if(sdl_event.key.keysym.sym == SDLK_a)
-            keyboard->setKeyUp(0xa);
+            replay.setKey(*this, 0xa, false);
         else if(sdl_event.key.keysym.sym == SDLK_b)
-            keyboard->setKeyUp(0xb);
+            replay.setKey(*this, 0xb, false);
         else if(sdl_event.key.keysym.sym == SDLK_c)
-            keyboard->setKeyUp(0xc);
+            replay.setKey(*this, 0xc, false);
         else if(sdl_event.key.keysym.sym == SDLK_d)
-            keyboard->setKeyUp(0xd);
+            replay.setKey(*this, 0xd, false);
         else if(sdl_event.key.keysym.sym == SDLK_e)
-            keyboard->setKeyUp(0xe);
+            replay.setKey(*this, 0xe, false);
         else if(sdl_event.key.keysym.sym == SDLK_f)
-            keyboard->setKeyUp(0xf);
+            replay.setKey(*this, 0xf, false);
     }
 }
 
-// The "processOpcode" method will be in charge of decoding and processing the opcode
-void Chip8::processOpcode()
-{
-    u16 opcode = (memory[PC] << 8) | memory[PC+1];
-
-    PC+=2;
-
-    // CLS
-    if (opcode == 0x00E0)
-    {
-        display->clear();
-    }
-    // Return from subroutine
-    else if(opcode == 0x00EE)
-    {
-        // Pop the address off of the stack
-        u16 addr = stack_pop();
-        // Set the PC(Program Counter) to the address popped off of the stack
-        PC = addr;
-    }
-    else
-    {
-        u16 nnn = 0;
-        u8 x = 0;
-        u8 y = 0;
-        u8 kk = 0;
-        u8 n = 0;
-        u16 t = 0;
-        u16 op_h_nibble = opcode >> 12;
-        switch(op_h_nibble)
-        {
-            case 1: // JP, Jump to memory location "nnn"
-            {
-                // Get the location to jump to from the opcode
-                nnn = opcode & 0x0fff;
-                // Set the PC(Program Counter) to the location to jump to
-                PC = nnn;
-            }
-            break;
-
-            case 2: // CALL, calls a subroutine at the address in memory location "nnn"
-            {
-                nnn = opcode & 0x0fff;
-                // Push the PC(Program Counter) onto the stack, this is used to return from the sub-routine
-                stack_push(PC);
-                // Set the PC(Program Counter) to the new address specified in "nnn"
-                PC = nnn;
-            }
-            break;
-
-            case 3: // SE, Skip the next instruction if register "Vx" = "kk"
-            {
-                x = (opcode & 0x0f00) >> 8;
-                kk = opcode & 0x00ff;
-
-                // If the register "Vx" is equal to the value "kk" then skip the next instruction
-                if (V[x] == kk)
-                    PC+=2;
-            }
-            break;
-
-            case 4: // SNE, Skip the next instruction if register "Vx" does not equal "kk"
-            {
-                x = (opcode & 0x0f00) >> 8;
-                kk = opcode & 0x00ff;
-
-                // If the register "Vx" is not equal to the value "kk" then skip the next instruction
-                if (V[x] != kk)
-                    PC+=2;
-            }
-            break;
-
-            case 5: // SE Vx, Vy, Skip the next instruction if register "Vx" equals register "Vy"
-            {
-                x = (opcode & 0x0f00) >> 8;
-                y = (opcode & 0x00f0) >> 4;
-
-                // If the value in register "Vx" equals the value in register "Vy" then skip the next instruction
-                if (V[x] == V[y])
-                    PC+=2;
-            }
-            break;
-
-            case 6: // LD, Loads the value "kk" into register "Vx"
-            {
-                // "x" is the register to load the value into
-                x = (opcode & 0x0f00) >> 8;
-                // "kk" is the value to load into the register
-                kk = opcode & 0x00ff;
-
-                // Load the value in "kk" into register "Vx"
-                V[x] = kk;
-            }
-            break;
-
-            case 7: // ADD, adds "kk" to "Vx"
-            {
-                x = (opcode & 0x0f00) >> 8;
-                kk = opcode & 0x00ff;
-
-                // Add the value in "kk" to register "Vx"
-                V[x] += kk;
-            }
-            break;
-
-            case 8:
-            {
-                x = (opcode & 0x0f00) >> 8;
-                y = (opcode & 0x00f0) >> 4;
-                n = opcode & 0x000f;
-
-                if (n == 0)  // LD, store value of "Vy" into "Vx"
-                {
-                    // Set value of register "Vx" to value of register "Vy"
-                    V[x] = V[y];
-                }
-                else if(n == 1) // OR, preforms a bitwize OR with "Vx" and "Vy" then stores the result in "Vx"
-                {
-                    // Preform bitwize OR on "Vx" and "Vy" then store the result in "Vx"
-                    V[x] = V[x] | V[y];
-                }
-                else if (n == 2) // AND, preforms a bitwize AND with "Vx" and "Vy" then stores the result in "Vx"
-                {
-                    V[x] = V[x] & V[y];
-                }
-                else if (n == 3) // XOR, preforms a bitwize XOR with "Vx" and "Vy" then stores the result in "Vx"
-                {
-                    V[x] = V[x] ^ V[y];
-                }
-                else if(n == 4) // ADD, adds "Vx" and "Vy" together the "VF" carry flag is set if result is above 8 bits otherwise its unset. The first 8 bits of the result are then stored in "Vx"
-                {
-                    u16 result = V[x] + V[y];
-                    if (result > 255)
-                        V[0xf] = 1;
-                    else
-                        V[0xf] = 0;
-
-                    V[x] = result & 0x00ff;
-                }
-                else if(n == 5) // SUB, if "Vx" is above "Vy" then set the "VF" carry flag otherwise its unset. Subtract "Vx" by "Vy" then store the result in "Vx"
-                {
-                    if (V[x] > V[y])
-                        V[0xf] = 1;
-                    else
-                        V[0xf] = 0;
-
-                    V[x] = V[x] - V[y];
-                }
-                else if(n == 6) // SHR, if the least significant bit of "Vx" is 1 then "VF" is set to 1 otherwise 0. "Vx" is then divided by 2
-                {
-                    // Set the carry flag if the least significant bit of "Vx" is 1 otherwise unset it
-                    if (V[x] & 0x01)
-                        V[0xf] = 1;
-                    else
-                        V[0xf] = 0;
-
-                    // Divide Vx by two
-                    V[x] /= 2;
-                }
-
-                else if(n == 7) // SUBN, If "Vy" is greater than "Vx" then the carry flag "VF" is set to 1 otherwise 0. "Vx" is then subtracted from "Vy" and the resultresult is stored in "Vx"
-                {
-                    if (V[y] > V[x])
-                        V[0xf] = 1;
-                    else
-                        V[0xf] = 0;
-
-                    V[x] = V[y] - V[x];
-                }
-
-                else if(n == 0xE) // SHL, If the most significant bit of "Vx" is 1 then then the carry flag "VF" is set to 1 otherwise 0. "Vx" is then multiplied by 2.
-                {
-                    if (V[x] & 0x8000)
-                        V[0xf] = 1;
-                    else
-                        V[0xf] = 0;
-
-                    V[x] *= 2;
-                }
-            }
-            break;
-
-            case 9: // SNE, skip next instruction if "Vx" does not equal "Vy"
-            {
-                x = (opcode & 0x0f00) >> 8;
-                y = (opcode & 0x00f0) >> 4;
-
-                if (V[x] != V[y])
-                    PC+=2;
-            }
-            break;
-
-            case 0xA: // LD, Set register "I" to "nnn"
-            {
-                nnn = opcode & 0x0fff;
-                I = nnn;
-            }
-            break;
-
-            case 0xB: // JP, the PC(Program Counter) is set to "nnn" added with register "V0"
-            {
-                nnn = opcode & 0x0fff;
-                PC = nnn + V[0];
-            }
-            break;
-
-            case 0xC: // RND, a random number from 0 to 255 is generated. The random number is then ANDED with the value "kk" and stored in register "Vx"
-            {
-                x = (opcode & 0x0f00) >> 8;
-                kk = opcode & 0x00ff;
-
-                // Generate a random number from 0 to 255 and then AND the number with the value "kk" then store in "Vx"
-                V[x] = (rand() % 256) & kk;
-            }
-            break;
-
-            case 0xD: // DRW, Draws a sprite to the screen at screen coordinates X: "Vx", Y: "Vy"
-            {
-                // Sprite array, will hold the sprite to display
-                u8 sprite[16];
-                // The physical positions are stored in the registers and the operands received state the registers to read from
-                x = V[(opcode & 0x0f00) >> 8];
-                y = V[(opcode & 0x00f0) >> 4];
-
-
-                n = opcode & 0x000f;
-
-                V[0xf] = false;
-
-                // Load "n" bytes from memory
-                for (int c = 0; c < n; c++)
-                {
-                    // Load sprite from memory where "I" is the segment and "c" is the offset
-                    sprite[c] = memory[I + c];
-                }
-
-                for (int yc = 0; yc < n; yc++)
-                {
-                    for (int xc = 0; xc < 8; xc++)
-                    {
-                        bool s_on = (sprite[yc] & (0x80 >> xc));
-                        bool p_on = display->getPixel(xc + x, yc + y);
-                        // Collision detection
-                        // Check is pixel is already set
-
-                        if (s_on)
-                        {
-                            if (p_on)
-                            {
-                                V[0xf] = true;
-                            }
-
-
-                            // Set the pixel on the display
-                            display->setPixel(xc + x, yc + y, 1, true);
-                        }
-
-                    }
-                }
-
-            }
-            break;
-
-            case 0xE:
-            {
-                x = (opcode & 0x0f00) >> 8;
-                t = opcode & 0x00ff;
-                if (t == 0x9E) // SKP, Skip the next instruction if the key with the value of "Vx" is pressed
-                {
-                    if (keyboard->keyDown(V[x]))
-                        PC+=2;
-                }
-                else if(t == 0xA1) // SKNP, Skip the next instruction if the key with the value of "Vx" is not pressed
-                {
-                   if (keyboard->keyUp(V[x]))
-                        PC+=2;
-                }
-            }
-            break;
-
-            case 0xF:
-            {
-                x = (opcode & 0x0f00) >> 8;
-                t = opcode & 0x00ff;
-                if (t == 0x07) // LD, Set "Vx" to the delay timer value
-                {
-                    V[x] = DT;
-                }
-                else if(t == 0x0A) // LD, waits for a key press and stores the key in the "Vx" register.
-                {
-                    while(true)
-                    {
-                        if (sdl_event.type == SDL_KEYDOWN)
-                        {
-                            V[x] = keyboard->getLastKeyPressed();
-                            break;
-                        }
-                    }
-                }
-                else if(t == 0x15) // LD, set delay timer to the value of "Vx"
-                {
-                    DT = V[x];
-                }
-                else if(t == 0x18) // LD, set sound timer to value of "Vx"
-                {
-                    ST = V[x];
-                }
-                else if(t == 0x1E) // ADD, I is added with "Vx" and the result is stored in I
-                {
-                    I = V[x] + I;
-                }
-                else if(t == 0x29) // LD, set I to the location of the sprite specified in "x"
-                {
-                    // Sprites start at position "0" in memory
-                    I = V[x] * 5;
-                }
-                else if(t == 0x33) // LD, stores BCD(Binary Coded Decimal) of Vx in memory locations I, I+1, and I+2
-                {
-                    int hundreds = (V[x] / 100);
-                    int tens = (V[x] / 10) % 10;
-                    int units = (V[x] % 10);
-                    memory[I] = hundreds;
-                    memory[I+1] = tens;
-                    memory[I+2] = units;
-                }
-                else if(t == 0x55) // LD, stores registers V0 to Vx into memory starting at location I
-                {
-                    for (int c = 0; c <= x; c++)
-                    {
-                        memory[I+c] = V[c];
-                    }
-                }
-                else if(t == 0x65) // LD, reads memory in memory location I into registers V0 to Vx
-                {
-                    for (int c = 0; c <= x; c++)
-                    {
-                        V[c] = memory[I+c];
-                    }
-                }
-            }
-            break;
-
-            default:
-                {
-                    MessageBoxA(0, (LPCSTR)"Opcode not supported", (LPCSTR) "Bad opcode", 0);
-                    std::cout << "Bad opcode: x" << std::hex << opcode << " at memory location: x" << std::hex << PC << std::endl;
-                }
-            break;
-        }
-    }
-
-    // Decrement the delay timer if its non-zero
-    if (DT > 0)
-        DT--;
-
-    // Decrement the sound timer if its non-zero
-    if (ST > 0)
-        ST--;
-}
-
-REGISTERS Chip8::getRegs()
-{
-    REGISTERS regs;
-    regs.I = this->I;
-    regs.PC = this->PC;
-    regs.SP = this->SP;
-    regs.ST = this->ST;
-    regs.DT = this->DT;
-    for (int i = 0; i < 16; i++)
-    {
-        regs.V[i] = this->V[i];
-    }
-
-    return regs;
-}
-
-bool Chip8::setReg(std::string reg, u16 value)
-{
-    bool ok = true;
-    std::stringstream ss;
-
-    // General purpose registers
-    if (reg[0] == 'V' || reg[0] == 'v')
-    {
-      /* If the size of the register is above 2 then its also invalid, this is used for the general purpose registers
-      to check their not above VF*/
-        if (reg.size() > 2)
-        {
-            ok = false;
-        }
-        else
-        {
-            // The general purpose register to set 0-F
-            u16 vReg;
-            ss << reg[1];
-            ss >> std::hex >> vReg;
-            this->V[vReg] = value;
-        }
-    }
-    // Other registers
-    else if(reg == "I" || reg == "i")
-    {
-        I = value;
-    }
-    else if(reg == "PC" || reg == "pc")
-    {
-        PC = value;
-    }
-    else if(reg == "DT" || reg == "dt")
-    {
-        DT = value;
-    }
-    else if(reg == "ST" || reg == "st")
-    {
-        ST = value;
-    }
-    else
-    {
-        // Set "ok" to false if none of the registers were attempted to be set, in this case it was an invalid register
-        ok = false;
-    }
-    return ok;
-}
-
-bool Chip8::setBreakPoint(u16 location)
-{
-    breakPoints.push_back(location);
-    return true;
-}
-
-bool Chip8::hasBreakPoint(u16 location)
-{
-    for (u16 i = 0; i < breakPoints.size(); i++)
-    {
-        if (breakPoints[i] == location)
-        {
-            return true;
-        }
-    }
-
-    return false;
-}
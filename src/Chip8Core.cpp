@@ -0,0 +1,498 @@
+#include <fstream>
+#include <iostream>
+#include <stdlib.h>
+#include <string.h>
+#include <sstream>
+#include "Chip8Core.h"
+
+// Rotates a display row right, pixels pushed off the right edge come back in on the left. Compilers turn this into one instruction
+static inline u64 rotateRight(u64 value, u8 shift)
+{
+    return (value >> (shift & 63)) | (value << ((64 - shift) & 63));
+}
+
+// The bit of a display row that holds the pixel at "x"
+#define CHIP8_PIXEL_BIT(x) (0x8000000000000000ull >> (x))
+
+const u8 Chip8Core::charset[CHIP8_CHARSET_SIZE] = {0xF0, 0x90, 0x90, 0x90, 0xF0, // 0
+                                                   0x20, 0x60, 0x20, 0x20, 0x70, // 1
+                                                   0xF0, 0x10, 0xF0, 0x80, 0xF0, // 2
+                                                   0xF0, 0x10, 0xF0, 0x10, 0xF0, // 3
+                                                   0x90, 0x90, 0xF0, 0x10, 0x10, // 4
+                                                   0xF0, 0x80, 0xF0, 0x10, 0xF0, // 5
+                                                   0xF0, 0x80, 0xF0, 0x90, 0xF0, // 6
+                                                   0xF0, 0x10, 0x20, 0x40, 0x40, // 7
+                                                   0xF0, 0x90, 0xF0, 0x90, 0xF0, // 8
+                                                   0xF0, 0x90, 0xF0, 0x10, 0xF0, // 9
+                                                   0xF0, 0x90, 0xF0, 0x90, 0x90, // A
+                                                   0xE0, 0x90, 0xE0, 0x90, 0xE0, // B
+                                                   0xF0, 0x80, 0x80, 0x80, 0xF0, // C
+                                                   0xE0, 0x90, 0x90, 0x90, 0xE0, // D
+                                                   0xF0, 0x80, 0xF0, 0x80, 0xF0, // E
+                                                   0xF0, 0x80, 0xF0, 0x80, 0x80};// F
+
+Chip8Core::Chip8Core()
+{
+    // The state is plain data so clearing it is all the construction that is needed
+    memset(&state, 0, sizeof(state));
+    state.random = 1;
+    state.instructionsPerFrame = CHIP8_INSTRUCTIONS_PER_FRAME;
+    running = false;
+    quit = false;
+    dirtyRows = 0;
+    engine = (DISPATCH_ENGINE) CHIP8_DISPATCH_ENGINE;
+    quirkProfile = QUIRK_PROFILE_DEFAULT;
+    quirks = &quirkEngines[QUIRK_PROFILE_DEFAULT];
+    memset(&decodeCacheStats, 0, sizeof(decodeCacheStats));
+    fusedPatternMask = 0;
+    memset(&fusionStats, 0, sizeof(fusionStats));
+    profiling = false;
+    tracer = NULL;
+    profiler = NULL;
+    heatmap = NULL;
+    idleSkipping = false;
+    memset(&idleStats, 0, sizeof(idleStats));
+    memset(&keyWaitStats, 0, sizeof(keyWaitStats));
+    soundWriteCount = 0;
+    compiled = NULL;
+    compiledLookedUp = false;
+    compiledStale = false;
+    memset(&compiledStats, 0, sizeof(compiledStats));
+    memset(breakBits, 0, sizeof(breakBits));
+    watchingMemory = false;
+    watchedReads = 0;
+    watchedWrites = 0;
+    debugging = false;
+    memset(&lastBreak, 0, sizeof(lastBreak));
+    breakResume = false;
+
+    // Copy the charset into the begining of the main memory
+    memcpy(state.memory, charset, sizeof(charset));
+    this->reset();
+}
+
+Chip8Core::~Chip8Core()
+{
+
+}
+
+// The "loadFile" method is in charge of loading the file into the Chip8 memory
+bool Chip8Core::loadFile(const char* fname)
+{
+    std::ifstream file;
+    file.open(fname, std::ios::binary | std::ios::ate);
+    if (!file.is_open())
+        return false;
+
+    int fileSize = file.tellg();
+    if (fileSize <= 0 || fileSize > CHIP8_MEMORY_SIZE - CHIP8_PROGRAM_LOAD_ADDRESS)
+    {
+        // File size is too big!
+        return false;
+    }
+
+    // We have to position the pointer back to the start of the file as std::ios::ate puts it at the end
+    file.seekg(file.beg);
+
+    std::vector<u8> data(fileSize);
+    file.read((char*)data.data(), fileSize);
+    if (file.fail())
+    {
+        file.clear();
+        return false;
+    }
+
+    return loadMemory(data.data(), fileSize);
+}
+
+// The "loadMemory" method loads a program that is already in memory, standard chip 8 programs load into memory at 0x200
+bool Chip8Core::loadMemory(const u8* data, u32 size)
+{
+    if (size > CHIP8_MEMORY_SIZE - CHIP8_PROGRAM_LOAD_ADDRESS)
+        return false;
+
+    memcpy(&state.memory[CHIP8_PROGRAM_LOAD_ADDRESS], data, size);
+    this->flushDecodeCache();
+    // Reset the chip8
+    this->reset();
+    return true;
+}
+
+// Resets all the registers
+void Chip8Core::reset()
+{
+    // 0x200 in memory is where the chip8 program is loaded, begin executing their.
+    state.PC = CHIP8_PROGRAM_LOAD_ADDRESS;
+    state.I = 0;
+    state.SP = 0;
+    state.DT = 0;
+    state.ST = 0;
+    memset(state.stack, 0, sizeof(state.stack));
+    memset(state.V, 0, sizeof(state.V));
+    memset(state.keys, 0, sizeof(state.keys));
+    state.lastKeyPressed = 0;
+    state.instructions = 0;
+    state.timerPhase = 0;
+    state.keyWait = 0;
+    state.keyWaitKey = 0;
+    breakResume = false;
+    // Clear the display
+    this->clearScreen();
+    // Stop the chip8 emulator
+    this->stop();
+}
+
+// Call this "run" method to run the chip8
+void Chip8Core::run()
+{
+    this->running = true;
+}
+
+// Call this "stop" method to stop the chip8
+void Chip8Core::stop()
+{
+    this->running = false;
+}
+
+// The "isRunning" method will return true if the chip8 is currently running, otherwise it will return false
+bool Chip8Core::isRunning()
+{
+    return running;
+}
+
+bool Chip8Core::hasQuit()
+{
+    return this->quit;
+}
+
+// The process method should be called at frequent intervals and executes a single instruction
+void Chip8Core::process()
+{
+    // Stops on a break point rather than executing it
+    this->execute(1);
+}
+
+void Chip8Core::setSeed(u32 seed)
+{
+    state.random = seed ? seed : 1;
+}
+
+void Chip8Core::setInstructionsPerFrame(u16 instructions)
+{
+    state.instructionsPerFrame = instructions ? instructions : 1;
+    state.timerPhase %= state.instructionsPerFrame;
+}
+
+u16 Chip8Core::getInstructionsPerFrame()
+{
+    return state.instructionsPerFrame;
+}
+
+void Chip8Core::clearSoundWrites()
+{
+    soundWriteCount = 0;
+}
+
+u32 Chip8Core::getSoundWrites(const SOUND_WRITE*& writes)
+{
+    writes = soundWrites;
+    return soundWriteCount;
+}
+
+u64 Chip8Core::getInstructions()
+{
+    return state.instructions;
+}
+
+CHIP8_STATE& Chip8Core::getState()
+{
+    return state;
+}
+
+// Returns the memory at the location specified
+u8 Chip8Core::getMemory(u16 mLocation)
+{
+    if (mLocation < CHIP8_MEMORY_SIZE)
+        return state.memory[mLocation];
+
+    return 0;
+}
+
+void Chip8Core::setMemory(u16 mLocation, u8 value)
+{
+    if (mLocation < CHIP8_MEMORY_SIZE)
+        writeMemory(mLocation, value);
+}
+
+// Pushes a 16 bit value on to the stack then increments the "SP" by 1
+bool Chip8Core::stack_push(u16 value)
+{
+    bool ok = false;
+    // If the SP(Stack Pointer) is greater than the stack size then their is a problem and it should be handled
+    if (state.SP > CHIP8_STACK_SIZE-2)
+    {
+        // Error
+        std::cout << "Problem pushing to stack" << std::endl;
+        quit = true;
+        ok = false;
+    }
+    else
+    {
+        // Set the memory pointed to by the "SP(Stack Pointer)" to "value"
+        state.SP++;
+        state.stack[state.SP] = value;
+        ok = true;
+    }
+
+    return ok;
+}
+
+// Pops a 16 value off the stack then decrements the "SP" by 1
+u16 Chip8Core::stack_pop()
+{
+    u16 value = 0;
+    if (state.SP > 0 && state.SP < CHIP8_STACK_SIZE)
+    {
+        value = state.stack[state.SP];
+        state.SP--;
+    }
+    else
+    {
+        // Error, handle the error here
+        std::cout << "Problem popping from stack" << std::endl;
+        quit = true;
+    }
+
+    return value;
+}
+
+void Chip8Core::setKeyDown(u8 key)
+{
+    state.keys[key & 0x0f] = true;
+    state.lastKeyPressed = key & 0x0f;
+    if (state.keyWait && !state.keyWaitKey)
+    {
+        if (quirks->quirks & CHIP8_QUIRK_KEY_RELEASE)
+            state.keyWaitKey = CHIP8_KEY_WAITING | (key & 0x0f);
+        else
+            resumeKeyWait(key & 0x0f);
+    }
+}
+
+void Chip8Core::setKeyUp(u8 key)
+{
+    state.keys[key & 0x0f] = false;
+    if (state.keyWait && state.keyWaitKey == (CHIP8_KEY_WAITING | (key & 0x0f)))
+        resumeKeyWait(key & 0x0f);
+}
+
+bool Chip8Core::keyDown(u8 key)
+{
+    return state.keys[key & 0x0f];
+}
+
+bool Chip8Core::keyUp(u8 key)
+{
+    return !state.keys[key & 0x0f];
+}
+
+u8 Chip8Core::getLastKeyPressed()
+{
+    return state.lastKeyPressed;
+}
+
+bool Chip8Core::isWaitingForKey()
+{
+    return state.keyWait != 0;
+}
+
+bool Chip8Core::injectKey(u8 key)
+{
+    bool waiting = isWaitingForKey();
+    setKeyDown(key);
+    setKeyUp(key);
+    return waiting;
+}
+
+KEY_WAIT_STATS Chip8Core::getKeyWaitStats()
+{
+    return keyWaitStats;
+}
+
+// The instruction after "Fx0A" is already in "PC" so the machine carries on from there on the next "execute"
+void Chip8Core::resumeKeyWait(u8 key)
+{
+    state.V[state.keyWait & 0x0f] = key;
+    state.keyWait = 0;
+    state.keyWaitKey = 0;
+}
+
+// Clears the display
+void Chip8Core::clearScreen()
+{
+    // Turn all of the pixels off
+    memset(state.pixels, 0, sizeof(state.pixels));
+    dirtyRows = 0xffffffff;
+}
+
+void Chip8Core::setPixel(u16 x, u16 y, bool on, bool XOR)
+{
+    // Wrap around the pixels if they breach the screen coordinates
+    x %= CHIP8_ORIGINAL_DISPLAY_WIDTH;
+    y %= CHIP8_ORIGINAL_DISPLAY_HEIGHT;
+    dirtyRows |= 1u << y;
+
+    // Set the pixel to either on or off based on the bool provided
+    u64 bit = CHIP8_PIXEL_BIT(x);
+    if (XOR)
+    {
+        if (on)
+            state.pixels[y] ^= bit;
+    }
+    else if (on)
+    {
+        state.pixels[y] |= bit;
+    }
+    else
+    {
+        state.pixels[y] &= ~bit;
+    }
+}
+
+// getPixel returns true when the pixel is set and false when it is not
+bool Chip8Core::getPixel(u16 x, u16 y)
+{
+    x %= CHIP8_ORIGINAL_DISPLAY_WIDTH;
+    y %= CHIP8_ORIGINAL_DISPLAY_HEIGHT;
+    return state.pixels[y] & CHIP8_PIXEL_BIT(x);
+}
+
+bool Chip8Core::drawSprite(u8 x, u8 y, const u8* sprite, u8 n)
+{
+    u64* pixels = state.pixels;
+    u64 collision = 0;
+    u32 dirty = 0;
+    u8 shift = x % CHIP8_ORIGINAL_DISPLAY_WIDTH;
+    for (u8 c = 0; c < n; c++)
+    {
+        // Start with the sprite byte in the left most 8 pixels then rotate it along, this wraps it around the right edge
+        u64 bits = rotateRight((u64) sprite[c] << 56, shift);
+        u32 row = (y + c) % CHIP8_ORIGINAL_DISPLAY_HEIGHT;
+
+        // Any pixel that is on in both the sprite and the row is a collision
+        u64 line = pixels[row];
+        collision |= line & bits;
+        pixels[row] = line ^ bits;
+        dirty |= (u32)(bits != 0) << row;
+    }
+
+    dirtyRows |= dirty;
+    return collision != 0;
+}
+
+bool Chip8Core::drawSpriteClipped(u8 x, u8 y, const u8* sprite, u8 n)
+{
+    u64* pixels = state.pixels;
+    u64 collision = 0;
+    u32 dirty = 0;
+    // Only the starting position wraps, a plain shift drops the pixels that would go past the right edge
+    u8 shift = x % CHIP8_ORIGINAL_DISPLAY_WIDTH;
+    u8 top = y % CHIP8_ORIGINAL_DISPLAY_HEIGHT;
+    for (u8 c = 0; c < n && top + c < CHIP8_ORIGINAL_DISPLAY_HEIGHT; c++)
+    {
+        u64 bits = ((u64) sprite[c] << 56) >> shift;
+        u32 row = top + c;
+
+        u64 line = pixels[row];
+        collision |= line & bits;
+        pixels[row] = line ^ bits;
+        dirty |= (u32)(bits != 0) << row;
+    }
+
+    dirtyRows |= dirty;
+    return collision != 0;
+}
+
+const u64* Chip8Core::getPixels()
+{
+    return state.pixels;
+}
+
+u32 Chip8Core::takeDirtyRows()
+{
+    u32 rows = dirtyRows;
+    dirtyRows = 0;
+    return rows;
+}
+
+void Chip8Core::badOpcode(u16 opcode)
+{
+    std::cout << "Bad opcode: x" << std::hex << opcode << " at memory location: x" << std::hex << state.PC << std::endl;
+}
+
+REGISTERS Chip8Core::getRegs()
+{
+    REGISTERS regs;
+    regs.I = state.I;
+    regs.PC = state.PC;
+    regs.SP = state.SP;
+    regs.ST = state.ST;
+    regs.DT = state.DT;
+    for (int i = 0; i < CHIP8_TOTAL_GENERAL_PURPOSE_REGISTERS; i++)
+    {
+        regs.V[i] = state.V[i];
+    }
+
+    return regs;
+}
+
+bool Chip8Core::setReg(std::string reg, u16 value)
+{
+    bool ok = true;
+    std::stringstream ss;
+
+    // General purpose registers
+    if (reg[0] == 'V' || reg[0] == 'v')
+    {
+      /* If the size of the register is above 2 then its also invalid, this is used for the general purpose registers
+      to check their not above VF*/
+        if (reg.size() != 2)
+        {
+            ok = false;
+        }
+        else
+        {
+            // The general purpose register to set 0-F
+            u16 vReg = 0;
+            ss << reg[1];
+            ss >> std::hex >> vReg;
+            if (ss.fail())
+                ok = false;
+            else
+                state.V[vReg & 0x0f] = value;
+        }
+    }
+    // Other registers
+    else if(reg == "I" || reg == "i")
+    {
+        state.I = value;
+    }
+    else if(reg == "PC" || reg == "pc")
+    {
+        state.PC = value;
+    }
+    else if(reg == "DT" || reg == "dt")
+    {
+        state.DT = value;
+    }
+    else if(reg == "ST" || reg == "st")
+    {
+        state.ST = value;
+    }
+    else
+    {
+        // Set "ok" to false if none of the registers were attempted to be set, in this case it was an invalid register
+        ok = false;
+    }
+    return ok;
+}
@@ -0,0 +1,26 @@
+#include <string.h>
+#include <vector>
+#include "Compiled.h"
+
+// Held in a function so generated files can register from their static constructors in any order
+static std::vector<const COMPILED_PROGRAM*>& compiledPrograms()
+{
+    static std::vector<const COMPILED_PROGRAM*> programs;
+    return programs;
+}
+
+void registerCompiledProgram(const COMPILED_PROGRAM* program)
+{
+    compiledPrograms().push_back(program);
+}
+
+const COMPILED_PROGRAM* findCompiledProgram(const CHIP8_STATE& state)
+{
+    for (const COMPILED_PROGRAM* program : compiledPrograms())
+    {
+        if (program->romSize <= CHIP8_MEMORY_SIZE - CHIP8_PROGRAM_LOAD_ADDRESS &&
+            memcmp(&state.memory[CHIP8_PROGRAM_LOAD_ADDRESS], program->rom, program->romSize) == 0)
+            return program;
+    }
+    return NULL;
+}
@@ -0,0 +1,448 @@
+#include <algorithm>
+#include <stdio.h>
+#include <string.h>
+#include "Chip8Core.h"
+#include "Debugger.h"
+
+// Copies "from" into a fixed size text field, cutting it short if it does not fit
+static void copyText(char* to, const std::string& from)
+{
+    size_t length = from.size() < CHIP8_DEBUG_TEXT_SIZE - 1 ? from.size() : CHIP8_DEBUG_TEXT_SIZE - 1;
+    memcpy(to, from.data(), length);
+    to[length] = 0;
+}
+
+Chip8Debugger::Chip8Debugger()
+{
+    machineSide.sleeping = false;
+    debuggerSide.sleeping = false;
+    closed = false;
+    droppedEvents = 0;
+    breaksSent = 0;
+}
+
+Chip8Debugger::~Chip8Debugger()
+{
+    close();
+}
+
+/* The sleeper says it is about to sleep before it looks at the queue one last time and the waker looks for a sleeper
+ * after it has pushed, with a full fence on both sides at least one of them sees the other. The look made under the
+ * mutex means a wake sent between that look and the wait cannot be lost */
+template<typename READY>
+void Chip8Debugger::sleep(WAKE& side, READY ready)
+{
+    side.sleeping.store(true, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    std::unique_lock<std::mutex> lock(side.lock);
+    side.wake.wait(lock, [&]() { return ready() || closed.load(std::memory_order_acquire); });
+    side.sleeping.store(false, std::memory_order_relaxed);
+}
+
+void Chip8Debugger::wake(WAKE& side)
+{
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (side.sleeping.load(std::memory_order_relaxed))
+    {
+        std::lock_guard<std::mutex> lock(side.lock);
+        side.wake.notify_one();
+    }
+}
+
+bool Chip8Debugger::send(const DEBUG_COMMAND& command)
+{
+    if (!commands.push(command))
+        return false;
+    wake(machineSide);
+    return true;
+}
+
+bool Chip8Debugger::pollEvent(DEBUG_EVENT& event)
+{
+    return events.pop(event);
+}
+
+bool Chip8Debugger::waitEvent(DEBUG_EVENT& event)
+{
+    while (!events.pop(event))
+    {
+        if (closed.load(std::memory_order_acquire))
+            return events.pop(event);
+        sleep(debuggerSide, [this]() { return !events.empty(); });
+    }
+    return true;
+}
+
+DEBUG_SNAPSHOT Chip8Debugger::getSnapshot() const
+{
+    return snapshot.read();
+}
+
+u64 Chip8Debugger::getDroppedEvents() const
+{
+    return droppedEvents.load(std::memory_order_relaxed);
+}
+
+bool Chip8Debugger::nextCommand(DEBUG_COMMAND& command)
+{
+    return commands.pop(command);
+}
+
+void Chip8Debugger::waitCommand()
+{
+    if (commands.empty() && !closed.load(std::memory_order_acquire))
+        sleep(machineSide, [this]() { return !commands.empty(); });
+}
+
+void Chip8Debugger::apply(Chip8Core& core, const DEBUG_COMMAND& command)
+{
+    DEBUG_EVENT event;
+    memset(&event, 0, sizeof(event));
+    std::string error;
+    switch(command.kind)
+    {
+        case DEBUG_RUN:
+            core.run();
+            break;
+        case DEBUG_STOP:
+            core.stop();
+            break;
+        case DEBUG_STEP:
+        {
+            // A step stops short at a break, "publish" sends that rather than a step
+            u64 breaks = core.getLastBreak().number;
+            event.value = core.execute(command.value);
+            if (core.getLastBreak().number == breaks)
+            {
+                event.kind = DEBUG_EVENT_STEPPED;
+                sendEvent(event, core);
+            }
+            break;
+        }
+        case DEBUG_SET_REGISTER:
+            if (command.reg < CHIP8_REGISTER_COUNT)
+                writeRegister(core.getState(), command.reg, command.value);
+            break;
+        case DEBUG_READ_MEMORY:
+            event.kind = DEBUG_EVENT_MEMORY;
+            event.address = command.address;
+            event.length = command.length < CHIP8_DEBUG_READ_SIZE ? command.length : CHIP8_DEBUG_READ_SIZE;
+            for (u8 b = 0; b < event.length; b++)
+                event.bytes[b] = core.getMemory((command.address + b) & (CHIP8_MEMORY_SIZE - 1));
+            sendEvent(event, core);
+            break;
+        case DEBUG_WRITE_MEMORY:
+            core.setMemory(command.address & (CHIP8_MEMORY_SIZE - 1), command.value);
+            break;
+        case DEBUG_BREAK:
+        {
+            // The text is cut short rather than read past the end if it was not terminated
+            std::string condition(command.text, strnlen(command.text, CHIP8_DEBUG_TEXT_SIZE));
+            if (!core.setBreakPoint(command.address, condition, error))
+            {
+                event.kind = DEBUG_EVENT_ERROR;
+                copyText(event.text, "Bad break point, " + error);
+                sendEvent(event, core);
+            }
+            break;
+        }
+        case DEBUG_UNBREAK:
+            core.clearBreakPoint(command.address);
+            break;
+        case DEBUG_CLEAR_BREAKS:
+            core.clearBreakPoints();
+            break;
+        case DEBUG_LIST_BREAKS:
+            event.kind = DEBUG_EVENT_BREAK_POINT;
+            for (u16 location : core.getBreakPoints())
+            {
+                event.address = location;
+                event.text[0] = 0;
+                for (const BREAK_POINT& b : core.getBreakConditions())
+                {
+                    if (b.location == location)
+                        copyText(event.text, b.condition.getText());
+                }
+                sendEvent(event, core);
+            }
+            for (const BREAK_POINT& b : core.getBreakConditions())
+            {
+                if (b.location == CHIP8_BREAK_ANYWHERE)
+                {
+                    event.address = CHIP8_BREAK_ANYWHERE;
+                    copyText(event.text, b.condition.getText());
+                    sendEvent(event, core);
+                }
+            }
+            break;
+        case DEBUG_WATCH:
+            core.setWatchPoint(command.address, command.length, command.access);
+            break;
+        case DEBUG_WATCH_REGISTER:
+            if (!core.setRegisterWatchPoint(command.reg, command.access))
+            {
+                event.kind = DEBUG_EVENT_ERROR;
+                copyText(event.text, "Bad register watch point, PC cannot be watched");
+                sendEvent(event, core);
+            }
+            break;
+        case DEBUG_UNWATCH:
+            core.clearWatchPoints();
+            break;
+        case DEBUG_KEY:
+            core.injectKey(command.reg & 0x0f);
+            break;
+        case DEBUG_TRACE:
+        {
+            std::string fname(command.text, strnlen(command.text, CHIP8_DEBUG_TEXT_SIZE));
+            if (tracer.isOpen())
+            {
+                core.setTracer(NULL);
+                tracer.close();
+                event.kind = DEBUG_EVENT_TRACED;
+                copyText(event.text, "Traced " + std::to_string(tracer.getRecords()) + " instructions in " +
+                                     std::to_string(tracer.getBytes()) + " bytes");
+                sendEvent(event, core);
+            }
+            if (fname.empty())
+                break;
+            if (tracer.create(fname.c_str(), command.value))
+            {
+                core.setTracer(&tracer);
+            }
+            else
+            {
+                event.kind = DEBUG_EVENT_ERROR;
+                copyText(event.text, "Could not create the trace file " + fname);
+                sendEvent(event, core);
+            }
+            break;
+        }
+        case DEBUG_PROFILE:
+        {
+            if (command.value)
+            {
+                profiler.reset(core.getState());
+                core.setProfiler(&profiler);
+                break;
+            }
+            if (core.getProfiler() != &profiler)
+            {
+                event.kind = DEBUG_EVENT_ERROR;
+                copyText(event.text, "Not profiling, use 'profile' to start");
+                sendEvent(event, core);
+                break;
+            }
+            core.setProfiler(NULL);
+
+            // The total, the addresses executed the most with their opcodes and the opcode classes executed the most
+            u64 total = profiler.getInstructions();
+            double percent = total ? 100.0 / total : 0.0;
+            char line[CHIP8_DEBUG_TEXT_SIZE];
+            event.kind = DEBUG_EVENT_PROFILED;
+            copyText(event.text, "Profiled " + std::to_string(total) + " instructions, the hottest were");
+            sendEvent(event, core);
+            const u8* memory = core.getState().memory;
+            for (u16 address : profiler.getHottest(CHIP8_PROFILE_HOTTEST))
+            {
+                u16 opcode = (memory[address] << 8) | memory[(address + 1) & (CHIP8_MEMORY_SIZE - 1)];
+                u64 executions = profiler.getExecutions()[address];
+                snprintf(line, sizeof(line), "   %03X %04X %-4s in %03X %6.2f%% %llu", address, opcode,
+                         opcodeClassName(decodeOpcode(opcode).cls), profiler.getFunction(address),
+                         executions * percent, (unsigned long long) executions);
+                copyText(event.text, line);
+                sendEvent(event, core);
+            }
+            const u64* classes = profiler.getClassCounts();
+            u8 top[OPCODE_CLASS_COUNT];
+            for (u8 c = 0; c < OPCODE_CLASS_COUNT; c++)
+                top[c] = c;
+            std::partial_sort(top, top + 3, top + OPCODE_CLASS_COUNT, [classes](u8 a, u8 b) { return classes[a] > classes[b]; });
+            snprintf(line, sizeof(line), "Classes %s %.1f%%, %s %.1f%%, %s %.1f%%", opcodeClassName(top[0]),
+                     classes[top[0]] * percent, opcodeClassName(top[1]), classes[top[1]] * percent,
+                     opcodeClassName(top[2]), classes[top[2]] * percent);
+            copyText(event.text, line);
+            sendEvent(event, core);
+
+            std::string fname(command.text, strnlen(command.text, CHIP8_DEBUG_TEXT_SIZE));
+            if (fname.empty())
+                break;
+            if (profiler.writeCallgrind(fname.c_str(), "chip8"))
+            {
+                copyText(event.text, "Wrote the profile to " + fname + " for callgrind viewers");
+            }
+            else
+            {
+                event.kind = DEBUG_EVENT_ERROR;
+                copyText(event.text, "Could not write the profile to " + fname);
+            }
+            sendEvent(event, core);
+            break;
+        }
+        case DEBUG_HEATMAP:
+        {
+            if (command.value)
+            {
+                heatmap.reset();
+                core.setHeatmap(&heatmap);
+                break;
+            }
+            if (core.getHeatmap() != &heatmap)
+            {
+                event.kind = DEBUG_EVENT_ERROR;
+                copyText(event.text, "No heatmap, use 'heatmap' to start one");
+                sendEvent(event, core);
+                break;
+            }
+            core.setHeatmap(NULL);
+
+            // The bytes touched, any code that was written and the data touched the most
+            HEATMAP_STATS stats = heatmap.getStats();
+            char line[CHIP8_DEBUG_TEXT_SIZE];
+            event.kind = DEBUG_EVENT_HEATMAP;
+            snprintf(line, sizeof(line), "%u bytes read, %u written, %u executed", stats.read, stats.written, stats.executed);
+            copyText(event.text, line);
+            sendEvent(event, core);
+            if (stats.codeWritten)
+            {
+                snprintf(line, sizeof(line), "%u bytes of code were written, from %03X", stats.codeWritten,
+                         stats.firstCodeWritten);
+                copyText(event.text, line);
+                sendEvent(event, core);
+            }
+            for (const HEATMAP_REGION& region : heatmap.getDataRegions(CHIP8_HEATMAP_REGIONS))
+            {
+                snprintf(line, sizeof(line), "   data %03X-%03X %u bytes, %llu reads %llu writes", region.address,
+                         region.address + region.length - 1, region.length, (unsigned long long) region.reads,
+                         (unsigned long long) region.writes);
+                copyText(event.text, line);
+                sendEvent(event, core);
+            }
+
+            std::string fname(command.text, strnlen(command.text, CHIP8_DEBUG_TEXT_SIZE));
+            if (fname.empty())
+                break;
+            bool csv = fname.size() > 4 && fname.compare(fname.size() - 4, 4, ".csv") == 0;
+            if (csv ? heatmap.writeCsv(fname.c_str()) : heatmap.save(fname.c_str()))
+            {
+                copyText(event.text, "Wrote the heatmap to " + fname);
+            }
+            else
+            {
+                event.kind = DEBUG_EVENT_ERROR;
+                copyText(event.text, "Could not write the heatmap to " + fname);
+            }
+            sendEvent(event, core);
+            break;
+        }
+        case DEBUG_INSTRUCTIONS_PER_FRAME:
+        {
+            core.setInstructionsPerFrame(command.value < 0xffff ? command.value : 0xffff);
+            u32 instructions = core.getInstructionsPerFrame();
+            sendText(core, DEBUG_EVENT_INFO, "Running " + std::to_string(instructions) + " instructions a frame, " +
+                                             std::to_string(instructions * CHIP8_FRAMES_PER_SECOND) + " a second");
+            break;
+        }
+        case DEBUG_IDLE:
+        {
+            IDLE_STATS stats = core.getIdleStats();
+            u64 instructions = core.getInstructions();
+            char line[CHIP8_DEBUG_TEXT_SIZE];
+            snprintf(line, sizeof(line), "Idle loops: %llu found in %llu looks", (unsigned long long) stats.loops,
+                     (unsigned long long) stats.looks);
+            sendText(core, DEBUG_EVENT_INFO, line);
+            snprintf(line, sizeof(line), "%llu instructions skipped, %.1f%% of %llu", (unsigned long long) stats.elided,
+                     instructions ? 100.0 * stats.elided / instructions : 0.0, (unsigned long long) instructions);
+            sendText(core, DEBUG_EVENT_INFO, line);
+            break;
+        }
+        default:
+            sendText(core, DEBUG_EVENT_ERROR, "This machine has no frontend to take that command");
+            break;
+    }
+}
+
+u32 Chip8Debugger::applyCommands(Chip8Core& core)
+{
+    u32 applied = 0;
+    DEBUG_COMMAND command;
+    while (commands.pop(command))
+    {
+        apply(core, command);
+        applied++;
+    }
+    publish(core);
+    return applied;
+}
+
+void Chip8Debugger::publish(Chip8Core& core)
+{
+    BREAK_EVENT why = core.getLastBreak();
+    if (why.number != breaksSent)
+    {
+        breaksSent = why.number;
+        DEBUG_EVENT event;
+        memset(&event, 0, sizeof(event));
+        event.kind = DEBUG_EVENT_BREAK;
+        event.why = why;
+        sendEvent(event, core);
+    }
+    snapshot.write(snapshotOf(core));
+}
+
+void Chip8Debugger::sendText(Chip8Core& core, u8 kind, const std::string& text)
+{
+    DEBUG_EVENT event;
+    memset(&event, 0, sizeof(event));
+    event.kind = kind;
+    copyText(event.text, text);
+    sendEvent(event, core);
+}
+
+void Chip8Debugger::close()
+{
+    closed.store(true, std::memory_order_release);
+    // Taking each mutex means a side about to wait sees "closed" or is already waiting and gets the notify
+    {
+        std::lock_guard<std::mutex> lock(machineSide.lock);
+        machineSide.wake.notify_all();
+    }
+    {
+        std::lock_guard<std::mutex> lock(debuggerSide.lock);
+        debuggerSide.wake.notify_all();
+    }
+}
+
+bool Chip8Debugger::isClosed() const
+{
+    return closed.load(std::memory_order_acquire);
+}
+
+DEBUG_SNAPSHOT Chip8Debugger::snapshotOf(Chip8Core& core)
+{
+    const CHIP8_STATE& s = core.getState();
+    DEBUG_SNAPSHOT regs;
+    memset(&regs, 0, sizeof(regs));
+    regs.instructions = s.instructions;
+    regs.breaks = core.getLastBreak().number;
+    regs.I = s.I;
+    regs.PC = s.PC;
+    memcpy(regs.V, s.V, sizeof(regs.V));
+    regs.SP = s.SP;
+    regs.DT = s.DT;
+    regs.ST = s.ST;
+    regs.keyWait = s.keyWait;
+    regs.running = core.isRunning();
+    return regs;
+}
+
+void Chip8Debugger::sendEvent(DEBUG_EVENT& event, Chip8Core& core)
+{
+    event.registers = snapshotOf(core);
+    if (!events.push(event))
+    {
+        droppedEvents.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    wake(debuggerSide);
+}
@@ -0,0 +1,552 @@
+#include <string.h>
+#include "Chip8Core.h"
+#include "Fusion.h"
+#include "Handlers.h"
+
+// Builds the 64K opcode class table, this runs in the compiler so the table is plain constant data in the binary
+static constexpr OPCODE_CLASS_TABLE buildOpcodeClassTable()
+{
+    OPCODE_CLASS_TABLE table = {};
+    for (u32 opcode = 0; opcode < 0x10000; opcode++)
+    {
+        table.classes[opcode] = classifyOpcode(opcode);
+    }
+    return table;
+}
+
+constexpr OPCODE_CLASS_TABLE opcodeClassTable = buildOpcodeClassTable();
+
+static_assert(opcodeClassTable.classes[0x00E0] == OPCODE_CLS && opcodeClassTable.classes[0xF265] == OPCODE_LD_VX_I,
+              "The opcode class table must be generated from classifyOpcode");
+
+#define CHIP8_OPCODE_NAME(name, text) text,
+static const char* const opcodeClassNames[OPCODE_CLASS_COUNT] = { CHIP8_OPCODE_CLASSES(CHIP8_OPCODE_NAME) };
+#undef CHIP8_OPCODE_NAME
+
+const char* opcodeClassName(u8 cls)
+{
+    if (cls >= OPCODE_CLASS_COUNT)
+        return opcodeClassNames[OPCODE_BAD];
+    return opcodeClassNames[cls];
+}
+
+// The handler table for one set of quirks
+template<u32 QUIRKS>
+struct QUIRK_HANDLER_TABLE
+{
+    #define CHIP8_HANDLER_ENTRY(name, text) &QuirkHandlers<QUIRKS>::name,
+    static constexpr OPCODE_HANDLER handlers[OPCODE_CLASS_COUNT] = { CHIP8_OPCODE_CLASSES(CHIP8_HANDLER_ENTRY) };
+    #undef CHIP8_HANDLER_ENTRY
+};
+
+// Every profile gets its own instantiation of the interpreter engines, picking a profile just picks a row of this
+#define CHIP8_QUIRK_ENGINE_ENTRY(name, text, bits) {bits, &Chip8Core::executeSwitch<bits>, &Chip8Core::executeTable<bits>, \
+                                                    &Chip8Core::executeGoto<bits>, &Chip8Core::executeInstrumented<bits>, \
+                                                    QUIRK_HANDLER_TABLE<bits>::handlers},
+const Chip8Core::QUIRK_ENGINES Chip8Core::quirkEngines[QUIRK_PROFILE_COUNT] = { CHIP8_QUIRK_PROFILES(CHIP8_QUIRK_ENGINE_ENTRY) };
+#undef CHIP8_QUIRK_ENGINE_ENTRY
+
+#define CHIP8_QUIRK_PROFILE_INFO(name, text, bits) {text, bits},
+static const struct
+{
+    const char* name;
+    u32 quirks;
+} quirkProfiles[QUIRK_PROFILE_COUNT] = { CHIP8_QUIRK_PROFILES(CHIP8_QUIRK_PROFILE_INFO) };
+#undef CHIP8_QUIRK_PROFILE_INFO
+
+u32 quirkProfileQuirks(QUIRK_PROFILE profile)
+{
+    return profile < QUIRK_PROFILE_COUNT ? quirkProfiles[profile].quirks : 0;
+}
+
+const char* quirkProfileName(QUIRK_PROFILE profile)
+{
+    return profile < QUIRK_PROFILE_COUNT ? quirkProfiles[profile].name : "unknown";
+}
+
+QUIRK_PROFILE findQuirkProfile(const char* name)
+{
+    for (u8 p = 0; p < QUIRK_PROFILE_COUNT; p++)
+    {
+        if (strcmp(quirkProfiles[p].name, name) == 0)
+            return (QUIRK_PROFILE) p;
+    }
+    return QUIRK_PROFILE_COUNT;
+}
+
+void Chip8Core::setDispatchEngine(DISPATCH_ENGINE engine)
+{
+    this->engine = engine;
+}
+
+DISPATCH_ENGINE Chip8Core::getDispatchEngine()
+{
+    return engine;
+}
+
+void Chip8Core::setQuirkProfile(QUIRK_PROFILE profile)
+{
+    if (profile >= QUIRK_PROFILE_COUNT || profile == quirkProfile)
+        return;
+
+    quirkProfile = profile;
+    quirks = &quirkEngines[profile];
+    // Cached handlers and translated blocks were built for the old quirks
+    flushDecodeCache();
+    if (jit)
+        jit->setQuirks(quirks->quirks);
+}
+
+QUIRK_PROFILE Chip8Core::getQuirkProfile()
+{
+    return quirkProfile;
+}
+
+// The "processOpcode" method will be in charge of decoding and processing the opcode
+void Chip8Core::processOpcode()
+{
+    dispatch(1);
+}
+
+u32 Chip8Core::execute(u32 count)
+{
+    // Break and watch points have to be checked before every instruction so they are stepped one at a time
+    if (debugging)
+        return executeDebugging(count);
+    return dispatch(count);
+}
+
+u32 Chip8Core::dispatch(u32 count)
+{
+    u32 done = 0;
+    if (!state.keyWait)
+    {
+        // Profiling and tracing have to see every instruction so nothing is skipped while any is on
+        if (idleSkipping && !profiling && !tracer && !profiler && !heatmap && count >= CHIP8_IDLE_MIN_BUDGET)
+            done = dispatchSkippingIdle(count);
+        else
+            done = runEngine(count);
+    }
+
+    /* A machine halted on "Fx0A" spends the rest of the call waiting, nothing runs but the timers tick through it as
+     * they would have if it had kept executing so a key press lands at the same point of emulated time whatever the
+     * engine or the length of the calls */
+    if (state.keyWait && !quit && done < count)
+    {
+        keyWaitStats.instructions += count - done;
+        Handlers::tickTimers(*this, count - done);
+        done = count;
+    }
+
+    // Counted once a call rather than in the engines so their loops stay as they are
+    state.instructions += done;
+    return done;
+}
+
+u32 Chip8Core::runEngine(u32 count)
+{
+    u32 done;
+    if (tracer || profiler || heatmap)
+        done = (this->*quirks->instrumentedEngine)(count);
+    else if (profiling)
+        done = executeProfiled(count);
+    else
+    {
+        switch(engine)
+        {
+            case DISPATCH_SWITCH:
+                done = (this->*quirks->switchEngine)(count);
+            break;
+            case DISPATCH_TABLE:
+                done = (this->*quirks->tableEngine)(count);
+            break;
+            case DISPATCH_CACHE:
+                done = executeCached(count);
+            break;
+            case DISPATCH_JIT:
+                done = executeJit(count);
+            break;
+            case DISPATCH_COMPILED:
+                done = executeCompiled(count);
+            break;
+            default:
+                done = (this->*quirks->gotoEngine)(count);
+            break;
+        }
+    }
+    return done;
+}
+
+// The reference engine, a switch on the opcode class
+template<u32 QUIRKS>
+u32 Chip8Core::executeSwitch(u32 count)
+{
+    u32 done = 0;
+    while (done < count && !stopped())
+    {
+        INSTRUCTION ins = decodeOpcode(Handlers::fetch(state));
+        state.PC += 2;
+        switch(ins.cls)
+        {
+            #define CHIP8_SWITCH_CASE(name, text) case OPCODE_##name: QuirkHandlers<QUIRKS>::name(*this, ins); break;
+            CHIP8_OPCODE_CLASSES(CHIP8_SWITCH_CASE)
+            #undef CHIP8_SWITCH_CASE
+            default: Handlers::BAD(*this, ins); break;
+        }
+        Handlers::tickTimers(*this);
+        done++;
+    }
+    return done;
+}
+
+// Calls the handler for the opcode class through a table of function pointers
+template<u32 QUIRKS>
+u32 Chip8Core::executeTable(u32 count)
+{
+    const OPCODE_HANDLER* handlers = QUIRK_HANDLER_TABLE<QUIRKS>::handlers;
+    u32 done = 0;
+    while (done < count && !stopped())
+    {
+        INSTRUCTION ins = decodeOpcode(Handlers::fetch(state));
+        state.PC += 2;
+        handlers[ins.cls](*this, ins);
+        Handlers::tickTimers(*this);
+        done++;
+    }
+    return done;
+}
+
+#if defined(__GNUC__) || defined(__clang__)
+/* Jumps straight from the end of one handler to the label of the next, every handler gets its own indirect jump
+ * which the branch predictor can learn far better than the single jump of a switch */
+template<u32 QUIRKS>
+u32 Chip8Core::executeGoto(u32 count)
+{
+    #define CHIP8_GOTO_LABEL(name, text) &&op_##name,
+    static const void* const labels[OPCODE_CLASS_COUNT] = { CHIP8_OPCODE_CLASSES(CHIP8_GOTO_LABEL) };
+    #undef CHIP8_GOTO_LABEL
+
+    u32 done = 0;
+    INSTRUCTION ins;
+
+    #define CHIP8_DISPATCH() \
+        if (done == count || stopped()) \
+            return done; \
+        ins = decodeOpcode(Handlers::fetch(state)); \
+        state.PC += 2; \
+        done++; \
+        goto *labels[ins.cls];
+
+    CHIP8_DISPATCH();
+
+    #define CHIP8_GOTO_HANDLER(name, text) \
+        op_##name: \
+            QuirkHandlers<QUIRKS>::name(*this, ins); \
+            Handlers::tickTimers(*this); \
+            CHIP8_DISPATCH();
+    CHIP8_OPCODE_CLASSES(CHIP8_GOTO_HANDLER)
+    #undef CHIP8_GOTO_HANDLER
+    #undef CHIP8_DISPATCH
+}
+#else
+template<u32 QUIRKS>
+u32 Chip8Core::executeGoto(u32 count)
+{
+    return executeTable<QUIRKS>(count);
+}
+#endif
+
+/* Executes from the predecoded instruction cache, an address is decoded the first time it is executed and after that
+ * its handler and operands come straight from the cache until memory under it is written to */
+u32 Chip8Core::executeCached(u32 count)
+{
+    if (!decodeCache)
+    {
+        decodeCache.reset(new CACHED_INSTRUCTION[CHIP8_MEMORY_SIZE]);
+        memset(decodeCache.get(), 0, sizeof(CACHED_INSTRUCTION) * CHIP8_MEMORY_SIZE);
+    }
+
+    CACHED_INSTRUCTION* cache = decodeCache.get();
+    u32 done = 0;
+    u64 misses = 0;
+    while (done < count && !stopped())
+    {
+        CACHED_INSTRUCTION& entry = cache[CHIP8_ADDRESS(state.PC)];
+        if (!entry.handler)
+        {
+            entry.ins = decodeOpcode(Handlers::fetch(state));
+            entry.handler = quirks->handlers[entry.ins.cls];
+            misses++;
+            if (fusedPatternMask)
+                fuseDecodeCache(CHIP8_ADDRESS(state.PC));
+        }
+
+        // A fused run is only taken when the budget covers all of it so "count" is never overshot
+        if (entry.fused && count - done >= entry.fusedLength)
+        {
+            u8 pattern = entry.fusedPattern;
+            u32 ran = entry.fused(*this, &entry);
+            fusionStats.dispatches[pattern]++;
+            fusionStats.instructions[pattern] += ran;
+            done += ran;
+            continue;
+        }
+
+        // The entry is copied as the handler may write over the memory it was decoded from
+        INSTRUCTION ins = entry.ins;
+        state.PC += 2;
+        entry.handler(*this, ins);
+        Handlers::tickTimers(*this);
+        done++;
+    }
+
+    decodeCacheStats.misses += misses;
+    decodeCacheStats.hits += done - misses;
+    return done;
+}
+
+/* An instruction is two bytes so a write can land in the one starting at "address" or the one starting just before it,
+ * a fused run can start up to five bytes before "address" */
+void Chip8Core::invalidateDecodeCache(u16 address)
+{
+    CACHED_INSTRUCTION* cache = decodeCache.get();
+    if (cache[address].handler)
+    {
+        cache[address].handler = NULL;
+        decodeCacheStats.invalidations++;
+    }
+
+    u16 previous = CHIP8_ADDRESS(address - 1);
+    if (cache[previous].handler)
+    {
+        cache[previous].handler = NULL;
+        decodeCacheStats.invalidations++;
+    }
+
+    if (fusedPatternMask)
+    {
+        for (u16 back = 0; back < CHIP8_MAX_FUSED_LENGTH * 2; back++)
+        {
+            CACHED_INSTRUCTION& entry = cache[CHIP8_ADDRESS(address - back)];
+            if (entry.fusedLength * 2 > back)
+            {
+                entry.fused = NULL;
+                entry.fusedLength = 0;
+            }
+        }
+    }
+}
+
+void Chip8Core::flushDecodeCache()
+{
+    if (decodeCache)
+        memset(decodeCache.get(), 0, sizeof(CACHED_INSTRUCTION) * CHIP8_MEMORY_SIZE);
+    if (jit)
+        jit->flush();
+
+    // Memory may now hold a different ROM so the compiled program is looked up again
+    compiled = NULL;
+    compiledLookedUp = false;
+    compiledStale = false;
+}
+
+DECODE_CACHE_STATS Chip8Core::getDecodeCacheStats()
+{
+    return decodeCacheStats;
+}
+
+/* Looks for an enabled pattern starting at "address" once it has been decoded into the cache, the instructions after
+ * it are decoded into their entries too so the fused handler can read them from there */
+void Chip8Core::fuseDecodeCache(u16 address)
+{
+    CACHED_INSTRUCTION* cache = decodeCache.get();
+    for (u8 p = 0; p < FUSED_PATTERN_COUNT; p++)
+    {
+        const FUSED_PATTERN_INFO& info = fusedPatterns[p];
+        if (!(fusedPatternMask & (1 << p)) || address + (info.length * 2) > CHIP8_MEMORY_SIZE)
+            continue;
+        // The fused handlers are built from the plain handlers so a pattern a quirk changes is left unfused
+        if (quirksAffect(info.classes[0], quirks->quirks) || quirksAffect(info.classes[1], quirks->quirks) ||
+            (info.length == 3 && quirksAffect(info.classes[2], quirks->quirks)))
+            continue;
+
+        bool match = true;
+        for (u32 c = 0; c < info.length && match; c++)
+        {
+            // Only the instruction is filled in, the handler is left for the address's own miss to try fusing from there
+            CACHED_INSTRUCTION& next = cache[address + (c * 2)];
+            if (!next.handler)
+                next.ins = decodeOpcode((state.memory[address + (c * 2)] << 8) | state.memory[address + (c * 2) + 1]);
+            match = next.ins.cls == info.classes[c];
+        }
+
+        if (match)
+        {
+            cache[address].fused = info.handler;
+            cache[address].fusedPattern = p;
+            cache[address].fusedLength = info.length;
+            return;
+        }
+    }
+}
+
+/* Executes through the handler table while counting every pair and triple of opcode classes. Only runs that sit next
+ * to each other in memory and were executed by falling through are counted, "fuseDecodeCache" matches patterns at
+ * "address", "address + 2" and "address + 4" so a pair joined by a jump or a taken skip could never be fused. After an
+ * instruction that sends "PC" anywhere else the history starts again from OPCODE_BAD, which is never counted. */
+u32 Chip8Core::executeProfiled(u32 count)
+{
+    OPCODE_PROFILE& profile = *opcodeProfile;
+    const OPCODE_HANDLER* handlers = quirks->handlers;
+    u8 first = profileHistory[0];
+    u8 second = profileHistory[1];
+    u32 done = 0;
+    while (done < count && !stopped())
+    {
+        u16 pc = state.PC;
+        INSTRUCTION ins = decodeOpcode(Handlers::fetch(state));
+        state.PC += 2;
+        handlers[ins.cls](*this, ins);
+        Handlers::tickTimers(*this);
+        done++;
+
+        if (second != OPCODE_BAD)
+        {
+            profile.pairs[second][ins.cls]++;
+            if (first != OPCODE_BAD)
+                profile.triples[first][second][ins.cls]++;
+        }
+        if (CHIP8_ADDRESS(state.PC) == CHIP8_ADDRESS(pc + 2))
+        {
+            first = second;
+            second = ins.cls;
+        }
+        else
+        {
+            first = OPCODE_BAD;
+            second = OPCODE_BAD;
+        }
+    }
+
+    profile.total += done;
+    profileHistory[0] = first;
+    profileHistory[1] = second;
+    return done;
+}
+
+/* Records each instruction into the tracer with the registers it left, counts it into the profiler and counts the
+ * memory it touches into the heatmap, whichever are set. A trace record carries the count the machine had before the
+ * instruction, worked out from the count at the start of the call as "dispatch" only adds this call's instructions on
+ * at the end. It dispatches as the switch engine does so the handlers are inlined and recording is most of what
+ * tracing or profiling costs */
+template<u32 QUIRKS>
+u32 Chip8Core::executeInstrumented(u32 count)
+{
+    Chip8Tracer* trace = tracer;
+    Chip8Profiler* profile = profiler;
+    Chip8Heatmap* map = heatmap;
+    u64 instruction = state.instructions;
+    u32 done = 0;
+    while (done < count && !stopped())
+    {
+        u16 pc = state.PC;
+        INSTRUCTION ins = decodeOpcode(Handlers::fetch(state));
+        // What an instruction reads and writes is worked out from the machine before it runs
+        if (map)
+            map->count(state, pc, ins, QUIRKS);
+        state.PC += 2;
+        switch(ins.cls)
+        {
+            #define CHIP8_SWITCH_CASE(name, text) case OPCODE_##name: QuirkHandlers<QUIRKS>::name(*this, ins); break;
+            CHIP8_OPCODE_CLASSES(CHIP8_SWITCH_CASE)
+            #undef CHIP8_SWITCH_CASE
+            default: Handlers::BAD(*this, ins); break;
+        }
+        Handlers::tickTimers(*this);
+        if (profile)
+            profile->count(state, pc, ins.cls);
+        if (trace)
+            trace->record(state, pc, ins.opcode, instruction + done);
+        done++;
+    }
+    return done;
+}
+
+/* Runs translated blocks, an address the jit cannot start a block at is executed from the decode cache. Blocks are
+ * chained into each other so one call into translated code can run many blocks before it comes back here */
+u32 Chip8Core::executeJit(u32 count)
+{
+    if (!jit)
+    {
+        jit.reset(new Jit());
+        jit->setQuirks(quirks->quirks);
+    }
+
+    if (!jit->isAvailable())
+        return executeCached(count);
+
+    u32 done = 0;
+    while (done < count && !stopped())
+    {
+        const u8* block = jit->getBlock(state, state.PC);
+        u32 ran = 0;
+        if (block)
+            ran = jit->run(state, count - done, block);
+
+        // Nothing ran when there is no block or the budget left cannot cover the whole block
+        if (ran == 0)
+            ran = executeCached(1);
+        done += ran;
+    }
+    return done;
+}
+
+JIT_STATS Chip8Core::getJitStats()
+{
+    if (!jit)
+    {
+        JIT_STATS stats;
+        memset(&stats, 0, sizeof(stats));
+        return stats;
+    }
+    return jit->getStats();
+}
+
+/* Runs the compiled program for the loaded ROM, the interpreter takes any instruction compiled code does not cover and
+ * everything once code the program was compiled from has been written over */
+u32 Chip8Core::executeCompiled(u32 count)
+{
+    if (!compiledLookedUp)
+    {
+        compiled = findCompiledProgram(state);
+        compiledLookedUp = true;
+        // A program compiled for other quirks would behave differently so the interpreter runs everything instead
+        if (compiled && compiled->quirks != quirks->quirks)
+            compiled = NULL;
+    }
+
+    u32 done = 0;
+    u64 interpreted = 0;
+    while (done < count && !stopped())
+    {
+        u32 ran = 0;
+        if (compiled && !compiledStale)
+            ran = compiled->run(*this, count - done);
+
+        if (ran == 0)
+        {
+            ran = executeCached(1);
+            interpreted += ran;
+        }
+        done += ran;
+    }
+
+    compiledStats.compiled += done - interpreted;
+    compiledStats.interpreted += interpreted;
+    return done;
+}
+
+COMPILED_STATS Chip8Core::getCompiledStats()
+{
+    return compiledStats;
+}
@@ -1,8 +1,12 @@
+#include <string.h>
 #include "Display.h"
 
 Display::Display()
 {
     screen = NULL;
+    pixels = NULL;
+    framesPresented = 0;
+    framesSkipped = 0;
 }
 
 Display::~Display()
@@ -13,7 +17,7 @@ Display::~Display()
     }
 }
 
-void Display::Init(u32 w, u32 h, PIXEL_COLOUR pcol_on, PIXEL_COLOUR pcol_off)
+void Display::Init(u32 w, u32 h, PIXEL_COLOUR pcol_on, PIXEL_COLOUR pcol_off, const u64* pixels)
 {
     // Free the screen surface if it already exists
     if (this->screen != NULL)
@@ -28,97 +32,104 @@ void Display::Init(u32 w, u32 h, PIXEL_COLOUR pcol_on, PIXEL_COLOUR pcol_off)
 
     this->pcol_on = pcol_on;
     this->pcol_off = pcol_off;
+    this->pixels = pixels;
 }
 
-// Clears the display
-void Display::clear()
+// Expands a packed row of 64 pixels into the first scanline of the row then copies it down for the rest of the pixel height
+void Display::drawRow(u16 y, u64 row)
 {
-    // Turn all of the pixels off
-    for (int i = 0; i < CHIP8_RESOLUTION; i++)
+    u32* scanline = (u32*)((u8*)this->screen->pixels + (y * ph * this->screen->pitch));
+    u32* out = scanline;
+    for (u16 x = 0; x < CHIP8_ORIGINAL_DISPLAY_WIDTH; x++)
     {
-        this->pixels[i] = false;
+        u32 pixelColour = (row & 0x8000000000000000ull) ? this->pcol_on : this->pcol_off;
+        row <<= 1;
+        for (u16 x1 = 0; x1 < pw; x1++)
+        {
+            *out++ = pixelColour;
+        }
     }
-}
 
-void Display::setPixel(u16 x, u16 y, bool on, bool XOR)
-{
-    // Wrap around the pixels if they breach the screen coordinates
-    if (x >= CHIP8_ORIGINAL_DISPLAY_WIDTH)
+    for (u16 y1 = 1; y1 < ph; y1++)
     {
-        x -= CHIP8_ORIGINAL_DISPLAY_WIDTH;
+        memcpy((u8*)scanline + (y1 * this->screen->pitch), scanline, CHIP8_ORIGINAL_DISPLAY_WIDTH * pw * sizeof(u32));
     }
+}
 
-    if (y >= CHIP8_ORIGINAL_DISPLAY_HEIGHT)
+void Display::process(u32 dirtyRows)
+{
+    if (dirtyRows == 0)
     {
-        y -= CHIP8_ORIGINAL_DISPLAY_HEIGHT;
+        framesSkipped++;
+        return;
     }
 
-    // Set the pixel to either on or off based on the bool provided
-    if (XOR)
-    {
-        this->pixels[(y * CHIP8_ORIGINAL_DISPLAY_WIDTH) + x] ^= on;
-    }
-    else
-    {
-        this->pixels[(y * CHIP8_ORIGINAL_DISPLAY_WIDTH) + x] = on;
-    }
+    draw(dirtyRows);
+    framesPresented++;
 }
 
-// getPixel returns true when the pixel is set and false when it is not
-bool Display::getPixel(u16 x, u16 y)
+void Display::setPixels(const u64* pixels)
 {
-    return this->pixels[(y * CHIP8_ORIGINAL_DISPLAY_WIDTH) + x];
+    this->pixels = pixels;
 }
-void Display::drawPixel(u16 x, u16 y, bool on)
+
+void Display::drawHeatmap(const u32* colours)
 {
-    u32* screenPixels = (u32*)this->screen->pixels;
-    u32 pixelColour;
-    if (on)
-        pixelColour = this->pcol_on;
-    else
-        pixelColour = this->pcol_off;
-
-    // Calculate real coordinates
-    u16 xr = x * pw;
-    u16 yr = y * ph;
-
-    // Draw the pixels until correct size is reached
-    for (u32 x1 = xr; x1 < xr + pw; x1++)
+    const u16 columns = 64;
+    const u16 rows = CHIP8_MEMORY_SIZE / columns;
+    SDL_Rect cell;
+    cell.w = this->w / columns;
+    cell.h = this->h / rows;
+    for (u16 y = 0; y < rows; y++)
     {
-        for (u32 y2 = yr; y2 < yr + pw; y2++)
+        for (u16 x = 0; x < columns; x++)
         {
-            screenPixels[(y2 * this->w) + x1] = pixelColour;
+            u32 colour = colours[y * columns + x];
+            cell.x = x * cell.w;
+            cell.y = y * cell.h;
+            SDL_FillRect(screen, &cell, SDL_MapRGB(screen->format, colour >> 16, (colour >> 8) & 0xff, colour & 0xff));
         }
     }
+    SDL_UpdateRect(screen, 0, 0, 0, 0);
 }
 
-void Display::process()
+u64 Display::getFramesPresented()
 {
-   draw();
+    return framesPresented;
 }
 
-bool* Display::getPixels()
+u64 Display::getFramesSkipped()
 {
-    return this->pixels;
+    return framesSkipped;
 }
 
-void Display::draw()
+void Display::draw(u32 dirtyRows)
 {
-   for (u16 x = 0; x < CHIP8_ORIGINAL_DISPLAY_WIDTH; x++)
-   {
-       for (u16 y = 0; y < CHIP8_ORIGINAL_DISPLAY_HEIGHT; y++)
-       {
-            bool p = this->pixels[(y * CHIP8_ORIGINAL_DISPLAY_WIDTH) + x];
-            // If the pixel is set then draw it to the screen
-            if (p)
-            {
-                drawPixel(x, y, true);
-            }
-            else
-                drawPixel(x, y, false);
-       }
-   }
-
-    // Update the screen
-    SDL_Flip(screen);
+    SDL_Rect rects[CHIP8_ORIGINAL_DISPLAY_HEIGHT];
+    int totalRects = 0;
+
+    for (u16 y = 0; y < CHIP8_ORIGINAL_DISPLAY_HEIGHT; y++)
+    {
+        if (!(dirtyRows & (1u << y)))
+            continue;
+
+        drawRow(y, this->pixels[y]);
+
+        // Neighbouring dirty rows are merged into a single rectangle
+        if (totalRects > 0 && (dirtyRows & (1u << (y - 1))))
+        {
+            rects[totalRects-1].h += ph;
+        }
+        else
+        {
+            rects[totalRects].x = 0;
+            rects[totalRects].y = y * ph;
+            rects[totalRects].w = this->w;
+            rects[totalRects].h = ph;
+            totalRects++;
+        }
+    }
+
+    // Only update the parts of the screen that changed
+    SDL_UpdateRects(screen, totalRects, rects);
 }
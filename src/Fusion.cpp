@@ -0,0 +1,133 @@
+#include <string.h>
+#include "Chip8Core.h"
+#include "Fusion.h"
+#include "Handlers.h"
+
+// Calls the handler for a class known at compile time so the fused handlers compile to straight line code
+template<u8 CLS>
+static inline void callHandler(Chip8Core& core, const INSTRUCTION& ins)
+{
+    switch(CLS)
+    {
+        #define CHIP8_FUSED_CASE(name, text) case OPCODE_##name: Handlers::name(core, ins); break;
+        CHIP8_OPCODE_CLASSES(CHIP8_FUSED_CASE)
+        #undef CHIP8_FUSED_CASE
+    }
+}
+
+// True for the classes that can send "PC" anywhere but the next instruction
+static constexpr bool changesFlow(u8 cls)
+{
+    return cls == OPCODE_RET || cls == OPCODE_JP || cls == OPCODE_CALL || cls == OPCODE_SE_VX_KK || cls == OPCODE_SNE_VX_KK ||
+           cls == OPCODE_SE_VX_VY || cls == OPCODE_SNE_VX_VY || cls == OPCODE_JP_V0 || cls == OPCODE_SKP || cls == OPCODE_SKNP ||
+           cls == OPCODE_LD_VX_K;
+}
+
+// True for the classes that read or write a timer, the timers have to tick before these run
+static constexpr bool usesTimers(u8 cls)
+{
+    return cls == OPCODE_LD_VX_DT || cls == OPCODE_LD_DT_VX || cls == OPCODE_LD_ST_VX;
+}
+
+/* Executes the instructions of a pattern exactly as the interpreter would, "PC" is moved past each instruction before
+ * its handler and the run stops as soon as an instruction sends "PC" anywhere else. The timers count once per
+ * instruction, they are counted together at the end unless a later instruction in the pattern reads or writes them. */
+template<u8 LENGTH, u8 A, u8 B, u8 C>
+static u32 fusedHandler(Chip8Core& core, const CACHED_INSTRUCTION* entry)
+{
+    CHIP8_STATE& s = core.getState();
+    u16 start = s.PC;
+    u8 pending = 0;
+
+    s.PC += 2;
+    callHandler<A>(core, entry[0].ins);
+    pending++;
+    if (changesFlow(A) && s.PC != start + 2)
+    {
+        Handlers::tickTimers(core, pending);
+        return 1;
+    }
+
+    if (usesTimers(B))
+    {
+        Handlers::tickTimers(core, pending);
+        pending = 0;
+    }
+    s.PC += 2;
+    callHandler<B>(core, entry[2].ins);
+    pending++;
+    if (LENGTH == 2 || (changesFlow(B) && s.PC != start + 4))
+    {
+        Handlers::tickTimers(core, pending);
+        return 2;
+    }
+
+    if (usesTimers(C))
+    {
+        Handlers::tickTimers(core, pending);
+        pending = 0;
+    }
+    s.PC += 2;
+    callHandler<C>(core, entry[4].ins);
+    pending++;
+    Handlers::tickTimers(core, pending);
+    return 3;
+}
+
+#define CHIP8_FUSED_PATTERN_INFO(name, text, length, a, b, c) {text, length, {a, b, c}, &fusedHandler<length, a, b, c>},
+const FUSED_PATTERN_INFO fusedPatterns[FUSED_PATTERN_COUNT] = { CHIP8_FUSED_PATTERNS(CHIP8_FUSED_PATTERN_INFO) };
+#undef CHIP8_FUSED_PATTERN_INFO
+
+u64 fusedPatternCount(const OPCODE_PROFILE& profile, u8 pattern)
+{
+    const FUSED_PATTERN_INFO& info = fusedPatterns[pattern];
+    if (info.length == 3)
+        return profile.triples[info.classes[0]][info.classes[1]][info.classes[2]];
+    return profile.pairs[info.classes[0]][info.classes[1]];
+}
+
+u32 chooseFusedPatterns(const OPCODE_PROFILE& profile, double minShare)
+{
+    u32 mask = 0;
+    for (u8 p = 0; p < FUSED_PATTERN_COUNT; p++)
+    {
+        // Each run of the pattern saves one dispatch for every instruction after its first
+        double saved = (double) fusedPatternCount(profile, p) * (fusedPatterns[p].length - 1);
+        if (profile.total > 0 && saved / profile.total >= minShare)
+            mask |= 1 << p;
+    }
+    return mask;
+}
+
+void Chip8Core::setFusedPatterns(u32 mask)
+{
+    fusedPatternMask = mask & CHIP8_ALL_FUSED_PATTERNS;
+    flushDecodeCache();
+}
+
+u32 Chip8Core::getFusedPatterns()
+{
+    return fusedPatternMask;
+}
+
+FUSION_STATS Chip8Core::getFusionStats()
+{
+    return fusionStats;
+}
+
+void Chip8Core::setProfiling(bool on)
+{
+    if (on && !opcodeProfile)
+    {
+        opcodeProfile.reset(new OPCODE_PROFILE);
+        memset(opcodeProfile.get(), 0, sizeof(OPCODE_PROFILE));
+        profileHistory[0] = OPCODE_BAD;
+        profileHistory[1] = OPCODE_BAD;
+    }
+    profiling = on;
+}
+
+const OPCODE_PROFILE* Chip8Core::getOpcodeProfile()
+{
+    return opcodeProfile.get();
+}
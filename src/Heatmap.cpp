@@ -0,0 +1,163 @@
+#include <algorithm>
+#include <fstream>
+#include <math.h>
+#include <string.h>
+#include "Chip8Core.h"
+#include "Heatmap.h"
+
+void Chip8Core::setHeatmap(Chip8Heatmap* heatmap)
+{
+    this->heatmap = heatmap;
+}
+
+Chip8Heatmap* Chip8Core::getHeatmap()
+{
+    return heatmap;
+}
+
+Chip8Heatmap::Chip8Heatmap()
+{
+    reset();
+}
+
+Chip8Heatmap::~Chip8Heatmap()
+{
+
+}
+
+void Chip8Heatmap::reset()
+{
+    instructions = 0;
+    memset(reads, 0, sizeof(reads));
+    memset(writes, 0, sizeof(writes));
+    memset(executes, 0, sizeof(executes));
+}
+
+u64 Chip8Heatmap::getInstructions()
+{
+    return instructions;
+}
+
+const u64* Chip8Heatmap::getReads()
+{
+    return reads;
+}
+
+const u64* Chip8Heatmap::getWrites()
+{
+    return writes;
+}
+
+const u64* Chip8Heatmap::getExecutes()
+{
+    return executes;
+}
+
+HEATMAP_STATS Chip8Heatmap::getStats()
+{
+    HEATMAP_STATS stats;
+    memset(&stats, 0, sizeof(stats));
+    stats.firstCodeWritten = CHIP8_MEMORY_SIZE;
+    for (u32 a = 0; a < CHIP8_MEMORY_SIZE; a++)
+    {
+        stats.read += reads[a] != 0;
+        stats.written += writes[a] != 0;
+        stats.executed += executes[a] != 0;
+        if (writes[a] && executes[a])
+        {
+            if (stats.codeWritten == 0)
+                stats.firstCodeWritten = a;
+            stats.codeWritten++;
+        }
+    }
+    return stats;
+}
+
+std::vector<HEATMAP_REGION> Chip8Heatmap::getDataRegions(u32 count)
+{
+    std::vector<HEATMAP_REGION> regions;
+    for (u32 a = 0; a < CHIP8_MEMORY_SIZE; a++)
+    {
+        if (executes[a] || !(reads[a] || writes[a]))
+            continue;
+        // A byte carries on the region of the byte before it if that was data too
+        if (regions.empty() || regions.back().address + regions.back().length != a)
+            regions.push_back({(u16) a, 0, 0, 0});
+        regions.back().length++;
+        regions.back().reads += reads[a];
+        regions.back().writes += writes[a];
+    }
+    count = std::min<u32>(count, regions.size());
+    std::partial_sort(regions.begin(), regions.begin() + count, regions.end(), [](const HEATMAP_REGION& a, const HEATMAP_REGION& b) {
+        return a.reads + a.writes > b.reads + b.writes;
+    });
+    regions.resize(count);
+    return regions;
+}
+
+// Scales "value" to 0-255 by its log, "scale" is 255 over the log of the most any byte has
+static u32 channel(u64 value, double scale)
+{
+    return value ? (u32) (log2((double) value + 1) * scale + 0.5) : 0;
+}
+
+void Chip8Heatmap::getColours(u32* colours)
+{
+    u64 mostReads = *std::max_element(reads, reads + CHIP8_MEMORY_SIZE);
+    u64 mostWrites = *std::max_element(writes, writes + CHIP8_MEMORY_SIZE);
+    u64 mostExecutes = *std::max_element(executes, executes + CHIP8_MEMORY_SIZE);
+    double readScale = 255.0 / log2((double) mostReads + 1);
+    double writeScale = 255.0 / log2((double) mostWrites + 1);
+    double executeScale = 255.0 / log2((double) mostExecutes + 1);
+    for (u32 a = 0; a < CHIP8_MEMORY_SIZE; a++)
+        colours[a] = channel(writes[a], writeScale) << 16 | channel(reads[a], readScale) << 8 | channel(executes[a], executeScale);
+}
+
+bool Chip8Heatmap::writeCsv(const char* fname)
+{
+    std::ofstream file(fname, std::ios::trunc);
+    if (!file.is_open())
+        return false;
+    file << "address,reads,writes,executes" << std::endl;
+    for (u32 a = 0; a < CHIP8_MEMORY_SIZE; a++)
+        file << a << "," << reads[a] << "," << writes[a] << "," << executes[a] << "\n";
+    return !file.fail();
+}
+
+bool Chip8Heatmap::save(const char* fname)
+{
+    HEATMAP_FILE_HEADER header;
+    memset(&header, 0, sizeof(header));
+    header.magic = CHIP8_HEATMAP_MAGIC;
+    header.version = CHIP8_HEATMAP_VERSION;
+    header.instructions = instructions;
+    std::ofstream file(fname, std::ios::binary | std::ios::trunc);
+    if (!file.is_open())
+        return false;
+    file.write((const char*) &header, sizeof(header));
+    file.write((const char*) reads, sizeof(reads));
+    file.write((const char*) writes, sizeof(writes));
+    file.write((const char*) executes, sizeof(executes));
+    return !file.fail();
+}
+
+bool Chip8Heatmap::load(const char* fname)
+{
+    std::ifstream file(fname, std::ios::binary);
+    if (!file.is_open())
+        return false;
+    HEATMAP_FILE_HEADER header;
+    file.read((char*) &header, sizeof(header));
+    if (file.fail() || header.magic != CHIP8_HEATMAP_MAGIC || header.version != CHIP8_HEATMAP_VERSION)
+        return false;
+    file.read((char*) reads, sizeof(reads));
+    file.read((char*) writes, sizeof(writes));
+    file.read((char*) executes, sizeof(executes));
+    if (file.fail())
+    {
+        reset();
+        return false;
+    }
+    instructions = header.instructions;
+    return true;
+}
@@ -0,0 +1,121 @@
+#include <string.h>
+#include "Chip8Core.h"
+#include "Handlers.h"
+#include "Idle.h"
+
+void Chip8Core::setIdleSkipping(bool on)
+{
+    idleSkipping = on;
+}
+
+bool Chip8Core::getIdleSkipping()
+{
+    return idleSkipping;
+}
+
+IDLE_STATS Chip8Core::getIdleStats()
+{
+    return idleStats;
+}
+
+/* Looks before each slice rather than after so an "execute" of a single frame still gets a look, the frontend runs
+ * one frame a call. What is left once it is too little for a look runs straight through */
+u32 Chip8Core::dispatchSkippingIdle(u32 count)
+{
+    u32 done = 0;
+    while (done < count && !stopped())
+    {
+        u32 resume = CHIP8_IDLE_SLICE;
+        if (count - done >= CHIP8_IDLE_MIN_BUDGET)
+            done += skipIdle(count - done, resume);
+        if (done >= count || stopped())
+            break;
+
+        u32 slice = count - done < resume ? count - done : resume;
+        u32 ran = runEngine(slice);
+        done += ran;
+        if (ran < slice)
+            break;
+    }
+    return done;
+}
+
+/* A loop is found by stepping from "PC" until it comes back round, which works from any instruction in the loop. The
+ * first pass may still be setting registers up from before the loop was entered so a second pass is tried when the
+ * first changes them. A pass that saw a timer it uses tick proves nothing about passes that will not */
+u32 Chip8Core::skipIdle(u32 count, u32& resume)
+{
+    if (!idleBackoff)
+    {
+        idleBackoff.reset(new IDLE_BACKOFF[CHIP8_MEMORY_SIZE]);
+        memset(idleBackoff.get(), 0, CHIP8_MEMORY_SIZE * sizeof(IDLE_BACKOFF));
+    }
+
+    u16 start = CHIP8_ADDRESS(state.PC);
+    IDLE_BACKOFF& backoff = idleBackoff[start];
+    if (backoff.skips)
+    {
+        backoff.skips--;
+        return 0;
+    }
+    idleStats.looks++;
+
+    u32 done = 0;
+    for (u32 pass = 0; pass < 2; pass++)
+    {
+        u8 V[CHIP8_TOTAL_GENERAL_PURPOSE_REGISTERS];
+        memcpy(V, state.V, sizeof(V));
+        u16 I = state.I;
+        u8 DT = state.DT;
+        u8 ST = state.ST;
+        u32 phase = state.timerPhase;
+        bool timed = false;
+        u32 length = 0;
+        do
+        {
+            INSTRUCTION ins = decodeOpcode(Handlers::fetch(state));
+            if (length == CHIP8_IDLE_MAX_LOOP || done + length >= count || !idleClass(ins.cls) || runEngine(1) == 0)
+            {
+                missIdle(backoff);
+                return done + length;
+            }
+            timed = timed || idleTimerClass(ins.cls);
+            length++;
+        } while (CHIP8_ADDRESS(state.PC) != start);
+        done += length;
+
+        bool ticked = phase + length >= state.instructionsPerFrame;
+        if (memcmp(V, state.V, sizeof(V)) != 0 || I != state.I || DT != state.DT || ST != state.ST || (timed && ticked))
+            continue;
+
+        /* Every pass from here does the same until the timer ticks, the tick comes at the end of the instruction that
+         * completes the frame so the passes skipped have to end before that instruction */
+        u32 room = count - done;
+        u32 toTick = state.instructionsPerFrame - state.timerPhase;
+        if (timed && room > toTick - 1)
+            room = toTick - 1;
+        u32 skipped = room - room % length;
+        // No room for a whole pass before the tick or the end of the call is as good as a miss
+        if (skipped == 0)
+            break;
+        Handlers::tickTimers(*this, skipped);
+        done += skipped;
+        idleStats.loops++;
+        idleStats.elided += skipped;
+        backoff.misses = 0;
+        // A loop using the timers is looked at again straight after the tick
+        resume = timed ? toTick - skipped : CHIP8_IDLE_SLICE;
+        return done;
+    }
+
+    missIdle(backoff);
+    return done;
+}
+
+// Each miss in a row at an address waits twice as long as the last before looking there again
+void Chip8Core::missIdle(IDLE_BACKOFF& backoff)
+{
+    backoff.skips = CHIP8_IDLE_BACKOFF << backoff.misses;
+    if (backoff.misses < CHIP8_IDLE_MAX_BACKOFF_SHIFT)
+        backoff.misses++;
+}
@@ -0,0 +1,887 @@
+#include <stddef.h>
+#include <string.h>
+#include "Jit.h"
+#include "Opcode.h"
+
+#if CHIP8_JIT_SUPPORTED
+
+#ifdef _WIN32
+    #include <Windows.h>
+#else
+    #include <sys/mman.h>
+#endif
+
+// x86-64 register numbers
+enum X64_REGISTER
+{
+    RAX = 0, RCX = 1, RDX = 2, RBX = 3, RSP = 4, RBP = 5, RSI = 6, RDI = 7,
+    R8 = 8, R9 = 9, R10 = 10, R11 = 11, R12 = 12, R13 = 13, R14 = 14, R15 = 15
+};
+
+// x86-64 condition codes
+enum X64_CONDITION
+{
+    CC_B = 0x2, CC_AE = 0x3, CC_E = 0x4, CC_NE = 0x5, CC_A = 0x7
+};
+
+/* Register use inside translated code:
+ * rbx holds the CHIP8_STATE pointer, r12d the instructions left in the budget, r13d the "I" register and bpl a
+ * condition for skips. rax and rcx are scratch and the "V" registers a block uses are given registers from the pool. */
+static const u8 registerPool[] = {RDX, RSI, RDI, R8, R9, R10, R11, R14, R15};
+#define CHIP8_JIT_REGISTER_POOL_SIZE (sizeof(registerPool) / sizeof(registerPool[0]))
+
+#define OFFSET_V(i) ((u32) (offsetof(CHIP8_STATE, V) + (i)))
+#define OFFSET_I ((u32) offsetof(CHIP8_STATE, I))
+#define OFFSET_PC ((u32) offsetof(CHIP8_STATE, PC))
+#define OFFSET_DT ((u32) offsetof(CHIP8_STATE, DT))
+#define OFFSET_ST ((u32) offsetof(CHIP8_STATE, ST))
+#define OFFSET_KEYS ((u32) offsetof(CHIP8_STATE, keys))
+#define OFFSET_TIMER_PHASE ((u32) offsetof(CHIP8_STATE, timerPhase))
+#define OFFSET_INSTRUCTIONS_PER_FRAME ((u32) offsetof(CHIP8_STATE, instructionsPerFrame))
+
+// Writes x86-64 machine code into the arena, only the handful of instruction forms the translator needs are here
+class X64Emitter
+{
+    public:
+        X64Emitter(u8* code, u32 capacity)
+        {
+            this->code = code;
+            this->capacity = capacity;
+            this->size = 0;
+        }
+
+        bool overflowed() { return size > capacity; }
+        u32 offset() { return size; }
+        u8* at(u32 offset) { return code + offset; }
+
+        void byte(u8 value)
+        {
+            if (size < capacity)
+                code[size] = value;
+            size++;
+        }
+
+        void word(u16 value)
+        {
+            byte(value & 0xff);
+            byte(value >> 8);
+        }
+
+        void dword(u32 value)
+        {
+            word(value & 0xffff);
+            word(value >> 16);
+        }
+
+        // A REX prefix is always written for byte registers so that 4 to 7 mean spl, bpl, sil and dil
+        void rex(bool w, u8 reg, u8 index, u8 rm)
+        {
+            byte(0x40 | (w ? 8 : 0) | ((reg >> 3) << 2) | ((index >> 3) << 1) | (rm >> 3));
+        }
+
+        void modrmRegister(u8 reg, u8 rm)
+        {
+            byte(0xC0 | ((reg & 7) << 3) | (rm & 7));
+        }
+
+        // ModRM for [rbx + disp32]
+        void modrmState(u8 reg, u32 displacement)
+        {
+            byte(0x80 | ((reg & 7) << 3) | RBX);
+            dword(displacement);
+        }
+
+        // "op r/m8, r8" forms such as mov 0x88, add 0x00, or 0x08, and 0x20, sub 0x28, xor 0x30 and cmp 0x38
+        void byteRegisterRegister(u8 op, u8 dst, u8 src)
+        {
+            rex(false, src, 0, dst);
+            byte(op);
+            modrmRegister(src, dst);
+        }
+
+        // "op r/m8, imm8" forms where "extension" is add 0, or 1, and 4, sub 5, xor 6 and cmp 7
+        void byteRegisterImmediate(u8 extension, u8 dst, u8 value)
+        {
+            rex(false, 0, 0, dst);
+            byte(0x80);
+            modrmRegister(extension, dst);
+            byte(value);
+        }
+
+        void movByteImmediate(u8 dst, u8 value)
+        {
+            rex(false, 0, 0, dst);
+            byte(0xB0 | (dst & 7));
+            byte(value);
+        }
+
+        // shl 4 or shr 5 of an 8 bit register by one
+        void shiftByteOne(u8 extension, u8 dst)
+        {
+            rex(false, 0, 0, dst);
+            byte(0xD0);
+            modrmRegister(extension, dst);
+        }
+
+        void negByte(u8 dst)
+        {
+            rex(false, 0, 0, dst);
+            byte(0xF6);
+            modrmRegister(3, dst);
+        }
+
+        void setcc(u8 condition, u8 dst)
+        {
+            rex(false, 0, 0, dst);
+            byte(0x0F);
+            byte(0x90 | condition);
+            modrmRegister(0, dst);
+        }
+
+        void testByte(u8 a, u8 b)
+        {
+            byteRegisterRegister(0x84, a, b);
+        }
+
+        // movzx r32, byte [rbx + disp32]
+        void loadStateByte(u8 dst, u32 displacement)
+        {
+            rex(false, dst, 0, 0);
+            byte(0x0F);
+            byte(0xB6);
+            modrmState(dst, displacement);
+        }
+
+        // mov byte [rbx + disp32], r8
+        void storeStateByte(u32 displacement, u8 src)
+        {
+            rex(false, src, 0, 0);
+            byte(0x88);
+            modrmState(src, displacement);
+        }
+
+        // movzx r32, word [rbx + disp32]
+        void loadStateWord(u8 dst, u32 displacement)
+        {
+            rex(false, dst, 0, 0);
+            byte(0x0F);
+            byte(0xB7);
+            modrmState(dst, displacement);
+        }
+
+        // mov word [rbx + disp32], r16
+        void storeStateWord(u32 displacement, u8 src)
+        {
+            byte(0x66);
+            rex(false, src, 0, 0);
+            byte(0x89);
+            modrmState(src, displacement);
+        }
+
+        // mov r32, dword [rbx + disp32]
+        void loadStateDword(u8 dst, u32 displacement)
+        {
+            rex(false, dst, 0, 0);
+            byte(0x8B);
+            modrmState(dst, displacement);
+        }
+
+        // mov dword [rbx + disp32], r32
+        void storeStateDword(u32 displacement, u8 src)
+        {
+            rex(false, src, 0, 0);
+            byte(0x89);
+            modrmState(src, displacement);
+        }
+
+        // "op byte [rbx + disp32], imm8" where "extension" is add 0, adc 2 and sub 5
+        void stateByteImmediate(u8 extension, u32 displacement, u8 value)
+        {
+            byte(0x80);
+            modrmState(extension, displacement);
+            byte(value);
+        }
+
+        // "op r/m32, r32" forms such as sub 0x29 and cmp 0x39
+        void dwordRegisterRegister(u8 op, u8 dst, u8 src)
+        {
+            rex(false, src, 0, dst);
+            byte(op);
+            modrmRegister(src, dst);
+        }
+
+        // mov word [rbx + disp32], imm16
+        void storeStateWordImmediate(u32 displacement, u16 value)
+        {
+            byte(0x66);
+            byte(0xC7);
+            modrmState(0, displacement);
+            word(value);
+        }
+
+        // movzx r32, r8
+        void movzxByte(u8 dst, u8 src)
+        {
+            rex(false, dst, 0, src);
+            byte(0x0F);
+            byte(0xB6);
+            modrmRegister(dst, src);
+        }
+
+        // mov r32, imm32
+        void movImmediate(u8 dst, u32 value)
+        {
+            if (dst >= 8)
+                byte(0x41);
+            byte(0xB8 | (dst & 7));
+            dword(value);
+        }
+
+        // "op r/m32, imm32" where "extension" is add 0, and 4, sub 5 and cmp 7
+        void dwordImmediate(u8 extension, u8 dst, u32 value)
+        {
+            if (dst >= 8)
+                byte(0x41);
+            byte(0x81);
+            modrmRegister(extension, dst);
+            dword(value);
+        }
+
+        // add r16, r16
+        void addWord(u8 dst, u8 src)
+        {
+            byte(0x66);
+            rex(false, src, 0, dst);
+            byte(0x01);
+            modrmRegister(src, dst);
+        }
+
+        // imul r32, r32, imm8
+        void imulImmediate(u8 dst, u8 src, u8 value)
+        {
+            rex(false, dst, 0, src);
+            byte(0x6B);
+            modrmRegister(dst, src);
+            byte(value);
+        }
+
+        // cmp byte [rbx + rax + disp32], 0
+        void compareKeyZero(u32 displacement)
+        {
+            byte(0x80);
+            byte(0x84 | (7 << 3));
+            byte((RAX << 3) | RBX);
+            dword(displacement);
+            byte(0);
+        }
+
+        // Emits a jump with a 32 bit displacement and returns the offset of the displacement so it can be patched
+        u32 jump(u8 condition, bool conditional)
+        {
+            if (conditional)
+            {
+                byte(0x0F);
+                byte(0x80 | condition);
+            }
+            else
+            {
+                byte(0xE9);
+            }
+            u32 patch = offset();
+            dword(0);
+            return patch;
+        }
+
+        void patch(u32 patchOffset, const u8* target)
+        {
+            if (overflowed())
+                return;
+            s32 displacement = (s32) (target - (code + patchOffset + 4));
+            memcpy(code + patchOffset, &displacement, sizeof(displacement));
+        }
+
+        void push(u8 reg)
+        {
+            if (reg >= 8)
+                byte(0x41);
+            byte(0x50 | (reg & 7));
+        }
+
+        void pop(u8 reg)
+        {
+            if (reg >= 8)
+                byte(0x41);
+            byte(0x58 | (reg & 7));
+        }
+
+    private:
+        u8* code;
+        u32 capacity;
+        u32 size;
+};
+
+/* Counts "instructions" on the timer phase and ticks the timers once for every frame it passes, the same as
+ * "Handlers::tickTimers". The loop only runs when a frame has passed, a tick is a sub and an adc so a timer at zero
+ * stays there */
+static void emitTimerTicks(X64Emitter& e, u32 instructions)
+{
+    e.loadStateDword(RAX, OFFSET_TIMER_PHASE);
+    e.dwordImmediate(0, RAX, instructions);
+    e.loadStateWord(RCX, OFFSET_INSTRUCTIONS_PER_FRAME);
+    e.dwordRegisterRegister(0x39, RAX, RCX);
+    u32 skip = e.jump(CC_B, true);
+
+    u32 tick = e.offset();
+    e.stateByteImmediate(5, OFFSET_DT, 1);
+    e.stateByteImmediate(2, OFFSET_DT, 0);
+    e.stateByteImmediate(5, OFFSET_ST, 1);
+    e.stateByteImmediate(2, OFFSET_ST, 0);
+    e.dwordRegisterRegister(0x29, RAX, RCX);
+    e.dwordRegisterRegister(0x39, RAX, RCX);
+    e.patch(e.jump(CC_AE, true), e.at(tick));
+
+    e.patch(skip, e.at(e.offset()));
+    e.storeStateDword(OFFSET_TIMER_PHASE, RAX);
+}
+
+// How the translator treats each opcode class
+enum JIT_KIND
+{
+    // Not translated, the block ends before it and the interpreter executes it
+    JIT_STOP,
+    // Translated and the block carries on after it
+    JIT_STRAIGHT,
+    // Translated and ends the block
+    JIT_END
+};
+
+static JIT_KIND jitKind(const INSTRUCTION& ins, u32 quirks)
+{
+    // Translated code follows the plain handlers, anything a quirk changes is left to the interpreter
+    if (quirksAffect(ins.cls, quirks))
+        return JIT_STOP;
+
+    switch(ins.cls)
+    {
+        case OPCODE_LD_VX_KK:
+        case OPCODE_ADD_VX_KK:
+        case OPCODE_LD_VX_VY:
+        case OPCODE_OR:
+        case OPCODE_AND:
+        case OPCODE_XOR:
+        case OPCODE_LD_I:
+        case OPCODE_ADD_I_VX:
+        case OPCODE_LD_F_VX:
+        case OPCODE_LD_VX_DT:
+        case OPCODE_LD_DT_VX:
+            return JIT_STRAIGHT;
+
+        // "Fx18" is left to the interpreter so the core notes where it turned the buzzer on or off
+        case OPCODE_LD_ST_VX:
+            return JIT_STOP;
+
+        // The interpreter writes "VF" before the result so these are only translated when "VF" is not an operand
+        case OPCODE_ADD_VX_VY:
+        case OPCODE_SUB:
+        case OPCODE_SUBN:
+            return (ins.x != 0xf && ins.y != 0xf) ? JIT_STRAIGHT : JIT_STOP;
+        case OPCODE_SHR:
+        case OPCODE_SHL:
+            return ins.x != 0xf ? JIT_STRAIGHT : JIT_STOP;
+
+        case OPCODE_JP:
+        case OPCODE_SE_VX_KK:
+        case OPCODE_SNE_VX_KK:
+        case OPCODE_SE_VX_VY:
+        case OPCODE_SNE_VX_VY:
+        case OPCODE_SKP:
+        case OPCODE_SKNP:
+            return JIT_END;
+
+        default:
+            return JIT_STOP;
+    }
+}
+
+// The "V" registers an instruction reads or writes
+static u16 jitRegisters(const INSTRUCTION& ins)
+{
+    switch(ins.cls)
+    {
+        case OPCODE_LD_I:
+        case OPCODE_JP:
+            return 0;
+        case OPCODE_LD_VX_VY:
+        case OPCODE_OR:
+        case OPCODE_AND:
+        case OPCODE_XOR:
+        case OPCODE_SE_VX_VY:
+        case OPCODE_SNE_VX_VY:
+            return (1 << ins.x) | (1 << ins.y);
+        case OPCODE_ADD_VX_VY:
+        case OPCODE_SUB:
+        case OPCODE_SUBN:
+            return (1 << ins.x) | (1 << ins.y) | (1 << 0xf);
+        case OPCODE_SHR:
+        case OPCODE_SHL:
+            return (1 << ins.x) | (1 << 0xf);
+        default:
+            return 1 << ins.x;
+    }
+}
+
+// The "V" registers an instruction writes
+static u16 jitWrites(const INSTRUCTION& ins)
+{
+    switch(ins.cls)
+    {
+        case OPCODE_LD_VX_KK:
+        case OPCODE_ADD_VX_KK:
+        case OPCODE_LD_VX_VY:
+        case OPCODE_OR:
+        case OPCODE_AND:
+        case OPCODE_XOR:
+        case OPCODE_LD_VX_DT:
+            return 1 << ins.x;
+        case OPCODE_ADD_VX_VY:
+        case OPCODE_SUB:
+        case OPCODE_SUBN:
+        case OPCODE_SHR:
+        case OPCODE_SHL:
+            return (1 << ins.x) | (1 << 0xf);
+        default:
+            return 0;
+    }
+}
+
+static u16 countBits(u16 value)
+{
+    u16 total = 0;
+    for (; value; value &= value - 1)
+        total++;
+    return total;
+}
+
+Jit::Jit()
+{
+    #ifdef _WIN32
+        arena = (u8*) VirtualAlloc(NULL, CHIP8_JIT_ARENA_SIZE, MEM_COMMIT | MEM_RESERVE, PAGE_EXECUTE_READWRITE);
+    #else
+        arena = (u8*) mmap(NULL, CHIP8_JIT_ARENA_SIZE, PROT_READ | PROT_WRITE | PROT_EXEC, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (arena == MAP_FAILED)
+            arena = NULL;
+    #endif
+
+    quirks = 0;
+    memset(&stats, 0, sizeof(stats));
+    flush();
+    stats.flushes = 0;
+}
+
+Jit::~Jit()
+{
+    if (arena == NULL)
+        return;
+
+    #ifdef _WIN32
+        VirtualFree(arena, 0, MEM_RELEASE);
+    #else
+        munmap(arena, CHIP8_JIT_ARENA_SIZE);
+    #endif
+}
+
+bool Jit::isAvailable()
+{
+    return arena != NULL;
+}
+
+void Jit::flush()
+{
+    memset(blocks, 0, sizeof(blocks));
+    memset(interpretOnly, 0, sizeof(interpretOnly));
+    memset(covered, 0, sizeof(covered));
+    memset(totalPendingLinks, 0, sizeof(totalPendingLinks));
+    used = 0;
+    stats.flushes++;
+    if (arena != NULL)
+        emitTrampolines();
+}
+
+JIT_STATS Jit::getStats()
+{
+    return stats;
+}
+
+void Jit::emitTrampolines()
+{
+    X64Emitter e(arena, CHIP8_JIT_ARENA_SIZE);
+
+    // The entry saves every register translated code uses that the calling convention wants kept
+    entry = (ENTRY) e.at(e.offset());
+    static const u8 saved[] = {RBX, RBP, RSI, RDI, R12, R13, R14, R15};
+    for (u8 reg : saved)
+        e.push(reg);
+
+    #ifdef _WIN32
+        // state in rcx, budget in edx, block in r8
+        e.byte(0x48); e.byte(0x89); e.modrmRegister(RCX, RBX);
+        e.byte(0x41); e.byte(0x89); e.modrmRegister(RDX, R12);
+        e.byte(0x41); e.byte(0xFF); e.modrmRegister(4, R8);
+    #else
+        // state in rdi, budget in esi, block in rdx
+        e.byte(0x48); e.byte(0x89); e.modrmRegister(RDI, RBX);
+        e.byte(0x41); e.byte(0x89); e.modrmRegister(RSI, R12);
+        e.byte(0xFF); e.modrmRegister(4, RDX);
+    #endif
+
+    // The exit hands back what is left of the budget
+    exitStub = e.at(e.offset());
+    e.byte(0x44); e.byte(0x89); e.modrmRegister(R12, RAX);
+    for (int i = sizeof(saved) - 1; i >= 0; i--)
+        e.pop(saved[i]);
+    e.byte(0xC3);
+
+    used = e.offset();
+}
+
+const u8* Jit::getBlock(const CHIP8_STATE& state, u16 address)
+{
+    if (arena == NULL || address >= CHIP8_MEMORY_SIZE || interpretOnly[address])
+        return NULL;
+
+    if (blocks[address] == NULL)
+        return translate(state, address);
+
+    return blocks[address];
+}
+
+u32 Jit::run(CHIP8_STATE& state, u32 budget, const u8* block)
+{
+    return budget - entry(&state, budget, block);
+}
+
+u8* Jit::translate(const CHIP8_STATE& state, u16 address)
+{
+    // Find where the block ends and which "V" registers it uses
+    INSTRUCTION instructions[CHIP8_JIT_MAX_BLOCK_INSTRUCTIONS];
+    u32 total = 0;
+    u16 usedRegisters = 0;
+    u16 writtenRegisters = 0;
+    bool usesI = false;
+    bool writesI = false;
+    bool ended = false;
+    u16 pc = address;
+    while (total < CHIP8_JIT_MAX_BLOCK_INSTRUCTIONS && pc < CHIP8_MEMORY_SIZE - 0x10)
+    {
+        INSTRUCTION ins = decodeOpcode((state.memory[pc] << 8) | state.memory[pc + 1]);
+        JIT_KIND kind = jitKind(ins, quirks);
+        if (kind == JIT_STOP)
+            break;
+
+        u16 registers = usedRegisters | jitRegisters(ins);
+        if (countBits(registers) > CHIP8_JIT_REGISTER_POOL_SIZE)
+            break;
+
+        usedRegisters = registers;
+        writtenRegisters |= jitWrites(ins);
+        if (ins.cls == OPCODE_LD_I || ins.cls == OPCODE_ADD_I_VX || ins.cls == OPCODE_LD_F_VX)
+        {
+            usesI = true;
+            writesI = true;
+        }
+
+        instructions[total++] = ins;
+        pc += 2;
+        if (kind == JIT_END)
+        {
+            ended = true;
+            break;
+        }
+    }
+
+    if (total == 0)
+    {
+        interpretOnly[address] = true;
+        covered[address] = true;
+        covered[address + 1] = true;
+        stats.interpreted++;
+        return NULL;
+    }
+
+    // Start again with an empty arena if this block might not fit
+    if (used + 2048 > CHIP8_JIT_ARENA_SIZE)
+    {
+        flush();
+        return translate(state, address);
+    }
+
+    X64Emitter e(arena + used, CHIP8_JIT_ARENA_SIZE - used);
+    u8* block = e.at(0);
+
+    // Give each "V" register the block uses a host register
+    s8 host[CHIP8_TOTAL_GENERAL_PURPOSE_REGISTERS];
+    u32 next = 0;
+    for (int v = 0; v < CHIP8_TOTAL_GENERAL_PURPOSE_REGISTERS; v++)
+        host[v] = (usedRegisters & (1 << v)) ? registerPool[next++] : -1;
+
+    // Leave straight away if the budget cannot cover the whole block
+    e.dwordImmediate(7, R12, total);
+    u32 bail = e.jump(CC_B, true);
+    e.dwordImmediate(5, R12, total);
+
+    for (int v = 0; v < CHIP8_TOTAL_GENERAL_PURPOSE_REGISTERS; v++)
+    {
+        if (host[v] >= 0)
+            e.loadStateByte(host[v], OFFSET_V(v));
+    }
+    if (usesI)
+        e.loadStateWord(R13, OFFSET_I);
+
+    // The timers count every instruction, the counts are added up and only applied when something uses the timers
+    u32 ticked = 0;
+    u16 exitTargets[2];
+    u32 exits = 0;
+    for (u32 i = 0; i < total; i++)
+    {
+        const INSTRUCTION& ins = instructions[i];
+        u16 at = address + (i * 2);
+        s8 vx = host[ins.x];
+        s8 vy = host[ins.y];
+        s8 vf = host[0xf];
+        switch(ins.cls)
+        {
+            case OPCODE_LD_VX_KK:
+                e.movByteImmediate(vx, ins.kk);
+            break;
+            case OPCODE_ADD_VX_KK:
+                e.byteRegisterImmediate(0, vx, ins.kk);
+            break;
+            case OPCODE_LD_VX_VY:
+                e.byteRegisterRegister(0x88, vx, vy);
+            break;
+            case OPCODE_OR:
+                e.byteRegisterRegister(0x08, vx, vy);
+            break;
+            case OPCODE_AND:
+                e.byteRegisterRegister(0x20, vx, vy);
+            break;
+            case OPCODE_XOR:
+                e.byteRegisterRegister(0x30, vx, vy);
+            break;
+            case OPCODE_ADD_VX_VY:
+                e.byteRegisterRegister(0x00, vx, vy);
+                e.setcc(CC_B, vf);
+            break;
+            case OPCODE_SUB:
+                e.byteRegisterRegister(0x38, vx, vy);
+                e.setcc(CC_A, vf);
+                e.byteRegisterRegister(0x28, vx, vy);
+            break;
+            case OPCODE_SUBN:
+                e.byteRegisterRegister(0x38, vy, vx);
+                e.setcc(CC_A, vf);
+                if (ins.x == ins.y)
+                {
+                    e.movByteImmediate(vx, 0);
+                }
+                else
+                {
+                    e.negByte(vx);
+                    e.byteRegisterRegister(0x00, vx, vy);
+                }
+            break;
+            case OPCODE_SHR:
+                e.shiftByteOne(5, vx);
+                e.setcc(CC_B, vf);
+            break;
+            case OPCODE_SHL:
+                e.shiftByteOne(4, vx);
+                e.setcc(CC_B, vf);
+            break;
+            case OPCODE_LD_I:
+                e.movImmediate(R13, ins.nnn);
+            break;
+            case OPCODE_ADD_I_VX:
+                e.movzxByte(RAX, vx);
+                e.addWord(R13, RAX);
+            break;
+            case OPCODE_LD_F_VX:
+                e.movzxByte(R13, vx);
+                e.dwordImmediate(4, R13, 0x0f);
+                e.imulImmediate(R13, R13, 5);
+            break;
+            case OPCODE_LD_VX_DT:
+                if (i > ticked)
+                {
+                    emitTimerTicks(e, i - ticked);
+                    ticked = i;
+                }
+                e.loadStateByte(RAX, OFFSET_DT);
+                e.byteRegisterRegister(0x88, vx, RAX);
+            break;
+            case OPCODE_LD_DT_VX:
+                if (i > ticked)
+                {
+                    emitTimerTicks(e, i - ticked);
+                    ticked = i;
+                }
+                e.storeStateByte(OFFSET_DT, vx);
+            break;
+            case OPCODE_JP:
+                exitTargets[exits++] = ins.nnn;
+            break;
+            case OPCODE_SE_VX_KK:
+            case OPCODE_SNE_VX_KK:
+                e.byteRegisterImmediate(7, vx, ins.kk);
+                e.setcc(ins.cls == OPCODE_SE_VX_KK ? CC_E : CC_NE, RBP);
+            break;
+            case OPCODE_SE_VX_VY:
+            case OPCODE_SNE_VX_VY:
+                e.byteRegisterRegister(0x38, vx, vy);
+                e.setcc(ins.cls == OPCODE_SE_VX_VY ? CC_E : CC_NE, RBP);
+            break;
+            case OPCODE_SKP:
+            case OPCODE_SKNP:
+                e.movzxByte(RAX, vx);
+                e.dwordImmediate(4, RAX, 0x0f);
+                e.compareKeyZero(OFFSET_KEYS);
+                e.setcc(ins.cls == OPCODE_SKP ? CC_NE : CC_E, RBP);
+            break;
+        }
+
+        // Skips leave the block at the next instruction or the one after it
+        if (ins.cls != OPCODE_JP && jitKind(ins, quirks) == JIT_END)
+        {
+            exitTargets[exits++] = at + 2;
+            exitTargets[exits++] = at + 4;
+        }
+    }
+
+    if (!ended)
+        exitTargets[exits++] = address + (total * 2);
+
+    // Put the registers back in the state and apply the timer ticks that are left
+    for (int v = 0; v < CHIP8_TOTAL_GENERAL_PURPOSE_REGISTERS; v++)
+    {
+        if (writtenRegisters & (1 << v))
+            e.storeStateByte(OFFSET_V(v), host[v]);
+    }
+    if (writesI)
+        e.storeStateWord(OFFSET_I, R13);
+    if (total > ticked)
+    {
+        emitTimerTicks(e, total - ticked);
+    }
+
+    // Each exit sets "PC" then jumps to the exit stub, the jump is chained to the target block once it exists
+    u32 skipJump = 0;
+    if (exits == 2)
+    {
+        e.testByte(RBP, RBP);
+        skipJump = e.jump(CC_NE, true);
+    }
+
+    u32 exitJumps[2];
+    for (u32 i = 0; i < exits; i++)
+    {
+        if (i == 1)
+            e.patch(skipJump, e.at(e.offset()));
+        e.storeStateWordImmediate(OFFSET_PC, exitTargets[i]);
+        exitJumps[i] = e.jump(0, false);
+    }
+
+    e.patch(bail, e.at(e.offset()));
+    e.storeStateWordImmediate(OFFSET_PC, address);
+    u32 bailJump = e.jump(0, false);
+
+    if (e.overflowed())
+    {
+        flush();
+        return translate(state, address);
+    }
+
+    e.patch(bailJump, exitStub);
+    for (u32 i = 0; i < exits; i++)
+    {
+        u16 target = exitTargets[i];
+        if (target < CHIP8_MEMORY_SIZE && blocks[target] != NULL)
+        {
+            e.patch(exitJumps[i], blocks[target]);
+            stats.links++;
+        }
+        else
+        {
+            e.patch(exitJumps[i], exitStub);
+            if (target < CHIP8_MEMORY_SIZE && totalPendingLinks[target] < 4)
+                pendingLinks[target][totalPendingLinks[target]++] = (block - arena) + exitJumps[i];
+        }
+    }
+
+    used += e.offset();
+    blocks[address] = block;
+    memset(&covered[address], 1, total * 2);
+    stats.blocks++;
+
+    // Chain every exit that was waiting for this block
+    X64Emitter linker(arena, CHIP8_JIT_ARENA_SIZE);
+    for (u32 i = 0; i < totalPendingLinks[address]; i++)
+    {
+        linker.patch(pendingLinks[address][i], block);
+        stats.links++;
+    }
+    totalPendingLinks[address] = 0;
+
+    return block;
+}
+
+#else
+
+// Without x86-64 every address is left to the interpreter
+Jit::Jit()
+{
+    arena = NULL;
+    quirks = 0;
+    memset(&stats, 0, sizeof(stats));
+    memset(covered, 0, sizeof(covered));
+}
+
+Jit::~Jit()
+{
+
+}
+
+bool Jit::isAvailable()
+{
+    return false;
+}
+
+const u8* Jit::getBlock(const CHIP8_STATE& state, u16 address)
+{
+    return NULL;
+}
+
+u32 Jit::run(CHIP8_STATE& state, u32 budget, const u8* block)
+{
+    return 0;
+}
+
+void Jit::flush()
+{
+    stats.flushes++;
+}
+
+JIT_STATS Jit::getStats()
+{
+    return stats;
+}
+
+#endif // CHIP8_JIT_SUPPORTED
+
+void Jit::setQuirks(u32 quirks)
+{
+    if (quirks == this->quirks)
+        return;
+
+    this->quirks = quirks;
+    flush();
+}
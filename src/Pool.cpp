@@ -0,0 +1,223 @@
+#include <string.h>
+#include "Chip8Core.h"
+#include "Pool.h"
+
+Chip8Pool::Chip8Pool(u32 slots, u32 pages, bool copyOnWrite)
+{
+    totalSlots = slots;
+    totalPages = pages;
+    this->copyOnWrite = copyOnWrite;
+    this->slots.reset(new CHIP8_FORK[slots]);
+    this->pages.reset(new u8[pages][CHIP8_POOL_PAGE_SIZE]);
+    pageRefs.reset(new u32[pages]);
+    freePages.reset(new u32[pages]);
+    memset(&stats, 0, sizeof(stats));
+
+    // Both free lists start in order so the first forks use the lowest slots and pages
+    for (u32 s = 0; s < slots; s++)
+        this->slots[s].nextFree = s + 1 < slots ? s + 1 : CHIP8_POOL_NONE;
+    freeSlot = slots ? 0 : CHIP8_POOL_NONE;
+    for (u32 p = 0; p < pages; p++)
+    {
+        pageRefs[p] = 0;
+        freePages[p] = pages - 1 - p;
+    }
+    totalFreePages = pages;
+}
+
+Chip8Pool::~Chip8Pool()
+{
+
+}
+
+u32 Chip8Pool::fork(Chip8Core& core, u32 parent)
+{
+    u32 slot = allocateSlot();
+    if (slot == CHIP8_POOL_NONE)
+        return CHIP8_POOL_NONE;
+
+    CHIP8_FORK& fork = slots[slot];
+    const CHIP8_STATE& state = core.getState();
+    memcpy(fork.machine, &state, CHIP8_POOL_MACHINE_SIZE);
+    fork.quirkProfile = core.getQuirkProfile();
+    fork.quit = core.hasQuit();
+
+    const CHIP8_FORK* from = copyOnWrite && parent != CHIP8_POOL_NONE ? &slots[parent] : NULL;
+    for (u32 p = 0; p < CHIP8_POOL_PAGES; p++)
+    {
+        const u8* memory = &state.memory[p * CHIP8_POOL_PAGE_SIZE];
+        if (from && memcmp(pages[from->pages[p]], memory, CHIP8_POOL_PAGE_SIZE) == 0)
+        {
+            fork.pages[p] = from->pages[p];
+            pageRefs[fork.pages[p]]++;
+            continue;
+        }
+
+        fork.pages[p] = allocatePage();
+        if (fork.pages[p] == CHIP8_POOL_NONE)
+        {
+            abandon(slot, p);
+            return CHIP8_POOL_NONE;
+        }
+        memcpy(pages[fork.pages[p]], memory, CHIP8_POOL_PAGE_SIZE);
+    }
+
+    stats.forks++;
+    return slot;
+}
+
+u32 Chip8Pool::fork(u32 parent)
+{
+    u32 slot = allocateSlot();
+    if (slot == CHIP8_POOL_NONE)
+        return CHIP8_POOL_NONE;
+
+    CHIP8_FORK& fork = slots[slot];
+    const CHIP8_FORK& from = slots[parent];
+    fork = from;
+    if (copyOnWrite)
+    {
+        for (u32 p = 0; p < CHIP8_POOL_PAGES; p++)
+            pageRefs[fork.pages[p]]++;
+    }
+    else
+    {
+        for (u32 p = 0; p < CHIP8_POOL_PAGES; p++)
+        {
+            fork.pages[p] = allocatePage();
+            if (fork.pages[p] == CHIP8_POOL_NONE)
+            {
+                abandon(slot, p);
+                return CHIP8_POOL_NONE;
+            }
+            memcpy(pages[fork.pages[p]], pages[from.pages[p]], CHIP8_POOL_PAGE_SIZE);
+        }
+    }
+
+    stats.forks++;
+    return slot;
+}
+
+void Chip8Pool::release(u32 slot)
+{
+    CHIP8_FORK& fork = slots[slot];
+    for (u32 p = 0; p < CHIP8_POOL_PAGES; p++)
+        releasePage(fork.pages[p]);
+    fork.nextFree = freeSlot;
+    freeSlot = slot;
+    stats.liveSlots--;
+}
+
+void Chip8Pool::load(u32 slot, Chip8Core& core)
+{
+    const CHIP8_FORK& fork = slots[slot];
+    CHIP8_STATE& state = core.state;
+    memcpy(&state, fork.machine, CHIP8_POOL_MACHINE_SIZE);
+    for (u32 p = 0; p < CHIP8_POOL_PAGES; p++)
+        memcpy(&state.memory[p * CHIP8_POOL_PAGE_SIZE], pages[fork.pages[p]], CHIP8_POOL_PAGE_SIZE);
+
+    // The same as loading a savestate, memory may hold different code now
+    if (core.quirkProfile != fork.quirkProfile)
+        core.setQuirkProfile(fork.quirkProfile);
+    else
+        core.flushDecodeCache();
+    core.dirtyRows = 0xffffffff;
+    core.quit = fork.quit;
+}
+
+bool Chip8Pool::store(Chip8Core& core, u32 slot)
+{
+    CHIP8_FORK& fork = slots[slot];
+    const CHIP8_STATE& state = core.getState();
+
+    // Find the pages the core changed first so the slot is left alone if there are not enough pages to copy them into
+    u32 changed = 0;
+    u32 copies = 0;
+    for (u32 p = 0; p < CHIP8_POOL_PAGES; p++)
+    {
+        if (memcmp(pages[fork.pages[p]], &state.memory[p * CHIP8_POOL_PAGE_SIZE], CHIP8_POOL_PAGE_SIZE) != 0)
+        {
+            changed |= 1u << p;
+            copies += pageRefs[fork.pages[p]] > 1;
+        }
+    }
+    if (copies > totalFreePages)
+        return false;
+
+    memcpy(fork.machine, &state, CHIP8_POOL_MACHINE_SIZE);
+    fork.quirkProfile = core.getQuirkProfile();
+    fork.quit = core.hasQuit();
+    for (u32 p = 0; p < CHIP8_POOL_PAGES; p++)
+    {
+        if (!(changed & (1u << p)))
+            continue;
+
+        // A page only this slot points at is written in place, a shared one is copied first
+        u32 page = fork.pages[p];
+        if (pageRefs[page] > 1)
+        {
+            pageRefs[page]--;
+            fork.pages[p] = page = allocatePage();
+            stats.pageCopies++;
+        }
+        memcpy(pages[page], &state.memory[p * CHIP8_POOL_PAGE_SIZE], CHIP8_POOL_PAGE_SIZE);
+    }
+    return true;
+}
+
+void Chip8Pool::getState(u32 slot, CHIP8_STATE& state)
+{
+    const CHIP8_FORK& fork = slots[slot];
+    memcpy(&state, fork.machine, CHIP8_POOL_MACHINE_SIZE);
+    for (u32 p = 0; p < CHIP8_POOL_PAGES; p++)
+        memcpy(&state.memory[p * CHIP8_POOL_PAGE_SIZE], pages[fork.pages[p]], CHIP8_POOL_PAGE_SIZE);
+}
+
+bool Chip8Pool::isCopyOnWrite()
+{
+    return copyOnWrite;
+}
+
+POOL_STATS Chip8Pool::getStats()
+{
+    POOL_STATS current = stats;
+    current.livePages = totalPages - totalFreePages;
+    current.liveBytes = (u64) current.liveSlots * sizeof(CHIP8_FORK) + (u64) current.livePages * CHIP8_POOL_PAGE_SIZE;
+    return current;
+}
+
+u32 Chip8Pool::allocatePage()
+{
+    if (totalFreePages == 0)
+        return CHIP8_POOL_NONE;
+    u32 page = freePages[--totalFreePages];
+    pageRefs[page] = 1;
+    return page;
+}
+
+void Chip8Pool::releasePage(u32 page)
+{
+    if (--pageRefs[page] == 0)
+        freePages[totalFreePages++] = page;
+}
+
+void Chip8Pool::abandon(u32 slot, u32 pagesTaken)
+{
+    CHIP8_FORK& fork = slots[slot];
+    for (u32 p = 0; p < pagesTaken; p++)
+        releasePage(fork.pages[p]);
+    fork.nextFree = freeSlot;
+    freeSlot = slot;
+    stats.liveSlots--;
+}
+
+u32 Chip8Pool::allocateSlot()
+{
+    u32 slot = freeSlot;
+    if (slot != CHIP8_POOL_NONE)
+    {
+        freeSlot = slots[slot].nextFree;
+        stats.liveSlots++;
+    }
+    return slot;
+}
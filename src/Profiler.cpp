@@ -0,0 +1,175 @@
+#include <algorithm>
+#include <fstream>
+#include <stdio.h>
+#include <string.h>
+#include "Chip8Core.h"
+#include "Profiler.h"
+
+void Chip8Core::setProfiler(Chip8Profiler* profiler)
+{
+    this->profiler = profiler;
+}
+
+Chip8Profiler* Chip8Core::getProfiler()
+{
+    return profiler;
+}
+
+Chip8Profiler::Chip8Profiler()
+{
+    CHIP8_STATE empty;
+    memset(&empty, 0, sizeof(empty));
+    reset(empty);
+}
+
+Chip8Profiler::~Chip8Profiler()
+{
+
+}
+
+void Chip8Profiler::reset(const CHIP8_STATE& s)
+{
+    instructions = 0;
+    memset(executions, 0, sizeof(executions));
+    memset(classes, 0, sizeof(classes));
+    memset(functions, 0, sizeof(functions));
+    memset(calls, 0, sizeof(calls));
+
+    depth = s.SP & (CHIP8_STACK_SIZE - 1);
+    running[0] = CHIP8_PROGRAM_LOAD_ADDRESS;
+    sites[0] = 0;
+    entered[0] = 0;
+    for (u32 d = 1; d <= depth; d++)
+    {
+        // "stack[d]" is where the call into depth "d" returns to, the "2nnn" that made it is just before
+        u16 site = (s.stack[d] - 2) & (CHIP8_MEMORY_SIZE - 1);
+        u16 opcode = (s.memory[site] << 8) | s.memory[(site + 1) & (CHIP8_MEMORY_SIZE - 1)];
+        running[d] = (opcode >> 12) == 0x2 ? opcode & 0x0fff : site;
+        sites[d] = site;
+        entered[d] = 0;
+    }
+}
+
+void Chip8Profiler::changeDepth(const CHIP8_STATE& s, u16 pc)
+{
+    u8 to = s.SP & (CHIP8_STACK_SIZE - 1);
+    // A return, or a program that dropped frames, finishes every call above where the stack is now
+    while (depth > to)
+    {
+        calls[sites[depth]].inclusive += instructions - entered[depth];
+        depth--;
+    }
+    // A call, the instruction at "pc" made it and "PC" is where it went
+    while (depth < to)
+    {
+        depth++;
+        running[depth] = s.PC & (CHIP8_MEMORY_SIZE - 1);
+        sites[depth] = pc;
+        entered[depth] = instructions;
+        calls[pc].calls++;
+        calls[pc].callee = running[depth];
+    }
+}
+
+u64 Chip8Profiler::getInstructions()
+{
+    return instructions;
+}
+
+const u64* Chip8Profiler::getExecutions()
+{
+    return executions;
+}
+
+const u64* Chip8Profiler::getClassCounts()
+{
+    return classes;
+}
+
+const PROFILE_CALL& Chip8Profiler::getCall(u16 site)
+{
+    return calls[site & (CHIP8_MEMORY_SIZE - 1)];
+}
+
+u16 Chip8Profiler::getFunction(u16 address)
+{
+    return functions[address & (CHIP8_MEMORY_SIZE - 1)];
+}
+
+std::vector<u16> Chip8Profiler::getHottest(u32 count)
+{
+    std::vector<u16> addresses;
+    for (u32 a = 0; a < CHIP8_MEMORY_SIZE; a++)
+    {
+        if (executions[a])
+            addresses.push_back(a);
+    }
+    count = std::min<u32>(count, addresses.size());
+    std::partial_sort(addresses.begin(), addresses.begin() + count, addresses.end(), [this](u16 a, u16 b) {
+        return executions[a] > executions[b] || (executions[a] == executions[b] && a < b);
+    });
+    addresses.resize(count);
+    return addresses;
+}
+
+// The name a function is shown by in callgrind viewers
+static std::string functionName(u16 entry)
+{
+    if (entry == CHIP8_PROGRAM_LOAD_ADDRESS)
+        return "start";
+    char name[16];
+    snprintf(name, sizeof(name), "sub_%03X", entry);
+    return name;
+}
+
+bool Chip8Profiler::writeCallgrind(const char* fname, const char* command)
+{
+    std::ofstream file(fname, std::ios::trunc);
+    if (!file.is_open())
+        return false;
+
+    // The calls still running have cost as much as they have run so far
+    u64 running[CHIP8_MEMORY_SIZE];
+    for (u32 site = 0; site < CHIP8_MEMORY_SIZE; site++)
+        running[site] = calls[site].inclusive;
+    for (u32 d = 1; d <= depth; d++)
+        running[sites[d]] += instructions - entered[d];
+
+    // Every function that ran an instruction or was called, in address order
+    std::vector<u16> entries;
+    for (u32 a = 0; a < CHIP8_MEMORY_SIZE; a++)
+    {
+        if (executions[a])
+            entries.push_back(functions[a]);
+        if (calls[a].calls)
+            entries.push_back(calls[a].callee);
+    }
+    std::sort(entries.begin(), entries.end());
+    entries.erase(std::unique(entries.begin(), entries.end()), entries.end());
+
+    file << "# callgrind format" << std::endl
+         << "version: 1" << std::endl
+         << "creator: Chip8Profiler" << std::endl
+         << "cmd: " << command << std::endl
+         << "positions: instr" << std::endl
+         << "events: Instructions" << std::endl
+         << "summary: " << instructions << std::endl
+         << std::endl
+         << "ob=" << command << std::endl;
+    for (u16 entry : entries)
+    {
+        file << std::endl << "fn=" << functionName(entry) << std::endl;
+        for (u32 a = 0; a < CHIP8_MEMORY_SIZE; a++)
+        {
+            if (!executions[a] || functions[a] != entry)
+                continue;
+            file << "0x" << std::hex << a << std::dec << " " << executions[a] << std::endl;
+            if (!calls[a].calls)
+                continue;
+            file << "cfn=" << functionName(calls[a].callee) << std::endl
+                 << "calls=" << calls[a].calls << " 0x" << std::hex << calls[a].callee << std::dec << std::endl
+                 << "0x" << std::hex << a << std::dec << " " << running[a] << std::endl;
+        }
+    }
+    return !file.fail();
+}
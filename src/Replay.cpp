@@ -0,0 +1,218 @@
+#include <fstream>
+#include <string.h>
+#include "Chip8Core.h"
+#include "Replay.h"
+
+// Pressed keys have the top bit of their event byte set
+#define CHIP8_REPLAY_KEY_DOWN 0x80
+
+// "execute" takes a 32 bit count so long stretches without input are run in chunks of this many instructions
+#define CHIP8_REPLAY_CHUNK (1u << 20)
+
+Chip8Replay::Chip8Replay()
+{
+    start.reset(new SAVESTATE());
+    memset(&header, 0, sizeof(header));
+    recording = false;
+    finished = false;
+}
+
+Chip8Replay::~Chip8Replay()
+{
+
+}
+
+void Chip8Replay::record(Chip8Core& core)
+{
+    core.saveState(*start);
+    events.clear();
+    memset(&header, 0, sizeof(header));
+    recording = true;
+    finished = false;
+}
+
+void Chip8Replay::setKey(Chip8Core& core, u8 key, bool down)
+{
+    if (down)
+        core.setKeyDown(key);
+    else
+        core.setKeyUp(key);
+
+    if (recording)
+    {
+        REPLAY_EVENT event;
+        event.instruction = core.getInstructions();
+        event.key = key & 0x0f;
+        event.down = down;
+        events.push_back(event);
+    }
+}
+
+void Chip8Replay::truncate(Chip8Core& core)
+{
+    if (!recording)
+        return;
+
+    u64 now = core.getInstructions();
+    if (now < start->state.instructions)
+    {
+        record(core);
+        return;
+    }
+    while (!events.empty() && events.back().instruction >= now)
+        events.pop_back();
+}
+
+void Chip8Replay::finish(Chip8Core& core)
+{
+    if (!recording)
+        return;
+
+    const CHIP8_STATE& state = core.getState();
+    header.magic = CHIP8_REPLAY_MAGIC;
+    header.version = CHIP8_REPLAY_VERSION;
+    header.events = events.size();
+    header.instructions = state.instructions;
+    header.checksum = savestateChecksum(state);
+    memcpy(header.pixels, state.pixels, sizeof(header.pixels));
+    recording = false;
+    finished = true;
+}
+
+bool Chip8Replay::isRecording()
+{
+    return recording;
+}
+
+bool Chip8Replay::save(const char* fname)
+{
+    if (!finished)
+        return false;
+
+    std::vector<u8> bytes = encodeEvents();
+    header.eventBytes = bytes.size();
+    std::ofstream file(fname, std::ios::binary | std::ios::trunc);
+    if (!file.is_open())
+        return false;
+    file.write((const char*) &header, sizeof(header));
+    file.write((const char*) start.get(), sizeof(SAVESTATE));
+    file.write((const char*) bytes.data(), bytes.size());
+    return !file.fail();
+}
+
+bool Chip8Replay::load(const char* fname)
+{
+    recording = false;
+    finished = false;
+    events.clear();
+
+    std::ifstream file(fname, std::ios::binary);
+    if (!file.is_open())
+        return false;
+    file.read((char*) &header, sizeof(header));
+    if (file.fail() || header.magic != CHIP8_REPLAY_MAGIC || header.version != CHIP8_REPLAY_VERSION)
+        return false;
+    file.read((char*) start.get(), sizeof(SAVESTATE));
+    if (file.fail() || !savestateValid(*start))
+        return false;
+    std::vector<u8> bytes(header.eventBytes);
+    file.read((char*) bytes.data(), bytes.size());
+    if (file.fail())
+        return false;
+
+    // Each event is a LEB128 count of the instructions since the event before and then the key byte
+    u64 instruction = start->state.instructions;
+    u32 at = 0;
+    events.reserve(header.events);
+    while (at < bytes.size())
+    {
+        u64 gap = 0;
+        for (u32 shift = 0; at < bytes.size() && shift < 64; shift += 7)
+        {
+            u8 b = bytes[at++];
+            gap |= (u64) (b & 0x7f) << shift;
+            if (!(b & 0x80))
+                break;
+        }
+        if (at >= bytes.size())
+            return false;
+
+        REPLAY_EVENT event;
+        instruction += gap;
+        event.instruction = instruction;
+        event.key = bytes[at] & 0x0f;
+        event.down = (bytes[at] & CHIP8_REPLAY_KEY_DOWN) != 0;
+        at++;
+        events.push_back(event);
+    }
+
+    finished = events.size() == header.events && instruction <= header.instructions;
+    return finished;
+}
+
+bool Chip8Replay::play(Chip8Core& core)
+{
+    if (!finished || !core.loadState(*start))
+        return false;
+
+    for (const REPLAY_EVENT& event : events)
+    {
+        if (!runTo(core, event.instruction))
+            break;
+        if (event.down)
+            core.setKeyDown(event.key);
+        else
+            core.setKeyUp(event.key);
+    }
+    runTo(core, header.instructions);
+
+    const CHIP8_STATE& state = core.getState();
+    return state.instructions == header.instructions && savestateChecksum(state) == header.checksum &&
+           memcmp(state.pixels, header.pixels, sizeof(header.pixels)) == 0;
+}
+
+u64 Chip8Replay::getInstructions()
+{
+    return header.instructions - start->state.instructions;
+}
+
+const std::vector<REPLAY_EVENT>& Chip8Replay::getEvents()
+{
+    return events;
+}
+
+u64 Chip8Replay::getFileSize()
+{
+    return sizeof(REPLAY_FILE_HEADER) + sizeof(SAVESTATE) + encodeEvents().size();
+}
+
+bool Chip8Replay::runTo(Chip8Core& core, u64 instruction)
+{
+    while (core.getInstructions() < instruction)
+    {
+        u64 left = instruction - core.getInstructions();
+        if (!core.execute(left < CHIP8_REPLAY_CHUNK ? left : CHIP8_REPLAY_CHUNK))
+            return false;
+    }
+    return true;
+}
+
+std::vector<u8> Chip8Replay::encodeEvents()
+{
+    std::vector<u8> bytes;
+    bytes.reserve(events.size() * 3);
+    u64 last = start->state.instructions;
+    for (const REPLAY_EVENT& event : events)
+    {
+        u64 gap = event.instruction - last;
+        last = event.instruction;
+        do
+        {
+            u8 b = gap & 0x7f;
+            gap >>= 7;
+            bytes.push_back(gap ? b | 0x80 : b);
+        } while (gap);
+        bytes.push_back(event.key | (event.down ? CHIP8_REPLAY_KEY_DOWN : 0));
+    }
+    return bytes;
+}
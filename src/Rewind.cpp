@@ -0,0 +1,278 @@
+#include <string.h>
+#include "Chip8Core.h"
+#include "Rewind.h"
+
+/* The most bytes a frame encodes to. A run of changed bytes costs its length and a 4 byte header and each run is
+ * followed by at least one unchanged 8 byte word, so only a run that reaches the end of the state can cost more than
+ * the bytes it covers */
+#define CHIP8_REWIND_MAX_FRAME_BYTES (sizeof(CHIP8_STATE) + 4)
+
+// A machine of all zeros, keyframes are encoded against it
+static const CHIP8_STATE zeroState = {};
+
+/* Encodes the XOR of "now" and "before" into "out" as runs, each run is the number of unchanged bytes before it, the
+ * number of changed bytes and then the XOR of those bytes. Unchanged words are skipped 8 bytes at a time and a run
+ * ends at the first unchanged word. Returns the bytes written */
+static u32 encodeDelta(u8* out, const CHIP8_STATE& now, const CHIP8_STATE& before)
+{
+    const u64* a = (const u64*) &now;
+    const u64* b = (const u64*) &before;
+    const u32 words = sizeof(CHIP8_STATE) / 8;
+    u8* o = out;
+    u32 last = 0;
+    u32 w = 0;
+    while (w < words)
+    {
+        // Most of the machine is unchanged from one frame to the next so it is skipped four words at a time
+        if (w + 4 <= words && !((a[w] ^ b[w]) | (a[w + 1] ^ b[w + 1]) | (a[w + 2] ^ b[w + 2]) | (a[w + 3] ^ b[w + 3])))
+        {
+            w += 4;
+            continue;
+        }
+        u64 x = a[w] ^ b[w];
+        if (!x)
+        {
+            w++;
+            continue;
+        }
+
+        // The first and last changed bytes of the run, the state is little endian so the low bits are the first byte
+        u32 start = w * 8 + __builtin_ctzll(x) / 8;
+        u64 lastWord = x;
+        while (w + 1 < words && (a[w + 1] ^ b[w + 1]))
+        {
+            w++;
+            lastWord = a[w] ^ b[w];
+        }
+        u32 end = w * 8 + 8 - __builtin_clzll(lastWord) / 8;
+        w++;
+
+        u16 skip = start - last;
+        u16 length = end - start;
+        memcpy(o, &skip, sizeof(skip));
+        memcpy(o + 2, &length, sizeof(length));
+        o += 4;
+        for (u32 i = start; i < end; i++)
+            *o++ = ((const u8*) &now)[i] ^ ((const u8*) &before)[i];
+        last = end;
+    }
+    return o - out;
+}
+
+// XORs an encoded frame into "state", applying a delta twice puts the state back as it was
+static void applyDelta(CHIP8_STATE& state, const u8* in, u32 size)
+{
+    u8* to = (u8*) &state;
+    const u8* end = in + size;
+    while (in < end)
+    {
+        u16 skip;
+        u16 length;
+        memcpy(&skip, in, sizeof(skip));
+        memcpy(&length, in + 2, sizeof(length));
+        in += 4;
+        to += skip;
+        for (u16 i = 0; i < length; i++)
+            *to++ ^= *in++;
+    }
+}
+
+Chip8Rewind::Chip8Rewind(u32 bytes, u32 frames, u32 keyframeInterval)
+{
+    // The ring always has room for at least one whole frame
+    bufferSize = bytes > CHIP8_REWIND_MAX_FRAME_BYTES ? bytes : CHIP8_REWIND_MAX_FRAME_BYTES;
+    maxFrames = frames > 1 ? frames : 1;
+    this->keyframeInterval = keyframeInterval > 1 ? keyframeInterval : 1;
+    // Touching the ring now keeps first use page faults out of "record"
+    buffer.reset(new u8[bufferSize]);
+    memset(buffer.get(), 0, bufferSize);
+    this->frames.reset(new REWIND_FRAME[maxFrames]);
+    current.reset(new CHIP8_STATE());
+    scratch.reset(new u8[CHIP8_REWIND_MAX_FRAME_BYTES]);
+    clear();
+}
+
+Chip8Rewind::~Chip8Rewind()
+{
+
+}
+
+void Chip8Rewind::record(Chip8Core& core)
+{
+    const CHIP8_STATE& state = core.getState();
+
+    // Recording after a rewind carries on from the frame rewound to, the frames that were after it are gone
+    if (!isEmpty() && position + 1 != next)
+    {
+        next = position + 1;
+        head = frameAt(position).offset + frameAt(position).size;
+        sinceKeyframe = 0;
+        for (u64 f = position; !frameAt(f).keyframe; f--)
+            sinceKeyframe++;
+    }
+
+    bool keyframe = isEmpty() || sinceKeyframe + 1 >= keyframeInterval;
+    u32 size = encodeDelta(scratch.get(), state, keyframe ? zeroState : *current);
+
+    /* Drop the oldest history until the frame fits after the newest one or at the start of the ring. Once the frames
+     * held wrap round the ring the newest is before the oldest, a frame never ends right on the oldest so frames that
+     * encode to nothing cannot make a full ring look empty */
+    u32 at = 0;
+    while (!isEmpty())
+    {
+        if (next - oldest < maxFrames)
+        {
+            u32 start = frameAt(oldest).offset;
+            bool wraps = frameAt(next - 1).offset < start;
+            if (!wraps && head + size <= bufferSize)
+            {
+                at = head;
+                break;
+            }
+            if (!wraps && size < start)
+                break;
+            if (wraps && head + size < start)
+            {
+                at = head;
+                break;
+            }
+        }
+        dropOldest();
+    }
+
+    // With nothing left to be a delta against the frame has to be a keyframe
+    if (isEmpty() && !keyframe)
+    {
+        keyframe = true;
+        size = encodeDelta(scratch.get(), state, zeroState);
+    }
+
+    memcpy(&buffer[at], scratch.get(), size);
+    REWIND_FRAME& frame = frameAt(next);
+    frame.offset = at;
+    frame.size = size;
+    frame.keyframe = keyframe;
+    head = at + size;
+    position = next;
+    next++;
+    sinceKeyframe = keyframe ? 0 : sinceKeyframe + 1;
+    memcpy(current.get(), &state, sizeof(CHIP8_STATE));
+}
+
+bool Chip8Rewind::rewind(Chip8Core& core, u32 frames)
+{
+    if (isEmpty() || position - oldest < frames)
+        return false;
+
+    moveTo(position - frames);
+    loadCore(core);
+    return true;
+}
+
+bool Chip8Rewind::forward(Chip8Core& core, u32 frames)
+{
+    if (isEmpty() || next - 1 - position < frames)
+        return false;
+
+    moveTo(position + frames);
+    loadCore(core);
+    return true;
+}
+
+bool Chip8Rewind::seek(Chip8Core& core, u64 frame)
+{
+    if (frame < oldest || frame >= next)
+        return false;
+
+    moveTo(frame);
+    loadCore(core);
+    return true;
+}
+
+void Chip8Rewind::clear()
+{
+    head = 0;
+    oldest = 0;
+    next = 0;
+    position = 0;
+    sinceKeyframe = 0;
+}
+
+u64 Chip8Rewind::getOldestFrame()
+{
+    return oldest;
+}
+
+u64 Chip8Rewind::getNewestFrame()
+{
+    return next ? next - 1 : 0;
+}
+
+u64 Chip8Rewind::getFrame()
+{
+    return position;
+}
+
+bool Chip8Rewind::isEmpty()
+{
+    return oldest == next;
+}
+
+REWIND_STATS Chip8Rewind::getStats()
+{
+    REWIND_STATS stats;
+    memset(&stats, 0, sizeof(stats));
+    stats.frames = next - oldest;
+    stats.maxFrames = maxFrames;
+    stats.maxBytes = bufferSize;
+    for (u64 f = oldest; f < next; f++)
+    {
+        stats.keyframes += frameAt(f).keyframe;
+        stats.bytes += frameAt(f).size;
+    }
+    return stats;
+}
+
+void Chip8Rewind::moveTo(u64 frame)
+{
+    // Stepping back undoes each frame's delta until a keyframe is in the way
+    while (position > frame && !frameAt(position).keyframe)
+    {
+        applyDelta(*current, &buffer[frameAt(position).offset], frameAt(position).size);
+        position--;
+    }
+
+    // Start again from the keyframe at or before the frame, the oldest frame is always a keyframe
+    if (position > frame)
+    {
+        position = frame;
+        while (!frameAt(position).keyframe)
+            position--;
+        memset(current.get(), 0, sizeof(CHIP8_STATE));
+        applyDelta(*current, &buffer[frameAt(position).offset], frameAt(position).size);
+    }
+
+    while (position < frame)
+    {
+        position++;
+        if (frameAt(position).keyframe)
+            memset(current.get(), 0, sizeof(CHIP8_STATE));
+        applyDelta(*current, &buffer[frameAt(position).offset], frameAt(position).size);
+    }
+}
+
+void Chip8Rewind::loadCore(Chip8Core& core)
+{
+    // The same as loading a savestate, a machine rewound from a stack error runs again
+    memcpy(&core.state, current.get(), sizeof(CHIP8_STATE));
+    core.flushDecodeCache();
+    core.dirtyRows = 0xffffffff;
+    core.quit = false;
+}
+
+void Chip8Rewind::dropOldest()
+{
+    oldest++;
+    while (oldest < next && !frameAt(oldest).keyframe)
+        oldest++;
+}
@@ -0,0 +1,117 @@
+#include <chrono>
+#include <stddef.h>
+#include <string.h>
+#include "Chip8Core.h"
+#include "RunAhead.h"
+
+Chip8RunAhead::Chip8RunAhead(u32 frames)
+{
+    saved.reset(new CHIP8_STATE());
+    savedRunning = false;
+    savedQuit = false;
+    savedStale = false;
+    savedDirtyRows = 0;
+    memset(pixels, 0, sizeof(pixels));
+    memset(&stats, 0, sizeof(stats));
+    setFrames(frames);
+}
+
+Chip8RunAhead::~Chip8RunAhead()
+{
+
+}
+
+void Chip8RunAhead::setFrames(u32 frames)
+{
+    this->frames = frames < CHIP8_RUN_AHEAD_MAX_FRAMES ? frames : CHIP8_RUN_AHEAD_MAX_FRAMES;
+    // The display may be pointed at a different framebuffer so all of it is presented again
+    presented = false;
+}
+
+u32 Chip8RunAhead::getFrames()
+{
+    return frames;
+}
+
+u32 Chip8RunAhead::run(Chip8Core& core, u32 instructionsPerFrame)
+{
+    auto start = std::chrono::steady_clock::now();
+    CHIP8_STATE& state = core.state;
+    u64 before = state.instructions;
+    if (frames)
+    {
+        memcpy(saved.get(), &state, sizeof(CHIP8_STATE));
+        savedRunning = core.running;
+        savedQuit = core.quit;
+        savedStale = core.compiledStale;
+        savedDirtyRows = core.dirtyRows;
+
+        /* Each frame is run on its own so a run ahead behaves the same as the frames it stands in for, break points are
+         * not checked as frames that are thrown away must not stop the machine, nor are they traced, profiled or counted into a heatmap */
+        Chip8Tracer* tracer = core.tracer;
+        Chip8Profiler* profiler = core.profiler;
+        Chip8Heatmap* heatmap = core.heatmap;
+        core.tracer = NULL;
+        core.profiler = NULL;
+        core.heatmap = NULL;
+        for (u32 f = 0; f < frames && !core.quit; f++)
+            core.dispatch(instructionsPerFrame);
+        core.tracer = tracer;
+        core.profiler = profiler;
+        core.heatmap = heatmap;
+    }
+
+    u32 dirty = 0;
+    for (u32 y = 0; y < CHIP8_ORIGINAL_DISPLAY_HEIGHT; y++)
+        dirty |= (u32) (pixels[y] != state.pixels[y]) << y;
+    memcpy(pixels, state.pixels, sizeof(pixels));
+    if (!presented)
+        dirty = 0xffffffff;
+    presented = true;
+
+    if (frames)
+    {
+        stats.instructions += state.instructions - before;
+        restore(core);
+    }
+    u64 ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    stats.frames++;
+    stats.totalNs += ns;
+    stats.slowestNs = ns > stats.slowestNs ? ns : stats.slowestNs;
+    return dirty;
+}
+
+const u64* Chip8RunAhead::getPixels()
+{
+    return pixels;
+}
+
+RUN_AHEAD_STATS Chip8RunAhead::getStats()
+{
+    return stats;
+}
+
+void Chip8RunAhead::restore(Chip8Core& core)
+{
+    CHIP8_STATE& state = core.state;
+    memcpy(&state, saved.get(), offsetof(CHIP8_STATE, memory));
+
+    // Most frames write a few bytes of memory if any, only those are written back and only they invalidate cached code
+    const u64* now = (const u64*) state.memory;
+    const u64* was = (const u64*) saved->memory;
+    for (u32 w = 0; w < CHIP8_MEMORY_SIZE / 8; w++)
+    {
+        if (now[w] == was[w])
+            continue;
+        for (u32 b = w * 8; b < w * 8 + 8; b++)
+        {
+            if (state.memory[b] != saved->memory[b])
+                core.writeMemory(b, saved->memory[b]);
+        }
+    }
+
+    core.running = savedRunning;
+    core.quit = savedQuit;
+    core.compiledStale = savedStale;
+    core.dirtyRows = savedDirtyRows;
+}
@@ -0,0 +1,292 @@
+#include <iostream>
+#include <string.h>
+#include "Chip8Core.h"
+#include "Savestate.h"
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+// A savestate file starts out with room for this many states
+#define CHIP8_SAVESTATE_FILE_MIN_CAPACITY 64
+
+/* A Fletcher style checksum over 64 bit words, a running sum and a sum of the sums so swapped words are caught as well
+ * as changed ones. Four interleaved streams keep the additions independent so it runs at the speed of the loads. */
+template<bool COPY>
+static inline u64 checksumWords(u64* __restrict to, const u64* __restrict from, u32 words)
+{
+    u64 sum0 = 0, sum1 = 0, sum2 = 0, sum3 = 0;
+    u64 mix0 = 0, mix1 = 0, mix2 = 0, mix3 = 0;
+    for (u32 w = 0; w < words; w += 4)
+    {
+        u64 word0 = from[w];
+        u64 word1 = from[w + 1];
+        u64 word2 = from[w + 2];
+        u64 word3 = from[w + 3];
+        if (COPY)
+        {
+            to[w] = word0;
+            to[w + 1] = word1;
+            to[w + 2] = word2;
+            to[w + 3] = word3;
+        }
+        sum0 += word0;
+        sum1 += word1;
+        sum2 += word2;
+        sum3 += word3;
+        mix0 += sum0;
+        mix1 += sum1;
+        mix2 += sum2;
+        mix3 += sum3;
+    }
+
+    const u64 sums[] = {sum0, sum1, sum2, sum3, mix0, mix1, mix2, mix3};
+    u64 checksum = words;
+    for (u64 value : sums)
+        checksum = (checksum ^ value) * 0x9E3779B97F4A7C15ull;
+    return checksum;
+}
+
+u64 savestateChecksum(const CHIP8_STATE& state)
+{
+    return checksumWords<false>(NULL, (const u64*) &state, sizeof(CHIP8_STATE) / 8);
+}
+
+u64 savestateCopy(CHIP8_STATE& to, const CHIP8_STATE& from)
+{
+    return checksumWords<true>((u64*) &to, (const u64*) &from, sizeof(CHIP8_STATE) / 8);
+}
+
+bool savestateValid(const SAVESTATE& savestate)
+{
+    return savestate.magic == CHIP8_SAVESTATE_MAGIC && savestate.version == CHIP8_SAVESTATE_VERSION &&
+           savestate.stateSize == sizeof(CHIP8_STATE) && savestate.quirkProfile < QUIRK_PROFILE_COUNT &&
+           savestateChecksum(savestate.state) == savestate.checksum;
+}
+
+void Chip8Core::saveState(SAVESTATE& to)
+{
+    to.magic = CHIP8_SAVESTATE_MAGIC;
+    to.version = CHIP8_SAVESTATE_VERSION;
+    to.quirkProfile = quirkProfile;
+    to.quit = quit;
+    to.stateSize = sizeof(CHIP8_STATE);
+    to.reserved = 0;
+    to.checksum = savestateCopy(to.state, state);
+}
+
+bool Chip8Core::loadState(const SAVESTATE& from)
+{
+    // Everything is checked before the machine is touched so a bad savestate leaves it as it was
+    if (!savestateValid(from))
+        return false;
+
+    memcpy(&state, &from.state, sizeof(CHIP8_STATE));
+    // Memory may hold different code now so this throws away everything decoded or translated from it
+    if (quirkProfile != from.quirkProfile)
+        setQuirkProfile((QUIRK_PROFILE) from.quirkProfile);
+    else
+        flushDecodeCache();
+    dirtyRows = 0xffffffff;
+    quit = from.quit != 0;
+    return true;
+}
+
+SavestateFile::SavestateFile()
+{
+#ifdef _WIN32
+    file = INVALID_HANDLE_VALUE;
+    fileMapping = NULL;
+#else
+    file = -1;
+#endif
+    header = NULL;
+    slots = NULL;
+    capacity = 0;
+}
+
+SavestateFile::~SavestateFile()
+{
+    close();
+}
+
+bool SavestateFile::create(const char* fname)
+{
+    close();
+#ifdef _WIN32
+    file = CreateFileA(fname, GENERIC_READ | GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+#else
+    file = ::open(fname, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (file < 0)
+        return false;
+#endif
+
+    if (!map(CHIP8_SAVESTATE_FILE_MIN_CAPACITY))
+    {
+        close();
+        return false;
+    }
+
+    header->magic = CHIP8_SAVESTATE_FILE_MAGIC;
+    header->version = CHIP8_SAVESTATE_VERSION;
+    header->reserved = 0;
+    header->slotSize = sizeof(SAVESTATE);
+    header->count = 0;
+    return true;
+}
+
+bool SavestateFile::open(const char* fname)
+{
+    close();
+    // The header is read and checked before anything is mapped so a file that is not ours is never resized
+    SAVESTATE_FILE_HEADER fileHeader;
+    u64 size = 0;
+    bool read = false;
+#ifdef _WIN32
+    file = CreateFileA(fname, GENERIC_READ | GENERIC_WRITE, 0, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+    LARGE_INTEGER fileSize;
+    DWORD bytes = 0;
+    if (GetFileSizeEx(file, &fileSize))
+        size = fileSize.QuadPart;
+    read = ReadFile(file, &fileHeader, sizeof(fileHeader), &bytes, NULL) && bytes == sizeof(fileHeader);
+#else
+    file = ::open(fname, O_RDWR);
+    if (file < 0)
+        return false;
+    struct stat info;
+    if (fstat(file, &info) == 0)
+        size = info.st_size;
+    read = pread(file, &fileHeader, sizeof(fileHeader), 0) == sizeof(fileHeader);
+#endif
+
+    // The file has to hold every state its header counts
+    u32 states = read ? (size - sizeof(SAVESTATE_FILE_HEADER)) / sizeof(SAVESTATE) : 0;
+    bool ok = read && fileHeader.magic == CHIP8_SAVESTATE_FILE_MAGIC && fileHeader.version == CHIP8_SAVESTATE_VERSION &&
+              fileHeader.slotSize == sizeof(SAVESTATE) && fileHeader.count <= states;
+    if (!ok || !map(states > CHIP8_SAVESTATE_FILE_MIN_CAPACITY ? states : CHIP8_SAVESTATE_FILE_MIN_CAPACITY))
+    {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void SavestateFile::close()
+{
+    if (!isOpen())
+        return;
+
+    // A file that was mapped is ours, it is cut back to the states written so the room it grew into is not left on disk
+    bool trim = header != NULL;
+    u64 size = sizeof(SAVESTATE_FILE_HEADER) + (u64) getCount() * sizeof(SAVESTATE);
+    unmap();
+#ifdef _WIN32
+    LARGE_INTEGER end;
+    end.QuadPart = size;
+    if (trim && !(SetFilePointerEx(file, end, NULL, FILE_BEGIN) && SetEndOfFile(file)))
+        std::cout << "Problem trimming the savestate file" << std::endl;
+    CloseHandle(file);
+    file = INVALID_HANDLE_VALUE;
+#else
+    if (trim && ftruncate(file, size) != 0)
+        std::cout << "Problem trimming the savestate file" << std::endl;
+    ::close(file);
+    file = -1;
+#endif
+    capacity = 0;
+}
+
+bool SavestateFile::isOpen()
+{
+#ifdef _WIN32
+    return file != INVALID_HANDLE_VALUE;
+#else
+    return file >= 0;
+#endif
+}
+
+bool SavestateFile::append(Chip8Core& core)
+{
+    if (!header)
+        return false;
+    if (header->count == capacity && !map(capacity * 2))
+        return false;
+
+    core.saveState(slots[header->count]);
+    header->count++;
+    return true;
+}
+
+bool SavestateFile::load(u32 index, Chip8Core& core)
+{
+    const SAVESTATE* savestate = getSavestate(index);
+    return savestate && core.loadState(*savestate);
+}
+
+const SAVESTATE* SavestateFile::getSavestate(u32 index)
+{
+    if (!header || index >= header->count)
+        return NULL;
+    return &slots[index];
+}
+
+u32 SavestateFile::getCount()
+{
+    return header ? header->count : 0;
+}
+
+bool SavestateFile::map(u32 newCapacity)
+{
+    unmap();
+    u64 size = sizeof(SAVESTATE_FILE_HEADER) + (u64) newCapacity * sizeof(SAVESTATE);
+#ifdef _WIN32
+    // Mapping a file larger than it is grows it
+    fileMapping = CreateFileMappingA(file, NULL, PAGE_READWRITE, (DWORD)(size >> 32), (DWORD) size, NULL);
+    if (!fileMapping)
+        return false;
+    void* view = MapViewOfFile(fileMapping, FILE_MAP_ALL_ACCESS, 0, 0, size);
+    if (!view)
+    {
+        CloseHandle(fileMapping);
+        fileMapping = NULL;
+        return false;
+    }
+#else
+    struct stat info;
+    if (fstat(file, &info) != 0)
+        return false;
+    if ((u64) info.st_size < size && ftruncate(file, size) != 0)
+        return false;
+    void* view = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+    if (view == MAP_FAILED)
+        return false;
+#endif
+
+    header = (SAVESTATE_FILE_HEADER*) view;
+    slots = (SAVESTATE*)((u8*) view + sizeof(SAVESTATE_FILE_HEADER));
+    capacity = newCapacity;
+    return true;
+}
+
+void SavestateFile::unmap()
+{
+    if (!header)
+        return;
+#ifdef _WIN32
+    UnmapViewOfFile(header);
+    CloseHandle(fileMapping);
+    fileMapping = NULL;
+#else
+    munmap(header, sizeof(SAVESTATE_FILE_HEADER) + (u64) capacity * sizeof(SAVESTATE));
+#endif
+    header = NULL;
+    slots = NULL;
+}
@@ -0,0 +1,111 @@
+#include <string.h>
+#include <thread>
+#include "Scheduler.h"
+
+Chip8Scheduler::Chip8Scheduler(u32 framesPerSecond)
+{
+    period = std::chrono::nanoseconds(1000000000ull / (framesPerSecond ? framesPerSecond : 1));
+    paced = CHIP8_NO_DELAY == false;
+    start();
+}
+
+Chip8Scheduler::~Chip8Scheduler()
+{
+
+}
+
+void Chip8Scheduler::start()
+{
+    origin = epoch = awake = CLOCK::now();
+    scheduled = 0;
+    memset(&stats, 0, sizeof(stats));
+    jitterTotalNs = 0;
+    memset(jitter, 0, sizeof(jitter));
+}
+
+void Chip8Scheduler::wait()
+{
+    CLOCK::time_point now = CLOCK::now();
+    stats.busyNs += std::chrono::duration_cast<std::chrono::nanoseconds>(now - awake).count();
+    stats.frames++;
+    scheduled++;
+
+    if (paced)
+    {
+        CLOCK::time_point deadline = epoch + period * scheduled;
+        if (now >= deadline)
+        {
+            stats.lateFrames++;
+            if (now - deadline > period * CHIP8_SCHEDULER_MAX_BEHIND)
+            {
+                // Too far behind to catch up, the frames missed are dropped and the schedule carries on from now
+                stats.resyncs++;
+                epoch = now;
+                scheduled = 0;
+            }
+        }
+        else
+        {
+            std::this_thread::sleep_until(deadline);
+            now = CLOCK::now();
+            u64 late = std::chrono::duration_cast<std::chrono::nanoseconds>(now - deadline).count();
+            jitterTotalNs += late;
+            stats.jitterMaxNs = late > stats.jitterMaxNs ? late : stats.jitterMaxNs;
+            u64 bucket = late / 1000;
+            jitter[bucket < CHIP8_SCHEDULER_JITTER_BUCKETS ? bucket : CHIP8_SCHEDULER_JITTER_BUCKETS - 1]++;
+        }
+    }
+
+    awake = now;
+}
+
+void Chip8Scheduler::resume()
+{
+    CLOCK::time_point now = CLOCK::now();
+    origin += now - awake;
+    epoch = awake = now;
+    scheduled = 0;
+}
+
+void Chip8Scheduler::setPaced(bool paced)
+{
+    if (paced == this->paced)
+        return;
+    this->paced = paced;
+    // The deadlines start again from now, the frames run unpaced did not keep to them
+    epoch = CLOCK::now();
+    scheduled = 0;
+}
+
+bool Chip8Scheduler::isPaced()
+{
+    return paced;
+}
+
+SCHEDULER_STATS Chip8Scheduler::getStats()
+{
+    SCHEDULER_STATS result = stats;
+    u64 sleeps = 0;
+    for (u32 b = 0; b < CHIP8_SCHEDULER_JITTER_BUCKETS; b++)
+        sleeps += jitter[b];
+    if (sleeps)
+    {
+        result.jitterMeanNs = jitterTotalNs / sleeps;
+        u64 below = 0;
+        for (u32 b = 0; b < CHIP8_SCHEDULER_JITTER_BUCKETS; b++)
+        {
+            below += jitter[b];
+            if (below * 100 >= sleeps * 99)
+            {
+                // The top of the bucket, the wake ups counted in it were at most this late
+                result.jitterP99Ns = (u64) (b + 1) * 1000;
+                break;
+            }
+        }
+    }
+
+    result.elapsedNs = std::chrono::duration_cast<std::chrono::nanoseconds>(awake - origin).count();
+    result.driftNs = (s64) result.elapsedNs - (s64) (period.count() * stats.frames);
+    result.idle = result.elapsedNs ? 1.0 - (double) stats.busyNs / result.elapsedNs : 0;
+    return result;
+}
@@ -0,0 +1,491 @@
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <string.h>
+#include "Breakpoints.h"
+#include "Chip8Core.h"
+#include "Trace.h"
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+// The distance from one block to the next in a trace file
+#define CHIP8_TRACE_SLOT_SIZE (sizeof(TRACE_BLOCK_HEADER) + CHIP8_TRACE_BLOCK_SIZE)
+
+static_assert(CHIP8_TRACE_SLOT_SIZE % sizeof(TRACE_BLOCK_HEADER) == 0, "Blocks follow each other on whole cache lines");
+
+void Chip8Core::setTracer(Chip8Tracer* tracer)
+{
+    this->tracer = tracer;
+}
+
+Chip8Tracer* Chip8Core::getTracer()
+{
+    return tracer;
+}
+
+Chip8Tracer::Chip8Tracer()
+{
+#ifdef _WIN32
+    file = INVALID_HANDLE_VALUE;
+    fileMapping = NULL;
+#else
+    file = -1;
+#endif
+    header = NULL;
+    slots = 0;
+    slot = 0;
+    scratch.reset(new TRACE_BLOCK_HEADER[CHIP8_TRACE_SLOT_SIZE / sizeof(TRACE_BLOCK_HEADER)]);
+    records = 0;
+    bytes = 0;
+    useScratch();
+    failed = false;
+}
+
+Chip8Tracer::~Chip8Tracer()
+{
+    close();
+}
+
+bool Chip8Tracer::create(const char* fname, u32 ringBlocks)
+{
+    close();
+#ifdef _WIN32
+    file = CreateFileA(fname, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+#else
+    file = ::open(fname, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (file < 0)
+        return false;
+#endif
+
+    if (!map(ringBlocks ? ringBlocks : CHIP8_TRACE_MIN_BLOCKS))
+    {
+        close();
+        return false;
+    }
+
+    header->magic = CHIP8_TRACE_MAGIC;
+    header->version = CHIP8_TRACE_VERSION;
+    header->reserved = 0;
+    header->blockSize = CHIP8_TRACE_BLOCK_SIZE;
+    header->ringSlots = ringBlocks;
+    header->blocks = 0;
+
+    // A machine that has just been reset starts at the load address without a jump
+    nextInstruction = 0;
+    lastPC = CHIP8_PROGRAM_LOAD_ADDRESS - 2;
+    memset(lastRegisters, 0, sizeof(lastRegisters));
+    records = 0;
+    bytes = 0;
+    failed = false;
+    startBlock(0);
+    return true;
+}
+
+void Chip8Tracer::close()
+{
+    if (!isOpen())
+        return;
+
+    // A growing file is cut back to the blocks written, a ring keeps every slot as any of them may hold the newest
+    bool trim = header != NULL && header->ringSlots == 0;
+    u64 size = sizeof(TRACE_FILE_HEADER) + (u64) (slot + 1) * CHIP8_TRACE_SLOT_SIZE;
+    unmap();
+#ifdef _WIN32
+    LARGE_INTEGER end;
+    end.QuadPart = size;
+    if (trim && !(SetFilePointerEx(file, end, NULL, FILE_BEGIN) && SetEndOfFile(file)))
+        std::cout << "Problem trimming the trace file" << std::endl;
+    CloseHandle(file);
+    file = INVALID_HANDLE_VALUE;
+#else
+    if (trim && ftruncate(file, size) != 0)
+        std::cout << "Problem trimming the trace file" << std::endl;
+    ::close(file);
+    file = -1;
+#endif
+    slots = 0;
+    useScratch();
+}
+
+bool Chip8Tracer::isOpen()
+{
+#ifdef _WIN32
+    return file != INVALID_HANDLE_VALUE;
+#else
+    return file >= 0;
+#endif
+}
+
+u64 Chip8Tracer::getRecords()
+{
+    return records;
+}
+
+u64 Chip8Tracer::getBytes()
+{
+    return bytes;
+}
+
+bool Chip8Tracer::hasFailed()
+{
+    return failed;
+}
+
+void Chip8Tracer::nextBlock()
+{
+    if (!header)
+    {
+        // Not recording, the scratch block is just written over
+        used = 0;
+        return;
+    }
+
+    u32 next = slot + 1;
+    if (header->ringSlots)
+        next %= slots;
+    else if (next == slots && !map(slots * 2))
+    {
+        std::cout << "Problem growing the trace file, tracing has stopped" << std::endl;
+        failed = true;
+        useScratch();
+        return;
+    }
+    startBlock(next);
+}
+
+void Chip8Tracer::startBlock(u32 slot)
+{
+    this->slot = slot;
+    block = (TRACE_BLOCK_HEADER*) ((u8*) header + sizeof(TRACE_FILE_HEADER) + (u64) slot * CHIP8_TRACE_SLOT_SIZE);
+    data = (u8*) (block + 1);
+    used = 0;
+
+    // "bytes" is zeroed first so a crash part way through going round the ring never leaves the old records counted
+    block->bytes = 0;
+    block->records = 0;
+    block->magic = CHIP8_TRACE_BLOCK_MAGIC;
+    block->sequence = header->blocks++;
+    block->instruction = nextInstruction;
+    block->PC = lastPC;
+    memcpy(block->V, lastRegisters, sizeof(block->V));
+    block->I = (u16) lastRegisters[2];
+    block->SP = (u8) (lastRegisters[2] >> 16);
+    block->DT = (u8) (lastRegisters[2] >> 24);
+    block->ST = (u8) (lastRegisters[2] >> 32);
+    block->reserved = 0;
+    memset(opcodes, 0xff, sizeof(opcodes));
+}
+
+void Chip8Tracer::useScratch()
+{
+    header = NULL;
+    block = scratch.get();
+    data = (u8*) (block + 1);
+    used = 0;
+}
+
+bool Chip8Tracer::map(u32 newSlots)
+{
+    unmap();
+    u64 size = sizeof(TRACE_FILE_HEADER) + (u64) newSlots * CHIP8_TRACE_SLOT_SIZE;
+#ifdef _WIN32
+    // Mapping a file larger than it is grows it
+    fileMapping = CreateFileMappingA(file, NULL, PAGE_READWRITE, (DWORD)(size >> 32), (DWORD) size, NULL);
+    if (!fileMapping)
+        return false;
+    void* view = MapViewOfFile(fileMapping, FILE_MAP_ALL_ACCESS, 0, 0, size);
+    if (!view)
+    {
+        CloseHandle(fileMapping);
+        fileMapping = NULL;
+        return false;
+    }
+#else
+    struct stat info;
+    if (fstat(file, &info) != 0)
+        return false;
+    if ((u64) info.st_size < size && ftruncate(file, size) != 0)
+        return false;
+    void* view = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+    if (view == MAP_FAILED)
+        return false;
+#endif
+
+    header = (TRACE_FILE_HEADER*) view;
+    slots = newSlots;
+    // The block being written moved with the mapping
+    if (block != scratch.get())
+    {
+        block = (TRACE_BLOCK_HEADER*) ((u8*) header + sizeof(TRACE_FILE_HEADER) + (u64) slot * CHIP8_TRACE_SLOT_SIZE);
+        data = (u8*) (block + 1);
+    }
+    return true;
+}
+
+void Chip8Tracer::unmap()
+{
+    if (!header)
+        return;
+#ifdef _WIN32
+    UnmapViewOfFile(header);
+    CloseHandle(fileMapping);
+    fileMapping = NULL;
+#else
+    munmap(header, sizeof(TRACE_FILE_HEADER) + (u64) slots * CHIP8_TRACE_SLOT_SIZE);
+#endif
+    header = NULL;
+}
+
+Chip8TraceReader::Chip8TraceReader()
+{
+    records = 0;
+    recordBytes = 0;
+    lost = 0;
+    corrupt = false;
+    rewind();
+}
+
+Chip8TraceReader::~Chip8TraceReader()
+{
+
+}
+
+bool Chip8TraceReader::load(const char* fname)
+{
+    std::ifstream file(fname, std::ios::binary);
+    bytes.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    order.clear();
+    records = 0;
+    recordBytes = 0;
+    lost = 0;
+    corrupt = false;
+
+    TRACE_FILE_HEADER header;
+    if (bytes.size() < sizeof(header))
+        return false;
+    memcpy(&header, bytes.data(), sizeof(header));
+    if (header.magic != CHIP8_TRACE_MAGIC || header.version != CHIP8_TRACE_VERSION || header.blockSize != CHIP8_TRACE_BLOCK_SIZE)
+        return false;
+
+    // Every slot that holds a block, put in the order the blocks were started
+    std::vector<std::pair<u64, u64>> blocks;
+    for (u64 offset = sizeof(header); offset + CHIP8_TRACE_SLOT_SIZE <= bytes.size(); offset += CHIP8_TRACE_SLOT_SIZE)
+    {
+        TRACE_BLOCK_HEADER block;
+        memcpy(&block, &bytes[offset], sizeof(block));
+        if (block.magic == CHIP8_TRACE_BLOCK_MAGIC && block.bytes <= CHIP8_TRACE_BLOCK_SIZE)
+        {
+            blocks.push_back(std::make_pair(block.sequence, offset));
+            records += block.records;
+            recordBytes += block.bytes;
+        }
+    }
+    std::sort(blocks.begin(), blocks.end());
+    for (const std::pair<u64, u64>& b : blocks)
+        order.push_back(b.second);
+    lost = blocks.empty() ? 0 : blocks[0].first;
+    rewind();
+    return true;
+}
+
+void Chip8TraceReader::rewind()
+{
+    corrupt = false;
+    startBlock(0);
+}
+
+// Reads a zigzag LEB128 number, returns false if it runs past "end"
+static bool getSigned(const u8*& in, const u8* end, s64& value)
+{
+    u64 zigzag = 0;
+    for (u32 shift = 0; shift < 64; shift += 7)
+    {
+        if (in == end)
+            return false;
+        u8 byte = *in++;
+        zigzag |= (u64) (byte & 0x7f) << shift;
+        if (!(byte & 0x80))
+        {
+            value = (s64) (zigzag >> 1) ^ -(s64) (zigzag & 1);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool Chip8TraceReader::next(TRACE_RECORD& record)
+{
+    while (in == end)
+    {
+        if (blockIndex >= order.size())
+            return false;
+        startBlock(blockIndex + 1);
+    }
+
+    // A record that runs past the end of its block or names an opcode it never gave is not read any further
+    u8 flags = *in++;
+    s64 difference = 0;
+    if (flags & TRACE_GAP)
+    {
+        if (!getSigned(in, end, difference))
+            return fail();
+        nextInstruction += difference;
+    }
+    last.instruction = nextInstruction++;
+    u16 pc = last.PC + 2;
+    if (flags & TRACE_JUMP)
+    {
+        if (!getSigned(in, end, difference))
+            return fail();
+        pc += difference;
+    }
+    last.PC = pc;
+    u32& seen = opcodes[pc & (CHIP8_MEMORY_SIZE - 1)];
+    if (flags & TRACE_OPCODE)
+    {
+        if (end - in < 2)
+            return fail();
+        seen = (in[0] << 8) | in[1];
+        in += 2;
+    }
+    if (seen > 0xffff)
+        return fail();
+    last.opcode = seen;
+
+    // The masks then a byte for each bit set in them, numbered as "changed" numbers the registers
+    u32 masks[3] = {0, 0, 0};
+    for (u32 m = 0; m < 3; m++)
+    {
+        if (!(flags & (TRACE_V_LOW << m)))
+            continue;
+        if (in == end)
+            return fail();
+        masks[m] = *in++;
+    }
+    u8 other[5] = {(u8) last.I, (u8) (last.I >> 8), last.SP, last.DT, last.ST};
+    for (u32 changed = masks[0] | (masks[1] << 8) | (masks[2] << 16); changed; changed &= changed - 1)
+    {
+        u32 b = __builtin_ctz(changed);
+        if (in == end || b >= CHIP8_TOTAL_GENERAL_PURPOSE_REGISTERS + sizeof(other))
+            return fail();
+        if (b < CHIP8_TOTAL_GENERAL_PURPOSE_REGISTERS)
+            last.V[b] = *in++;
+        else
+            other[b - CHIP8_TOTAL_GENERAL_PURPOSE_REGISTERS] = *in++;
+    }
+    last.I = other[0] | (other[1] << 8);
+    last.SP = other[2];
+    last.DT = other[3];
+    last.ST = other[4];
+    last.changed = masks[0] | (masks[1] << 8);
+    if (masks[2] & 0x03)
+        last.changed |= 1 << CHIP8_REGISTER_I;
+    if (masks[2] & 0x04)
+        last.changed |= 1 << CHIP8_REGISTER_SP;
+    if (masks[2] & 0x08)
+        last.changed |= 1 << CHIP8_REGISTER_DT;
+    if (masks[2] & 0x10)
+        last.changed |= 1 << CHIP8_REGISTER_ST;
+
+    record = last;
+    return true;
+}
+
+u64 Chip8TraceReader::getRecords()
+{
+    return records;
+}
+
+u32 Chip8TraceReader::getBlocks()
+{
+    return order.size();
+}
+
+u64 Chip8TraceReader::getLostBlocks()
+{
+    return lost;
+}
+
+u64 Chip8TraceReader::getFileSize()
+{
+    return bytes.size();
+}
+
+u64 Chip8TraceReader::getRecordBytes()
+{
+    return recordBytes;
+}
+
+bool Chip8TraceReader::isCorrupt()
+{
+    return corrupt;
+}
+
+bool Chip8TraceReader::fail()
+{
+    corrupt = true;
+    in = end;
+    blockIndex = order.size();
+    return false;
+}
+
+void Chip8TraceReader::startBlock(u32 index)
+{
+    blockIndex = index;
+    in = end = NULL;
+    if (index >= order.size())
+        return;
+
+    TRACE_BLOCK_HEADER block;
+    memcpy(&block, &bytes[order[index]], sizeof(block));
+    in = &bytes[order[index] + sizeof(block)];
+    end = in + block.bytes;
+    memset(&last, 0, sizeof(last));
+    last.PC = block.PC;
+    last.I = block.I;
+    memcpy(last.V, block.V, sizeof(last.V));
+    last.SP = block.SP;
+    last.DT = block.DT;
+    last.ST = block.ST;
+    nextInstruction = block.instruction;
+    memset(opcodes, 0xff, sizeof(opcodes));
+}
+
+// True if two records are of the same instruction leaving the same registers
+static bool sameRecord(const TRACE_RECORD& a, const TRACE_RECORD& b)
+{
+    return a.instruction == b.instruction && a.PC == b.PC && a.opcode == b.opcode && memcmp(a.V, b.V, sizeof(a.V)) == 0 &&
+           a.I == b.I && a.SP == b.SP && a.DT == b.DT && a.ST == b.ST;
+}
+
+TRACE_DIFF traceDiff(Chip8TraceReader& a, Chip8TraceReader& b)
+{
+    TRACE_DIFF diff;
+    memset(&diff, 0, sizeof(diff));
+    a.rewind();
+    b.rewind();
+    while (true)
+    {
+        diff.endedA = !a.next(diff.a);
+        diff.endedB = !b.next(diff.b);
+        if (diff.endedA && diff.endedB)
+            return diff;
+        if (diff.endedA || diff.endedB || !sameRecord(diff.a, diff.b))
+            break;
+        diff.index++;
+    }
+    diff.found = true;
+    if (diff.endedA)
+        memset(&diff.a, 0, sizeof(diff.a));
+    if (diff.endedB)
+        memset(&diff.b, 0, sizeof(diff.b));
+    return diff;
+}
@@ -0,0 +1,400 @@
+#include <stdio.h>
+#include <string.h>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "Def.h"
+#include "Opcode.h"
+#include "Quirks.h"
+
+/* The Recompiler turns a chip8 ROM into a C++ source file holding a COMPILED_PROGRAM for it.
+ * It follows every path through the ROM from 0x200 using the same decoder as the interpreter, splits the code it
+ * reaches into basic blocks and writes each block as a label inside one function so the C++ compiler can optimise
+ * across instructions. "Bnnn", "00EE" and anything that leaves the ROM go back through a switch on "PC" and the
+ * interpreter takes over whenever "PC" is not a compiled block or compiled code has been written over.
+ *
+ * Usage: Recompiler <rom> <output.cpp> [name] [quirk profile] */
+
+// How a compiled instruction leaves its block
+enum FLOW
+{
+    // Carries on to the next instruction
+    FLOW_NEXT,
+    // Jumps to "nnn"
+    FLOW_JUMP,
+    // Calls "nnn", the return lands on the next instruction
+    FLOW_CALL,
+    // Skips, goes on to the next instruction or the one after it
+    FLOW_SKIP,
+    // Waits on "Fx0A", it goes on to the next instruction once a key is down and until then the machine is halted
+    FLOW_WAIT,
+    // "PC" is only known at run time, such as after "00EE" and "Bnnn"
+    FLOW_DYNAMIC
+};
+
+static FLOW instructionFlow(const INSTRUCTION& ins)
+{
+    switch(ins.cls)
+    {
+        case OPCODE_JP:
+            return FLOW_JUMP;
+        case OPCODE_CALL:
+            return FLOW_CALL;
+        case OPCODE_SE_VX_KK:
+        case OPCODE_SNE_VX_KK:
+        case OPCODE_SE_VX_VY:
+        case OPCODE_SNE_VX_VY:
+        case OPCODE_SKP:
+        case OPCODE_SKNP:
+            return FLOW_SKIP;
+        case OPCODE_LD_VX_K:
+            return FLOW_WAIT;
+        // A bad opcode usually means the walk has run into data so it is not followed any further
+        case OPCODE_RET:
+        case OPCODE_JP_V0:
+        case OPCODE_BAD:
+            return FLOW_DYNAMIC;
+        default:
+            return FLOW_NEXT;
+    }
+}
+
+// The handlers that write memory, compiled code has to check it was not written over after each of them
+static bool writesMemory(const INSTRUCTION& ins)
+{
+    return ins.cls == OPCODE_LD_B_VX || ins.cls == OPCODE_LD_I_VX;
+}
+
+class Recompiler
+{
+    public:
+        Recompiler(const std::vector<u8>& rom, u32 quirks)
+        {
+            this->rom = rom;
+            this->quirks = quirks;
+            memset(reachable, 0, sizeof(reachable));
+            memset(leader, 0, sizeof(leader));
+        }
+
+        // Finds every instruction reachable from 0x200 and marks where blocks start
+        void walk()
+        {
+            std::vector<u16> pending;
+            addLeader(CHIP8_PROGRAM_LOAD_ADDRESS, pending);
+            while (!pending.empty())
+            {
+                u16 address = pending.back();
+                pending.pop_back();
+
+                INSTRUCTION ins = decode(address);
+                switch(instructionFlow(ins))
+                {
+                    case FLOW_NEXT:
+                        addReachable(address + 2, pending);
+                    break;
+                    case FLOW_JUMP:
+                        addLeader(ins.nnn, pending);
+                    break;
+                    case FLOW_CALL:
+                        addLeader(ins.nnn, pending);
+                        addLeader(address + 2, pending);
+                    break;
+                    case FLOW_SKIP:
+                        addLeader(address + 2, pending);
+                        addLeader(address + 4, pending);
+                    break;
+                    case FLOW_WAIT:
+                        addLeader(address + 2, pending);
+                    break;
+                    case FLOW_DYNAMIC:
+                    break;
+                }
+            }
+        }
+
+        bool write(FILE* out, const char* romName, const std::string& name)
+        {
+            fprintf(out, "// Generated by tools/Recompiler from %s, do not edit\n", romName);
+            fprintf(out, "#include \"Chip8Core.h\"\n#include \"Compiled.h\"\n#include \"Handlers.h\"\n\n");
+
+            fprintf(out, "static const u8 rom[] = {");
+            for (size_t c = 0; c < rom.size(); c++)
+                fprintf(out, "%s0x%02x", c % 16 ? ", " : (c ? ",\n    " : "\n    "), rom[c]);
+            fprintf(out, "\n};\n\n");
+
+            fprintf(out, "static u32 run(Chip8Core& core, u32 count)\n{\n");
+            fprintf(out, "    CHIP8_STATE& s = core.getState();\n    u32 done = 0;\n    goto dispatch;\n");
+
+            u32 blocks = 0;
+            for (u32 address = 0; address < CHIP8_MEMORY_SIZE; address++)
+            {
+                if (leader[address] && reachable[address])
+                {
+                    writeBlock(out, address);
+                    blocks++;
+                }
+            }
+
+            // Anything that is not a compiled block goes back to the interpreter
+            fprintf(out, "\ndispatch:\n    if (core.hasQuit())\n        return done;\n    switch(s.PC)\n    {\n");
+            for (u32 address = 0; address < CHIP8_MEMORY_SIZE; address++)
+            {
+                if (leader[address] && reachable[address])
+                    fprintf(out, "        case 0x%03x: goto block_%03x;\n", address, address);
+            }
+            fprintf(out, "    }\n    return done;\n}\n\n");
+
+            fprintf(out, "static const COMPILED_PROGRAM program = {\n    \"%s\",\n    rom,\n    sizeof(rom),\n    {", name.c_str());
+            for (u32 word = 0; word < CHIP8_MEMORY_SIZE / 64; word++)
+            {
+                u64 bits = 0;
+                for (u32 bit = 0; bit < 64; bit++)
+                {
+                    u32 address = word * 64 + bit;
+                    if (reachable[address] || (address > 0 && reachable[address - 1]))
+                        bits |= 1ull << bit;
+                }
+                fprintf(out, "%s0x%016llxull", word % 4 ? ", " : (word ? ",\n     " : ""), bits);
+            }
+            fprintf(out, "},\n    &run,\n    0x%x\n};\n\n", quirks);
+            fprintf(out, "static COMPILED_PROGRAM_REGISTRAR registrar(&program);\n");
+
+            printf("%s: %u instructions in %u blocks\n", romName, countReachable(), blocks);
+            return !ferror(out);
+        }
+
+    private:
+        // Only instructions that lie wholly inside the ROM are compiled, the rest of memory can change at run time
+        bool inRom(u32 address)
+        {
+            return address >= CHIP8_PROGRAM_LOAD_ADDRESS && address + 1 < CHIP8_PROGRAM_LOAD_ADDRESS + rom.size();
+        }
+
+        INSTRUCTION decode(u16 address)
+        {
+            u32 offset = address - CHIP8_PROGRAM_LOAD_ADDRESS;
+            return decodeOpcode((rom[offset] << 8) | rom[offset + 1]);
+        }
+
+        void addReachable(u32 address, std::vector<u16>& pending)
+        {
+            if (!inRom(address) || reachable[address])
+                return;
+            reachable[address] = true;
+            pending.push_back(address);
+        }
+
+        void addLeader(u32 address, std::vector<u16>& pending)
+        {
+            if (!inRom(address))
+                return;
+            leader[address] = true;
+            addReachable(address, pending);
+        }
+
+        u32 countReachable()
+        {
+            u32 total = 0;
+            for (u32 address = 0; address < CHIP8_MEMORY_SIZE; address++)
+                total += reachable[address];
+            return total;
+        }
+
+        // Where control goes once "PC" is "address", straight to its block or through the dispatch switch
+        void writeGoto(FILE* out, const char* indent, u32 address)
+        {
+            fprintf(out, "%ss.PC = 0x%03x;\n", indent, address);
+            if (address < CHIP8_MEMORY_SIZE && leader[address] && reachable[address])
+                fprintf(out, "%sgoto block_%03x;\n", indent, address);
+            else
+                fprintf(out, "%sgoto dispatch;\n", indent);
+        }
+
+        void writeInstruction(FILE* out, const INSTRUCTION& ins)
+        {
+            // Only the opcodes a quirk changes need the quirk handlers, the rest stay plain so the output reads the same
+            if (quirksAffect(ins.cls, quirks))
+                fprintf(out, "QuirkHandlers<0x%x>::", quirks);
+            else
+                fprintf(out, "Handlers::");
+            fprintf(out, "%s(core, {OPCODE_%s, 0x%x, 0x%x, 0x%x, 0x%02x, 0x%03x, 0x%04x});\n",
+                    handlerName(ins.cls), handlerName(ins.cls), ins.x, ins.y, ins.n, ins.kk, ins.nnn, ins.opcode);
+        }
+
+        void writeBlock(FILE* out, u32 start)
+        {
+            // The block runs until an instruction that changes flow or the start of another block
+            std::vector<u32> addresses;
+            u32 address = start;
+            while (true)
+            {
+                addresses.push_back(address);
+                if (instructionFlow(decode(address)) != FLOW_NEXT)
+                    break;
+                address += 2;
+                if (!inRom(address) || leader[address])
+                    break;
+            }
+
+            u32 total = addresses.size();
+            fprintf(out, "\nblock_%03x:\n    {\n", start);
+            fprintf(out, "        if (count - done < %u)\n            return done;\n        done += %u;\n", total, total);
+
+            for (u32 c = 0; c < total; c++)
+            {
+                u32 at = addresses[c];
+                u32 next = at + 2;
+                INSTRUCTION ins = decode(at);
+                fprintf(out, "        // 0x%03x: %04x %s\n", at, ins.opcode, opcodeClassName(ins.cls));
+
+                switch(instructionFlow(ins))
+                {
+                    case FLOW_NEXT:
+                        if (writesMemory(ins))
+                            fprintf(out, "        s.PC = 0x%03x;\n", next);
+                        fprintf(out, "        ");
+                        writeInstruction(out, ins);
+                        fprintf(out, "        Handlers::tickTimers(core);\n");
+                        if (writesMemory(ins))
+                            fprintf(out, "        if (core.isCompiledCodeStale())\n            return done - %u;\n", total - c - 1);
+                        if (c == total - 1)
+                            writeGoto(out, "        ", next);
+                    break;
+                    case FLOW_JUMP:
+                        fprintf(out, "        Handlers::tickTimers(core);\n");
+                        writeGoto(out, "        ", ins.nnn);
+                    break;
+                    case FLOW_CALL:
+                        fprintf(out, "        s.PC = 0x%03x;\n        ", next);
+                        writeInstruction(out, ins);
+                        fprintf(out, "        Handlers::tickTimers(core);\n");
+                        fprintf(out, "        if (core.hasQuit())\n            return done;\n");
+                        writeGoto(out, "        ", ins.nnn);
+                    break;
+                    case FLOW_SKIP:
+                        fprintf(out, "        bool skip = %s;\n", skipCondition(ins).c_str());
+                        fprintf(out, "        Handlers::tickTimers(core);\n");
+                        fprintf(out, "        if (skip)\n        {\n");
+                        writeGoto(out, "            ", at + 4);
+                        fprintf(out, "        }\n");
+                        writeGoto(out, "        ", next);
+                    break;
+                    case FLOW_WAIT:
+                        // A halted machine goes back to the engine, which waits out the rest of the call
+                        fprintf(out, "        s.PC = 0x%03x;\n        ", next);
+                        writeInstruction(out, ins);
+                        fprintf(out, "        Handlers::tickTimers(core);\n");
+                        fprintf(out, "        if (s.keyWait)\n            return done;\n");
+                        writeGoto(out, "        ", next);
+                    break;
+                    case FLOW_DYNAMIC:
+                        fprintf(out, "        s.PC = 0x%03x;\n        ", next);
+                        writeInstruction(out, ins);
+                        fprintf(out, "        Handlers::tickTimers(core);\n        goto dispatch;\n");
+                    break;
+                }
+            }
+
+            fprintf(out, "    }\n");
+        }
+
+        std::string skipCondition(const INSTRUCTION& ins)
+        {
+            char text[64];
+            switch(ins.cls)
+            {
+                case OPCODE_SE_VX_KK:
+                    snprintf(text, sizeof(text), "s.V[0x%x] == 0x%02x", ins.x, ins.kk);
+                break;
+                case OPCODE_SNE_VX_KK:
+                    snprintf(text, sizeof(text), "s.V[0x%x] != 0x%02x", ins.x, ins.kk);
+                break;
+                case OPCODE_SE_VX_VY:
+                    snprintf(text, sizeof(text), "s.V[0x%x] == s.V[0x%x]", ins.x, ins.y);
+                break;
+                case OPCODE_SNE_VX_VY:
+                    snprintf(text, sizeof(text), "s.V[0x%x] != s.V[0x%x]", ins.x, ins.y);
+                break;
+                case OPCODE_SKP:
+                    snprintf(text, sizeof(text), "s.keys[s.V[0x%x] & 0x0f] != 0", ins.x);
+                break;
+                default:
+                    snprintf(text, sizeof(text), "s.keys[s.V[0x%x] & 0x0f] == 0", ins.x);
+                break;
+            }
+            return text;
+        }
+
+        static const char* handlerName(u8 cls)
+        {
+            #define CHIP8_HANDLER_NAME(name, text) #name,
+            static const char* const names[OPCODE_CLASS_COUNT] = { CHIP8_OPCODE_CLASSES(CHIP8_HANDLER_NAME) };
+            #undef CHIP8_HANDLER_NAME
+            return names[cls];
+        }
+
+        std::vector<u8> rom;
+        // The quirk bits the program is compiled for
+        u32 quirks;
+        // Non-zero for every address an instruction was found at
+        u8 reachable[CHIP8_MEMORY_SIZE];
+        // Non-zero for every address a block starts at
+        u8 leader[CHIP8_MEMORY_SIZE];
+};
+
+// Turns a file name such as "roms/PONG.c8" into "PONG"
+static std::string programName(const char* path)
+{
+    std::string name = path;
+    size_t slash = name.find_last_of("/\\");
+    if (slash != std::string::npos)
+        name = name.substr(slash + 1);
+    size_t dot = name.find('.');
+    if (dot != std::string::npos)
+        name = name.substr(0, dot);
+    return name;
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 3)
+    {
+        printf("Usage: %s <rom> <output.cpp> [name] [quirk profile]\n", argv[0]);
+        return 1;
+    }
+
+    std::ifstream file(argv[1], std::ios::binary);
+    std::vector<u8> rom((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (!file.good() && !file.eof())
+    {
+        printf("Failed to read %s\n", argv[1]);
+        return 1;
+    }
+    if (rom.empty() || rom.size() > CHIP8_MEMORY_SIZE - CHIP8_PROGRAM_LOAD_ADDRESS)
+    {
+        printf("%s is not a chip8 ROM\n", argv[1]);
+        return 1;
+    }
+
+    QUIRK_PROFILE profile = argc > 4 ? findQuirkProfile(argv[4]) : QUIRK_PROFILE_DEFAULT;
+    if (profile == QUIRK_PROFILE_COUNT)
+    {
+        printf("Unknown quirk profile %s\n", argv[4]);
+        return 1;
+    }
+
+    Recompiler recompiler(rom, quirkProfileQuirks(profile));
+    recompiler.walk();
+
+    FILE* out = fopen(argv[2], "w");
+    if (out == NULL)
+    {
+        printf("Failed to open %s\n", argv[2]);
+        return 1;
+    }
+
+    std::string name = argc > 3 ? argv[3] : programName(argv[1]);
+    bool ok = recompiler.write(out, argv[1], name);
+    fclose(out);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,246 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <deque>
+#include <string>
+#include "Breakpoints.h"
+#include "Def.h"
+#include "Opcode.h"
+#include "Trace.h"
+
+/* The TraceTool reads the traces "trace" and "tracering" record and answers questions about them offline.
+ *
+ * Usage: TraceTool stats <trace>
+ *        TraceTool dump <trace> [first] [count]
+ *        TraceTool find <trace> <PC> [count]            the first times the instruction at "PC" ran
+ *        TraceTool writes <trace> <register> [PC] [count]  the last writes to a register before "PC" first ran
+ *        TraceTool diff <trace> <trace>                 the first instruction the two traces disagree on
+ *
+ * Numbers are decimal or hexadecimal with 0x, registers are V0-VF, I, DT, ST and SP. */
+
+// How many records "diff" shows before the first difference
+#define TRACE_TOOL_CONTEXT 4
+
+static u16 recordRegister(const TRACE_RECORD& record, u8 reg)
+{
+    switch(reg)
+    {
+        case CHIP8_REGISTER_I: return record.I;
+        case CHIP8_REGISTER_DT: return record.DT;
+        case CHIP8_REGISTER_ST: return record.ST;
+        case CHIP8_REGISTER_SP: return record.SP;
+        case CHIP8_REGISTER_PC: return record.PC;
+        default: return record.V[reg & 0x0f];
+    }
+}
+
+// Prints a record as its instruction count, address, opcode, opcode class and the registers it changed
+static void printRecord(const char* prefix, const TRACE_RECORD& record)
+{
+    printf("%s%12llu  %03X  %04X  %-4s ", prefix, (unsigned long long) record.instruction, record.PC, record.opcode,
+           opcodeClassName(decodeOpcode(record.opcode).cls));
+    for (u8 r = 0; r < CHIP8_REGISTER_PC; r++)
+    {
+        if (record.changed & (1 << r))
+            printf(" %s=%X", registerName(r), recordRegister(record, r));
+    }
+    printf("\n");
+}
+
+static bool loadTrace(Chip8TraceReader& reader, const char* fname)
+{
+    if (reader.load(fname))
+        return true;
+    printf("%s is not a trace\n", fname);
+    return false;
+}
+
+static u64 number(int argc, char* argv[], int index, u64 otherwise)
+{
+    return argc > index ? strtoull(argv[index], NULL, 0) : otherwise;
+}
+
+// Reports a trace that stopped decoding part way, a crash can leave the last record of a block half written
+static void checkCorrupt(Chip8TraceReader& reader)
+{
+    if (reader.isCorrupt())
+        printf("The trace stops decoding here, the rest of it was not read\n");
+}
+
+static int stats(Chip8TraceReader& reader)
+{
+    TRACE_RECORD record;
+    u64 records = 0;
+    u64 gaps = 0;
+    u64 first = 0;
+    u64 last = 0;
+    u64 previous = 0;
+    while (reader.next(record))
+    {
+        if (records == 0)
+            first = record.instruction;
+        else if (record.instruction != previous + 1)
+            gaps++;
+        previous = last = record.instruction;
+        records++;
+    }
+    printf("%llu records in %u blocks, %llu bytes of records, %.2f a record, in a file of %llu bytes\n",
+           (unsigned long long) records, reader.getBlocks(), (unsigned long long) reader.getRecordBytes(),
+           records ? (double) reader.getRecordBytes() / records : 0.0, (unsigned long long) reader.getFileSize());
+    if (records)
+        printf("Instructions %llu to %llu, %llu jumps in the count from halts, rewinds or loads\n", (unsigned long long) first,
+               (unsigned long long) last, (unsigned long long) gaps);
+    if (reader.getLostBlocks())
+        printf("The ring went round, %llu blocks before these were written over\n", (unsigned long long) reader.getLostBlocks());
+    checkCorrupt(reader);
+    return 0;
+}
+
+static int dump(Chip8TraceReader& reader, u64 first, u64 count)
+{
+    TRACE_RECORD record;
+    for (u64 index = 0; count && reader.next(record); index++)
+    {
+        if (index < first)
+            continue;
+        printRecord("", record);
+        count--;
+    }
+    checkCorrupt(reader);
+    return 0;
+}
+
+static int find(Chip8TraceReader& reader, u16 pc, u64 count)
+{
+    TRACE_RECORD record;
+    u64 found = 0;
+    while (found < count && reader.next(record))
+    {
+        if (record.PC != pc)
+            continue;
+        printRecord("", record);
+        found++;
+    }
+    if (found == 0)
+        printf("Nothing ran at %03X\n", pc);
+    checkCorrupt(reader);
+    return 0;
+}
+
+// "pc" past the end of memory looks through the whole trace
+static int writes(Chip8TraceReader& reader, u8 reg, u32 pc, u64 count)
+{
+    std::deque<TRACE_RECORD> last;
+    TRACE_RECORD record;
+    bool reached = false;
+    while (reader.next(record))
+    {
+        if (record.PC == pc)
+        {
+            reached = true;
+            break;
+        }
+        if (!(record.changed & (1 << reg)))
+            continue;
+        last.push_back(record);
+        if (last.size() > count)
+            last.pop_front();
+    }
+
+    if (pc < CHIP8_MEMORY_SIZE)
+        printf("The last writes to %s before %03X %s\n", registerName(reg), pc, reached ? "first ran" : "which never ran");
+    for (const TRACE_RECORD& write : last)
+        printRecord("", write);
+    if (reached)
+        printRecord("then ", record);
+    if (last.empty())
+        printf("Nothing wrote %s\n", registerName(reg));
+    checkCorrupt(reader);
+    return 0;
+}
+
+static int diff(Chip8TraceReader& a, Chip8TraceReader& b)
+{
+    TRACE_DIFF difference = traceDiff(a, b);
+    if (!difference.found)
+    {
+        printf("The traces agree on all %llu records\n", (unsigned long long) difference.index);
+        return 0;
+    }
+
+    printf("The traces agree on %llu records, then\n", (unsigned long long) difference.index);
+    // The records both traces agree on leading up to the difference
+    a.rewind();
+    TRACE_RECORD record;
+    for (u64 index = 0; index < difference.index && a.next(record); index++)
+    {
+        if (index + TRACE_TOOL_CONTEXT >= difference.index)
+            printRecord("   ", record);
+    }
+    if (difference.endedA)
+        printf("a: the trace ends\n");
+    else
+        printRecord("a: ", difference.a);
+    if (difference.endedB)
+        printf("b: the trace ends\n");
+    else
+        printRecord("b: ", difference.b);
+
+    // The registers that differ after the first instruction they disagree on
+    if (!difference.endedA && !difference.endedB)
+    {
+        for (u8 r = 0; r < CHIP8_REGISTER_PC; r++)
+        {
+            u16 x = recordRegister(difference.a, r);
+            u16 y = recordRegister(difference.b, r);
+            if (x != y)
+                printf("   %s is %X in a and %X in b\n", registerName(r), x, y);
+        }
+    }
+    return 1;
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 3)
+    {
+        printf("Usage: %s stats <trace>\n"
+               "       %s dump <trace> [first] [count]\n"
+               "       %s find <trace> <PC> [count]\n"
+               "       %s writes <trace> <register> [PC] [count]\n"
+               "       %s diff <trace> <trace>\n", argv[0], argv[0], argv[0], argv[0], argv[0]);
+        return 1;
+    }
+
+    std::string command = argv[1];
+    Chip8TraceReader reader;
+    if (!loadTrace(reader, argv[2]))
+        return 1;
+
+    if (command == "stats")
+        return stats(reader);
+    if (command == "dump")
+        return dump(reader, number(argc, argv, 3, 0), number(argc, argv, 4, 100));
+    if (command == "find" && argc > 3)
+        return find(reader, number(argc, argv, 3, 0), number(argc, argv, 4, 10));
+    if (command == "writes" && argc > 3)
+    {
+        u8 reg = findRegister(argv[3]);
+        if (reg >= CHIP8_REGISTER_PC)
+        {
+            printf("%s is not a register a trace records writes to, use V0-VF, I, DT, ST or SP\n", argv[3]);
+            return 1;
+        }
+        return writes(reader, reg, number(argc, argv, 4, CHIP8_MEMORY_SIZE), number(argc, argv, 5, 8));
+    }
+    if (command == "diff" && argc > 3)
+    {
+        Chip8TraceReader other;
+        if (!loadTrace(other, argv[3]))
+            return 1;
+        return diff(reader, other);
+    }
+
+    printf("Unknown command %s, run %s without arguments for the usage\n", argv[1], argv[0]);
+    return 1;
+}